@@ -0,0 +1,238 @@
+/*!
+ * \file archiveRehydrator.cpp
+ * \brief Command line tool to make self-contained log archive.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+#include <fcntl.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "artifactStoreFormat.hpp"
+#include "zipRewriter.hpp"
+
+/*!
+ * \brief Show usage.
+ * \param name [in] Program name.
+ */
+static void usage(const char *name) {
+  fprintf(stderr,
+          "Usage: %s [options] <archive file> <output file>\n"
+          "  -s, --store <dir>  Artifact store directory.\n"
+          "                     (default: recorded in archive, or "
+          ARTIFACT_STORE_DIRNAME " in directory of archive file)\n"
+          "  -h, --help         Show this message.\n",
+          name);
+}
+
+/*!
+ * \brief Read artifact from artifact store, and check its key.
+ * \param storeDir [in]  Artifact store directory.
+ * \param key      [in]  Key of artifact.
+ * \param data     [out] Content of artifact.
+ * \param mtime    [out] Modification time of artifact.
+ * \return Error message. Value is NULL if process is succeed.
+ */
+static const char *readArtifact(const std::string &storeDir,
+                                const std::string &key, std::string *data,
+                                time_t *mtime) {
+  /* Key must not point outside of artifact store. */
+  if (key.empty() || (key.find('/') != std::string::npos) ||
+      (key[0] == '.')) {
+    return "Invalid key.";
+  }
+
+  std::string path = storeDir + "/" + key;
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd == -1) {
+    return "Artifact is not in artifact store.";
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) == -1) {
+    close(fd);
+    return "Could not get size of artifact.";
+  }
+  *mtime = st.st_mtime;
+
+  data->resize(st.st_size);
+  size_t readLen = 0;
+  while (readLen < data->size()) {
+    ssize_t readSize = read(fd, &(*data)[readLen], data->size() - readLen);
+    if (readSize <= 0) {
+      close(fd);
+      return "Could not read artifact.";
+    }
+    readLen += readSize;
+  }
+  close(fd);
+
+  char actualKey[ARTIFACT_KEY_LENGTH];
+  makeArtifactKey(data->data(), data->size(), actualKey);
+  if (key != actualKey) {
+    return "Artifact is broken.";
+  }
+
+  return NULL;
+}
+
+/*!
+ * \brief Copy entries of archive, and add artifacts in manifest.
+ * \param rewriter    [in] Rewriter of archive.
+ * \param storeDir    [in] Artifact store directory.
+ * \param isSpecified [in] Artifact store is specified by option.<br>
+ *                         Store which is recorded in manifest is used
+ *                         instead of storeDir if it is false.
+ * \return Value is zero, if process is succeed.
+ */
+static int rehydrate(TZipRewriter *rewriter, std::string storeDir,
+                     bool isSpecified) {
+  const TZipSourceEntry *manifestEntry =
+      rewriter->findEntry(ARTIFACT_MANIFEST_FILENAME);
+  std::string manifest;
+  if (manifestEntry != NULL) {
+    rewriter->readEntry(manifestEntry, &manifest);
+  }
+
+  const std::vector<TZipSourceEntry> &entries = rewriter->getEntries();
+  for (size_t idx = 0; idx < entries.size(); idx++) {
+    if (&entries[idx] != manifestEntry) {
+      rewriter->copyEntry(&entries[idx]);
+    }
+  }
+
+  /* Each line is "<key>\t<entry name>" after path of artifact store. */
+  size_t pos = 0;
+  int lineNum = 0;
+  while (pos < manifest.size()) {
+    size_t lineEnd = manifest.find('\n', pos);
+    if (lineEnd == std::string::npos) {
+      lineEnd = manifest.size();
+    }
+    std::string line = manifest.substr(pos, lineEnd - pos);
+    pos = lineEnd + 1;
+    lineNum++;
+
+    size_t separator = line.find('\t');
+    if (separator == std::string::npos) {
+      fprintf(stderr, "%s:%d: Invalid line.\n", ARTIFACT_MANIFEST_FILENAME,
+              lineNum);
+      return 1;
+    }
+    std::string key = line.substr(0, separator);
+    std::string name = line.substr(separator + 1);
+
+    /* Store of agent is used if it exists. */
+    if (key == ARTIFACT_MANIFEST_STORE_KEY) {
+      struct stat st;
+      if (!isSpecified && (stat(name.c_str(), &st) == 0) &&
+          S_ISDIR(st.st_mode)) {
+        storeDir = name;
+      }
+      continue;
+    }
+
+    std::string data;
+    time_t mtime;
+    const char *errMsg = readArtifact(storeDir, key, &data, &mtime);
+    if (errMsg != NULL) {
+      fprintf(stderr, "%s (%s): %s\n", name.c_str(), key.c_str(), errMsg);
+      return 1;
+    }
+
+    rewriter->addEntry(name.c_str(), data.data(), data.size(), mtime);
+  }
+
+  return 0;
+}
+
+/*!
+ * \brief Main function.
+ * \param argc [in] Count of arguments.
+ * \param argv [in] Arguments.
+ * \return Exit status.
+ */
+int main(int argc, char *argv[]) {
+  const char *storeDir = NULL;
+
+  static struct option longOptions[] = {{"store", required_argument, NULL, 's'},
+                                        {"help", no_argument, NULL, 'h'},
+                                        {NULL, 0, NULL, 0}};
+
+  int opt;
+  while ((opt = getopt_long(argc, argv, "s:h", longOptions, NULL)) != -1) {
+    switch (opt) {
+      case 's':
+        storeDir = optarg;
+        break;
+      case 'h':
+        usage(argv[0]);
+        return 0;
+      default:
+        usage(argv[0]);
+        return 1;
+    }
+  }
+
+  if (optind != argc - 2) {
+    usage(argv[0]);
+    return 1;
+  }
+  const char *archiveFile = argv[optind];
+  const char *outputFile = argv[optind + 1];
+
+  std::string store;
+  if (storeDir != NULL) {
+    store = storeDir;
+  } else {
+    const char *separator = strrchr(archiveFile, '/');
+    store = (separator == NULL)
+                ? std::string(".")
+                : std::string(archiveFile, separator - archiveFile);
+    store += "/" ARTIFACT_STORE_DIRNAME;
+  }
+
+  TZipRewriter *rewriter = NULL;
+  try {
+    rewriter = new TZipRewriter(archiveFile, outputFile);
+  } catch (const char *errMsg) {
+    fprintf(stderr, "%s: %s\n", archiveFile, errMsg);
+    return 1;
+  }
+
+  /* Output file is removed by destructor if it is not finished. */
+  int result = 0;
+  try {
+    result = rehydrate(rewriter, store, storeDir != NULL);
+    if (result == 0) {
+      rewriter->finish();
+    }
+  } catch (const char *errMsg) {
+    fprintf(stderr, "%s: %s\n", archiveFile, errMsg);
+    result = 1;
+  }
+
+  delete rewriter;
+  return result;
+}
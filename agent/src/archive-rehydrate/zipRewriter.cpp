@@ -0,0 +1,634 @@
+/*!
+ * \file zipRewriter.cpp
+ * \brief Rewriter of zip archive file.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include "zipRewriter.hpp"
+
+/* Signatures and sizes of zip records. */
+#define ZIP_LOCAL_HEADER_SIG 0x04034b50
+#define ZIP_CENTRAL_HEADER_SIG 0x02014b50
+#define ZIP_END_OF_CENTRAL_SIG 0x06054b50
+#define ZIP64_END_OF_CENTRAL_SIG 0x06064b50
+#define ZIP64_LOCATOR_SIG 0x07064b50
+#define ZIP_LOCAL_HEADER_SIZE 30
+#define ZIP_CENTRAL_HEADER_SIZE 46
+#define ZIP_END_OF_CENTRAL_SIZE 22
+#define ZIP64_END_OF_CENTRAL_SIZE 56
+#define ZIP64_LOCATOR_SIZE 20
+
+/*!
+ * \brief Header ID of zip64 extended information extra field.
+ */
+#define ZIP64_EXTRA_ID 0x0001
+
+/*!
+ * \brief Version needed to extract. (2.0: deflate, 4.5: zip64)
+ */
+#define ZIP_VERSION 20
+#define ZIP64_VERSION 45
+
+/*!
+ * \brief Version made by. (Upper byte 3: UNIX)
+ */
+#define ZIP_VERSION_MADE_BY ((3 << 8) | ZIP64_VERSION)
+
+/* Compression methods. */
+#define ZIP_METHOD_STORE 0
+#define ZIP_METHOD_DEFLATE 8
+
+/*!
+ * \brief Flag of general purpose bit which means data descriptor follows.
+ */
+#define ZIP_FLAG_DATA_DESCRIPTOR 0x0008
+
+/*!
+ * \brief Value of 32 bit field which means value is in zip64 extension.
+ */
+#define ZIP_MAX_SIZE 0xffffffffULL
+
+/*!
+ * \brief Value of 16 bit field which means value is in zip64 extension.
+ */
+#define ZIP_MAX_COUNT 0xffff
+
+/*!
+ * \brief Read little endian integer.
+ * \param src [in] Data.
+ * \return Value.
+ */
+static inline uint16_t getUInt16(const unsigned char *src) {
+  return (uint16_t)(src[0] | (src[1] << 8));
+}
+
+static inline uint32_t getUInt32(const unsigned char *src) {
+  return (uint32_t)src[0] | ((uint32_t)src[1] << 8) |
+         ((uint32_t)src[2] << 16) | ((uint32_t)src[3] << 24);
+}
+
+static inline uint64_t getUInt64(const unsigned char *src) {
+  return (uint64_t)getUInt32(src) | ((uint64_t)getUInt32(src + 4) << 32);
+}
+
+/*!
+ * \brief Write little endian integer.
+ * \param dest  [out] Destination.
+ * \param value [in]  Value.
+ */
+static inline void putUInt16(unsigned char *dest, uint16_t value) {
+  dest[0] = (unsigned char)value;
+  dest[1] = (unsigned char)(value >> 8);
+}
+
+static inline void putUInt32(unsigned char *dest, uint32_t value) {
+  dest[0] = (unsigned char)value;
+  dest[1] = (unsigned char)(value >> 8);
+  dest[2] = (unsigned char)(value >> 16);
+  dest[3] = (unsigned char)(value >> 24);
+}
+
+static inline void putUInt64(unsigned char *dest, uint64_t value) {
+  putUInt32(dest, (uint32_t)value);
+  putUInt32(dest + 4, (uint32_t)(value >> 32));
+}
+
+/*!
+ * \brief Append 32 bit field of zip record. Value over 32 bits is appended
+ *        to zip64 extra field instead.
+ * \param dest  [out] Destination of 32 bit field.
+ * \param extra [out] Zip64 extra field.
+ * \param value [in]  Value.
+ */
+static void putZipField(unsigned char *dest, std::string *extra,
+                        uint64_t value) {
+  if (value < ZIP_MAX_SIZE) {
+    putUInt32(dest, (uint32_t)value);
+  } else {
+    putUInt32(dest, (uint32_t)ZIP_MAX_SIZE);
+    unsigned char buf[8];
+    putUInt64(buf, value);
+    extra->append((const char *)buf, sizeof(buf));
+  }
+}
+
+/*!
+ * \brief Make zip64 extra field from its data.
+ * \param data [in] Values of zip64 extra field.
+ * \return Extra field. Value is empty if data is empty.
+ */
+static std::string makeZip64Extra(const std::string &data) {
+  if (data.empty()) {
+    return data;
+  }
+
+  unsigned char header[4];
+  putUInt16(header, ZIP64_EXTRA_ID);
+  putUInt16(header + 2, (uint16_t)data.size());
+  return std::string((const char *)header, sizeof(header)) + data;
+}
+
+/*!
+ * \brief Convert time to MS-DOS form.
+ * \param mtime   [in]  Time.
+ * \param dosTime [out] Time in MS-DOS form.
+ * \param dosDate [out] Date in MS-DOS form.
+ */
+static void toDosTime(time_t mtime, uint16_t *dosTime, uint16_t *dosDate) {
+  struct tm tm;
+  localtime_r(&mtime, &tm);
+
+  /* MS-DOS date starts from 1980. */
+  if (tm.tm_year < 80) {
+    tm.tm_year = 80;
+    tm.tm_mon = 0;
+    tm.tm_mday = 1;
+    tm.tm_hour = tm.tm_min = tm.tm_sec = 0;
+  }
+
+  *dosTime = (uint16_t)((tm.tm_hour << 11) | (tm.tm_min << 5) |
+                        (tm.tm_sec >> 1));
+  *dosDate = (uint16_t)(((tm.tm_year - 80) << 9) | ((tm.tm_mon + 1) << 5) |
+                        tm.tm_mday);
+}
+
+/*!
+ * \brief TZipRewriter constructor.
+ * \param source [in] Source archive file.
+ * \param output [in] Output archive file.
+ */
+TZipRewriter::TZipRewriter(const char *source, const char *output)
+    : entries(), outputPath(output), centralHeaders() {
+  outputSize = 0;
+
+  int srcFd = open(source, O_RDONLY);
+  if (srcFd == -1) {
+    throw "Could not open archive file.";
+  }
+
+  struct stat st;
+  if ((fstat(srcFd, &st) == -1) || (st.st_size < ZIP_END_OF_CENTRAL_SIZE)) {
+    close(srcFd);
+    throw "Archive file is too small.";
+  }
+
+  mappedSize = st.st_size;
+  mapped = (unsigned char *)mmap(NULL, mappedSize, PROT_READ, MAP_PRIVATE,
+                                 srcFd, 0);
+  close(srcFd);
+  if (mapped == MAP_FAILED) {
+    throw "Could not map archive file.";
+  }
+
+  try {
+    parse();
+  } catch (...) {
+    munmap(mapped, mappedSize);
+    throw;
+  }
+
+  fd = open(output, O_CREAT | O_EXCL | O_WRONLY, 0644);
+  if (fd == -1) {
+    munmap(mapped, mappedSize);
+    throw "Could not create output file.";
+  }
+}
+
+/*!
+ * \brief TZipRewriter destructor.<br>
+ *        Output file is removed if it is not finished.
+ */
+TZipRewriter::~TZipRewriter(void) {
+  if (fd != -1) {
+    close(fd);
+    unlink(outputPath.c_str());
+  }
+
+  munmap(mapped, mappedSize);
+}
+
+/*!
+ * \brief Parse central directory of source archive.
+ */
+void TZipRewriter::parse(void) {
+  /* End of central directory record is followed by comment up to 64 KiB. */
+  const unsigned char *record = NULL;
+  size_t pos = mappedSize - ZIP_END_OF_CENTRAL_SIZE;
+  size_t limit = (pos > 0xffff) ? pos - 0xffff : 0;
+  while (true) {
+    if (getUInt32(mapped + pos) == ZIP_END_OF_CENTRAL_SIG) {
+      record = mapped + pos;
+      break;
+    }
+    if (pos == limit) {
+      throw "End of central directory is not found.";
+    }
+    pos--;
+  }
+
+  uint64_t count = getUInt16(record + 10);
+  uint64_t centralSize = getUInt32(record + 12);
+  uint64_t centralOffset = getUInt32(record + 16);
+  uint64_t recordOffset = record - mapped;
+  if ((count == ZIP_MAX_COUNT) || (centralSize == ZIP_MAX_SIZE) ||
+      (centralOffset == ZIP_MAX_SIZE)) {
+    /* Zip64 end of central directory record is pointed by locator. */
+    const unsigned char *locator = record - ZIP64_LOCATOR_SIZE;
+    if ((recordOffset < ZIP64_LOCATOR_SIZE) ||
+        (getUInt32(locator) != ZIP64_LOCATOR_SIG)) {
+      throw "Zip64 end of central directory locator is not found.";
+    }
+
+    recordOffset = getUInt64(locator + 8);
+    if ((recordOffset + ZIP64_END_OF_CENTRAL_SIZE > mappedSize) ||
+        (getUInt32(mapped + recordOffset) != ZIP64_END_OF_CENTRAL_SIG)) {
+      throw "Zip64 end of central directory is broken.";
+    }
+
+    const unsigned char *record64 = mapped + recordOffset;
+    count = getUInt64(record64 + 32);
+    centralSize = getUInt64(record64 + 40);
+    centralOffset = getUInt64(record64 + 48);
+  }
+  if ((centralOffset > recordOffset) ||
+      (centralSize > recordOffset - centralOffset)) {
+    throw "Central directory is broken.";
+  }
+
+  const unsigned char *header = mapped + centralOffset;
+  const unsigned char *end = header + centralSize;
+  for (uint64_t idx = 0; idx < count; idx++) {
+    if ((header + ZIP_CENTRAL_HEADER_SIZE > end) ||
+        (getUInt32(header) != ZIP_CENTRAL_HEADER_SIG)) {
+      throw "Central directory is broken.";
+    }
+
+    uint16_t nameLen = getUInt16(header + 28);
+    uint16_t extraLen = getUInt16(header + 30);
+    uint16_t commentLen = getUInt16(header + 32);
+    size_t headerSize = ZIP_CENTRAL_HEADER_SIZE + nameLen + extraLen +
+                        commentLen;
+    if (header + headerSize > end) {
+      throw "Central directory is broken.";
+    }
+
+    TZipSourceEntry entry;
+    entry.name.assign((const char *)header + ZIP_CENTRAL_HEADER_SIZE,
+                      nameLen);
+    entry.flags = getUInt16(header + 8);
+    entry.method = getUInt16(header + 10);
+    entry.dosTime = getUInt16(header + 12);
+    entry.dosDate = getUInt16(header + 14);
+    entry.crc = getUInt32(header + 16);
+    entry.csize = getUInt32(header + 20);
+    entry.size = getUInt32(header + 24);
+    entry.offset = getUInt32(header + 42);
+    entry.externalAttr = getUInt32(header + 38);
+
+    /* Values over 32 bits are in zip64 extra field in this order. */
+    const unsigned char *extra = header + ZIP_CENTRAL_HEADER_SIZE + nameLen;
+    const unsigned char *extraEnd = extra + extraLen;
+    while (extra + 4 <= extraEnd) {
+      uint16_t id = getUInt16(extra);
+      uint16_t len = getUInt16(extra + 2);
+      const unsigned char *data = extra + 4;
+      const unsigned char *dataEnd = data + len;
+      if (dataEnd > extraEnd) {
+        throw "Extra field is broken.";
+      }
+
+      if (id == ZIP64_EXTRA_ID) {
+        uint64_t *fields[] = {&entry.size, &entry.csize, &entry.offset};
+        for (int fieldIdx = 0; fieldIdx < 3; fieldIdx++) {
+          if (*fields[fieldIdx] != ZIP_MAX_SIZE) {
+            continue;
+          }
+          if (data + 8 > dataEnd) {
+            throw "Zip64 extra field is broken.";
+          }
+          *fields[fieldIdx] = getUInt64(data);
+          data += 8;
+        }
+      }
+
+      extra = dataEnd;
+    }
+
+    entries.push_back(entry);
+    header += headerSize;
+  }
+}
+
+/*!
+ * \brief Find entry of source archive.
+ * \param name [in] Entry name.
+ * \return Entry. Value is NULL if it is not in source archive.
+ */
+const TZipSourceEntry *TZipRewriter::findEntry(const char *name) const {
+  for (size_t idx = 0; idx < entries.size(); idx++) {
+    if (entries[idx].name == name) {
+      return &entries[idx];
+    }
+  }
+
+  return NULL;
+}
+
+/*!
+ * \brief Get local file header of source entry.<br>
+ *        Compressed data follows it.
+ * \param entry [in]  Entry of source archive.
+ * \param len   [out] Size of local header with name and extra field.
+ * \return Top of local file header in mapped file.
+ */
+const unsigned char *TZipRewriter::getLocalHeader(const TZipSourceEntry *entry,
+                                                  size_t *len) const {
+  if ((entry->offset + ZIP_LOCAL_HEADER_SIZE > mappedSize) ||
+      (getUInt32(mapped + entry->offset) != ZIP_LOCAL_HEADER_SIG)) {
+    throw "Local file header is broken.";
+  }
+
+  const unsigned char *header = mapped + entry->offset;
+  *len = ZIP_LOCAL_HEADER_SIZE + getUInt16(header + 26) +
+         getUInt16(header + 28);
+  if ((entry->csize > mappedSize) ||
+      (entry->offset + *len > mappedSize - entry->csize)) {
+    throw "Data of entry is broken.";
+  }
+
+  return header;
+}
+
+/*!
+ * \brief Read data of source entry.
+ * \param entry [in]  Entry of source archive.
+ * \param data  [out] Uncompressed data.
+ */
+void TZipRewriter::readEntry(const TZipSourceEntry *entry,
+                             std::string *data) const {
+  /* zlib takes 32 bit length. Only small entry like manifest is read. */
+  if ((entry->size >= ZIP_MAX_SIZE) || (entry->csize >= ZIP_MAX_SIZE)) {
+    throw "Entry is too large to read.";
+  }
+
+  size_t len;
+  const unsigned char *header = getLocalHeader(entry, &len);
+  const unsigned char *src = header + len;
+
+  if (entry->method == ZIP_METHOD_STORE) {
+    data->assign((const char *)src, entry->csize);
+  } else if (entry->method == ZIP_METHOD_DEFLATE) {
+    data->resize(entry->size);
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) {
+      throw "Could not initialize inflate.";
+    }
+
+    stream.next_in = (Bytef *)src;
+    stream.avail_in = (uInt)entry->csize;
+    stream.next_out = (Bytef *)&(*data)[0];
+    stream.avail_out = (uInt)entry->size;
+    int ret = inflate(&stream, Z_FINISH);
+    inflateEnd(&stream);
+    if ((ret != Z_STREAM_END) || (stream.avail_out != 0)) {
+      throw "Could not inflate entry.";
+    }
+  } else {
+    throw "Compression method of entry is not supported.";
+  }
+
+  if (crc32(crc32(0L, Z_NULL, 0), (const Bytef *)data->data(),
+            (uInt)data->size()) != entry->crc) {
+    throw "CRC of entry is mismatched.";
+  }
+}
+
+/*!
+ * \brief Copy entry of source archive to output as it is.
+ * \param entry [in] Entry of source archive.
+ */
+void TZipRewriter::copyEntry(const TZipSourceEntry *entry) {
+  size_t len;
+  const unsigned char *header = getLocalHeader(entry, &len);
+
+  /*
+   * CRC and sizes in central directory are written to new local file
+   * header, so data descriptor is not needed.
+   */
+  TZipSourceEntry copied = *entry;
+  copied.flags &= ~ZIP_FLAG_DATA_DESCRIPTOR;
+
+  writeHeader(&copied);
+  writeData(header + len, entry->csize);
+}
+
+/*!
+ * \brief Compress data and add it to output as new entry.
+ * \param name  [in] Entry name.
+ * \param data  [in] Data.
+ * \param size  [in] Size of data.
+ * \param mtime [in] Modification time.
+ */
+void TZipRewriter::addEntry(const char *name, const void *data, size_t size,
+                            time_t mtime) {
+  /* zlib takes 32 bit length. Artifacts are small files. */
+  if (size >= ZIP_MAX_SIZE) {
+    throw "Artifact is too large.";
+  }
+
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8,
+                   Z_DEFAULT_STRATEGY) != Z_OK) {
+    throw "Could not initialize deflate.";
+  }
+
+  std::string compressed;
+  compressed.resize(deflateBound(&stream, size));
+  stream.next_in = (Bytef *)data;
+  stream.avail_in = (uInt)size;
+  stream.next_out = (Bytef *)&compressed[0];
+  stream.avail_out = (uInt)compressed.size();
+  int ret = deflate(&stream, Z_FINISH);
+  compressed.resize(compressed.size() - stream.avail_out);
+  deflateEnd(&stream);
+  if (ret != Z_STREAM_END) {
+    throw "Could not deflate entry.";
+  }
+
+  TZipSourceEntry entry;
+  entry.name = name;
+  entry.flags = 0;
+  entry.method = ZIP_METHOD_DEFLATE;
+  toDosTime(mtime, &entry.dosTime, &entry.dosDate);
+  entry.crc = crc32(crc32(0L, Z_NULL, 0), (const Bytef *)data, (uInt)size);
+  entry.size = size;
+  entry.csize = compressed.size();
+  entry.offset = 0;
+  entry.externalAttr = (uint32_t)(S_IFREG | 0644) << 16;
+
+  writeHeader(&entry);
+  writeData(compressed.data(), compressed.size());
+}
+
+/*!
+ * \brief Write local file header of new entry, and keep its central
+ *        directory header. Data of entry must be written after this.
+ * \param entry [in] Entry. Offset is ignored.
+ */
+void TZipRewriter::writeHeader(const TZipSourceEntry *entry) {
+  /* Zip64 extra field in local header must have both sizes. */
+  bool isZip64 = (entry->size >= ZIP_MAX_SIZE) ||
+                 (entry->csize >= ZIP_MAX_SIZE);
+  std::string localExtra;
+  unsigned char local[ZIP_LOCAL_HEADER_SIZE];
+  memset(local, 0, sizeof(local));
+  putUInt32(local, ZIP_LOCAL_HEADER_SIG);
+  putUInt16(local + 4, isZip64 ? ZIP64_VERSION : ZIP_VERSION);
+  putUInt16(local + 6, entry->flags);
+  putUInt16(local + 8, entry->method);
+  putUInt16(local + 10, entry->dosTime);
+  putUInt16(local + 12, entry->dosDate);
+  putUInt32(local + 14, entry->crc);
+  if (isZip64) {
+    unsigned char sizes[16];
+    putUInt64(sizes, entry->size);
+    putUInt64(sizes + 8, entry->csize);
+    localExtra = makeZip64Extra(std::string((const char *)sizes, 16));
+    putUInt32(local + 18, (uint32_t)ZIP_MAX_SIZE);
+    putUInt32(local + 22, (uint32_t)ZIP_MAX_SIZE);
+  } else {
+    putUInt32(local + 18, (uint32_t)entry->csize);
+    putUInt32(local + 22, (uint32_t)entry->size);
+  }
+  putUInt16(local + 26, (uint16_t)entry->name.size());
+  putUInt16(local + 28, (uint16_t)localExtra.size());
+
+  std::string centralExtra;
+  unsigned char central[ZIP_CENTRAL_HEADER_SIZE];
+  memset(central, 0, sizeof(central));
+  putUInt32(central, ZIP_CENTRAL_HEADER_SIG);
+  putUInt16(central + 4, ZIP_VERSION_MADE_BY);
+  putUInt16(central + 8, entry->flags);
+  putUInt16(central + 10, entry->method);
+  putUInt16(central + 12, entry->dosTime);
+  putUInt16(central + 14, entry->dosDate);
+  putUInt32(central + 16, entry->crc);
+  putZipField(central + 24, &centralExtra, entry->size);
+  putZipField(central + 20, &centralExtra, entry->csize);
+  putZipField(central + 42, &centralExtra, outputSize);
+  centralExtra = makeZip64Extra(centralExtra);
+  putUInt16(central + 6, centralExtra.empty() ? ZIP_VERSION : ZIP64_VERSION);
+  putUInt16(central + 28, (uint16_t)entry->name.size());
+  putUInt16(central + 30, (uint16_t)centralExtra.size());
+  putUInt32(central + 38, entry->externalAttr);
+
+  centralHeaders.push_back(std::string((const char *)central,
+                                       sizeof(central)) +
+                           entry->name + centralExtra);
+
+  writeData(local, sizeof(local));
+  writeData(entry->name.data(), entry->name.size());
+  writeData(localExtra.data(), localExtra.size());
+}
+
+/*!
+ * \brief Write central directory, and close output archive.
+ */
+void TZipRewriter::finish(void) {
+  uint64_t centralOffset = outputSize;
+  for (size_t idx = 0; idx < centralHeaders.size(); idx++) {
+    writeData(centralHeaders[idx].data(), centralHeaders[idx].size());
+  }
+  uint64_t centralEnd = outputSize;
+  uint64_t centralSize = centralEnd - centralOffset;
+  uint64_t count = centralHeaders.size();
+
+  bool isZip64 = (count >= ZIP_MAX_COUNT) || (centralSize >= ZIP_MAX_SIZE) ||
+                 (centralOffset >= ZIP_MAX_SIZE);
+  if (isZip64) {
+    /* Zip64 end of central directory record and its locator. */
+    unsigned char record64[ZIP64_END_OF_CENTRAL_SIZE + ZIP64_LOCATOR_SIZE];
+    memset(record64, 0, sizeof(record64));
+    putUInt32(record64, ZIP64_END_OF_CENTRAL_SIG);
+    putUInt64(record64 + 4, ZIP64_END_OF_CENTRAL_SIZE - 12);
+    putUInt16(record64 + 12, ZIP_VERSION_MADE_BY);
+    putUInt16(record64 + 14, ZIP64_VERSION);
+    putUInt64(record64 + 24, count);
+    putUInt64(record64 + 32, count);
+    putUInt64(record64 + 40, centralSize);
+    putUInt64(record64 + 48, centralOffset);
+
+    unsigned char *locator = record64 + ZIP64_END_OF_CENTRAL_SIZE;
+    putUInt32(locator, ZIP64_LOCATOR_SIG);
+    putUInt64(locator + 8, centralEnd);
+    putUInt32(locator + 16, 1);
+    writeData(record64, sizeof(record64));
+  }
+
+  unsigned char record[ZIP_END_OF_CENTRAL_SIZE];
+  memset(record, 0, sizeof(record));
+  putUInt32(record, ZIP_END_OF_CENTRAL_SIG);
+  putUInt16(record + 8, isZip64 ? ZIP_MAX_COUNT : (uint16_t)count);
+  putUInt16(record + 10, isZip64 ? ZIP_MAX_COUNT : (uint16_t)count);
+  putUInt32(record + 12,
+            isZip64 ? (uint32_t)ZIP_MAX_SIZE : (uint32_t)centralSize);
+  putUInt32(record + 16,
+            isZip64 ? (uint32_t)ZIP_MAX_SIZE : (uint32_t)centralOffset);
+  writeData(record, sizeof(record));
+
+  if (close(fd) != 0) {
+    fd = -1;
+    unlink(outputPath.c_str());
+    throw "Could not write output file.";
+  }
+  fd = -1;
+}
+
+/*!
+ * \brief Write data to output archive.
+ * \param data [in] Data.
+ * \param size [in] Size of data.
+ */
+void TZipRewriter::writeData(const void *data, size_t size) {
+  const char *pos = (const char *)data;
+
+  while (size > 0) {
+    ssize_t written = write(fd, pos, size);
+    if (written == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw "Could not write output file.";
+    }
+
+    pos += written;
+    size -= written;
+    outputSize += written;
+  }
+}
@@ -0,0 +1,179 @@
+/*!
+ * \file zipRewriter.hpp
+ * \brief Rewriter of zip archive file.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+#ifndef ZIP_REWRITER_HPP
+#define ZIP_REWRITER_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <string>
+#include <vector>
+
+/*!
+ * \brief Entry of source archive.
+ */
+typedef struct {
+  std::string name;       /*!< Entry name.                          */
+  uint16_t flags;         /*!< General purpose bit flag.            */
+  uint16_t method;        /*!< Compression method.                  */
+  uint16_t dosTime;       /*!< Modification time in MS-DOS form.    */
+  uint16_t dosDate;       /*!< Modification date in MS-DOS form.    */
+  uint32_t crc;           /*!< CRC-32 of data.                      */
+  uint64_t size;          /*!< Size of data.                        */
+  uint64_t csize;         /*!< Size of compressed data.             */
+  uint64_t offset;        /*!< Offset of local file header.         */
+  uint32_t externalAttr;  /*!< External file attributes. e.g. mode. */
+} TZipSourceEntry;
+
+/*!
+ * \brief This class copies entries of zip archive to new archive, and adds
+ *        new entries.<br>
+ *        Data of copied entries is not recompressed. Headers are written
+ *        again, and zip64 extension is used for values over 32 bits.
+ */
+class TZipRewriter {
+ public:
+  /*!
+   * \brief TZipRewriter constructor.
+   * \param source [in] Source archive file.
+   * \param output [in] Output archive file.
+   */
+  TZipRewriter(const char *source, const char *output);
+
+  /*!
+   * \brief TZipRewriter destructor.<br>
+   *        Output file is removed if it is not finished.
+   */
+  virtual ~TZipRewriter(void);
+
+  /*!
+   * \brief Find entry of source archive.
+   * \param name [in] Entry name.
+   * \return Entry. Value is NULL if it is not in source archive.
+   */
+  const TZipSourceEntry *findEntry(const char *name) const;
+
+  /*!
+   * \brief Read data of source entry.
+   * \param entry [in]  Entry of source archive.
+   * \param data  [out] Uncompressed data.
+   */
+  void readEntry(const TZipSourceEntry *entry, std::string *data) const;
+
+  /*!
+   * \brief Copy entry of source archive to output as it is.
+   * \param entry [in] Entry of source archive.
+   */
+  void copyEntry(const TZipSourceEntry *entry);
+
+  /*!
+   * \brief Compress data and add it to output as new entry.
+   * \param name  [in] Entry name.
+   * \param data  [in] Data.
+   * \param size  [in] Size of data.
+   * \param mtime [in] Modification time.
+   */
+  void addEntry(const char *name, const void *data, size_t size,
+                time_t mtime);
+
+  /*!
+   * \brief Write central directory, and close output archive.
+   */
+  void finish(void);
+
+  /*!
+   * \brief Get entries of source archive.
+   * \return Entries in order of central directory.
+   */
+  inline const std::vector<TZipSourceEntry> &getEntries(void) const {
+    return entries;
+  }
+
+ protected:
+  /*!
+   * \brief Parse central directory of source archive.
+   */
+  void parse(void);
+
+  /*!
+   * \brief Get local file header of source entry.<br>
+   *        Compressed data follows it.
+   * \param entry [in]  Entry of source archive.
+   * \param len   [out] Size of local header with name and extra field.
+   * \return Top of local file header in mapped file.
+   */
+  const unsigned char *getLocalHeader(const TZipSourceEntry *entry,
+                                      size_t *len) const;
+
+  /*!
+   * \brief Write local file header of new entry, and keep its central
+   *        directory header. Data of entry must be written after this.
+   * \param entry [in] Entry. Offset is ignored.
+   */
+  void writeHeader(const TZipSourceEntry *entry);
+
+  /*!
+   * \brief Write data to output archive.
+   * \param data [in] Data.
+   * \param size [in] Size of data.
+   */
+  void writeData(const void *data, size_t size);
+
+ private:
+  /*!
+   * \brief Top of mapped source file.
+   */
+  unsigned char *mapped;
+
+  /*!
+   * \brief Size of mapped source file.
+   */
+  size_t mappedSize;
+
+  /*!
+   * \brief Entries of source archive.
+   */
+  std::vector<TZipSourceEntry> entries;
+
+  /*!
+   * \brief Path of output archive.
+   */
+  std::string outputPath;
+
+  /*!
+   * \brief File descriptor of output archive. -1 after finish().
+   */
+  int fd;
+
+  /*!
+   * \brief Current size of output archive.
+   */
+  uint64_t outputSize;
+
+  /*!
+   * \brief Central headers of output archive with name, extra and comment.
+   */
+  std::vector<std::string> centralHeaders;
+};
+
+#endif  // ZIP_REWRITER_HPP
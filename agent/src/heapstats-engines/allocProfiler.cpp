@@ -0,0 +1,398 @@
+/*!
+ * \file allocProfiler.cpp
+ * \brief This file is used to profile allocation sites through JVMTI
+ *        SampledObjectAlloc event.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ *
+ */
+
+#include <jvmti.h>
+#include <jni.h>
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+
+#ifdef HAVE_ATOMIC
+#include <atomic>
+#else
+#include <cstdatomic>
+#endif
+
+#include <string>
+
+#include "globals.hpp"
+#include "vmVariables.hpp"
+#include "vmFunctions.hpp"
+#include "callbackRegister.hpp"
+#include "callSiteTable.hpp"
+#include "allocProfiler.hpp"
+
+/*!
+ * \brief Max depth of stack trace which is recorded per sample.
+ */
+#define ALLOC_TRACE_MAX_DEPTH 16
+
+/*!
+ * \brief Number of slots in trace table and site table.
+ *        This value must be power of 2.
+ */
+#define ALLOC_TABLE_SIZE 65536
+
+/*!
+ * \brief Max count of linear probing in trace table.
+ */
+#define ALLOC_TABLE_MAX_PROBE 64
+
+/*!
+ * \brief Stack trace of allocation.
+ *        Trace is immutable after it is published to trace table.
+ */
+typedef struct {
+  unsigned int hash;   /*!< Hash value of frames.                       */
+  jint depth;          /*!< Count of frames.                            */
+  char *description;   /*!< Formatted frames. This is set by dumper.    */
+  jvmtiFrameInfo frames[ALLOC_TRACE_MAX_DEPTH]; /*!< Frames of trace.   */
+} TAllocTrace;
+
+namespace allocprofiler {
+
+  /*!
+   * \brief Processing flag.
+   */
+  static std::atomic_int processing(0);
+
+  /*!
+   * \brief Hash-consed table of allocation traces.
+   */
+  static std::atomic<TAllocTrace *> traceTable[ALLOC_TABLE_SIZE];
+
+  /*!
+   * \brief Table of allocation sites per (class, trace).<br>
+   *        Key of site is interned trace. Value of event is size of object.
+   */
+  static TCallSiteTable siteTable(ALLOC_TABLE_SIZE);
+
+  /*!
+   * \brief Count of samples which could not be recorded.
+   */
+  static std::atomic<jlong> droppedSamples(0);
+
+  /*!
+   * \brief Is allocation profiler working?
+   */
+  static bool enabled = false;
+
+  /*!
+   * \brief Mutex for output and finalization of allocation sites.
+   */
+  static pthread_mutex_t mutex = PTHREAD_ADAPTIVE_MUTEX_INITIALIZER_NP;
+
+  /*!
+   * \brief Calculate hash value of stack frames.
+   * \param frames [in] Stack frames.
+   * \param depth  [in] Count of frames.
+   * \return Hash value.
+   */
+  static inline unsigned int hashTrace(jvmtiFrameInfo *frames, jint depth) {
+    unsigned long long int hash = depth;
+
+    for (jint idx = 0; idx < depth; idx++) {
+      hash = hash * 31 + (unsigned long long int)frames[idx].method;
+      hash = hash * 31 + (unsigned long long int)frames[idx].location;
+    }
+
+    return (unsigned int)(hash ^ (hash >> 32));
+  }
+
+  /*!
+   * \brief Find or register stack trace in trace table.
+   * \param frames [in] Stack frames.
+   * \param depth  [in] Count of frames.
+   * \return Interned trace.<br>
+   *         Value is NULL if trace table is full.
+   */
+  static TAllocTrace *internTrace(jvmtiFrameInfo *frames, jint depth) {
+    unsigned int hash = hashTrace(frames, depth);
+    size_t framesSize = sizeof(jvmtiFrameInfo) * depth;
+
+    for (int probe = 0; probe < ALLOC_TABLE_MAX_PROBE; probe++) {
+      size_t idx = (hash + probe) & (ALLOC_TABLE_SIZE - 1);
+      TAllocTrace *cur = traceTable[idx].load();
+
+      if (cur == NULL) {
+        TAllocTrace *newTrace = (TAllocTrace *)malloc(sizeof(TAllocTrace));
+        if (unlikely(newTrace == NULL)) {
+          return NULL;
+        }
+
+        newTrace->hash = hash;
+        newTrace->depth = depth;
+        newTrace->description = NULL;
+        memcpy(newTrace->frames, frames, framesSize);
+
+        if (traceTable[idx].compare_exchange_strong(cur, newTrace)) {
+          return newTrace;
+        }
+
+        /* Other thread published trace to this slot. */
+        free(newTrace);
+      }
+
+      if ((cur->hash == hash) && (cur->depth == depth) &&
+          (memcmp(cur->frames, frames, framesSize) == 0)) {
+        return cur;
+      }
+    }
+
+    return NULL;
+  }
+
+  /*!
+   * \brief Event handler of JVMTI SampledObjectAlloc.
+   * \param jvmti        [in] JVMTI environment.
+   * \param env          [in] JNI environment of the event (current) thread.
+   * \param thread       [in] Thread which allocates the object.
+   * \param object       [in] JNI local reference to the allocated object.
+   * \param object_klass [in] JNI local reference to the class of the object.
+   * \param size         [in] Size of the object in bytes.
+   */
+  void JNICALL OnSampledObjectAlloc(jvmtiEnv *jvmti, JNIEnv *env,
+                                    jthread thread, jobject object,
+                                    jclass object_klass, jlong size) {
+    TProcessMark mark(processing);
+
+    jvmtiFrameInfo frames[ALLOC_TRACE_MAX_DEPTH];
+    jint depth = 0;
+    if (unlikely(jvmti->GetStackTrace(thread, 0, ALLOC_TRACE_MAX_DEPTH,
+                                      frames, &depth) != JVMTI_ERROR_NONE)) {
+      droppedSamples++;
+      return;
+    }
+
+    /*
+     * Wait if VM is at a safepoint which includes safepoint synchronizing,
+     * because jclass (oop in JNIHandle) might be relocated.
+     */
+    while (!isAtNormalExecution()) {
+      sched_yield();
+    }
+
+    void *klassOop =
+        TVMFunctions::getInstance()->AsKlassOop(*(void **)object_klass);
+    if (unlikely(klassOop == NULL)) {
+      droppedSamples++;
+      return;
+    }
+
+    TObjectData *objData = clsContainer->findClass(klassOop);
+    if (unlikely(objData == NULL)) {
+      objData = clsContainer->pushNewClass(klassOop);
+    }
+
+    TAllocTrace *trace = internTrace(frames, depth);
+    TCallSite *site =
+        ((trace == NULL) || (objData == NULL))
+            ? NULL
+            : siteTable.intern(objData->tag,
+                               clsContainer->getColdData(objData)->className,
+                               trace, 0);
+    if (unlikely(site == NULL)) {
+      droppedSamples++;
+      return;
+    }
+
+    TCallSiteTable::addEvent(site, size);
+  }
+
+  /*!
+   * \brief Format stack trace to string.
+   *        Formatted string is cached in trace.
+   * \param jvmti [in] JVMTI environment.
+   * \param env   [in] JNI environment of the current thread.
+   * \param trace [in] Stack trace to format.
+   * \return Formatted stack trace.
+   */
+  static const char *formatTrace(jvmtiEnv *jvmti, JNIEnv *env,
+                                 TAllocTrace *trace) {
+    if (trace->description != NULL) {
+      return trace->description;
+    }
+
+    std::string result;
+    char lineBuf[32];
+
+    for (jint idx = 0; idx < trace->depth; idx++) {
+      TJavaStackMethodInfo info;
+      getMethodFrameInfo(jvmti, env, trace->frames[idx], &info);
+
+      if (idx > 0) {
+        result += "|";
+      }
+
+      result += (info.className != NULL) ? info.className : "Unknown";
+      result += ".";
+      result += (info.methodName != NULL) ? info.methodName : "Unknown";
+      result += "(";
+      if (info.isNative) {
+        result += "Native Method";
+      } else {
+        result += (info.sourceFile != NULL) ? info.sourceFile : "Unknown";
+        snprintf(lineBuf, sizeof(lineBuf), ":%d", info.lineNumber);
+        result += lineBuf;
+      }
+      result += ")";
+
+      free(info.className);
+      free(info.methodName);
+      free(info.sourceFile);
+    }
+
+    trace->description = strdup(result.c_str());
+    return (trace->description != NULL) ? trace->description : "Unknown";
+  }
+
+  /*!
+   * \brief Allocation profiler initializer.
+   * \param jvmti    [in] JVMTI environment.
+   * \param interval [in] Average sampling interval in bytes.
+   * \return Process result.
+   */
+  bool initialize(jvmtiEnv *jvmti, jlong interval) {
+#ifdef HAVE_SAMPLED_OBJECT_ALLOC
+    jvmtiCapabilities capabilities = {0};
+    TSampledObjectAllocCallback::mergeCapabilities(&capabilities);
+    if (isError(jvmti, jvmti->AddCapabilities(&capabilities))) {
+      logger->printWarnMsg(
+                   "Couldn't set event capabilities for allocation sampling.");
+      return false;
+    }
+
+    if (isError(jvmti, jvmti->SetHeapSamplingInterval((jint)interval))) {
+      logger->printWarnMsg("Couldn't set heap sampling interval.");
+      return false;
+    }
+
+    {
+      TMutexLocker locker(&mutex);
+      droppedSamples = 0;
+      enabled = true;
+    }
+
+    TSampledObjectAllocCallback::registerCallback(&OnSampledObjectAlloc);
+    if (registerJVMTICallbacks(jvmti)) {
+      logger->printWarnMsg("Couldn't register SampledObjectAlloc event.");
+      TSampledObjectAllocCallback::unregisterCallback(&OnSampledObjectAlloc);
+      enabled = false;
+      return false;
+    }
+
+    TSampledObjectAllocCallback::switchEventNotification(jvmti, JVMTI_ENABLE);
+    return true;
+#else
+    logger->printWarnMsg(
+        "Allocation sampling is not supported in this build (needs JDK 11).");
+    return false;
+#endif
+  }
+
+  /*!
+   * \brief Append aggregated allocation sites to file.
+   *        Counters of each site are reset after output.
+   * \param jvmti [in] JVMTI environment.
+   * \param env   [in] JNI environment of the current thread.
+   * \param fname [in] File name to output allocation sites.
+   */
+  void dumpAllocSites(jvmtiEnv *jvmti, JNIEnv *env, const char *fname) {
+    TMutexLocker locker(&mutex);
+
+    if (!enabled) {
+      return;
+    }
+
+    {
+      TCallSiteCsvWriter csv(fname, "time,class,count,bytes,stacktrace");
+      if (unlikely(!csv.isOpened())) {
+        return;
+      }
+
+      for (int idx = 0; idx < siteTable.getSize(); idx++) {
+        TCallSite *site = siteTable.getSite(idx);
+        if (site == NULL) {
+          continue;
+        }
+
+        jlong count = site->count.exchange(0);
+        jlong totalSize = site->total.exchange(0);
+        if (count == 0) {
+          continue;
+        }
+
+        csv.writeRow(site->className,
+                     JLONG_FORMAT_STR "," JLONG_FORMAT_STR ",%s", count,
+                     totalSize,
+                     formatTrace(jvmti, env, (TAllocTrace *)site->key));
+      }
+    }
+
+    jlong dropped = droppedSamples.exchange(0);
+    if (dropped > 0) {
+      logger->printWarnMsg(
+          "Allocation sampling dropped " JLONG_FORMAT_STR " samples.", dropped);
+    }
+  }
+
+  /*!
+   * \brief Allocation profiler finalizer.
+   *        This function unregisters JVMTI callback and outputs remaining
+   *        allocation sites.
+   * \param jvmti [in] JVMTI environment.
+   * \param env   [in] JNI environment of the current thread.
+   * \param fname [in] File name to output allocation sites.
+   */
+  void finalize(jvmtiEnv *jvmti, JNIEnv *env, const char *fname) {
+#ifdef HAVE_SAMPLED_OBJECT_ALLOC
+    TSampledObjectAllocCallback::switchEventNotification(jvmti,
+                                                         JVMTI_DISABLE);
+    TSampledObjectAllocCallback::unregisterCallback(&OnSampledObjectAlloc);
+
+    /* Refresh JVMTI event callbacks */
+    registerJVMTICallbacks(jvmti);
+#endif
+
+    while (processing > 0) {
+      sched_yield();
+    }
+
+    /* Output remaining allocation sites. */
+    dumpAllocSites(jvmti, env, fname);
+
+    TMutexLocker locker(&mutex);
+    enabled = false;
+
+    siteTable.clear();
+    for (int idx = 0; idx < ALLOC_TABLE_SIZE; idx++) {
+      TAllocTrace *trace = traceTable[idx].exchange(NULL);
+      if (trace != NULL) {
+        free(trace->description);
+        free(trace);
+      }
+    }
+  }
+
+}
@@ -0,0 +1,74 @@
+/*!
+ * \file allocProfiler.hpp
+ * \brief This file is used to profile allocation sites through JVMTI
+ *        SampledObjectAlloc event.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ *
+ */
+
+#ifndef _ALLOC_PROFILER_H
+#define _ALLOC_PROFILER_H
+
+#include <jvmti.h>
+#include <jni.h>
+
+namespace allocprofiler {
+
+  /*!
+   * \brief Event handler of JVMTI SampledObjectAlloc.
+   * \param jvmti        [in] JVMTI environment.
+   * \param env          [in] JNI environment of the event (current) thread.
+   * \param thread       [in] Thread which allocates the object.
+   * \param object       [in] JNI local reference to the allocated object.
+   * \param object_klass [in] JNI local reference to the class of the object.
+   * \param size         [in] Size of the object in bytes.
+   */
+  void JNICALL OnSampledObjectAlloc(jvmtiEnv *jvmti, JNIEnv *env,
+                                    jthread thread, jobject object,
+                                    jclass object_klass, jlong size);
+
+  /*!
+   * \brief Allocation profiler initializer.
+   * \param jvmti    [in] JVMTI environment.
+   * \param interval [in] Average sampling interval in bytes.
+   * \return Process result.
+   */
+  bool initialize(jvmtiEnv *jvmti, jlong interval);
+
+  /*!
+   * \brief Append aggregated allocation sites to file.
+   *        Counters of each site are reset after output.
+   * \param jvmti [in] JVMTI environment.
+   * \param env   [in] JNI environment of the current thread.
+   * \param fname [in] File name to output allocation sites.
+   */
+  void dumpAllocSites(jvmtiEnv *jvmti, JNIEnv *env, const char *fname);
+
+  /*!
+   * \brief Allocation profiler finalizer.
+   *        This function unregisters JVMTI callback and outputs remaining
+   *        allocation sites.
+   * \param jvmti [in] JVMTI environment.
+   * \param env   [in] JNI environment of the current thread.
+   * \param fname [in] File name to output allocation sites.
+   */
+  void finalize(jvmtiEnv *jvmti, JNIEnv *env, const char *fname);
+
+};
+
+#endif  // _ALLOC_PROFILER_H
@@ -0,0 +1,318 @@
+/*!
+ * \file artifactCollector.cpp
+ * \brief This file is used to collect files for log archive in parallel.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ *
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "globals.hpp"
+#include "fsUtil.hpp"
+#include "artifactCollector.hpp"
+
+/*!
+ * \brief Get monotonic clock.
+ * \return Monotonic clock in msec.
+ */
+static inline jlong getMonotonicMSec(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (jlong)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/*!
+ * \brief TArtifactCollector constructor.
+ * \param sink [in] Destination of artifacts. It is retained.
+ */
+TArtifactCollector::TArtifactCollector(TArtifactSink *sink) : tasks() {
+  sink->retain();
+  this->sink = sink;
+
+  nextTask = 0;
+  finishedTasks = 0;
+  deadline = 0;
+  isCancelled = false;
+  diskFullResult = 0;
+  refCount = 1;
+  numWorkers = 0;
+
+  /* Condition is waited with monotonic clock. */
+  pthread_condattr_t condAttr;
+  pthread_condattr_init(&condAttr);
+  pthread_condattr_setclock(&condAttr, CLOCK_MONOTONIC);
+  pthread_cond_init(&cond, &condAttr);
+  pthread_condattr_destroy(&condAttr);
+  pthread_mutex_init(&mutex, NULL);
+}
+
+/*!
+ * \brief TArtifactCollector destructor.
+ */
+TArtifactCollector::~TArtifactCollector(void) {
+  pthread_cond_destroy(&cond);
+  pthread_mutex_destroy(&mutex);
+  sink->release();
+}
+
+/*!
+ * \brief Add task. Tasks must be added before start().
+ * \param name [in] Name of artifact. It must be static string.
+ * \param task [in] Task function.
+ * \param data [in] Data of task.
+ */
+void TArtifactCollector::add(const char *name, TArtifactTask task,
+                             void *data) {
+  TArtifactEntry entry = {name, task, data, ArtifactPending, 0};
+  tasks.push_back(entry);
+}
+
+/*!
+ * \brief Start worker threads.
+ * \param timeout [in] Deadline from now in msec. 0 means no deadline.
+ */
+void TArtifactCollector::start(jlong timeout) {
+  deadline = (timeout > 0) ? getMonotonicMSec() + timeout : 0;
+
+  int maxWorkers = (tasks.size() < ARTIFACT_COLLECTOR_MAX_WORKERS)
+                       ? (int)tasks.size()
+                       : ARTIFACT_COLLECTOR_MAX_WORKERS;
+
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+  /* Signals should be handled by threads of JVM. */
+  sigset_t allSignals;
+  sigset_t oldSignals;
+  sigfillset(&allSignals);
+  pthread_sigmask(SIG_SETMASK, &allSignals, &oldSignals);
+
+  for (int idx = 0; idx < maxWorkers; idx++) {
+    {
+      TMutexLocker locker(&mutex);
+      refCount++;
+    }
+
+    pthread_t thread;
+    int result = pthread_create(&thread, &attr, workerEntryPoint, this);
+    if (unlikely(result != 0)) {
+      /* Remaining tasks are run by caller thread. */
+      logger->printDebugMsg("Could not create worker thread: %s",
+                            strerror(result));
+
+      TMutexLocker locker(&mutex);
+      refCount--;
+      break;
+    }
+
+    numWorkers++;
+  }
+
+  pthread_sigmask(SIG_SETMASK, &oldSignals, NULL);
+  pthread_attr_destroy(&attr);
+}
+
+/*!
+ * \brief Wait until all tasks are finished or deadline is passed.<br>
+ *        Workers cannot add artifacts to sink after this, and unfinished
+ *        tasks are written to ARTIFACT_SKIPPED_FILENAME.
+ * \return Value is zero, if no task is failed by disk full.<br />
+ *         Value is error number a.k.a. "errno" of disk full.
+ */
+int TArtifactCollector::wait(void) {
+  /* Tasks are run on this thread only if there is no worker. */
+  if (unlikely(numWorkers == 0)) {
+    runTasks();
+  }
+
+  TMutexLocker locker(&mutex);
+
+  /*
+   * Wait for tasks on worker threads. If disk is full, only running tasks
+   * are waited.
+   */
+  while ((finishedTasks < (isCancelled ? nextTask : tasks.size())) &&
+         !isExpired()) {
+    if (deadline == 0) {
+      pthread_cond_wait(&cond, &mutex);
+    } else {
+      struct timespec ts;
+      ts.tv_sec = deadline / 1000;
+      ts.tv_nsec = (deadline % 1000) * 1000000;
+      pthread_cond_timedwait(&cond, &mutex, &ts);
+    }
+  }
+
+  /* Workers do not take any more task, and abandoned tasks stop. */
+  isCancelled = true;
+  if (unlikely(finishedTasks < tasks.size())) {
+    sink->rejectWorkers();
+    writeSkippedList();
+  }
+
+  return diskFullResult;
+}
+
+/*!
+ * \brief Release this object.
+ */
+void TArtifactCollector::release(void) {
+  bool isLast;
+  {
+    TMutexLocker locker(&mutex);
+    isLast = (--refCount == 0);
+    pthread_cond_broadcast(&cond);
+  }
+
+  if (isLast) {
+    delete this;
+  }
+}
+
+/*!
+ * \brief Any worker thread is still running or not.<br>
+ *        Workers are running after wait() only if they are abandoned.
+ * \return true if any worker thread refers to this object.
+ */
+bool TArtifactCollector::hasRunningWorkers(void) {
+  TMutexLocker locker(&mutex);
+  return (refCount > 1);
+}
+
+/*!
+ * \brief Wait until all worker threads exit.<br>
+ *        This should be called after wait(), so abandoned tasks stop soon
+ *        because sink rejects them.
+ */
+void TArtifactCollector::join(void) {
+  TMutexLocker locker(&mutex);
+
+  /* Only the caller refers to this object after all workers exit. */
+  while (refCount > 1) {
+    pthread_cond_wait(&cond, &mutex);
+  }
+}
+
+/*!
+ * \brief Entry point of worker thread.
+ * \param data [in] TArtifactCollector object.
+ * \return Always NULL.
+ */
+void *TArtifactCollector::workerEntryPoint(void *data) {
+  TArtifactCollector *collector = (TArtifactCollector *)data;
+
+  collector->runTasks();
+  collector->release();
+
+  return NULL;
+}
+
+/*!
+ * \brief Run pending tasks until all tasks are taken.
+ */
+void TArtifactCollector::runTasks(void) {
+  pthread_mutex_lock(&mutex);
+
+  while (!isCancelled && (nextTask < tasks.size())) {
+    if (unlikely(isExpired())) {
+      break;
+    }
+
+    TArtifactEntry *entry = &tasks[nextTask++];
+    entry->state = ArtifactRunning;
+    pthread_mutex_unlock(&mutex);
+
+    int result = entry->task(entry->data, sink);
+
+    pthread_mutex_lock(&mutex);
+    entry->result = result;
+    entry->state = ArtifactDone;
+    finishedTasks++;
+
+    /* Files are not collected any more if disk is full. */
+    if (unlikely(isRaisedDiskFull(result))) {
+      diskFullResult = result;
+      isCancelled = true;
+    }
+
+    pthread_cond_broadcast(&cond);
+  }
+
+  pthread_mutex_unlock(&mutex);
+}
+
+/*!
+ * \brief Deadline is passed or not.<br>
+ *        Caller must hold mutex.
+ * \return true if deadline is passed.
+ */
+bool TArtifactCollector::isExpired(void) {
+  return (deadline != 0) && (getMonotonicMSec() >= deadline);
+}
+
+/*!
+ * \brief Write unfinished tasks to ARTIFACT_SKIPPED_FILENAME.<br>
+ *        Caller must hold mutex.
+ */
+void TArtifactCollector::writeSkippedList(void) {
+  int fd = sink->openEntry(ARTIFACT_SKIPPED_FILENAME);
+  if (unlikely(fd < 0)) {
+    logger->printWarnMsgWithErrno("Could not create skipped artifact list.");
+  }
+
+  for (size_t idx = 0; idx < tasks.size(); idx++) {
+    if (tasks[idx].state == ArtifactDone) {
+      continue;
+    }
+
+    const char *reason = (tasks[idx].state == ArtifactPending)
+                             ? "not started"
+                             : "not finished";
+    logger->printWarnMsg("Artifact is skipped (%s): %s", reason,
+                         tasks[idx].name);
+
+    if (fd >= 0) {
+      char line[256];
+      int len = snprintf(line, sizeof(line), "%s: %s\n", tasks[idx].name,
+                         reason);
+      if (unlikely(write(fd, line, len) < 0)) {
+        logger->printWarnMsgWithErrno(
+            "Could not write to skipped artifact list.");
+        close(fd);
+        fd = -1;
+      }
+    }
+  }
+
+  if (fd >= 0) {
+    int result = sink->closeEntry(ARTIFACT_SKIPPED_FILENAME, fd);
+    if (unlikely(result != 0)) {
+      errno = result;
+      logger->printWarnMsgWithErrno("Could not add skipped artifact list.");
+    }
+  }
+}
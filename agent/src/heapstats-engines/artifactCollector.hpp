@@ -0,0 +1,220 @@
+/*!
+ * \file artifactCollector.hpp
+ * \brief This file is used to collect files for log archive in parallel.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ *
+ */
+
+#ifndef _ARTIFACT_COLLECTOR_H
+#define _ARTIFACT_COLLECTOR_H
+
+#include <pthread.h>
+
+#include <vector>
+
+#include "artifactSink.hpp"
+#include "util.hpp"
+
+/*!
+ * \brief Max count of worker threads.
+ */
+#define ARTIFACT_COLLECTOR_MAX_WORKERS 4
+
+/*!
+ * \brief Name of file which lists skipped artifacts.
+ */
+#define ARTIFACT_SKIPPED_FILENAME "skipped_artifacts.txt"
+
+/*!
+ * \brief Task to make an artifact.
+ * \param data [in] Data of task.
+ * \param sink [in] Destination of artifacts.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+typedef int (*TArtifactTask)(void *data, TArtifactSink *sink);
+
+/*!
+ * \brief State of artifact task.
+ */
+typedef enum {
+  ArtifactPending,  /*!< Task is not started.  */
+  ArtifactRunning,  /*!< Task is running.      */
+  ArtifactDone      /*!< Task is finished.     */
+} TArtifactState;
+
+/*!
+ * \brief Artifact task entry.
+ */
+typedef struct {
+  const char *name;     /*!< Name of artifact.  */
+  TArtifactTask task;   /*!< Task function.     */
+  void *data;           /*!< Data of task.      */
+  TArtifactState state; /*!< State of task.     */
+  int result;           /*!< Result of task.    */
+} TArtifactEntry;
+
+/*!
+ * \brief This class runs artifact tasks on a small worker pool until
+ *        deadline.<br>
+ *        If no worker thread can be created (e.g. RLIMIT_NPROC), caller
+ *        thread runs tasks in wait() instead.<br>
+ *        Workers which are still running at deadline are abandoned. So this
+ *        object is released by release() instead of delete, and it is
+ *        deallocated by the last thread which refers to it. Owner of data
+ *        of tasks must join() abandoned workers before it is deallocated.
+ */
+class TArtifactCollector {
+ public:
+  /*!
+   * \brief TArtifactCollector constructor.
+   * \param sink [in] Destination of artifacts. It is retained.
+   */
+  TArtifactCollector(TArtifactSink *sink);
+
+  /*!
+   * \brief Add task. Tasks must be added before start().
+   * \param name [in] Name of artifact. It must be static string.
+   * \param task [in] Task function.
+   * \param data [in] Data of task.
+   */
+  void add(const char *name, TArtifactTask task, void *data);
+
+  /*!
+   * \brief Start worker threads.
+   * \param timeout [in] Deadline from now in msec. 0 means no deadline.
+   */
+  void start(jlong timeout);
+
+  /*!
+   * \brief Wait until all tasks are finished or deadline is passed.<br>
+   *        Workers cannot add artifacts to sink after this, and unfinished
+   *        tasks are written to ARTIFACT_SKIPPED_FILENAME.
+   * \return Value is zero, if no task is failed by disk full.<br />
+   *         Value is error number a.k.a. "errno" of disk full.
+   */
+  int wait(void);
+
+  /*!
+   * \brief Release this object.
+   */
+  void release(void);
+
+  /*!
+   * \brief Any worker thread is still running or not.<br>
+   *        Workers are running after wait() only if they are abandoned.
+   * \return true if any worker thread refers to this object.
+   */
+  bool hasRunningWorkers(void);
+
+  /*!
+   * \brief Wait until all worker threads exit.<br>
+   *        This should be called after wait(), so abandoned tasks stop soon
+   *        because sink rejects them.
+   */
+  void join(void);
+
+ protected:
+  /*!
+   * \brief TArtifactCollector destructor.
+   */
+  virtual ~TArtifactCollector(void);
+
+  /*!
+   * \brief Entry point of worker thread.
+   * \param data [in] TArtifactCollector object.
+   * \return Always NULL.
+   */
+  static void *workerEntryPoint(void *data);
+
+  /*!
+   * \brief Run pending tasks until all tasks are taken.
+   */
+  void runTasks(void);
+
+  /*!
+   * \brief Deadline is passed or not.<br>
+   *        Caller must hold mutex.
+   * \return true if deadline is passed.
+   */
+  bool isExpired(void);
+
+  /*!
+   * \brief Write unfinished tasks to ARTIFACT_SKIPPED_FILENAME.<br>
+   *        Caller must hold mutex.
+   */
+  void writeSkippedList(void);
+
+ private:
+  /*!
+   * \brief Destination of artifacts.
+   */
+  TArtifactSink *sink;
+
+  /*!
+   * \brief Tasks.
+   */
+  std::vector<TArtifactEntry> tasks;
+
+  /*!
+   * \brief Index of next task to take.
+   */
+  size_t nextTask;
+
+  /*!
+   * \brief Count of finished tasks.
+   */
+  size_t finishedTasks;
+
+  /*!
+   * \brief Deadline in monotonic msec. 0 means no deadline.
+   */
+  jlong deadline;
+
+  /*!
+   * \brief No more task is taken. (deadline or disk full)
+   */
+  bool isCancelled;
+
+  /*!
+   * \brief Error number of disk full.
+   */
+  int diskFullResult;
+
+  /*!
+   * \brief Count of references. (caller and worker threads)
+   */
+  int refCount;
+
+  /*!
+   * \brief Count of worker threads which are created.
+   */
+  int numWorkers;
+
+  /*!
+   * \brief Mutex of this object.
+   */
+  pthread_mutex_t mutex;
+
+  /*!
+   * \brief Condition which is signaled when a task is finished.
+   */
+  pthread_cond_t cond;
+};
+
+#endif  // _ARTIFACT_COLLECTOR_H
@@ -0,0 +1,1009 @@
+/*!
+ * \file artifactSink.cpp
+ * \brief This file is used to store artifacts of log archive.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ *
+ */
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "globals.hpp"
+#include "fsUtil.hpp"
+#include "artifactSink.hpp"
+
+#ifndef MFD_CLOEXEC
+/*!
+ * \brief Flag of memfd_create(2). It might not be defined in old glibc.
+ */
+#define MFD_CLOEXEC 0x0001U
+#endif
+
+/*!
+ * \brief Write whole data to file.
+ * \param fd   [in] File descriptor.
+ * \param buf  [in] Data to write.
+ * \param size [in] Size of data.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+static int writeFully(int fd, char const *buf, size_t size) {
+  size_t written = 0;
+  while (written < size) {
+    ssize_t writeSize = write(fd, buf + written, size - written);
+    if (unlikely(writeSize < 0)) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return errno;
+    }
+    written += writeSize;
+  }
+
+  return 0;
+}
+
+/*!
+ * \brief TArtifactSink constructor.
+ */
+TArtifactSink::TArtifactSink(void) {
+  owner = pthread_self();
+  isRejecting = false;
+  refCount = 1;
+  pthread_mutex_init(&mutex, NULL);
+}
+
+/*!
+ * \brief TArtifactSink destructor.
+ */
+TArtifactSink::~TArtifactSink(void) { pthread_mutex_destroy(&mutex); }
+
+/*!
+ * \brief Reject artifacts from threads except the creator thread.
+ *        Artifact which is being stored by them is aborted.
+ */
+void TArtifactSink::rejectWorkers(void) {
+  TMutexLocker locker(&mutex);
+  isRejecting = true;
+}
+
+/*!
+ * \brief Release this object.
+ */
+void TArtifactSink::release(void) {
+  bool isLast;
+  {
+    TMutexLocker locker(&mutex);
+    isLast = (--refCount == 0);
+  }
+
+  if (isLast) {
+    delete this;
+  }
+}
+
+/*!
+ * \brief Add reference to this object.
+ */
+void TArtifactSink::retain(void) {
+  TMutexLocker locker(&mutex);
+  refCount++;
+}
+
+/*!
+ * \brief Check whether current thread can add artifacts.<br>
+ *        Caller must hold mutex.
+ * \return true if current thread can add artifacts.
+ */
+bool TArtifactSink::isAcceptable(void) {
+  return !isRejecting || pthread_equal(pthread_self(), owner);
+}
+
+/*!
+ * \brief Check whether artifact from current thread is rejected.<br>
+ *        Long copy checks it for each chunk, so abandoned worker stops.
+ * \param data [in] TArtifactSink object.
+ * \return true if current thread cannot add artifacts.
+ */
+bool TArtifactSink::isRejected(void *data) {
+  TArtifactSink *sink = (TArtifactSink *)data;
+
+  TMutexLocker locker(&sink->mutex);
+  return !sink->isAcceptable();
+}
+
+/*!
+ * \brief TDirArtifactSink constructor.
+ * \param basePath [in] Path of working directory.
+ */
+TDirArtifactSink::TDirArtifactSink(char const *basePath) : TArtifactSink() {
+  this->basePath = strdup(basePath);
+  if (unlikely(this->basePath == NULL)) {
+    throw "Could not allocate memory for artifact sink.";
+  }
+
+  isRemoving = false;
+}
+
+/*!
+ * \brief TDirArtifactSink destructor.
+ */
+TDirArtifactSink::~TDirArtifactSink(void) {
+  /* No worker refers to working directory any more. */
+  if (isRemoving) {
+    removeTempDir(basePath);
+  }
+
+  free(basePath);
+}
+
+/*!
+ * \brief Remove working directory when this object is deallocated.
+ *        Abandoned workers might refer to it until then.
+ */
+void TDirArtifactSink::removeOnRelease(void) {
+  TMutexLocker locker(&mutex);
+  isRemoving = true;
+}
+
+/*!
+ * \brief Guard of each chunk which is copied to working directory.<br>
+ *        Mutex is held while the chunk is written. rejectWorkers() waits
+ *        for it, so working directory is not changed while it is archived.
+ * \param data    [in] TDirArtifactSink object.
+ * \param isEnter [in] Chunk is going to be written.
+ * \return Value is zero, if the chunk can be written.<br />
+ *         Value is ECANCELED, if artifacts from current thread are rejected.
+ */
+int TDirArtifactSink::guardChunk(void *data, bool isEnter) {
+  TDirArtifactSink *sink = (TDirArtifactSink *)data;
+
+  if (!isEnter) {
+    pthread_mutex_unlock(&sink->mutex);
+    return 0;
+  }
+
+  pthread_mutex_lock(&sink->mutex);
+  if (unlikely(!sink->isAcceptable())) {
+    pthread_mutex_unlock(&sink->mutex);
+    return ECANCELED;
+  }
+
+  return 0;
+}
+
+/*!
+ * \brief Copy file as an artifact.
+ * \param source [in] Path of source file. It must be regular file.
+ * \param name   [in] Name of artifact.<br>
+ *                    File name of source is used, if value is null.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TDirArtifactSink::copyFile(char const *source, char const *name) {
+  {
+    TMutexLocker locker(&mutex);
+    if (unlikely(!isAcceptable())) {
+      return ECANCELED;
+    }
+  }
+
+  char rpath[PATH_MAX];
+  if (unlikely(!isCopiablePath(source, rpath))) {
+    return EINVAL;
+  }
+
+  char *newFile = createFilename(basePath, (name != NULL) ? name : source);
+  if (unlikely(newFile == NULL)) {
+    return ENOMEM;
+  }
+
+  /* Same name might be copied already. */
+  char *destFile = createUniquePath(newFile, false);
+  free(newFile);
+  if (unlikely(destFile == NULL)) {
+    return ENOMEM;
+  }
+
+  int srcFd = open(source, O_RDONLY | O_CLOEXEC);
+  if (unlikely(srcFd < 0)) {
+    int result = errno;
+    logger->printWarnMsgWithErrno("Couldn't open copy source file.");
+    free(destFile);
+    return result;
+  }
+
+  int destFd = open(destFile, O_CREAT | O_WRONLY | O_EXCL | O_CLOEXEC,
+                    S_IRUSR | S_IWUSR);
+  free(destFile);
+  if (unlikely(destFd < 0)) {
+    int result = errno;
+    logger->printWarnMsgWithErrno("Couldn't open copy destination file.");
+    close(srcFd);
+    return result;
+  }
+
+  /* Files in procfs have no size, so they are read until EOF. */
+  int result = copyFileData(srcFd, destFd, &guardChunk, this);
+  close(srcFd);
+
+  if (unlikely((close(destFd) != 0) && (result == 0))) {
+    result = errno;
+  }
+
+  return result;
+}
+
+/*!
+ * \brief Open an artifact to write. It must be closed by closeEntry().
+ * \param name [in] Name of artifact.
+ * \return File descriptor to write.<br>
+ *         Value is -1 and errno is set, if process is failure.
+ */
+int TDirArtifactSink::openEntry(char const *name) {
+  {
+    TMutexLocker locker(&mutex);
+    if (unlikely(!isAcceptable())) {
+      errno = ECANCELED;
+      return -1;
+    }
+  }
+
+  char *fname = createFilename(basePath, name);
+  if (unlikely(fname == NULL)) {
+    errno = ENOMEM;
+    return -1;
+  }
+
+  int fd = open(fname, O_CREAT | O_WRONLY | O_EXCL | O_CLOEXEC,
+                S_IRUSR | S_IWUSR);
+  free(fname);
+  return fd;
+}
+
+/*!
+ * \brief Close artifact which is opened by openEntry().
+ * \param name [in] Name of artifact.
+ * \param fd   [in] File descriptor which is returned by openEntry().
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TDirArtifactSink::closeEntry(char const *name, int fd) {
+  return (close(fd) == 0) ? 0 : errno;
+}
+
+/*!
+ * \brief Store data which is read from stream until EOF as an artifact.
+ * \param name  [in] Name of artifact.
+ * \param srcFd [in] File descriptor of source. e.g. pipe.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TDirArtifactSink::addStream(char const *name, int srcFd) {
+  int fd = openEntry(name);
+  if (unlikely(fd < 0)) {
+    return errno;
+  }
+
+  int result = copyFileData(srcFd, fd, &guardChunk, this);
+  int closeResult = closeEntry(name, fd);
+  return (result != 0) ? result : closeResult;
+}
+
+/*!
+ * \brief Copy data from offset to EOF of file as an artifact.
+ * \param name   [in]  Name of artifact.
+ * \param srcFd  [in]  File descriptor of source file.
+ * \param offset [in]  Offset of source file to start copy.
+ * \param size   [out] Size of copied data.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TDirArtifactSink::copyFileTail(char const *name, int srcFd, off_t offset,
+                                   off_t *size) {
+  int fd = openEntry(name);
+  if (unlikely(fd < 0)) {
+    return errno;
+  }
+
+  /* Data is copied in kernel, and source file offset is not changed. */
+  int result = ::copyFileTail(srcFd, fd, offset, size, &guardChunk, this);
+  int closeResult = closeEntry(name, fd);
+  return (result != 0) ? result : closeResult;
+}
+
+/*!
+ * \brief TZipArtifactSink constructor.
+ * \param archiver    [in] Zip archiver. It is used until finish().
+ * \param archiveFile [in] Path of archive file.
+ */
+TZipArtifactSink::TZipArtifactSink(TZipArchiver *archiver,
+                                   char const *archiveFile)
+    : TArtifactSink() {
+  bufferDir = getParentDirectoryPath(archiveFile);
+  if (unlikely(bufferDir == NULL)) {
+    throw "Could not allocate memory for artifact sink.";
+  }
+
+  int result = archiver->openArchive(archiveFile);
+  if (unlikely(result != 0)) {
+    free(bufferDir);
+    throw "Could not create archive file for artifacts.";
+  }
+
+  this->archiver = archiver;
+}
+
+/*!
+ * \brief TZipArtifactSink destructor.
+ */
+TZipArtifactSink::~TZipArtifactSink(void) {
+  /* Archive file is incomplete if it is not finished. */
+  if (unlikely(archiver != NULL)) {
+    archiver->closeArchive(ECANCELED);
+  }
+
+  free(bufferDir);
+}
+
+/*!
+ * \brief Open buffer of current thread. It is anonymous memory, or
+ *        unlinked file if memfd_create(2) is not available.
+ * \return File descriptor of buffer.<br>
+ *         Value is -1 and errno is set, if process is failure.
+ */
+int TZipArtifactSink::openBuffer(void) {
+#ifdef SYS_memfd_create
+  int fd = (int)syscall(SYS_memfd_create, "heapstats", MFD_CLOEXEC);
+  if (likely(fd >= 0)) {
+    return fd;
+  }
+#endif
+
+  char *tempName = createFilename(bufferDir, "heapstats-XXXXXX");
+  if (unlikely(tempName == NULL)) {
+    errno = ENOMEM;
+    return -1;
+  }
+
+  int tempFd = mkostemp(tempName, O_CLOEXEC);
+  if (likely(tempFd >= 0)) {
+    unlink(tempName);
+  }
+  free(tempName);
+
+  return tempFd;
+}
+
+/*!
+ * \brief Compress data which is read until EOF, and append it to archive.
+ * \param name  [in]  Name of artifact.
+ * \param srcFd [in]  File descriptor of source.
+ * \param size  [out] Size of source data. It can be null.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TZipArtifactSink::addData(char const *name, int srcFd, uint64_t *size) {
+  if (unlikely(isRejected(this))) {
+    return ECANCELED;
+  }
+
+  /*
+   * Rest of large regular file is compressed by parallel deflater into
+   * archive directly. rejectWorkers() aborts it without mutex.
+   */
+  struct stat st;
+  off_t pos = lseek(srcFd, 0, SEEK_CUR);
+  if ((pos >= 0) && (fstat(srcFd, &st) == 0) && S_ISREG(st.st_mode) &&
+      (st.st_size - pos >= ARTIFACT_SINK_PARALLEL_MIN_SIZE)) {
+    TMutexLocker locker(&mutex);
+    if (unlikely(!isAcceptable() || (archiver == NULL))) {
+      return ECANCELED;
+    } else if (archiver->isParallel()) {
+      return archiver->addStream(srcFd, name, size);
+    }
+  }
+
+  int bufFd = openBuffer();
+  if (unlikely(bufFd < 0)) {
+    return errno;
+  }
+
+  /* Source is read and compressed without mutex. */
+  TZipDeflatedData deflated;
+  int result =
+      TZipArchiver::deflateApart(srcFd, bufFd, &isRejected, this, &deflated);
+
+  /* Only finished entry is appended with mutex. */
+  if (likely(result == 0)) {
+    TMutexLocker locker(&mutex);
+    if (unlikely(!isAcceptable() || (archiver == NULL))) {
+      result = ECANCELED;
+    } else {
+      result = archiver->addDeflated(name, &deflated);
+    }
+  }
+
+  if ((result == 0) && (size != NULL)) {
+    *size = deflated.size;
+  }
+
+  close(bufFd);
+  return result;
+}
+
+/*!
+ * \brief Copy file as an artifact.
+ * \param source [in] Path of source file. It must be regular file.
+ * \param name   [in] Name of artifact.<br>
+ *                    File name of source is used, if value is null.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TZipArtifactSink::copyFile(char const *source, char const *name) {
+  char rpath[PATH_MAX];
+  if (unlikely(!isCopiablePath(source, rpath))) {
+    return EINVAL;
+  }
+
+  if (name == NULL) {
+    name = strrchr(source, '/');
+    name = (name == NULL) ? source : name + 1;
+  }
+
+  int srcFd = open(source, O_RDONLY | O_CLOEXEC);
+  if (unlikely(srcFd < 0)) {
+    int result = errno;
+    logger->printWarnMsgWithErrno("Could not open zip source file");
+    return result;
+  }
+
+  int result = addData(name, srcFd, NULL);
+  close(srcFd);
+
+  return result;
+}
+
+/*!
+ * \brief Open an artifact to write. It must be closed by closeEntry().<br>
+ *        Data is buffered in anonymous memory, or in unlinked file if
+ *        memfd_create(2) is not available.
+ * \param name [in] Name of artifact.
+ * \return File descriptor to write.<br>
+ *         Value is -1 and errno is set, if process is failure.
+ */
+int TZipArtifactSink::openEntry(char const *name) {
+  {
+    TMutexLocker locker(&mutex);
+    if (unlikely(!isAcceptable() || (archiver == NULL))) {
+      errno = ECANCELED;
+      return -1;
+    }
+  }
+
+  return openBuffer();
+}
+
+/*!
+ * \brief Close artifact which is opened by openEntry().
+ *        Buffered data is added to archive.
+ * \param name [in] Name of artifact.
+ * \param fd   [in] File descriptor which is returned by openEntry().
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TZipArtifactSink::closeEntry(char const *name, int fd) {
+  int result = 0;
+  if (unlikely(lseek(fd, 0, SEEK_SET) != 0)) {
+    result = errno;
+  } else {
+    result = addData(name, fd, NULL);
+  }
+
+  close(fd);
+  return result;
+}
+
+/*!
+ * \brief Store data which is read from stream until EOF as an artifact.
+ * \param name  [in] Name of artifact.
+ * \param srcFd [in] File descriptor of source. e.g. pipe.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TZipArtifactSink::addStream(char const *name, int srcFd) {
+  return addData(name, srcFd, NULL);
+}
+
+/*!
+ * \brief Copy data from offset to EOF of file as an artifact.
+ * \param name   [in]  Name of artifact.
+ * \param srcFd  [in]  File descriptor of source file.
+ * \param offset [in]  Offset of source file to start copy.
+ * \param size   [out] Size of copied data.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TZipArtifactSink::copyFileTail(char const *name, int srcFd, off_t offset,
+                                   off_t *size) {
+  if (unlikely(lseek(srcFd, offset, SEEK_SET) != offset)) {
+    return errno;
+  }
+
+  uint64_t dataSize = 0;
+  int result = addData(name, srcFd, &dataSize);
+  *size = (off_t)dataSize;
+  return result;
+}
+
+/*!
+ * \brief Reject artifacts from threads except the creator thread.
+ *        Artifact which is being stored by them is aborted.
+ */
+void TZipArtifactSink::rejectWorkers(void) {
+  /* Entry is aborted without mutex, because the worker holds it. */
+  if (likely(archiver != NULL)) {
+    archiver->setAborted(true);
+  }
+
+  TArtifactSink::rejectWorkers();
+
+  TMutexLocker locker(&mutex);
+  if (likely(archiver != NULL)) {
+    archiver->setAborted(false);
+  }
+}
+
+/*!
+ * \brief Finish archive file. No artifact can be added after this.<br>
+ *        Archive file is removed if result is not zero.
+ * \param result [in] Result of collecting artifacts.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TZipArtifactSink::finish(int result) {
+  if (unlikely(archiver == NULL)) {
+    return ECANCELED;
+  }
+  archiver->setAborted(true);
+
+  TMutexLocker locker(&mutex);
+  archiver->setAborted(false);
+  result = archiver->closeArchive(result);
+  archiver = NULL;
+
+  return result;
+}
+
+/*!
+ * \brief TDedupArtifactSink constructor.
+ * \param sink     [in] Destination sink.
+ * \param storeDir [in] Path of artifact store directory.
+ */
+TDedupArtifactSink::TDedupArtifactSink(TArtifactSink *sink,
+                                       char const *storeDir,
+                                       off_t maxStoreSize)
+    : TArtifactSink() {
+  if (unlikely((mkdir(storeDir, S_IRWXU) != 0) && (errno != EEXIST))) {
+    throw "Could not create artifact store directory.";
+  }
+
+  /* Absolute path is recorded in manifest for heapstats-rehydrate. */
+  this->storeDir = realpath(storeDir, NULL);
+  if (unlikely(this->storeDir == NULL)) {
+    throw "Could not resolve path of artifact store directory.";
+  }
+
+  sink->retain();
+  this->sink = sink;
+  this->maxStoreSize = maxStoreSize;
+
+  /*
+   * Timestamp of file is updated by coarse clock, so it might be older
+   * than current time slightly.
+   */
+  this->startTime = time(NULL) - 1;
+}
+
+/*!
+ * \brief TDedupArtifactSink destructor.
+ */
+TDedupArtifactSink::~TDedupArtifactSink(void) {
+  sink->release();
+  free(storeDir);
+}
+
+/*!
+ * \brief Copy file as an artifact.
+ * \param source [in] Path of source file. It must be regular file.
+ * \param name   [in] Name of artifact.<br>
+ *                    File name of source is used, if value is null.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TDedupArtifactSink::copyFile(char const *source, char const *name) {
+  {
+    TMutexLocker locker(&mutex);
+    if (unlikely(!isAcceptable())) {
+      return ECANCELED;
+    }
+  }
+
+  char rpath[PATH_MAX];
+  if (unlikely(!isCopiablePath(source, rpath))) {
+    return EINVAL;
+  }
+
+  if (name == NULL) {
+    name = strrchr(source, '/');
+    name = (name == NULL) ? source : name + 1;
+  }
+
+  char *buf = NULL;
+  size_t size = 0;
+  int result = readSmallFile(source, &buf, &size);
+  if (result == EFBIG) {
+    /* Large file is not deduplicated. */
+    return sink->copyFile(source, name);
+  } else if (unlikely(result != 0)) {
+    return result;
+  }
+
+  char key[ARTIFACT_KEY_LENGTH];
+  makeArtifactKey(buf, size, key);
+
+  bool isStored = false;
+  result = storeContent(key, buf, size, &isStored);
+  if (unlikely(result != 0)) {
+    /* Artifact is embedded if artifact store is not available. */
+    logger->printDebugMsg("Could not store artifact: %s", strerror(result));
+    isStored = false;
+  }
+
+  if (isStored) {
+    TMutexLocker locker(&mutex);
+    if (unlikely(!isAcceptable())) {
+      result = ECANCELED;
+    } else {
+      try {
+        manifest.push_back(std::string(key) + "\t" + name);
+        result = 0;
+      } catch (...) {
+        result = ENOMEM;
+      }
+    }
+  } else {
+    int fd = sink->openEntry(name);
+    if (unlikely(fd < 0)) {
+      result = errno;
+    } else {
+      result = writeFully(fd, buf, size);
+      int closeResult = sink->closeEntry(name, fd);
+      if (result == 0) {
+        result = closeResult;
+      }
+    }
+  }
+
+  free(buf);
+  return result;
+}
+
+/*!
+ * \brief Read whole file if it is small enough to deduplicate.
+ * \param source [in]  Path of source file.
+ * \param buf    [out] Content of file. Caller must free it.
+ * \param size   [out] Size of content.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is EFBIG if the file is too large to deduplicate.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TDedupArtifactSink::readSmallFile(char const *source, char **buf,
+                                      size_t *size) {
+  int fd = open(source, O_RDONLY | O_CLOEXEC);
+  if (unlikely(fd < 0)) {
+    return errno;
+  }
+
+  struct stat st;
+  if (unlikely(fstat(fd, &st) != 0)) {
+    int result = errno;
+    close(fd);
+    return result;
+  } else if (st.st_size > ARTIFACT_DEDUP_MAX_SIZE) {
+    close(fd);
+    return EFBIG;
+  }
+
+  /*
+   * Files in procfs and sysfs have no size, so they are read until EOF.
+   * File might grow while reading, so size is checked again.
+   */
+  size_t capacity =
+      (st.st_size == 0) ? ARTIFACT_DEDUP_READ_SIZE : st.st_size + 1;
+  *buf = (char *)malloc(capacity);
+  *size = 0;
+  if (unlikely(*buf == NULL)) {
+    close(fd);
+    return ENOMEM;
+  }
+
+  int result = 0;
+  while (true) {
+    if (*size == capacity) {
+      if (capacity > ARTIFACT_DEDUP_MAX_SIZE) {
+        result = EFBIG;
+        break;
+      }
+
+      char *newBuf = (char *)realloc(*buf, capacity * 2);
+      if (unlikely(newBuf == NULL)) {
+        result = ENOMEM;
+        break;
+      }
+      *buf = newBuf;
+      capacity *= 2;
+    }
+
+    ssize_t readSize = read(fd, *buf + *size, capacity - *size);
+    if (readSize == 0) {
+      break;
+    } else if (unlikely(readSize < 0)) {
+      if (errno == EINTR) {
+        continue;
+      }
+      result = errno;
+      break;
+    }
+
+    *size += readSize;
+  }
+  close(fd);
+
+  if (likely(result == 0) && unlikely(*size > ARTIFACT_DEDUP_MAX_SIZE)) {
+    result = EFBIG;
+  }
+
+  if (unlikely(result != 0)) {
+    free(*buf);
+    *buf = NULL;
+  }
+
+  return result;
+}
+
+/*!
+ * \brief Store content to artifact store if it is not stored yet.
+ * \param key  [in]  Key of content.
+ * \param buf  [in]  Content.
+ * \param size [in]  Size of content.
+ * \param isStored [out] Content was in artifact store already.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TDedupArtifactSink::storeContent(char const *key, char const *buf,
+                                     size_t size, bool *isStored) {
+  char *path = createFilename(storeDir, key);
+  if (unlikely(path == NULL)) {
+    return ENOMEM;
+  }
+
+  /*
+   * Key has size of content, so broken file is not used.
+   * Timestamp of content is updated to keep it from pruning.
+   */
+  struct stat st;
+  if ((stat(path, &st) == 0) && S_ISREG(st.st_mode) &&
+      (st.st_size == (off_t)size) &&
+      (utimensat(AT_FDCWD, path, NULL, 0) == 0)) {
+    *isStored = true;
+    free(path);
+    return 0;
+  }
+  *isStored = false;
+
+  /* Content is written to temporary file, and is renamed atomically. */
+  char tempPath[PATH_MAX];
+  snprintf(tempPath, PATH_MAX, "%s.XXXXXX", path);
+  int fd = mkostemp(tempPath, O_CLOEXEC);
+  if (unlikely(fd < 0)) {
+    int result = errno;
+    free(path);
+    return result;
+  }
+
+  int result = writeFully(fd, buf, size);
+  if (unlikely((close(fd) != 0) && (result == 0))) {
+    result = errno;
+  }
+  if (likely(result == 0) && unlikely(rename(tempPath, path) != 0)) {
+    result = errno;
+  }
+  if (unlikely(result != 0)) {
+    unlink(tempPath);
+  }
+
+  free(path);
+  return result;
+}
+
+/*!
+ * \brief Open an artifact to write. It must be closed by closeEntry().
+ * \param name [in] Name of artifact.
+ * \return File descriptor to write.<br>
+ *         Value is -1 and errno is set, if process is failure.
+ */
+int TDedupArtifactSink::openEntry(char const *name) {
+  return sink->openEntry(name);
+}
+
+/*!
+ * \brief Close artifact which is opened by openEntry().
+ * \param name [in] Name of artifact.
+ * \param fd   [in] File descriptor which is returned by openEntry().
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TDedupArtifactSink::closeEntry(char const *name, int fd) {
+  return sink->closeEntry(name, fd);
+}
+
+/*!
+ * \brief Store data which is read from stream until EOF as an artifact.
+ * \param name  [in] Name of artifact.
+ * \param srcFd [in] File descriptor of source. e.g. pipe.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TDedupArtifactSink::addStream(char const *name, int srcFd) {
+  return sink->addStream(name, srcFd);
+}
+
+/*!
+ * \brief Copy data from offset to EOF of file as an artifact.
+ * \param name   [in]  Name of artifact.
+ * \param srcFd  [in]  File descriptor of source file.
+ * \param offset [in]  Offset of source file to start copy.
+ * \param size   [out] Size of copied data.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TDedupArtifactSink::copyFileTail(char const *name, int srcFd,
+                                     off_t offset, off_t *size) {
+  return sink->copyFileTail(name, srcFd, offset, size);
+}
+
+/*!
+ * \brief Reject artifacts from threads except the creator thread.
+ *        Artifact which is being stored by them is aborted.
+ */
+void TDedupArtifactSink::rejectWorkers(void) {
+  TArtifactSink::rejectWorkers();
+  sink->rejectWorkers();
+}
+
+/*!
+ * \brief Store manifest of deduplicated artifacts to destination sink.
+ *        Nothing is stored if no artifact is deduplicated.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TDedupArtifactSink::writeManifest(void) {
+  std::string content;
+  {
+    TMutexLocker locker(&mutex);
+    if (manifest.empty()) {
+      return 0;
+    }
+
+    try {
+      content = ARTIFACT_MANIFEST_STORE_KEY "\t";
+      content += storeDir;
+      content += '\n';
+      for (size_t idx = 0; idx < manifest.size(); idx++) {
+        content += manifest[idx];
+        content += '\n';
+      }
+    } catch (...) {
+      return ENOMEM;
+    }
+  }
+
+  int fd = sink->openEntry(ARTIFACT_MANIFEST_FILENAME);
+  if (unlikely(fd < 0)) {
+    return errno;
+  }
+
+  int result = writeFully(fd, content.data(), content.size());
+  int closeResult = sink->closeEntry(ARTIFACT_MANIFEST_FILENAME, fd);
+  return (result != 0) ? result : closeResult;
+}
+
+/*!
+ * \brief Remove contents which are not used for the longest time from
+ *        artifact store until its size is less than the limit.<br>
+ *        Contents which are used by this sink are not removed.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TDedupArtifactSink::pruneStore(void) {
+  if (maxStoreSize <= 0) {
+    return 0;
+  }
+
+  DIR *dir = opendir(storeDir);
+  if (unlikely(dir == NULL)) {
+    return errno;
+  }
+
+  std::vector<TStoredArtifact> contents;
+  off_t totalSize = 0;
+  int result = 0;
+  try {
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+      struct stat st;
+      if ((entry->d_name[0] == '.') ||
+          (fstatat(dirfd(dir), entry->d_name, &st, AT_SYMLINK_NOFOLLOW) !=
+           0) ||
+          !S_ISREG(st.st_mode)) {
+        continue;
+      }
+
+      totalSize += st.st_size;
+      TStoredArtifact content = {st.st_mtime, st.st_size, entry->d_name};
+      contents.push_back(content);
+    }
+  } catch (...) {
+    result = ENOMEM;
+  }
+
+  if (likely(result == 0) && (totalSize > maxStoreSize)) {
+    std::sort(contents.begin(), contents.end(), isOlderArtifact);
+
+    for (size_t idx = 0;
+         (idx < contents.size()) && (totalSize > maxStoreSize); idx++) {
+      /* Contents after this are used by this sink or other process. */
+      if (contents[idx].mtime >= startTime) {
+        break;
+      }
+
+      if (unlikely((unlinkat(dirfd(dir), contents[idx].name.c_str(), 0) !=
+                    0) &&
+                   (errno != ENOENT))) {
+        result = errno;
+        break;
+      }
+      totalSize -= contents[idx].size;
+    }
+  }
+
+  closedir(dir);
+  return result;
+}
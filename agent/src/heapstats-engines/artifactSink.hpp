@@ -0,0 +1,425 @@
+/*!
+ * \file artifactSink.hpp
+ * \brief This file is used to store artifacts of log archive.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ *
+ */
+
+#ifndef _ARTIFACT_SINK_H
+#define _ARTIFACT_SINK_H
+
+#include <pthread.h>
+#include <sys/types.h>
+#include <time.h>
+
+#include <string>
+#include <vector>
+
+#include "artifactStoreFormat.hpp"
+#include "zipArchiver.hpp"
+
+/*!
+ * \brief Min size of regular file which is compressed into zip archive
+ *        directly by parallel deflater instead of buffer of each thread.
+ */
+#define ARTIFACT_SINK_PARALLEL_MIN_SIZE (4 * 1024 * 1024)
+
+/*!
+ * \brief This class is destination of artifacts of log archive.<br>
+ *        Artifacts are added by the thread which creates this object and by
+ *        worker threads of TArtifactCollector. After rejectWorkers() is
+ *        called, only the creator thread can add artifacts.<br>
+ *        Workers might refer to this object after their deadline, so this
+ *        object is released by release() instead of delete.
+ */
+class TArtifactSink {
+ public:
+  /*!
+   * \brief TArtifactSink constructor.
+   */
+  TArtifactSink(void);
+
+  /*!
+   * \brief Copy file as an artifact.
+   * \param source [in] Path of source file. It must be regular file.
+   * \param name   [in] Name of artifact.<br>
+   *                    File name of source is used, if value is null.
+   * \return Value is zero, if process is succeed.<br />
+   *         Value is error number a.k.a. "errno", if process is failure.
+   */
+  virtual int copyFile(char const *source, char const *name = NULL) = 0;
+
+  /*!
+   * \brief Open an artifact to write. It must be closed by closeEntry().
+   * \param name [in] Name of artifact.
+   * \return File descriptor to write.<br>
+   *         Value is -1 and errno is set, if process is failure.
+   */
+  virtual int openEntry(char const *name) = 0;
+
+  /*!
+   * \brief Close artifact which is opened by openEntry().
+   * \param name [in] Name of artifact.
+   * \param fd   [in] File descriptor which is returned by openEntry().
+   * \return Value is zero, if process is succeed.<br />
+   *         Value is error number a.k.a. "errno", if process is failure.
+   */
+  virtual int closeEntry(char const *name, int fd) = 0;
+
+  /*!
+   * \brief Store data which is read from stream until EOF as an artifact.
+   * \param name  [in] Name of artifact.
+   * \param srcFd [in] File descriptor of source. e.g. pipe.
+   * \return Value is zero, if process is succeed.<br />
+   *         Value is error number a.k.a. "errno", if process is failure.
+   */
+  virtual int addStream(char const *name, int srcFd) = 0;
+
+  /*!
+   * \brief Copy data from offset to EOF of file as an artifact.
+   * \param name   [in]  Name of artifact.
+   * \param srcFd  [in]  File descriptor of source file.
+   * \param offset [in]  Offset of source file to start copy.
+   * \param size   [out] Size of copied data.
+   * \return Value is zero, if process is succeed.<br />
+   *         Value is error number a.k.a. "errno", if process is failure.
+   */
+  virtual int copyFileTail(char const *name, int srcFd, off_t offset,
+                           off_t *size) = 0;
+
+  /*!
+   * \brief Reject artifacts from threads except the creator thread.
+   *        Artifact which is being stored by them is aborted.
+   */
+  virtual void rejectWorkers(void);
+
+  /*!
+   * \brief Release this object.
+   */
+  void release(void);
+
+  /*!
+   * \brief Add reference to this object.
+   */
+  void retain(void);
+
+ protected:
+  /*!
+   * \brief TArtifactSink destructor.
+   */
+  virtual ~TArtifactSink(void);
+
+  /*!
+   * \brief Check whether current thread can add artifacts.<br>
+   *        Caller must hold mutex.
+   * \return true if current thread can add artifacts.
+   */
+  bool isAcceptable(void);
+
+  /*!
+   * \brief Check whether artifact from current thread is rejected.<br>
+   *        Long copy checks it for each chunk, so abandoned worker stops.
+   * \param data [in] TArtifactSink object.
+   * \return true if current thread cannot add artifacts.
+   */
+  static bool isRejected(void *data);
+
+  /*!
+   * \brief Mutex of this object.
+   */
+  pthread_mutex_t mutex;
+
+ private:
+  /*!
+   * \brief Thread which creates this object.
+   */
+  pthread_t owner;
+
+  /*!
+   * \brief Artifacts from worker threads are rejected.
+   */
+  bool isRejecting;
+
+  /*!
+   * \brief Count of references.
+   */
+  int refCount;
+};
+
+/*!
+ * \brief This class stores artifacts as files in working directory.<br>
+ *        The directory is archived by TArchiveMaker after collection.
+ *        Data is copied in kernel chunk by chunk with mutex, so no
+ *        abandoned worker writes to the directory after rejectWorkers().<br>
+ *        The directory is removed when the last reference is released if
+ *        removeOnRelease() is called.
+ */
+class TDirArtifactSink : public TArtifactSink {
+ public:
+  /*!
+   * \brief TDirArtifactSink constructor.
+   * \param basePath [in] Path of working directory.
+   */
+  TDirArtifactSink(char const *basePath);
+
+  virtual int copyFile(char const *source, char const *name = NULL);
+  virtual int openEntry(char const *name);
+  virtual int closeEntry(char const *name, int fd);
+  virtual int addStream(char const *name, int srcFd);
+  virtual int copyFileTail(char const *name, int srcFd, off_t offset,
+                           off_t *size);
+
+  /*!
+   * \brief Get path of working directory.
+   * \return Path of working directory.
+   */
+  inline char const *getBasePath(void) { return basePath; }
+
+  /*!
+   * \brief Remove working directory when this object is deallocated.
+   *        Abandoned workers might refer to it until then.
+   */
+  void removeOnRelease(void);
+
+ protected:
+  /*!
+   * \brief TDirArtifactSink destructor.
+   */
+  virtual ~TDirArtifactSink(void);
+
+  /*!
+   * \brief Guard of each chunk which is copied to working directory.<br>
+   *        Mutex is held while the chunk is written. rejectWorkers() waits
+   *        for it, so working directory is not changed while it is archived.
+   * \param data    [in] TDirArtifactSink object.
+   * \param isEnter [in] Chunk is going to be written.
+   * \return Value is zero, if the chunk can be written.<br />
+   *         Value is ECANCELED, if artifacts from current thread are
+   *         rejected.
+   */
+  static int guardChunk(void *data, bool isEnter);
+
+ private:
+  /*!
+   * \brief Path of working directory.
+   */
+  char *basePath;
+
+  /*!
+   * \brief Working directory is removed in destructor.
+   */
+  bool isRemoving;
+};
+
+/*!
+ * \brief This class stores artifacts as entries of zip archive directly.<br>
+ *        Each artifact is compressed into a buffer of the calling thread
+ *        without mutex, and the finished entry is appended to archive with
+ *        mutex. So slow source does not block other threads.<br>
+ *        Large regular file is compressed into archive directly with mutex
+ *        if archiver has parallel deflater, because it is not buffered and
+ *        all compression threads are used for it.<br>
+ *        Artifacts which are made by agent are buffered in memory until
+ *        closeEntry().
+ */
+class TZipArtifactSink : public TArtifactSink {
+ public:
+  /*!
+   * \brief TZipArtifactSink constructor.
+   * \param archiver    [in] Zip archiver. It is used until finish().
+   * \param archiveFile [in] Path of archive file.
+   */
+  TZipArtifactSink(TZipArchiver *archiver, char const *archiveFile);
+
+  virtual int copyFile(char const *source, char const *name = NULL);
+  virtual int openEntry(char const *name);
+  virtual int closeEntry(char const *name, int fd);
+  virtual int addStream(char const *name, int srcFd);
+  virtual int copyFileTail(char const *name, int srcFd, off_t offset,
+                           off_t *size);
+  virtual void rejectWorkers(void);
+
+  /*!
+   * \brief Finish archive file. No artifact can be added after this.<br>
+   *        Archive file is removed if result is not zero.
+   * \param result [in] Result of collecting artifacts.
+   * \return Value is zero, if process is succeed.<br />
+   *         Value is error number a.k.a. "errno", if process is failure.
+   */
+  int finish(int result);
+
+ protected:
+  /*!
+   * \brief TZipArtifactSink destructor.
+   */
+  virtual ~TZipArtifactSink(void);
+
+  /*!
+   * \brief Open buffer of current thread. It is anonymous memory, or
+   *        unlinked file if memfd_create(2) is not available.
+   * \return File descriptor of buffer.<br>
+   *         Value is -1 and errno is set, if process is failure.
+   */
+  int openBuffer(void);
+
+  /*!
+   * \brief Compress data which is read until EOF, and append it to archive.
+   * \param name  [in]  Name of artifact.
+   * \param srcFd [in]  File descriptor of source.
+   * \param size  [out] Size of source data. It can be null.
+   * \return Value is zero, if process is succeed.<br />
+   *         Value is error number a.k.a. "errno", if process is failure.
+   */
+  int addData(char const *name, int srcFd, uint64_t *size);
+
+ private:
+  /*!
+   * \brief Zip archiver. NULL after finish().
+   */
+  TZipArchiver *archiver;
+
+  /*!
+   * \brief Directory to create buffer file if memfd is not available.
+   */
+  char *bufferDir;
+};
+
+/*!
+ * \brief Content in artifact store.
+ */
+typedef struct {
+  time_t mtime;      /*!< Time of last use.    */
+  off_t size;        /*!< Size of content.     */
+  std::string name;  /*!< File name of content. */
+} TStoredArtifact;
+
+/*!
+ * \brief Compare contents in artifact store by time of last use.
+ * \param a [in] Content.
+ * \param b [in] Content.
+ * \return Value is true, if a is used before b.
+ */
+inline bool isOlderArtifact(const TStoredArtifact &a,
+                            const TStoredArtifact &b) {
+  return a.mtime < b.mtime;
+}
+
+/*!
+ * \brief This class deduplicates copied files by artifact store.<br>
+ *        A file which is in the store already is recorded in manifest
+ *        instead of storing it to the destination sink. A new file is
+ *        stored to both of them, so the first archive has it.<br>
+ *        Large files and other artifacts are passed to the destination.<br>
+ *        Timestamp of content in the store is updated when it is used, so
+ *        contents which are not used for the longest time are pruned.
+ */
+class TDedupArtifactSink : public TArtifactSink {
+ public:
+  /*!
+   * \brief TDedupArtifactSink constructor.
+   * \param sink     [in] Destination sink.
+   * \param storeDir [in] Path of artifact store directory.
+   * \param maxStoreSize [in] Max size of artifact store.<br>
+   *                          Zero means unlimited.
+   */
+  TDedupArtifactSink(TArtifactSink *sink, char const *storeDir,
+                     off_t maxStoreSize);
+
+  virtual int copyFile(char const *source, char const *name = NULL);
+  virtual int openEntry(char const *name);
+  virtual int closeEntry(char const *name, int fd);
+  virtual int addStream(char const *name, int srcFd);
+  virtual int copyFileTail(char const *name, int srcFd, off_t offset,
+                           off_t *size);
+  virtual void rejectWorkers(void);
+
+  /*!
+   * \brief Store manifest of deduplicated artifacts to destination sink.
+   *        Nothing is stored if no artifact is deduplicated.
+   * \return Value is zero, if process is succeed.<br />
+   *         Value is error number a.k.a. "errno", if process is failure.
+   */
+  int writeManifest(void);
+
+  /*!
+   * \brief Remove contents which are not used for the longest time from
+   *        artifact store until its size is less than the limit.<br>
+   *        Contents which are used by this sink are not removed.
+   * \return Value is zero, if process is succeed.<br />
+   *         Value is error number a.k.a. "errno", if process is failure.
+   */
+  int pruneStore(void);
+
+ protected:
+  /*!
+   * \brief TDedupArtifactSink destructor.
+   */
+  virtual ~TDedupArtifactSink(void);
+
+  /*!
+   * \brief Read whole file if it is small enough to deduplicate.
+   * \param source [in]  Path of source file.
+   * \param buf    [out] Content of file. Caller must free it.
+   * \param size   [out] Size of content.
+   * \return Value is zero, if process is succeed.<br />
+   *         Value is EFBIG if the file is too large to deduplicate.<br />
+   *         Value is error number a.k.a. "errno", if process is failure.
+   */
+  int readSmallFile(char const *source, char **buf, size_t *size);
+
+  /*!
+   * \brief Store content to artifact store if it is not stored yet.
+   * \param key  [in]  Key of content.
+   * \param buf  [in]  Content.
+   * \param size [in]  Size of content.
+   * \param isStored [out] Content was in artifact store already.
+   * \return Value is zero, if process is succeed.<br />
+   *         Value is error number a.k.a. "errno", if process is failure.
+   */
+  int storeContent(char const *key, char const *buf, size_t size,
+                   bool *isStored);
+
+ private:
+  /*!
+   * \brief Destination sink.
+   */
+  TArtifactSink *sink;
+
+  /*!
+   * \brief Path of artifact store directory.
+   */
+  char *storeDir;
+
+  /*!
+   * \brief Max size of artifact store. Zero means unlimited.
+   */
+  off_t maxStoreSize;
+
+  /*!
+   * \brief Time when this sink is created.<br>
+   *        Contents which are used after this are not pruned.
+   */
+  time_t startTime;
+
+  /*!
+   * \brief Lines of manifest.
+   */
+  std::vector<std::string> manifest;
+};
+
+#endif  // _ARTIFACT_SINK_H
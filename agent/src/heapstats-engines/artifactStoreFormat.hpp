@@ -0,0 +1,189 @@
+/*!
+ * \file artifactStoreFormat.hpp
+ * \brief This file defines format of artifact store and manifest.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ *
+ */
+
+#ifndef ARTIFACT_STORE_FORMAT_HPP
+#define ARTIFACT_STORE_FORMAT_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/*!
+ * \brief Name of artifact store directory in log directory.<br>
+ *        Each artifact is stored as a file named by its key.
+ */
+#define ARTIFACT_STORE_DIRNAME "artifact-store"
+
+/*!
+ * \brief Name of manifest in log archive.<br>
+ *        Each line is "<key>\t<entry name>" of an artifact which is not
+ *        embedded in the archive but is in artifact store. The first line
+ *        is "#store\t<absolute path of artifact store>".
+ */
+#define ARTIFACT_MANIFEST_FILENAME "artifacts.manifest"
+
+/*!
+ * \brief Key of manifest line which has path of artifact store.
+ */
+#define ARTIFACT_MANIFEST_STORE_KEY "#store"
+
+/*!
+ * \brief Max length of artifact key. (16 hex digits, '-' and size)
+ */
+#define ARTIFACT_KEY_LENGTH 40
+
+/*!
+ * \brief Max size of artifact which is deduplicated.
+ */
+#define ARTIFACT_DEDUP_MAX_SIZE (1024 * 1024)
+
+/*!
+ * \brief Initial size of buffer to read file which has no size.
+ */
+#define ARTIFACT_DEDUP_READ_SIZE 4096
+
+/*!
+ * \brief Primes of XXH64.
+ */
+#define ARTIFACT_HASH_PRIME1 0x9e3779b185ebca87ULL
+#define ARTIFACT_HASH_PRIME2 0xc2b2ae3d27d4eb4fULL
+#define ARTIFACT_HASH_PRIME3 0x165667b19e3779f9ULL
+#define ARTIFACT_HASH_PRIME4 0x85ebca77c2b2ae63ULL
+#define ARTIFACT_HASH_PRIME5 0x27d4eb2f165667c5ULL
+
+/*!
+ * \brief Rotate bits to left.
+ * \param value [in] Value.
+ * \param bits  [in] Count of bits.
+ * \return Rotated value.
+ */
+inline uint64_t rotateArtifactHash(uint64_t value, int bits) {
+  return (value << bits) | (value >> (64 - bits));
+}
+
+/*!
+ * \brief Mix 8 bytes of input into accumulator of XXH64.
+ * \param acc   [in] Accumulator.
+ * \param input [in] Input.
+ * \return New accumulator.
+ */
+inline uint64_t roundArtifactHash(uint64_t acc, uint64_t input) {
+  acc += input * ARTIFACT_HASH_PRIME2;
+  acc = rotateArtifactHash(acc, 31);
+  return acc * ARTIFACT_HASH_PRIME1;
+}
+
+/*!
+ * \brief Merge accumulator of XXH64 into hash.
+ * \param hash [in] Hash.
+ * \param acc  [in] Accumulator.
+ * \return New hash.
+ */
+inline uint64_t mergeArtifactHash(uint64_t hash, uint64_t acc) {
+  hash ^= roundArtifactHash(0, acc);
+  return hash * ARTIFACT_HASH_PRIME1 + ARTIFACT_HASH_PRIME4;
+}
+
+/*!
+ * \brief Calculate XXH64 hash with seed 0.<br>
+ *        Input is read as little endian.
+ * \param data [in] Data.
+ * \param len  [in] Length of data.
+ * \return Hash value.
+ */
+inline uint64_t calculateArtifactHash(const void *data, size_t len) {
+  const unsigned char *pos = (const unsigned char *)data;
+  const unsigned char *end = pos + len;
+  uint64_t hash;
+
+  if (len >= 32) {
+    uint64_t acc[4] = {ARTIFACT_HASH_PRIME1 + ARTIFACT_HASH_PRIME2,
+                       ARTIFACT_HASH_PRIME2, 0, 0 - ARTIFACT_HASH_PRIME1};
+    do {
+      for (int idx = 0; idx < 4; idx++) {
+        uint64_t input;
+        memcpy(&input, pos, sizeof(input));
+        acc[idx] = roundArtifactHash(acc[idx], input);
+        pos += sizeof(input);
+      }
+    } while (pos + 32 <= end);
+
+    hash = rotateArtifactHash(acc[0], 1) + rotateArtifactHash(acc[1], 7) +
+           rotateArtifactHash(acc[2], 12) + rotateArtifactHash(acc[3], 18);
+    for (int idx = 0; idx < 4; idx++) {
+      hash = mergeArtifactHash(hash, acc[idx]);
+    }
+  } else {
+    hash = ARTIFACT_HASH_PRIME5;
+  }
+
+  hash += len;
+
+  while (pos + 8 <= end) {
+    uint64_t input;
+    memcpy(&input, pos, sizeof(input));
+    hash ^= roundArtifactHash(0, input);
+    hash = rotateArtifactHash(hash, 27) * ARTIFACT_HASH_PRIME1 +
+           ARTIFACT_HASH_PRIME4;
+    pos += 8;
+  }
+
+  if (pos + 4 <= end) {
+    uint32_t input;
+    memcpy(&input, pos, sizeof(input));
+    hash ^= (uint64_t)input * ARTIFACT_HASH_PRIME1;
+    hash = rotateArtifactHash(hash, 23) * ARTIFACT_HASH_PRIME2 +
+           ARTIFACT_HASH_PRIME3;
+    pos += 4;
+  }
+
+  while (pos < end) {
+    hash ^= (*pos) * ARTIFACT_HASH_PRIME5;
+    hash = rotateArtifactHash(hash, 11) * ARTIFACT_HASH_PRIME1;
+    pos++;
+  }
+
+  hash ^= hash >> 33;
+  hash *= ARTIFACT_HASH_PRIME2;
+  hash ^= hash >> 29;
+  hash *= ARTIFACT_HASH_PRIME3;
+  hash ^= hash >> 32;
+
+  return hash;
+}
+
+/*!
+ * \brief Make key of artifact in artifact store.<br>
+ *        Key is XXH64 hash of content in hex and size of content, so
+ *        contents which have same hash and different size do not collide.
+ * \param data [in]  Content of artifact.
+ * \param len  [in]  Length of content.
+ * \param key  [out] Buffer of key. Its size must be ARTIFACT_KEY_LENGTH.
+ */
+inline void makeArtifactKey(const void *data, size_t len, char *key) {
+  snprintf(key, ARTIFACT_KEY_LENGTH, "%016llx-%llu",
+           (unsigned long long)calculateArtifactHash(data, len),
+           (unsigned long long)len);
+}
+
+#endif  // ARTIFACT_STORE_FORMAT_HPP
@@ -0,0 +1,204 @@
+/*!
+ * \file callSiteTable.cpp
+ * \brief This file is used to aggregate events of profilers per call site.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ *
+ */
+
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "globals.hpp"
+#include "callSiteTable.hpp"
+
+/*!
+ * \brief Max count of linear probing in call site table.
+ */
+#define CALL_SITE_TABLE_MAX_PROBE 64
+
+/*!
+ * \brief TCallSiteTable constructor.
+ * \param size [in] Number of slots. This value must be power of 2.
+ */
+TCallSiteTable::TCallSiteTable(int size) {
+  this->size = size;
+  this->table = new std::atomic<TCallSite *>[size];
+  for (int idx = 0; idx < size; idx++) {
+    this->table[idx] = NULL;
+  }
+}
+
+/*!
+ * \brief TCallSiteTable destructor.
+ */
+TCallSiteTable::~TCallSiteTable(void) {
+  clear();
+  delete[] table;
+}
+
+/*!
+ * \brief Find or register call site.
+ * \param classTag  [in] Tag of class.
+ * \param className [in] Name of class.
+ * \param key       [in] Key of call site.
+ * \param location  [in] Location of call site.
+ * \return Call site.<br>
+ *         Value is NULL if table is full.
+ */
+TCallSite *TCallSiteTable::intern(jlong classTag, const char *className,
+                                  const void *key, jlocation location) {
+  unsigned long long int hashKey = (unsigned long long int)classTag;
+  hashKey = hashKey * 31 + (unsigned long long int)key;
+  hashKey = hashKey * 31 + (unsigned long long int)location;
+  unsigned int hash = (unsigned int)(hashKey ^ (hashKey >> 32));
+
+  for (int probe = 0; probe < CALL_SITE_TABLE_MAX_PROBE; probe++) {
+    size_t idx = (hash + probe) & (size - 1);
+    TCallSite *cur = table[idx].load();
+
+    if (cur == NULL) {
+      TCallSite *newSite = NULL;
+      try {
+        newSite = new TCallSite();
+      } catch (...) {
+        return NULL;
+      }
+
+      newSite->hash = hash;
+      newSite->classTag = classTag;
+      newSite->className = strdup(className);
+      newSite->key = key;
+      newSite->location = location;
+      newSite->description = NULL;
+      newSite->count = 0;
+      newSite->total = 0;
+      newSite->max = 0;
+      if (unlikely(newSite->className == NULL)) {
+        delete newSite;
+        return NULL;
+      }
+
+      if (table[idx].compare_exchange_strong(cur, newSite)) {
+        return newSite;
+      }
+
+      /* Other thread published site to this slot. */
+      free(newSite->className);
+      delete newSite;
+    }
+
+    /*
+     * Tag of class might be reused by other class after class unloading.
+     * So we compare class name too.
+     */
+    if ((cur->hash == hash) && (cur->classTag == classTag) &&
+        (cur->key == key) && (cur->location == location) &&
+        (strcmp(cur->className, className) == 0)) {
+      return cur;
+    }
+  }
+
+  return NULL;
+}
+
+/*!
+ * \brief Reset counters of all call sites.
+ */
+void TCallSiteTable::resetCounters(void) {
+  for (int idx = 0; idx < size; idx++) {
+    TCallSite *site = table[idx].load();
+    if (site != NULL) {
+      site->count = 0;
+      site->total = 0;
+      site->max = 0;
+    }
+  }
+}
+
+/*!
+ * \brief Remove all call sites.<br>
+ *        Caller must ensure that no event handler refers the table.
+ */
+void TCallSiteTable::clear(void) {
+  for (int idx = 0; idx < size; idx++) {
+    TCallSite *site = table[idx].exchange(NULL);
+    if (site != NULL) {
+      free(site->className);
+      free(site->description);
+      delete site;
+    }
+  }
+}
+
+/*!
+ * \brief TCallSiteCsvWriter constructor.
+ * \param fname  [in] File name to append rows.
+ * \param header [in] Header line of CSV without line feed.
+ */
+TCallSiteCsvWriter::TCallSiteCsvWriter(const char *fname,
+                                       const char *header) {
+  this->fileName = fname;
+
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  this->nowTime = (jlong)tv.tv_sec * 1000 + (jlong)tv.tv_usec / 1000;
+
+  this->out = fopen(fname, "a");
+  if (unlikely(this->out == NULL)) {
+    logger->printWarnMsgWithErrno("Could not open %s", fname);
+    return;
+  }
+
+  /* Write CSV header to new file. */
+  if (ftell(this->out) == 0) {
+    fprintf(this->out, "%s\n", header);
+  }
+}
+
+/*!
+ * \brief TCallSiteCsvWriter destructor.<br>
+ *        File is closed in this function.
+ */
+TCallSiteCsvWriter::~TCallSiteCsvWriter(void) {
+  if ((out != NULL) && unlikely(fclose(out) != 0)) {
+    logger->printWarnMsgWithErrno("Could not write %s", fileName);
+  }
+}
+
+/*!
+ * \brief Append a row.
+ * \param className [in] Class name.
+ * \param format    [in] Format string of printf for rest columns.
+ */
+void TCallSiteCsvWriter::writeRow(const char *className, const char *format,
+                                  ...) {
+  if (unlikely(out == NULL)) {
+    return;
+  }
+
+  fprintf(out, JLONG_FORMAT_STR ",%s,", nowTime, className);
+
+  va_list args;
+  va_start(args, format);
+  vfprintf(out, format, args);
+  va_end(args);
+
+  fputc('\n', out);
+}
@@ -0,0 +1,189 @@
+/*!
+ * \file callSiteTable.hpp
+ * \brief This file is used to aggregate events of profilers per call site.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ *
+ */
+
+#ifndef CALL_SITE_TABLE_HPP
+#define CALL_SITE_TABLE_HPP
+
+#include <jvmti.h>
+#include <jni.h>
+
+#include <stddef.h>
+#include <stdio.h>
+
+#ifdef HAVE_ATOMIC
+#include <atomic>
+#else
+#include <cstdatomic>
+#endif
+
+#include "util.hpp"
+
+/*!
+ * \brief Events of class at call site.<br>
+ *        Meaning of key and counters is defined by each profiler.
+ */
+typedef struct {
+  unsigned int hash;          /*!< Hash value of class and site.     */
+  jlong classTag;             /*!< Tag of class.                     */
+  char *className;            /*!< Name of class.                    */
+  const void *key;            /*!< Key of call site.                 */
+  jlocation location;         /*!< Location of call site.            */
+  char *description;          /*!< Formatted site. Set by dumper.    */
+  std::atomic<jlong> count;   /*!< Count of events.                  */
+  std::atomic<jlong> total;   /*!< Total value of events.            */
+  std::atomic<jlong> max;     /*!< Max value of events.              */
+} TCallSite;
+
+/*!
+ * \brief This class aggregates events per (class, call site).<br>
+ *        Sites are published to open addressing table by CAS, so event
+ *        handlers do not need any lock. Sites are never removed until
+ *        the table is cleared.
+ */
+class TCallSiteTable {
+ public:
+  /*!
+   * \brief TCallSiteTable constructor.
+   * \param size [in] Number of slots. This value must be power of 2.
+   */
+  TCallSiteTable(int size);
+
+  /*!
+   * \brief TCallSiteTable destructor.
+   */
+  virtual ~TCallSiteTable(void);
+
+  /*!
+   * \brief Find or register call site.
+   * \param classTag  [in] Tag of class.
+   * \param className [in] Name of class.
+   * \param key       [in] Key of call site.
+   * \param location  [in] Location of call site.
+   * \return Call site.<br>
+   *         Value is NULL if table is full.
+   */
+  TCallSite *intern(jlong classTag, const char *className, const void *key,
+                    jlocation location);
+
+  /*!
+   * \brief Add event to call site.
+   * \param site  [in] Call site.
+   * \param value [in] Value of event.
+   */
+  inline static void addEvent(TCallSite *site, jlong value) {
+    site->count++;
+    site->total += value;
+
+    jlong max = site->max.load(std::memory_order_relaxed);
+    while ((value > max) && !site->max.compare_exchange_weak(max, value)) {
+      /* Retry with updated max. */
+    }
+  }
+
+  /*!
+   * \brief Get number of slots.
+   * \return Number of slots.
+   */
+  inline int getSize(void) { return size; }
+
+  /*!
+   * \brief Get call site in slot.
+   * \param idx [in] Index of slot.
+   * \return Call site. Value is NULL if slot is empty.
+   */
+  inline TCallSite *getSite(int idx) { return table[idx].load(); }
+
+  /*!
+   * \brief Reset counters of all call sites.
+   */
+  void resetCounters(void);
+
+  /*!
+   * \brief Remove all call sites.<br>
+   *        Caller must ensure that no event handler refers the table.
+   */
+  void clear(void);
+
+ private:
+  /*!
+   * \brief Slots of call sites.
+   */
+  std::atomic<TCallSite *> *table;
+
+  /*!
+   * \brief Number of slots.
+   */
+  int size;
+};
+
+/*!
+ * \brief This class appends rows to CSV file of profiler.<br>
+ *        Each row starts with current time and class name. Header is
+ *        written when the file is created.
+ */
+class TCallSiteCsvWriter {
+ public:
+  /*!
+   * \brief TCallSiteCsvWriter constructor.
+   * \param fname  [in] File name to append rows.
+   * \param header [in] Header line of CSV without line feed.
+   */
+  TCallSiteCsvWriter(const char *fname, const char *header);
+
+  /*!
+   * \brief TCallSiteCsvWriter destructor.<br>
+   *        File is closed in this function.
+   */
+  virtual ~TCallSiteCsvWriter(void);
+
+  /*!
+   * \brief Is the file opened?
+   * \return true if the file is opened.
+   */
+  inline bool isOpened(void) { return out != NULL; }
+
+  /*!
+   * \brief Append a row.
+   * \param className [in] Class name.
+   * \param format    [in] Format string of printf for rest columns.
+   */
+  void writeRow(const char *className, const char *format, ...)
+      __attribute__((format(printf, 3, 4)));
+
+ private:
+  /*!
+   * \brief File name.
+   */
+  const char *fileName;
+
+  /*!
+   * \brief Output file.
+   */
+  FILE *out;
+
+  /*!
+   * \brief Time of rows in milliseconds.
+   */
+  jlong nowTime;
+};
+
+#endif  // CALL_SITE_TABLE_HPP
@@ -371,6 +371,29 @@ class TMonitorWaitedCallback
   };
 };
 
+#ifdef HAVE_SAMPLED_OBJECT_ALLOC
+/*!
+ * \brief JVMTI SampledObjectAlloc callback.
+ */
+class TSampledObjectAllocCallback
+    : public TJVMTIEventCallback<jvmtiEventSampledObjectAlloc,
+                                 JVMTI_EVENT_SAMPLED_OBJECT_ALLOC> {
+ public:
+  static void JNICALL callbackStub(jvmtiEnv *jvmti, JNIEnv *env, jthread thread,
+                                   jobject object, jclass object_klass,
+                                   jlong size) {
+    ITERATE_CALLBACK_CHAIN(jvmtiEventSampledObjectAlloc, jvmti, env, thread,
+                           object, object_klass, size);
+  };
+
+  DEFINE_MERGE_CALLBACK(SampledObjectAlloc)
+
+  static void mergeCapabilities(jvmtiCapabilities *capabilities) {
+    capabilities->can_generate_sampled_object_alloc = 1;
+  };
+};
+#endif
+
 /*!
  * \brief Register JVMTI callbacks to JVM.
  *
@@ -392,6 +415,9 @@ inline bool registerJVMTICallbacks(jvmtiEnv *jvmti) {
   TThreadEndCallback::mergeCallback(&callbacks);
   TMonitorWaitCallback::mergeCallback(&callbacks);
   TMonitorWaitedCallback::mergeCallback(&callbacks);
+#ifdef HAVE_SAMPLED_OBJECT_ALLOC
+  TSampledObjectAllocCallback::mergeCallback(&callbacks);
+#endif
 
   return isError(
       jvmti, jvmti->SetEventCallbacks(&callbacks, sizeof(jvmtiEventCallbacks)));
@@ -0,0 +1,131 @@
+/*!
+ * \file chunkArena.cpp
+ * \brief This file is used to store variable-length entries in chunks.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ *
+ */
+
+#include <stdlib.h>
+
+#include "globals.hpp"
+#include "chunkArena.hpp"
+
+/*!
+ * \brief Round up size of entry to keep alignment of entries.
+ * \param size [in] Size of entry.
+ * \return Size of entry in chunk.
+ */
+static inline size_t alignEntrySize(size_t size) {
+  return (size + 7) & ~(size_t)7;
+}
+
+/*!
+ * \brief TChunkArena constructor.
+ * \param chunkSize [in] Size of a chunk.
+ */
+TChunkArena::TChunkArena(size_t chunkSize) {
+  this->chunkSize = chunkSize;
+  this->chunks = NULL;
+  this->totalSize = 0;
+}
+
+/*!
+ * \brief TChunkArena destructor.
+ */
+TChunkArena::~TChunkArena(void) {
+  while (chunks != NULL) {
+    TArenaChunk *next = chunks->next;
+    free(chunks);
+    chunks = next;
+  }
+}
+
+/*!
+ * \brief Get space of new entry at the tail of current chunk.<br>
+ *        The space is not used until it is committed, so caller can
+ *        discard the entry built in it.
+ * \param size [in] Size of entry.
+ * \return Top of the space. Value is null, if process is failure.
+ */
+void *TChunkArena::reserve(size_t size) {
+  size_t entrySize = alignEntrySize(size);
+
+  /* Switch to new chunk if current chunk does not have enough space. */
+  if ((chunks == NULL) || (chunks->capacity - chunks->used < entrySize)) {
+    size_t capacity = (entrySize > chunkSize) ? entrySize : chunkSize;
+    TArenaChunk *chunk =
+        (TArenaChunk *)malloc(sizeof(TArenaChunk) + capacity);
+    if (unlikely(chunk == NULL)) {
+      return NULL;
+    }
+
+    chunk->used = 0;
+    chunk->capacity = capacity;
+    chunk->liveEntries = 0;
+
+    /* Old chunk which has no entry is not needed anymore. */
+    if ((chunks != NULL) && (chunks->liveEntries == 0)) {
+      TArenaChunk *old = chunks;
+      chunks = old->next;
+      totalSize -= old->capacity;
+      free(old);
+    }
+
+    chunk->next = chunks;
+    chunks = chunk;
+    totalSize += capacity;
+  }
+
+  return chunks->body + chunks->used;
+}
+
+/*!
+ * \brief Commit entry which is built in reserved space.
+ * \param size [in] Size of entry. It must be same as reserve().
+ * \return Chunk which contains the entry.
+ */
+TArenaChunk *TChunkArena::commit(size_t size) {
+  chunks->used += alignEntrySize(size);
+  chunks->liveEntries++;
+  return chunks;
+}
+
+/*!
+ * \brief Release an entry.<br>
+ *        Chunk is released when all entries in it are released.
+ * \param chunk [in] Chunk which contains the entry.
+ */
+void TChunkArena::release(TArenaChunk *chunk) {
+  if (--chunk->liveEntries > 0) {
+    return;
+  }
+
+  if (chunk == chunks) {
+    /* Current chunk can be reused from the top. */
+    chunk->used = 0;
+    return;
+  }
+
+  TArenaChunk **prev = &chunks;
+  while (*prev != chunk) {
+    prev = &(*prev)->next;
+  }
+  *prev = chunk->next;
+  totalSize -= chunk->capacity;
+  free(chunk);
+}
@@ -0,0 +1,105 @@
+/*!
+ * \file chunkArena.hpp
+ * \brief This file is used to store variable-length entries in chunks.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ *
+ */
+
+#ifndef CHUNK_ARENA_HPP
+#define CHUNK_ARENA_HPP
+
+#include <stddef.h>
+
+/*!
+ * \brief Chunk of arena.
+ */
+typedef struct TArenaChunk {
+  struct TArenaChunk *next; /*!< Next chunk.                     */
+  size_t used;              /*!< Used bytes in body.             */
+  size_t capacity;          /*!< Size of body.                   */
+  size_t liveEntries;       /*!< Count of referred entries.      */
+  char body[];              /*!< Storage of entries.             */
+} TArenaChunk;
+
+/*!
+ * \brief This class stores variable-length entries in chunks.<br>
+ *        Entries are appended to the current chunk, and a chunk is
+ *        released when all entries in it are released. Entries are never
+ *        moved.<br>
+ *        This class is not thread-safe. Owner must lock it.
+ */
+class TChunkArena {
+ public:
+  /*!
+   * \brief TChunkArena constructor.
+   * \param chunkSize [in] Size of a chunk.
+   */
+  TChunkArena(size_t chunkSize);
+
+  /*!
+   * \brief TChunkArena destructor.
+   */
+  virtual ~TChunkArena(void);
+
+  /*!
+   * \brief Get space of new entry at the tail of current chunk.<br>
+   *        The space is not used until it is committed, so caller can
+   *        discard the entry built in it.
+   * \param size [in] Size of entry.
+   * \return Top of the space. Value is null, if process is failure.
+   */
+  void *reserve(size_t size);
+
+  /*!
+   * \brief Commit entry which is built in reserved space.
+   * \param size [in] Size of entry. It must be same as reserve().
+   * \return Chunk which contains the entry.
+   */
+  TArenaChunk *commit(size_t size);
+
+  /*!
+   * \brief Release an entry.<br>
+   *        Chunk is released when all entries in it are released.
+   * \param chunk [in] Chunk which contains the entry.
+   */
+  void release(TArenaChunk *chunk);
+
+  /*!
+   * \brief Get size of arena.
+   * \return Total size of chunks.
+   */
+  inline size_t getSize(void) { return totalSize; }
+
+ private:
+  /*!
+   * \brief Size of a chunk.
+   */
+  size_t chunkSize;
+
+  /*!
+   * \brief Chunk list. Head is current chunk.
+   */
+  TArenaChunk *chunks;
+
+  /*!
+   * \brief Total size of chunks.
+   */
+  size_t totalSize;
+};
+
+#endif  // CHUNK_ARENA_HPP
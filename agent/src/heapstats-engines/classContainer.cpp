@@ -90,6 +90,7 @@ static char ORDER_DELTA[6] = "DELTA";
 TClassContainer::TClassContainer(void) : classMap(), updatedClassList() {
   /* Create trap sender. */
   pSender = conf->SnmpSend()->get() ? new TTrapSender() : NULL;
+  leakDetector = NULL;
 }
 
 /*!
@@ -101,6 +102,7 @@ TClassContainer::~TClassContainer(void) {
 
   /* Cleanup instances. */
   delete pSender;
+  delete leakDetector;
 }
 
 /*!
@@ -113,25 +115,26 @@ TObjectData *TClassContainer::pushNewClass(void *klassOop) {
 
   /* Class info setting. */
 
-  cur = (TObjectData *)calloc(1, sizeof(TObjectData));
-  /* If failure allocate. */
-  if (unlikely(cur == NULL)) {
+  unsigned short symbolLen;
+  const char *symbol =
+      getClassSymbol(getKlassFromKlassOop(klassOop), &symbolLen);
+  /* If failure getting class name. */
+  if (unlikely(symbol == NULL)) {
     /* Adding empty to list is deny. */
-    logger->printWarnMsg("Couldn't allocate counter memory!");
+    logger->printWarnMsg("Couldn't get class name!");
     return NULL;
   }
 
-  cur->tag = (uintptr_t)cur;
-  cur->className = getClassName(getKlassFromKlassOop(klassOop));
-  /* If failure getting class name. */
-  if (unlikely(cur->className == NULL)) {
+  cur = storage.allocate(symbol, symbolLen);
+  /* If failure allocate. */
+  if (unlikely(cur == NULL)) {
     /* Adding empty to list is deny. */
-    logger->printWarnMsg("Couldn't get class name!");
-    free(cur);
+    logger->printWarnMsg("Couldn't allocate counter memory!");
     return NULL;
   }
-  cur->classNameLen = strlen(cur->className);
-  cur->oopType = getClassType(cur->className);
+
+  TObjectColdData *cold = storage.getColdData(cur);
+  cur->oopType = getClassType(cold->className);
 
   void *clsLoader = getClassLoader(klassOop, cur->oopType);
   TObjectData *clsLoaderData = NULL;
@@ -147,15 +150,14 @@ TObjectData *TClassContainer::pushNewClass(void *klassOop) {
       }
     }
   }
-  cur->clsLoaderTag = (clsLoaderData != NULL) ? clsLoaderData->tag : 0;
-  cur->clsLoaderId = (uintptr_t)clsLoader;
+  cold->clsLoaderTag = (clsLoaderData != NULL) ? clsLoaderData->tag : 0;
+  cold->clsLoaderId = (uintptr_t)clsLoader;
 
   /* Chain setting. */
   cur->klassOop = klassOop;
   TObjectData *result = this->pushNewClass(klassOop, cur);
   if (unlikely(result != cur)) {
-    free(cur->className);
-    free(cur);
+    storage.release(cur);
   }
   return result;
 }
@@ -179,10 +181,12 @@ TObjectData *TClassContainer::pushNewClass(void *klassOop,
   if (!classMap.insert(acc, std::make_pair(klassOop, objData))) {
     TObjectData *expectData = acc->second;
     if (likely(expectData != NULL)) {
+      TObjectColdData *objCold = storage.getColdData(objData);
+      TObjectColdData *expectCold = storage.getColdData(expectData);
       /* If adding class data for another class is already exists. */
-      if (unlikely((expectData->className == NULL) ||
-                   (strcmp(objData->className, expectData->className) != 0) ||
-                   (objData->clsLoaderId != expectData->clsLoaderId))) {
+      if (unlikely((expectCold->className == NULL) ||
+                   (objCold->className != expectCold->className) ||
+                   (objCold->clsLoaderId != expectCold->clsLoaderId))) {
         acc->second = objData;
         unloadedList.push(expectData);
       }
@@ -205,12 +209,11 @@ void TClassContainer::removeClass(TObjectData *target) {
  *        This function will be called from d'tor of TClassContainer.
  */
 void TClassContainer::allClear(void) {
-  /* Add all TObjectData pointers in container map to unloadedList */
+  /* Release all TObjectData in container map. */
   for (auto cur = classMap.begin(); cur != classMap.end(); cur++) {
-    TObjectData *objData = cur->second;
-    free(objData->className);
-    free(objData);
+    storage.release(cur->second);
   }
+  classMap.clear();
 }
 
 /*!
@@ -436,28 +439,32 @@ inline bool sendHeapAlertTrap(TTrapSender *pSender, THeapDelta heapUsage,
  * \brief Output class information to file.
  * \param fd      [in] Target file descriptor.
  * \param objData [in] The class information.
+ * \param cold    [in] Cold part of the class information.
  * \param cur     [in] The class size counter.
  * \param snapshot[in] SnapShot container.
  * \return Value is zero, if process is succeed.<br />
  *         Value is error number a.k.a. "errno", if process is failure.
  */
 inline int writeClassData(const int fd, const TObjectData *objData,
-                          TClassCounter *cur, TSnapShotContainer *snapshot) {
+                          const TObjectColdData *cold, TClassCounter *cur,
+                          TSnapShotContainer *snapshot) {
   int result = 0;
   /* Output class-information. */
   try {
-    /* Output TObjectData.tag & TObjectData.classNameLen. */
-    if (unlikely(write(fd, objData, sizeof(jlong) << 1) < 0)) {
+    /* Output TObjectData.tag & TObjectColdData.classNameLen. */
+    jlong header[2] = {objData->tag, cold->classNameLen};
+    if (unlikely(write(fd, header, sizeof(header)) < 0)) {
       throw 1;
     }
 
     /* Output class name. */
-    if (unlikely(write(fd, objData->className, objData->classNameLen) < 0)) {
+    if (unlikely(write(fd, cold->className, cold->classNameLen) < 0)) {
       throw 1;
     }
 
     /* Output class loader's instance id and class tag. */
-    if (unlikely(write(fd, &objData->clsLoaderId, sizeof(jlong) << 1) < 0)) {
+    jlong loader[2] = {cold->clsLoaderId, cold->clsLoaderTag};
+    if (unlikely(write(fd, loader, sizeof(loader)) < 0)) {
       throw 1;
     }
 
@@ -530,6 +537,11 @@ int TClassContainer::afterTakeSnapShot(TSnapShotContainer *snapshot,
   hdr.safepointTime = jvmInfo->getSafepointTime();
   hdr.magicNumber |= EXTENDED_SAFEPOINT_TIME;
 
+  /* Classes which are not matched to class filter are not in snapshot. */
+  if (snapshot->getIsFiltered()) {
+    hdr.magicNumber |= EXTENDED_FILTERED_SNAPSHOT;
+  }
+
   /* If java heap usage alert is enable. */
   if (conf->getHeapAlertThreshold() > 0) {
     jlong usage = hdr.newAreaSize + hdr.oldAreaSize;
@@ -574,6 +586,27 @@ int TClassContainer::afterTakeSnapShot(TSnapShotContainer *snapshot,
   /* Class map used snapshot output. */
   auto workClsMap(classMap);
 
+  /* Leak trend is calculated from snapshots after GC only. */
+  TLeakTrendDetector *trend = NULL;
+  int leakWindow = conf->LeakDetectWindow()->get();
+  if ((leakWindow > 0) && (hdr.cause == GC)) {
+    if ((leakDetector == NULL) ||
+        (leakDetector->getWindowSize() != leakWindow)) {
+      delete leakDetector;
+      try {
+        leakDetector = new TLeakTrendDetector(leakWindow);
+      } catch (...) {
+        leakDetector = NULL;
+        logger->printWarnMsg("Couldn't allocate leak trend detector!");
+      }
+    }
+
+    trend = leakDetector;
+    if (likely(trend != NULL)) {
+      trend->beginSnapShot(hdr.snapShotTime);
+    }
+  }
+
   /* Allocate return array. */
   jlong rankCnt = workClsMap.size();
   rankCnt =
@@ -636,7 +669,18 @@ int TClassContainer::afterTakeSnapShot(TSnapShotContainer *snapshot,
   /* Loop each class. */
   for (auto it = workClsMap.begin(); it != workClsMap.end(); it++) {
     TObjectData *objData = it->second;
+    TObjectColdData *cold = storage.getColdData(objData);
     TClassCounter *cur = snapshot->findClass(objData);
+
+    /*
+     * Filtered snapshot does not count classes which are not matched.
+     * So we skip them to keep their previous usage for next delta.
+     * Matched classes are not skipped even if no instance is found.
+     */
+    if (snapshot->getIsFiltered() && !snapshot->isMatchedClass(objData)) {
+      continue;
+    }
+
     /* If don't registed class yet. */
     if (unlikely(cur == NULL)) {
       cur = snapshot->pushNewClass(objData);
@@ -651,15 +695,15 @@ int TClassContainer::afterTakeSnapShot(TSnapShotContainer *snapshot,
 
     /* Calculate uasge and delta size. */
     result.usage = cur->counter->total_size;
-    result.delta = cur->counter->total_size - objData->oldTotalSize;
+    result.delta = cur->counter->total_size - cold->oldTotalSize;
     result.tag = objData->tag;
-    objData->oldTotalSize = result.usage;
+    cold->oldTotalSize = result.usage;
 
     /* If do output class. */
     if (!conf->ReduceSnapShot()->get() || (result.usage > 0)) {
       /* Output class-information. */
       if (likely(raiseErrorCode == 0)) {
-        raiseErrorCode = writeClassData(fd, objData, cur, snapshot);
+        raiseErrorCode = writeClassData(fd, objData, cold, cur, snapshot);
       }
 
       numEntries++;
@@ -668,6 +712,29 @@ int TClassContainer::afterTakeSnapShot(TSnapShotContainer *snapshot,
     /* Ranking sort. */
     sortArray->push(result);
 
+    /* If leak trend detection is enable. */
+    double sizeSlope;
+    double countSlope;
+    if ((trend != NULL) &&
+        trend->addSample(objData->tag, result.usage, cur->counter->count,
+                         &sizeSlope, &countSlope) &&
+        (sizeSlope > conf->LeakAlertSlope()->get()) &&
+        trend->setAlerted(objData->tag)) {
+      /* Raise alert once until usage of the class decreases. */
+      logger->printWarnMsg(
+          "ALERT(LEAK): \"%s\" keeps growing after GC "
+          "(%.0f bytes/sec, %.2f objects/sec)",
+          cold->className, sizeSlope, countSlope);
+
+      /* If need send trap. */
+      if (conf->SnmpSend()->get()) {
+        if (unlikely(!sendHeapAlertTrap(pSender, result, cold->className,
+                                        cur->counter->count))) {
+          logger->printWarnMsg("Send SNMP trap failed!");
+        }
+      }
+    }
+
     /* If alert is enable. */
     if (AlertThreshold > 0) {
       /* Variable for send trap. */
@@ -678,21 +745,21 @@ int TClassContainer::afterTakeSnapShot(TSnapShotContainer *snapshot,
         /* Raise alert. */
         logger->printWarnMsg(
             "ALERT(DELTA): \"%s\" exceeded the threshold (%ld bytes)",
-            objData->className, result.delta);
+            cold->className, result.delta);
         /* Set need send trap flag. */
         sendFlag = 1;
       } else if ((order == USAGE) && (AlertThreshold <= result.usage)) {
         /* Raise alert. */
         logger->printWarnMsg(
             "ALERT(USAGE): \"%s\" exceeded the threshold (%ld bytes)",
-            objData->className, result.usage);
+            cold->className, result.usage);
         /* Set need send trap flag. */
         sendFlag = 1;
       }
 
       /* If need send trap. */
       if (conf->SnmpSend()->get() && sendFlag != 0) {
-        if (unlikely(!sendHeapAlertTrap(pSender, result, objData->className,
+        if (unlikely(!sendHeapAlertTrap(pSender, result, cold->className,
                                         cur->counter->count))) {
           logger->printWarnMsg("Send SNMP trap failed!");
         }
@@ -700,6 +767,11 @@ int TClassContainer::afterTakeSnapShot(TSnapShotContainer *snapshot,
     }
   }
 
+  /* Remove time series of classes which are not in this snapshot. */
+  if (trend != NULL) {
+    trend->endSnapShot();
+  }
+
   /* Set output entry count. */
   hdr.size = numEntries;
   /* Stored error number to avoid overwriting by "truncate" and etc.. */
@@ -795,8 +867,7 @@ void JNICALL OnGarbageCollectionFinishForUnload(jvmtiEnv *jvmti) {
     TObjectData *objData;
     while (unloadedList.try_pop(objData)) {
       clsContainer->removeClass(objData);
-      free(objData->className);
-      free(objData);
+      clsContainer->releaseObjectData(objData);
     }
   }
 
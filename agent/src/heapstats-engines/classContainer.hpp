@@ -29,6 +29,8 @@
 #include "sorter.hpp"
 #include "trapSender.hpp"
 #include "oopUtil.hpp"
+#include "leakTrendDetector.hpp"
+#include "objectDataStorage.hpp"
 
 #if PROCESSOR_ARCH == X86
 #include "arch/x86/lock.inline.hpp"
@@ -36,31 +38,11 @@
 #include "arch/arm/lock.inline.hpp"
 #endif
 
-/*!
- * \brief Pointer type of klassOop.
- */
-typedef void* PKlassOop;
-
 /*!
  * \brief Forward declaration in snapShotContainer.hpp
  */
 class TSnapShotContainer;
 
-/*!
- * \brief This structure stored class information.
- */
-typedef struct {
-  jlong tag;          /*!< Class tag.                                 */
-  jlong classNameLen; /*!< Class name.                                */
-  char *className;    /*!< Class name length.                         */
-  PKlassOop klassOop; /*!< Java inner class object.                   */
-  jlong oldTotalSize; /*!< Class old total use size.                  */
-  TOopType oopType;   /*!< Type of class.                             */
-  jlong clsLoaderId;  /*!< Class loader instance id.                  */
-  jlong clsLoaderTag; /*!< Class loader class tag.                    */
-  jlong instanceSize; /*!< Class size if this class is instanceKlass. */
-} TObjectData;
-
 /*!
  * \brief This structure stored size of a class used in heap.
  */
@@ -163,6 +145,23 @@ class TClassContainer {
     return classMap.size();
   }
 
+  /*!
+   * \brief Get class information which is not referred by heap iteration.
+   * \param objData [in] Class information.
+   * \return Cold part of class information.
+   */
+  inline TObjectColdData *getColdData(const TObjectData *objData) {
+    return storage.getColdData(objData);
+  }
+
+  /*!
+   * \brief Release class information.
+   * \param objData [in] Class information to release.
+   */
+  inline void releaseObjectData(TObjectData *objData) {
+    storage.release(objData);
+  }
+
   /*!
    * \brief Remove all-class from container.
    */
@@ -190,6 +189,16 @@ class TClassContainer {
    */
   TTrapSender *pSender;
 
+  /*!
+   * \brief Leak trend detector for snapshots after GC.
+   */
+  TLeakTrendDetector *leakDetector;
+
+  /*!
+   * \brief Storage of class information.
+   */
+  TObjectDataStorage storage;
+
   /*!
    * \brief Maps of class counting record.
    */
@@ -23,6 +23,7 @@
 #include "fsUtil.hpp"
 #include "signalManager.hpp"
 #include "configuration.hpp"
+#include "parallelDeflater.hpp"
 
 #if USE_PCRE
 #include "pcreRegex.hpp"
@@ -83,6 +84,7 @@ void TConfiguration::initializeConfig(const TConfiguration *src) {
     heapLogFile =
         new TStringConfig(this, "heaplogfile", (char *)"heapstats_log.csv",
                           &ReadStringValue, (TStringConfig::TFinalizer) & free);
+    heapLogBinary = new TBooleanConfig(this, "heaplog_binary", false);
     archiveFile =
         new TStringConfig(this, "archivefile", (char *)"heapstats_analyze.zip",
                           &ReadStringValue, (TStringConfig::TFinalizer) & free);
@@ -90,12 +92,16 @@ void TConfiguration::initializeConfig(const TConfiguration *src) {
                                 (TStringConfig::TFinalizer) & free);
     reduceSnapShot = new TBooleanConfig(this, "reduce_snapshot", true);
     collectRefTree = new TBooleanConfig(this, "collect_reftree", true);
+    snapShotClassFilter =
+        new TStringConfig(this, "snapshot_class_filter", (char *)"",
+                          &ReadStringValue, (TStringConfig::TFinalizer) & free);
     triggerOnFullGC = new TBooleanConfig(this, "trigger_on_fullgc", true,
                                          &setOnewayBooleanValue);
     triggerOnDump = new TBooleanConfig(this, "trigger_on_dump", true,
                                        &setOnewayBooleanValue);
     checkDeadlock = new TBooleanConfig(this, "check_deadlock", false,
                                        &setOnewayBooleanValue);
+    deadlockScanInterval = new TLongConfig(this, "deadlock_scan_interval", 0);
     triggerOnLogError = new TBooleanConfig(this, "trigger_on_logerror", true,
                                            &setOnewayBooleanValue);
     triggerOnLogSignal = new TBooleanConfig(this, "trigger_on_logsignal", true,
@@ -107,6 +113,8 @@ void TConfiguration::initializeConfig(const TConfiguration *src) {
     alertPercentage = new TIntConfig(this, "alert_percentage", 50);
     heapAlertPercentage = new TIntConfig(this, "javaheap_alert_percentage", 95);
     metaspaceThreshold = new TLongConfig(this, "metaspace_alert_threshold", 0);
+    leakDetectWindow = new TIntConfig(this, "leak_detect_window", 0);
+    leakAlertSlope = new TLongConfig(this, "leak_alert_slope", 1024);
     timerInterval = new TLongConfig(this, "snapshot_interval", 0);
     logInterval = new TLongConfig(this, "log_interval", 300);
     firstCollect = new TBooleanConfig(this, "first_collect", true);
@@ -130,6 +138,28 @@ void TConfiguration::initializeConfig(const TConfiguration *src) {
         this, "thread_record_iotracer",
         (char *)DEFAULT_CONF_DIR "/IoTrace.class",
         &ReadStringValue, (TStringConfig::TFinalizer) & free);
+    threadRecordStreamFileSize =
+        new TLongConfig(this, "thread_record_stream_file_size", 0);
+    threadRecordStreamFiles =
+        new TIntConfig(this, "thread_record_stream_files", 4);
+    threadRecordSnapshotSignal = new TStringConfig(
+        this, "thread_record_snapshot_signal", NULL, &setSignalValue,
+        (TStringConfig::TFinalizer) & free);
+    allocSamplingEnable =
+        new TBooleanConfig(this, "alloc_sampling_enable", false);
+    allocSamplingInterval =
+        new TLongConfig(this, "alloc_sampling_interval", 512 * 1024);
+    allocSamplingFileName = new TStringConfig(
+        this, "alloc_sampling_filename", (char *)"heapstats_alloc.csv",
+        &ReadStringValue, (TStringConfig::TFinalizer) & free);
+    contentionProfileEnable =
+        new TBooleanConfig(this, "contention_profile_enable", false);
+    contentionSampleInterval =
+        new TIntConfig(this, "contention_sample_interval", 16);
+    contentionProfileFileName = new TStringConfig(
+        this, "contention_profile_filename",
+        (char *)"heapstats_contention.csv", &ReadStringValue,
+        (TStringConfig::TFinalizer) & free);
     snmpSend =
         new TBooleanConfig(this, "snmp_send", false, &setOnewayBooleanValue);
     snmpTarget =
@@ -146,20 +176,29 @@ void TConfiguration::initializeConfig(const TConfiguration *src) {
                                (TStringConfig::TFinalizer) & free);
     archiveCommand = new TStringConfig(
         this, "archive_command",
-        (char *)"/usr/bin/zip %archivefile% -jr %logdir%",
+        (char *)DEFAULT_ARCHIVE_COMMAND,
         &ReadStringValue, (TStringConfig::TFinalizer) & free);
+    archiveTimeout = new TLongConfig(this, "archive_timeout", 60);
+    archiveThreads = new TIntConfig(this, "archive_threads", 1);
+    archiveNice = new TIntConfig(this, "archive_nice", 10);
+    archiveStreaming = new TBooleanConfig(this, "archive_streaming", true);
+    archiveDedup = new TBooleanConfig(this, "archive_dedup", false);
+    archiveStoreSize = new TIntConfig(this, "archive_store_size", 64);
     killOnError = new TBooleanConfig(this, "kill_on_error", false);
   } else {
     attach = new TBooleanConfig(*src->attach);
     fileName = new TStringConfig(*src->fileName);
     heapLogFile = new TStringConfig(*src->heapLogFile);
+    heapLogBinary = new TBooleanConfig(*src->heapLogBinary);
     archiveFile = new TStringConfig(*src->archiveFile);
     logFile = new TStringConfig(*src->logFile);
     reduceSnapShot = new TBooleanConfig(*src->reduceSnapShot);
     collectRefTree = new TBooleanConfig(*src->collectRefTree);
+    snapShotClassFilter = new TStringConfig(*src->snapShotClassFilter);
     triggerOnFullGC = new TBooleanConfig(*src->triggerOnFullGC);
     triggerOnDump = new TBooleanConfig(*src->triggerOnDump);
     checkDeadlock = new TBooleanConfig(*src->checkDeadlock);
+    deadlockScanInterval = new TLongConfig(*src->deadlockScanInterval);
     triggerOnLogError = new TBooleanConfig(*src->triggerOnLogError);
     triggerOnLogSignal = new TBooleanConfig(*src->triggerOnLogSignal);
     triggerOnLogLock = new TBooleanConfig(*src->triggerOnLogLock);
@@ -169,6 +208,8 @@ void TConfiguration::initializeConfig(const TConfiguration *src) {
     alertPercentage = new TIntConfig(*src->alertPercentage);
     heapAlertPercentage = new TIntConfig(*src->heapAlertPercentage);
     metaspaceThreshold = new TLongConfig(*src->metaspaceThreshold);
+    leakDetectWindow = new TIntConfig(*src->leakDetectWindow);
+    leakAlertSlope = new TLongConfig(*src->leakAlertSlope);
     timerInterval = new TLongConfig(*src->timerInterval);
     logInterval = new TLongConfig(*src->logInterval);
     firstCollect = new TBooleanConfig(*src->firstCollect);
@@ -179,25 +220,48 @@ void TConfiguration::initializeConfig(const TConfiguration *src) {
     threadRecordBufferSize = new TLongConfig(*src->threadRecordBufferSize);
     threadRecordFileName = new TStringConfig(*src->threadRecordFileName);
     threadRecordIOTracer = new TStringConfig(*src->threadRecordIOTracer);
+    threadRecordStreamFileSize =
+        new TLongConfig(*src->threadRecordStreamFileSize);
+    threadRecordStreamFiles = new TIntConfig(*src->threadRecordStreamFiles);
+    threadRecordSnapshotSignal =
+        new TStringConfig(*src->threadRecordSnapshotSignal);
+    allocSamplingEnable = new TBooleanConfig(*src->allocSamplingEnable);
+    allocSamplingInterval = new TLongConfig(*src->allocSamplingInterval);
+    allocSamplingFileName = new TStringConfig(*src->allocSamplingFileName);
+    contentionProfileEnable =
+        new TBooleanConfig(*src->contentionProfileEnable);
+    contentionSampleInterval =
+        new TIntConfig(*src->contentionSampleInterval);
+    contentionProfileFileName =
+        new TStringConfig(*src->contentionProfileFileName);
     snmpSend = new TBooleanConfig(*src->snmpSend);
     snmpTarget = new TStringConfig(*src->snmpTarget);
     snmpComName = new TStringConfig(*src->snmpComName);
     snmpLibPath = new TStringConfig(*src->snmpLibPath);
     logDir = new TStringConfig(*src->logDir);
     archiveCommand = new TStringConfig(*src->archiveCommand);
+    archiveTimeout = new TLongConfig(*src->archiveTimeout);
+    archiveThreads = new TIntConfig(*src->archiveThreads);
+    archiveNice = new TIntConfig(*src->archiveNice);
+    archiveStreaming = new TBooleanConfig(*src->archiveStreaming);
+    archiveDedup = new TBooleanConfig(*src->archiveDedup);
+    archiveStoreSize = new TIntConfig(*src->archiveStoreSize);
     killOnError = new TBooleanConfig(*src->killOnError);
   }
 
   configs.push_back(attach);
   configs.push_back(fileName);
   configs.push_back(heapLogFile);
+  configs.push_back(heapLogBinary);
   configs.push_back(archiveFile);
   configs.push_back(logFile);
   configs.push_back(reduceSnapShot);
   configs.push_back(collectRefTree);
+  configs.push_back(snapShotClassFilter);
   configs.push_back(triggerOnFullGC);
   configs.push_back(triggerOnDump);
   configs.push_back(checkDeadlock);
+  configs.push_back(deadlockScanInterval);
   configs.push_back(triggerOnLogError);
   configs.push_back(triggerOnLogSignal);
   configs.push_back(triggerOnLogLock);
@@ -207,6 +271,8 @@ void TConfiguration::initializeConfig(const TConfiguration *src) {
   configs.push_back(alertPercentage);
   configs.push_back(heapAlertPercentage);
   configs.push_back(metaspaceThreshold);
+  configs.push_back(leakDetectWindow);
+  configs.push_back(leakAlertSlope);
   configs.push_back(timerInterval);
   configs.push_back(logInterval);
   configs.push_back(firstCollect);
@@ -217,12 +283,27 @@ void TConfiguration::initializeConfig(const TConfiguration *src) {
   configs.push_back(threadRecordBufferSize);
   configs.push_back(threadRecordFileName);
   configs.push_back(threadRecordIOTracer);
+  configs.push_back(threadRecordStreamFileSize);
+  configs.push_back(threadRecordStreamFiles);
+  configs.push_back(threadRecordSnapshotSignal);
+  configs.push_back(allocSamplingEnable);
+  configs.push_back(allocSamplingInterval);
+  configs.push_back(allocSamplingFileName);
+  configs.push_back(contentionProfileEnable);
+  configs.push_back(contentionSampleInterval);
+  configs.push_back(contentionProfileFileName);
   configs.push_back(snmpSend);
   configs.push_back(snmpTarget);
   configs.push_back(snmpComName);
   configs.push_back(snmpLibPath);
   configs.push_back(logDir);
   configs.push_back(archiveCommand);
+  configs.push_back(archiveTimeout);
+  configs.push_back(archiveThreads);
+  configs.push_back(archiveNice);
+  configs.push_back(archiveStreaming);
+  configs.push_back(archiveDedup);
+  configs.push_back(archiveStoreSize);
   configs.push_back(killOnError);
 }
 
@@ -439,6 +520,8 @@ void TConfiguration::printSetting(void) {
   /* Output filenames. */
   logger->printInfoMsg("SnapShot FileName = %s", fileName->get());
   logger->printInfoMsg("Heap Log FileName = %s", heapLogFile->get());
+  logger->printInfoMsg("Heap Log Format = %s",
+                       heapLogBinary->get() ? "binary" : "CSV");
   logger->printInfoMsg("Archive FileName = %s", archiveFile->get());
   logger->printInfoMsg(
       "Console Log FileName = %s",
@@ -455,6 +538,14 @@ void TConfiguration::printSetting(void) {
   logger->printInfoMsg("CollectRefTree = %s",
                        collectRefTree->get() ? "true" : "false");
 
+  /* Output class filter for JVMTI snapshot. */
+  char *clsFilter = snapShotClassFilter->get();
+  if (clsFilter == NULL || strlen(clsFilter) == 0) {
+    logger->printInfoMsg("SnapShot class filter is DISABLED.");
+  } else {
+    logger->printInfoMsg("SnapShot class filter = %s", clsFilter);
+  }
+
   /* Output status of snapshot triggers. */
   logger->printInfoMsg("Trigger on FullGC = %s",
                        triggerOnFullGC->get() ? "true" : "false");
@@ -464,6 +555,12 @@ void TConfiguration::printSetting(void) {
   /* Output status of deadlock check. */
   logger->printInfoMsg("Deadlock check = %s",
                        checkDeadlock->get() ? "true" : "false");
+  if (deadlockScanInterval->get() == 0) {
+    logger->printInfoMsg("Deadlock check mode = event");
+  } else {
+    logger->printInfoMsg("Deadlock scan interval = %ld sec",
+                         deadlockScanInterval->get());
+  }
 
   /* Output status of logging triggers. */
   logger->printInfoMsg("Log trigger on Error = %s",
@@ -504,6 +601,15 @@ void TConfiguration::printSetting(void) {
                          metaspaceThreshold->get() / 1024 / 1024);
   }
 
+  /* Output about leak trend alert. */
+  if (leakDetectWindow->get() == 0) {
+    logger->printInfoMsg("Leak trend alert is DISABLED.");
+  } else {
+    logger->printInfoMsg(
+        "Leak trend alert window = %d snapshots, slope = %ld bytes/sec",
+        leakDetectWindow->get(), leakAlertSlope->get());
+  }
+
   /* Output about interval snapshot. */
   if (timerInterval == 0) {
     logger->printInfoMsg("Interval SnapShot is DISABLED.");
@@ -552,6 +658,33 @@ void TConfiguration::printSetting(void) {
                        threadRecordFileName->get());
   logger->printInfoMsg("Thread record I/O tracer = %s",
                        threadRecordIOTracer->get());
+  logger->printInfoMsg("Streaming file size of thread recorder = %ld MB",
+                       threadRecordStreamFileSize->get());
+  logger->printInfoMsg("Streaming files of thread recorder = %d",
+                       threadRecordStreamFiles->get());
+  char *snapshotSig = threadRecordSnapshotSignal->get();
+  if (snapshotSig == NULL || strlen(snapshotSig) == 0) {
+    logger->printInfoMsg("Signal for thread record snapshot is DISABLED.");
+  } else {
+    logger->printInfoMsg("Signal for thread record snapshot = %s",
+                         snapshotSig);
+  }
+
+  /* Allocation sampling. */
+  logger->printInfoMsg("Allocation sampling = %s",
+                       allocSamplingEnable->get() ? "true" : "false");
+  logger->printInfoMsg("Allocation sampling interval = %ld bytes",
+                       allocSamplingInterval->get());
+  logger->printInfoMsg("Allocation sampling file name = %s",
+                       allocSamplingFileName->get());
+
+  /* Monitor contention profiler. */
+  logger->printInfoMsg("Contention profiler = %s",
+                       contentionProfileEnable->get() ? "true" : "false");
+  logger->printInfoMsg("Contention sample interval = %d events",
+                       contentionSampleInterval->get());
+  logger->printInfoMsg("Contention profile file name = %s",
+                       contentionProfileFileName->get());
 
   /* Output about SNMP trap. */
   logger->printInfoMsg("Send SNMP Trap = %s",
@@ -565,6 +698,18 @@ void TConfiguration::printSetting(void) {
 
   /* Output archive command. */
   logger->printInfoMsg("Archive command = \"%s\"", archiveCommand->get());
+  if (archiveTimeout->get() == 0) {
+    logger->printInfoMsg("Archive Timeout = unlimited");
+  } else {
+    logger->printInfoMsg("Archive Timeout = %ld sec", archiveTimeout->get());
+  }
+  logger->printInfoMsg("Archive Threads = %d", archiveThreads->get());
+  logger->printInfoMsg("Archive Nice = %d", archiveNice->get());
+  logger->printInfoMsg("Archive Streaming = %s",
+                       archiveStreaming->get() ? "true" : "false");
+  logger->printInfoMsg("Archive Dedup = %s",
+                       archiveDedup->get() ? "true" : "false");
+  logger->printInfoMsg("Archive Store Size = %d MB", archiveStoreSize->get());
 
   /* Output about force killing JVM. */
   logger->printInfoMsg("Kill on Error = %s",
@@ -613,6 +758,55 @@ bool TConfiguration::validate(void) {
     }
   }
 
+  /* Deadlock scan check */
+  if (deadlockScanInterval->get() < 0) {
+    logger->printWarnMsg("Out of range: deadlock_scan_interval = %ld",
+                         deadlockScanInterval->get());
+    result = false;
+  }
+
+  /* Archive timeout check */
+  if (archiveTimeout->get() < 0) {
+    logger->printWarnMsg("Out of range: archive_timeout = %ld",
+                         archiveTimeout->get());
+    result = false;
+  }
+
+  /* Archive threads check */
+  if ((archiveThreads->get() < 1) ||
+      (archiveThreads->get() > PARALLEL_DEFLATE_MAX_THREADS)) {
+    logger->printWarnMsg("Out of range: archive_threads = %d",
+                         archiveThreads->get());
+    result = false;
+  }
+
+  /* Archive nice check */
+  if ((archiveNice->get() < -20) || (archiveNice->get() > 19)) {
+    logger->printWarnMsg("Out of range: archive_nice = %d",
+                         archiveNice->get());
+    result = false;
+  }
+
+  /* Archive store size check */
+  if (archiveStoreSize->get() < 0) {
+    logger->printWarnMsg("Out of range: archive_store_size = %d",
+                         archiveStoreSize->get());
+    result = false;
+  }
+
+  /* Leak trend check */
+  if ((leakDetectWindow->get() != 0) && (leakDetectWindow->get() < 3)) {
+    logger->printWarnMsg("Out of range: leak_detect_window = %d",
+                         leakDetectWindow->get());
+    result = false;
+  }
+
+  if (leakAlertSlope->get() < 0) {
+    logger->printWarnMsg("Out of range: leak_alert_slope = %ld",
+                         leakAlertSlope->get());
+    result = false;
+  }
+
   /* Set alert threshold. */
   jlong maxMem = this->jvmInfo->getMaxMemory();
   alertThreshold =
@@ -645,6 +839,34 @@ bool TConfiguration::validate(void) {
     result = false;
   }
 
+  char *snapshotSig = threadRecordSnapshotSignal->get();
+  if (snapshotSig != NULL) {
+    if (((normalSig != NULL) && (strcmp(normalSig, snapshotSig) == 0)) ||
+        ((allSig != NULL) && (strcmp(allSig, snapshotSig) == 0)) ||
+        ((reloadSig != NULL) && (strcmp(reloadSig, snapshotSig) == 0))) {
+      logger->printWarnMsg(
+          "Cannot share signal with thread_record_snapshot_signal: %s",
+          snapshotSig);
+      result = false;
+    }
+  }
+
+  /* Class filter check */
+  char *clsFilter = snapShotClassFilter->get();
+  if ((clsFilter != NULL) && (strlen(clsFilter) > 0)) {
+    try {
+#if USE_PCRE
+      TPCRERegex filterRegex(clsFilter, 3);
+#else
+      TCPPRegex filterRegex(clsFilter);
+#endif
+    } catch (...) {
+      logger->printWarnMsg("Invalid regex: snapshot_class_filter = %s",
+                           clsFilter);
+      result = false;
+    }
+  }
+
   /* Thread recorder check */
   if (threadRecordEnable->get()) {
     if (threadRecordBufferSize <= 0) {
@@ -656,6 +878,46 @@ bool TConfiguration::validate(void) {
                            threadRecordFileName->get());
       result = false;
     }
+
+    if (threadRecordStreamFileSize->get() < 0) {
+      logger->printWarnMsg(
+          "Invalid value: thread_record_stream_file_size = %ld",
+          threadRecordStreamFileSize->get());
+      result = false;
+    } else if ((threadRecordStreamFileSize->get() > 0) &&
+               (threadRecordStreamFiles->get() <= 0)) {
+      logger->printWarnMsg("Invalid value: thread_record_stream_files = %d",
+                           threadRecordStreamFiles->get());
+      result = false;
+    }
+  }
+
+  /* Allocation sampling check */
+  if (allocSamplingEnable->get()) {
+    if ((allocSamplingInterval->get() <= 0) ||
+        (allocSamplingInterval->get() > INT_MAX)) {
+      logger->printWarnMsg("Invalid value: alloc_sampling_interval = %ld",
+                           allocSamplingInterval->get());
+      result = false;
+    } else if (!isValidPath(allocSamplingFileName->get())) {
+      logger->printWarnMsg("Permission denied: alloc_sampling_filename = %s",
+                           allocSamplingFileName->get());
+      result = false;
+    }
+  }
+
+  /* Contention profiler check */
+  if (contentionProfileEnable->get()) {
+    if (contentionSampleInterval->get() <= 0) {
+      logger->printWarnMsg("Invalid value: contention_sample_interval = %d",
+                           contentionSampleInterval->get());
+      result = false;
+    } else if (!isValidPath(contentionProfileFileName->get())) {
+      logger->printWarnMsg(
+          "Permission denied: contention_profile_filename = %s",
+          contentionProfileFileName->get());
+      result = false;
+    }
   }
 
   /* SNMP check */
@@ -687,15 +949,18 @@ void TConfiguration::merge(TConfiguration *src) {
   attach->set(src->attach->get());
   fileName->set(src->fileName->get());
   heapLogFile->set(src->heapLogFile->get());
+  heapLogBinary->set(src->heapLogBinary->get());
   archiveFile->set(src->archiveFile->get());
   logFile->set(src->logFile->get());
   rankLevel->set(src->rankLevel->get());
   logLevel->set(src->logLevel->get());
   reduceSnapShot->set(src->reduceSnapShot->get());
   collectRefTree->set(src->collectRefTree->get());
+  snapShotClassFilter->set(src->snapShotClassFilter->get());
   triggerOnFullGC->set(triggerOnFullGC->get() && src->triggerOnFullGC->get());
   triggerOnDump->set(triggerOnDump->get() && src->triggerOnDump->get());
   checkDeadlock->set(checkDeadlock->get() && src->checkDeadlock->get());
+  deadlockScanInterval->set(src->deadlockScanInterval->get());
   triggerOnLogError->set(triggerOnLogError->get() &&
                          src->triggerOnLogError->get());
   triggerOnLogSignal->set(triggerOnLogSignal->get() &&
@@ -706,13 +971,27 @@ void TConfiguration::merge(TConfiguration *src) {
   alertPercentage->set(src->alertPercentage->get());
   heapAlertPercentage->set(src->heapAlertPercentage->get());
   metaspaceThreshold->set(src->metaspaceThreshold->get());
+  leakDetectWindow->set(src->leakDetectWindow->get());
+  leakAlertSlope->set(src->leakAlertSlope->get());
   timerInterval->set(src->timerInterval->get());
   logInterval->set(src->logInterval->get());
   firstCollect->set(src->firstCollect->get());
   threadRecordFileName->set(src->threadRecordFileName->get());
+  threadRecordStreamFileSize->set(src->threadRecordStreamFileSize->get());
+  threadRecordStreamFiles->set(src->threadRecordStreamFiles->get());
+  allocSamplingInterval->set(src->allocSamplingInterval->get());
+  allocSamplingFileName->set(src->allocSamplingFileName->get());
+  contentionSampleInterval->set(src->contentionSampleInterval->get());
+  contentionProfileFileName->set(src->contentionProfileFileName->get());
   snmpSend->set(snmpSend->get() & src->snmpSend->get());
   logDir->set(src->logDir->get());
   archiveCommand->set(src->archiveCommand->get());
+  archiveTimeout->set(src->archiveTimeout->get());
+  archiveThreads->set(src->archiveThreads->get());
+  archiveNice->set(src->archiveNice->get());
+  archiveStreaming->set(src->archiveStreaming->get());
+  archiveDedup->set(src->archiveDedup->get());
+  archiveStoreSize->set(src->archiveStoreSize->get());
   killOnError->set(src->killOnError->get());
 }
 
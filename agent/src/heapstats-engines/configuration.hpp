@@ -29,6 +29,11 @@
 #include "jvmInfo.hpp"
 #include "logger.hpp"
 
+/*!
+ * \brief Default value of archive_command.
+ */
+#define DEFAULT_ARCHIVE_COMMAND "/usr/bin/zip %archivefile% -jr %logdir%"
+
 /*!
  * \brief Ranking Order.<br>
  *        This order affects heap alert.
@@ -206,6 +211,9 @@ class TConfiguration {
   /*!< Output common log file name. */
   TStringConfig *heapLogFile;
 
+  /*!< Output common log as binary columnar format. */
+  TBooleanConfig *heapLogBinary;
+
   /*!< Output archive log file name. */
   TStringConfig *archiveFile;
 
@@ -218,6 +226,9 @@ class TConfiguration {
   /*!< Whether collecting reftree. */
   TBooleanConfig *collectRefTree;
 
+  /*!< Regex of class names which are counted by JVMTI snapshot. */
+  TStringConfig *snapShotClassFilter;
+
   /*!< Make snapshot is triggered by Full GC. */
   TBooleanConfig *triggerOnFullGC;
 
@@ -227,6 +238,9 @@ class TConfiguration {
   /*!< Is deadlock finder enabled? */
   TBooleanConfig *checkDeadlock;
 
+  /*!< Interval of deadlock scan. 0 means event driven check. */
+  TLongConfig *deadlockScanInterval;
+
   /*!< Logging on JVM error(Resoure exhausted). */
   TBooleanConfig *triggerOnLogError;
 
@@ -254,6 +268,12 @@ class TConfiguration {
   /*!< Trigger usage for javaMetaspaceAlert. */
   TLongConfig *metaspaceThreshold;
 
+  /*!< Count of GC snapshots to detect leak trend. */
+  TIntConfig *leakDetectWindow;
+
+  /*!< Trigger slope (bytes/sec) for leak trend alert. */
+  TLongConfig *leakAlertSlope;
+
   /*!< Interval of periodic snapshot. */
   TLongConfig *timerInterval;
 
@@ -284,6 +304,33 @@ class TConfiguration {
   /*!< Class file for I/O tracing. */
   TStringConfig *threadRecordIOTracer;
 
+  /*!< Size of each streaming file of thread recorder in MB. */
+  TLongConfig *threadRecordStreamFileSize;
+
+  /*!< Count of streaming files of thread recorder. */
+  TIntConfig *threadRecordStreamFiles;
+
+  /*!< Name of signal to take snapshot of thread recorder. */
+  TStringConfig *threadRecordSnapshotSignal;
+
+  /*!< Is allocation sampling enabled? */
+  TBooleanConfig *allocSamplingEnable;
+
+  /*!< Average sampling interval of allocation in bytes. */
+  TLongConfig *allocSamplingInterval;
+
+  /*!< Output file name of allocation sites. */
+  TStringConfig *allocSamplingFileName;
+
+  /*!< Is monitor contention profiler enabled? */
+  TBooleanConfig *contentionProfileEnable;
+
+  /*!< Contended events per call site sample. */
+  TIntConfig *contentionSampleInterval;
+
+  /*!< Output file name of contended monitors. */
+  TStringConfig *contentionProfileFileName;
+
   /*!< Flag of SNMP trap send enable. */
   TBooleanConfig *snmpSend;
 
@@ -302,6 +349,24 @@ class TConfiguration {
   /*!< Command was execute to making log archive. */
   TStringConfig *archiveCommand;
 
+  /*!< Deadline in seconds to collect files for log archive. */
+  TLongConfig *archiveTimeout;
+
+  /*!< Count of threads to compress log archive. */
+  TIntConfig *archiveThreads;
+
+  /*!< Nice value of threads to compress log archive. */
+  TIntConfig *archiveNice;
+
+  /*!< Store artifacts into log archive directly without temporary dir. */
+  TBooleanConfig *archiveStreaming;
+
+  /*!< Deduplicate unchanged files of log archive by artifact store. */
+  TBooleanConfig *archiveDedup;
+
+  /*!< Max size of artifact store in MB. Zero means unlimited. */
+  TIntConfig *archiveStoreSize;
+
   /*!< Abort JVM on resoure exhausted or deadlock. */
   TBooleanConfig *killOnError;
 
@@ -409,13 +474,16 @@ class TConfiguration {
   TBooleanConfig *Attach() { return attach; }
   TStringConfig *FileName() { return fileName; }
   TStringConfig *HeapLogFile() { return heapLogFile; }
+  TBooleanConfig *HeapLogBinary() { return heapLogBinary; }
   TStringConfig *ArchiveFile() { return archiveFile; }
   TStringConfig *LogFile() { return logFile; }
   TBooleanConfig *ReduceSnapShot() { return reduceSnapShot; }
   TBooleanConfig *CollectRefTree() { return collectRefTree; }
+  TStringConfig *SnapShotClassFilter() { return snapShotClassFilter; }
   TBooleanConfig *TriggerOnFullGC() { return triggerOnFullGC; }
   TBooleanConfig *TriggerOnDump() { return triggerOnDump; }
   TBooleanConfig *CheckDeadlock() { return checkDeadlock; }
+  TLongConfig *DeadlockScanInterval() { return deadlockScanInterval; }
   TBooleanConfig *TriggerOnLogError() { return triggerOnLogError; }
   TBooleanConfig *TriggerOnLogSignal() { return triggerOnLogSignal; }
   TBooleanConfig *TriggerOnLogLock() { return triggerOnLogLock; }
@@ -425,6 +493,8 @@ class TConfiguration {
   TIntConfig *AlertPercentage() { return alertPercentage; }
   TIntConfig *HeapAlertPercentage() { return heapAlertPercentage; }
   TLongConfig *MetaspaceThreshold() { return metaspaceThreshold; }
+  TIntConfig *LeakDetectWindow() { return leakDetectWindow; }
+  TLongConfig *LeakAlertSlope() { return leakAlertSlope; }
   TLongConfig *TimerInterval() { return timerInterval; }
   TLongConfig *LogInterval() { return logInterval; }
   TBooleanConfig *FirstCollect() { return firstCollect; }
@@ -435,12 +505,35 @@ class TConfiguration {
   TLongConfig *ThreadRecordBufferSize() { return threadRecordBufferSize; }
   TStringConfig *ThreadRecordFileName() { return threadRecordFileName; }
   TStringConfig *ThreadRecordIOTracer() { return threadRecordIOTracer; }
+  TLongConfig *ThreadRecordStreamFileSize() {
+    return threadRecordStreamFileSize;
+  }
+  TIntConfig *ThreadRecordStreamFiles() { return threadRecordStreamFiles; }
+  TStringConfig *ThreadRecordSnapshotSignal() {
+    return threadRecordSnapshotSignal;
+  }
+  TBooleanConfig *AllocSamplingEnable() { return allocSamplingEnable; }
+  TLongConfig *AllocSamplingInterval() { return allocSamplingInterval; }
+  TStringConfig *AllocSamplingFileName() { return allocSamplingFileName; }
+  TBooleanConfig *ContentionProfileEnable() {
+    return contentionProfileEnable;
+  }
+  TIntConfig *ContentionSampleInterval() { return contentionSampleInterval; }
+  TStringConfig *ContentionProfileFileName() {
+    return contentionProfileFileName;
+  }
   TBooleanConfig *SnmpSend() { return snmpSend; }
   TStringConfig *SnmpTarget() { return snmpTarget; }
   TStringConfig *SnmpComName() { return snmpComName; }
   TStringConfig *SnmpLibPath() { return snmpLibPath; }
   TStringConfig *LogDir() { return logDir; }
   TStringConfig *ArchiveCommand() { return archiveCommand; }
+  TLongConfig *ArchiveTimeout() { return archiveTimeout; }
+  TIntConfig *ArchiveThreads() { return archiveThreads; }
+  TIntConfig *ArchiveNice() { return archiveNice; }
+  TBooleanConfig *ArchiveStreaming() { return archiveStreaming; }
+  TBooleanConfig *ArchiveDedup() { return archiveDedup; }
+  TIntConfig *ArchiveStoreSize() { return archiveStoreSize; }
   TBooleanConfig *KillOnError() { return killOnError; }
 
   jlong getHeapAlertThreshold() { return heapAlertThreshold; }
@@ -0,0 +1,481 @@
+/*!
+ * \file contentionProfiler.cpp
+ * \brief This file is used to profile monitor contention through JVMTI
+ *        MonitorContendedEnter/Entered events.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ *
+ */
+
+#include <jvmti.h>
+#include <jni.h>
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <time.h>
+
+#ifdef HAVE_ATOMIC
+#include <atomic>
+#else
+#include <cstdatomic>
+#endif
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "globals.hpp"
+#include "vmVariables.hpp"
+#include "vmFunctions.hpp"
+#include "callbackRegister.hpp"
+#include "callSiteTable.hpp"
+#include "contentionProfiler.hpp"
+
+/*!
+ * \brief Number of slots in contention table.
+ *        This value must be power of 2.
+ */
+#define CONTENTION_TABLE_SIZE 8192
+
+/*!
+ * \brief Pair of wait time and contention site to sort sites.
+ *        Wait time is copied because counters are updated while sorting.
+ */
+typedef std::pair<jlong, TCallSite *> TContentionRank;
+
+/*!
+ * \brief Time when this thread started to wait monitor.
+ *        Value is 0 if this thread is not waiting.
+ */
+static __thread jlong contendedSince = 0;
+
+/*!
+ * \brief Top frame method of sampled event on this thread.
+ *        Value is NULL if current event is not sampled.
+ */
+static __thread jmethodID sampledMethod = NULL;
+
+/*!
+ * \brief Top frame location of sampled event on this thread.
+ */
+static __thread jlocation sampledLocation = 0;
+
+/*!
+ * \brief Count of contended events since last sample on this thread.
+ */
+static __thread int eventsSinceSample = 0;
+
+namespace ctprofiler {
+
+  /*!
+   * \brief Processing flag.
+   */
+  static std::atomic_int processing(0);
+
+  /*!
+   * \brief Table of contention per (class, call site).<br>
+   *        Key of site is top frame method. Site of which key is NULL
+   *        aggregates all contended events of the class. Other sites
+   *        aggregate sampled events only. Value of event is wait time in
+   *        nanoseconds.
+   */
+  static TCallSiteTable siteTable(CONTENTION_TABLE_SIZE);
+
+  /*!
+   * \brief Count of events which could not be recorded.
+   */
+  static std::atomic<jlong> droppedEvents(0);
+
+  /*!
+   * \brief Count of contended events per call site sample.
+   */
+  static int sampleInterval = 1;
+
+  /*!
+   * \brief Is contention profiler working?
+   */
+  static bool enabled = false;
+
+  /*!
+   * \brief Mutex for output and finalization of contention table.
+   */
+  static pthread_mutex_t mutex = PTHREAD_ADAPTIVE_MUTEX_INITIALIZER_NP;
+
+  /*!
+   * \brief Get current time of monotonic clock.
+   * \return Time in nanoseconds.
+   */
+  static inline jlong getMonotonicTime(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (jlong)ts.tv_sec * 1000000000L + ts.tv_nsec;
+  }
+
+  /*!
+   * \brief Event handler of JVMTI MonitorContendedEnter.
+   * \param jvmti  [in] JVMTI environment.
+   * \param env    [in] JNI environment of the event (current) thread.
+   * \param thread [in] JNI local reference to the thread attempting to enter
+   *                    the monitor.
+   * \param object [in] JNI local reference to the monitor.
+   */
+  void JNICALL OnMonitorContendedEnter(jvmtiEnv *jvmti, JNIEnv *env,
+                                       jthread thread, jobject object) {
+    TProcessMark mark(processing);
+
+    /* Stack is walked only for sampled events. */
+    sampledMethod = NULL;
+    if (unlikely(++eventsSinceSample >= sampleInterval)) {
+      eventsSinceSample = 0;
+
+      jvmtiFrameInfo frame;
+      jint depth = 0;
+      if (likely((jvmti->GetStackTrace(thread, 0, 1, &frame, &depth) ==
+                  JVMTI_ERROR_NONE) && (depth > 0))) {
+        sampledMethod = frame.method;
+        sampledLocation = frame.location;
+      }
+    }
+
+    /* Time of stack walk is not counted as wait time. */
+    contendedSince = getMonotonicTime();
+  }
+
+  /*!
+   * \brief Event handler of JVMTI MonitorContendedEntered.
+   * \param jvmti  [in] JVMTI environment.
+   * \param env    [in] JNI environment of the event (current) thread.
+   * \param thread [in] JNI local reference to the thread which entered
+   *                    the monitor.
+   * \param object [in] JNI local reference to the monitor.
+   */
+  void JNICALL OnMonitorContendedEntered(jvmtiEnv *jvmti, JNIEnv *env,
+                                         jthread thread, jobject object) {
+    TProcessMark mark(processing);
+
+    if (unlikely(contendedSince == 0)) {
+      /* Profiler was started while this thread was waiting. */
+      return;
+    }
+
+    jlong waitTime = getMonotonicTime() - contendedSince;
+    contendedSince = 0;
+
+    jclass monitorClass = env->GetObjectClass(object);
+    if (unlikely(monitorClass == NULL)) {
+      droppedEvents++;
+      return;
+    }
+
+    /*
+     * Wait if VM is at a safepoint which includes safepoint synchronizing,
+     * because jclass (oop in JNIHandle) might be relocated.
+     */
+    while (!isAtNormalExecution()) {
+      sched_yield();
+    }
+
+    void *klassOop =
+        TVMFunctions::getInstance()->AsKlassOop(*(void **)monitorClass);
+    env->DeleteLocalRef(monitorClass);
+    if (unlikely(klassOop == NULL)) {
+      droppedEvents++;
+      return;
+    }
+
+    TObjectData *objData = clsContainer->findClass(klassOop);
+    if (unlikely(objData == NULL)) {
+      objData = clsContainer->pushNewClass(klassOop);
+      if (unlikely(objData == NULL)) {
+        droppedEvents++;
+        return;
+      }
+    }
+
+    const char *className = clsContainer->getColdData(objData)->className;
+    TCallSite *site = siteTable.intern(objData->tag, className, NULL, 0);
+    if (unlikely(site == NULL)) {
+      droppedEvents++;
+      return;
+    }
+    TCallSiteTable::addEvent(site, waitTime);
+
+    if (sampledMethod != NULL) {
+      site = siteTable.intern(objData->tag, className, sampledMethod,
+                              sampledLocation);
+      if (likely(site != NULL)) {
+        TCallSiteTable::addEvent(site, waitTime);
+      }
+    }
+  }
+
+  /*!
+   * \brief Format call site to string.
+   *        Formatted string is cached in site.
+   * \param jvmti [in] JVMTI environment.
+   * \param env   [in] JNI environment of the current thread.
+   * \param site  [in] Contention site to format.
+   * \return Formatted call site.
+   */
+  static const char *formatSite(jvmtiEnv *jvmti, JNIEnv *env,
+                                TCallSite *site) {
+    if (site->description != NULL) {
+      return site->description;
+    }
+
+    jvmtiFrameInfo frame;
+    frame.method = (jmethodID)site->key;
+    frame.location = site->location;
+
+    TJavaStackMethodInfo info;
+    getMethodFrameInfo(jvmti, env, frame, &info);
+
+    char buf[1024];
+    if (info.isNative) {
+      snprintf(buf, sizeof(buf), "%s.%s(Native Method)",
+               (info.className != NULL) ? info.className : "Unknown",
+               (info.methodName != NULL) ? info.methodName : "Unknown");
+    } else {
+      snprintf(buf, sizeof(buf), "%s.%s(%s:%d)",
+               (info.className != NULL) ? info.className : "Unknown",
+               (info.methodName != NULL) ? info.methodName : "Unknown",
+               (info.sourceFile != NULL) ? info.sourceFile : "Unknown",
+               info.lineNumber);
+    }
+
+    free(info.className);
+    free(info.methodName);
+    free(info.sourceFile);
+
+    site->description = strdup(buf);
+    return (site->description != NULL) ? site->description : "Unknown";
+  }
+
+  /*!
+   * \brief Compare contention sites by wait time.
+   * \param a [in] Rank of contention site.
+   * \param b [in] Rank of contention site.
+   * \return true if a waited longer than b.
+   */
+  static bool compareWaitTime(const TContentionRank &a,
+                              const TContentionRank &b) {
+    return a.first > b.first;
+  }
+
+  /*!
+   * \brief Collect contention sites which have events.<br>
+   *        Caller must hold the mutex.
+   * \param classes [out] Ranks of whole class sorted by wait time.
+   * \param sites   [out] Ranks of sampled call sites sorted by wait time.
+   *                      Value can be NULL.
+   */
+  static void collectSites(std::vector<TContentionRank> *classes,
+                           std::vector<TContentionRank> *sites) {
+    for (int idx = 0; idx < siteTable.getSize(); idx++) {
+      TCallSite *site = siteTable.getSite(idx);
+      if ((site == NULL) || (site->count.load() == 0)) {
+        continue;
+      }
+
+      if (site->key == NULL) {
+        classes->push_back(std::make_pair(site->total.load(), site));
+      } else if (sites != NULL) {
+        sites->push_back(std::make_pair(site->total.load(), site));
+      }
+    }
+
+    std::sort(classes->begin(), classes->end(), compareWaitTime);
+    if (sites != NULL) {
+      std::sort(sites->begin(), sites->end(), compareWaitTime);
+    }
+  }
+
+  /*!
+   * \brief Contention profiler initializer.
+   * \param jvmti    [in] JVMTI environment.
+   * \param interval [in] Count of contended events per call site sample.
+   * \return Process result.
+   */
+  bool initialize(jvmtiEnv *jvmti, int interval) {
+    jvmtiCapabilities capabilities = {0};
+    TMonitorContendedEnterCallback::mergeCapabilities(&capabilities);
+    if (isError(jvmti, jvmti->AddCapabilities(&capabilities))) {
+      logger->printWarnMsg(
+                   "Couldn't set event capabilities for contention profiler.");
+      return false;
+    }
+
+    {
+      TMutexLocker locker(&mutex);
+      droppedEvents = 0;
+      sampleInterval = interval;
+      enabled = true;
+    }
+
+    TMonitorContendedEnterCallback::registerCallback(&OnMonitorContendedEnter);
+    TMonitorContendedEnteredCallback::registerCallback(
+                                                 &OnMonitorContendedEntered);
+    if (registerJVMTICallbacks(jvmti)) {
+      logger->printWarnMsg("Couldn't register MonitorContended events.");
+      TMonitorContendedEnterCallback::unregisterCallback(
+                                                &OnMonitorContendedEnter);
+      TMonitorContendedEnteredCallback::unregisterCallback(
+                                                &OnMonitorContendedEntered);
+      enabled = false;
+      return false;
+    }
+
+    TMonitorContendedEnterCallback::switchEventNotification(jvmti,
+                                                            JVMTI_ENABLE);
+    TMonitorContendedEnteredCallback::switchEventNotification(jvmti,
+                                                              JVMTI_ENABLE);
+    return true;
+  }
+
+  /*!
+   * \brief Get the most contended monitor classes since last output.
+   * \param monitors [out] Statistics sorted by wait time.
+   * \param max      [in]  Max count of monitors.
+   * \return Count of monitors which are stored.
+   */
+  int getTopMonitors(TContendedMonitor *monitors, int max) {
+    TMutexLocker locker(&mutex);
+
+    if (!enabled) {
+      return 0;
+    }
+
+    std::vector<TContentionRank> classes;
+    try {
+      collectSites(&classes, NULL);
+    } catch (...) {
+      return 0;
+    }
+
+    int result = 0;
+    for (size_t idx = 0; (idx < classes.size()) && (result < max); idx++) {
+      TCallSite *site = classes[idx].second;
+      monitors[result].className = strdup(site->className);
+      if (unlikely(monitors[result].className == NULL)) {
+        break;
+      }
+
+      monitors[result].count = site->count.load();
+      monitors[result].waitTime = site->total.load();
+      monitors[result].maxWaitTime = site->max.load();
+      result++;
+    }
+
+    return result;
+  }
+
+  /*!
+   * \brief Append the most contended monitors and call sites to file.
+   *        Counters of each monitor are reset after output.
+   * \param jvmti [in] JVMTI environment.
+   * \param env   [in] JNI environment of the current thread.
+   * \param fname [in] File name to output contended monitors.
+   */
+  void dumpContendedMonitors(jvmtiEnv *jvmti, JNIEnv *env,
+                             const char *fname) {
+    TMutexLocker locker(&mutex);
+
+    if (!enabled) {
+      return;
+    }
+
+    std::vector<TContentionRank> classes;
+    std::vector<TContentionRank> sites;
+    try {
+      collectSites(&classes, &sites);
+    } catch (...) {
+      logger->printWarnMsg("Could not collect contended monitors.");
+      return;
+    }
+
+    {
+      TCallSiteCsvWriter csv(fname,
+                             "time,class,site,count,wait_ns,max_wait_ns");
+      if (unlikely(!csv.isOpened())) {
+        return;
+      }
+
+      /* Site "*" is whole class. Other sites have sampled events only. */
+      for (size_t idx = 0;
+           (idx < classes.size()) && (idx < CONTENTION_TOP_COUNT); idx++) {
+        TCallSite *site = classes[idx].second;
+        csv.writeRow(site->className,
+                     "*," JLONG_FORMAT_STR "," JLONG_FORMAT_STR
+                     "," JLONG_FORMAT_STR,
+                     site->count.load(), site->total.load(),
+                     site->max.load());
+      }
+
+      for (size_t idx = 0;
+           (idx < sites.size()) && (idx < CONTENTION_TOP_COUNT); idx++) {
+        TCallSite *site = sites[idx].second;
+        csv.writeRow(site->className,
+                     "%s," JLONG_FORMAT_STR "," JLONG_FORMAT_STR
+                     "," JLONG_FORMAT_STR,
+                     formatSite(jvmti, env, site), site->count.load(),
+                     site->total.load(), site->max.load());
+      }
+    }
+
+    /* Reset all counters including sites which are not published. */
+    siteTable.resetCounters();
+
+    jlong dropped = droppedEvents.exchange(0);
+    if (dropped > 0) {
+      logger->printWarnMsg(
+          "Contention profiler dropped " JLONG_FORMAT_STR " events.", dropped);
+    }
+  }
+
+  /*!
+   * \brief Contention profiler finalizer.
+   *        This function unregisters JVMTI callback and outputs remaining
+   *        contended monitors.
+   * \param jvmti [in] JVMTI environment.
+   * \param env   [in] JNI environment of the current thread.
+   * \param fname [in] File name to output contended monitors.
+   */
+  void finalize(jvmtiEnv *jvmti, JNIEnv *env, const char *fname) {
+    /* Event notification is kept for deadlock detector and thread recorder. */
+    TMonitorContendedEnterCallback::unregisterCallback(
+                                                &OnMonitorContendedEnter);
+    TMonitorContendedEnteredCallback::unregisterCallback(
+                                                &OnMonitorContendedEntered);
+
+    /* Refresh JVMTI event callbacks */
+    registerJVMTICallbacks(jvmti);
+
+    while (processing > 0) {
+      sched_yield();
+    }
+
+    /* Output remaining contended monitors. */
+    dumpContendedMonitors(jvmti, env, fname);
+
+    TMutexLocker locker(&mutex);
+    enabled = false;
+
+    siteTable.clear();
+  }
+
+}
@@ -0,0 +1,107 @@
+/*!
+ * \file contentionProfiler.hpp
+ * \brief This file is used to profile monitor contention through JVMTI
+ *        MonitorContendedEnter/Entered events.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ *
+ */
+
+#ifndef _CONTENTION_PROFILER_H
+#define _CONTENTION_PROFILER_H
+
+#include <jvmti.h>
+#include <jni.h>
+
+/*!
+ * \brief Count of monitors and call sites which are published.
+ */
+#define CONTENTION_TOP_COUNT 20
+
+/*!
+ * \brief Contention statistics of monitor class.
+ */
+typedef struct {
+  char *className;   /*!< Name of monitor class. Caller must free it. */
+  jlong count;       /*!< Count of contended enters.                  */
+  jlong waitTime;    /*!< Total wait time in nanoseconds.             */
+  jlong maxWaitTime; /*!< Max wait time in nanoseconds.               */
+} TContendedMonitor;
+
+namespace ctprofiler {
+
+  /*!
+   * \brief Event handler of JVMTI MonitorContendedEnter.
+   * \param jvmti  [in] JVMTI environment.
+   * \param env    [in] JNI environment of the event (current) thread.
+   * \param thread [in] JNI local reference to the thread attempting to enter
+   *                    the monitor.
+   * \param object [in] JNI local reference to the monitor.
+   */
+  void JNICALL OnMonitorContendedEnter(jvmtiEnv *jvmti, JNIEnv *env,
+                                       jthread thread, jobject object);
+
+  /*!
+   * \brief Event handler of JVMTI MonitorContendedEntered.
+   * \param jvmti  [in] JVMTI environment.
+   * \param env    [in] JNI environment of the event (current) thread.
+   * \param thread [in] JNI local reference to the thread which entered
+   *                    the monitor.
+   * \param object [in] JNI local reference to the monitor.
+   */
+  void JNICALL OnMonitorContendedEntered(jvmtiEnv *jvmti, JNIEnv *env,
+                                         jthread thread, jobject object);
+
+  /*!
+   * \brief Contention profiler initializer.
+   * \param jvmti    [in] JVMTI environment.
+   * \param interval [in] Count of contended events per call site sample.
+   * \return Process result.
+   */
+  bool initialize(jvmtiEnv *jvmti, int interval);
+
+  /*!
+   * \brief Get the most contended monitor classes since last output.
+   * \param monitors [out] Statistics sorted by wait time.
+   * \param max      [in]  Max count of monitors.
+   * \return Count of monitors which are stored.
+   */
+  int getTopMonitors(TContendedMonitor *monitors, int max);
+
+  /*!
+   * \brief Append the most contended monitors and call sites to file.
+   *        Counters of each monitor are reset after output.
+   * \param jvmti [in] JVMTI environment.
+   * \param env   [in] JNI environment of the current thread.
+   * \param fname [in] File name to output contended monitors.
+   */
+  void dumpContendedMonitors(jvmtiEnv *jvmti, JNIEnv *env,
+                             const char *fname);
+
+  /*!
+   * \brief Contention profiler finalizer.
+   *        This function unregisters JVMTI callback and outputs remaining
+   *        contended monitors.
+   * \param jvmti [in] JVMTI environment.
+   * \param env   [in] JNI environment of the current thread.
+   * \param fname [in] File name to output contended monitors.
+   */
+  void finalize(jvmtiEnv *jvmti, JNIEnv *env, const char *fname);
+
+};
+
+#endif  // _CONTENTION_PROFILER_H
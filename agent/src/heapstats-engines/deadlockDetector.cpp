@@ -33,16 +33,59 @@
 #endif
 
 #include <map>
+#include <set>
+#include <vector>
 
 #include "globals.hpp"
 #include "elapsedTimer.hpp"
 #include "libmain.hpp"
+#include "vmFunctions.hpp"
 #include "callbackRegister.hpp"
+#include "timer.hpp"
+#include "waitForTable.hpp"
 #include "deadlockDetector.hpp"
 
 
 #define BUFFER_SZ 256
 
+/*!
+ * \brief Max length of wait-for chain to check.
+ */
+#define MAX_CHAIN_LENGTH 1024
+
+/*!
+ * \brief Tag of monitor key. Monitor key never collides with thread ID.
+ */
+#define MONITOR_KEY_TAG 0x100000000LL
+
+/*!
+ * \brief Flag in waiter entry which presents the deadlock is reported.
+ */
+#define DEADLOCK_REPORTED 0x200000000LL
+
+/*!
+ * \brief Max factor of scan interval while no thread is contended.
+ */
+#define MAX_SCAN_BACKOFF 8
+
+/*!
+ * \brief Capacity of JNI local references for deadlock scan.
+ */
+#define SCAN_LOCAL_REFS 256
+
+
+/*!
+ * \brief Thread which is blocked on monitor enter at deadlock scan.
+ */
+typedef struct {
+  jthread thread;   /*!< Blocked thread.                                  */
+  jobject monitor;  /*!< Monitor which the thread waits.                  */
+  jlong threadId;   /*!< Thread ID.                                       */
+  jlong monitorKey; /*!< Monitor key of the monitor.                      */
+  int owner;        /*!< Index of owner thread. -1 if it is not blocked.  */
+  int visited;      /*!< Walk which visits this thread. 0 is not visited. */
+} TBlockedThread;
+
 
 /*!
  * \brief Processing flag.
@@ -50,19 +93,44 @@
 static std::atomic_int processing(0);
 
 /*!
- * \brief Monitor owner map.
+ * \brief Monitor owner table.
+ *        Key is monitor key, value is thread ID of owner.
+ */
+static TWaitForTable *monitor_owners = NULL;
+
+/*!
+ * \brief Monitor waiters table.
+ *        Key is thread ID, value is monitor key which the thread waits.
+ */
+static TWaitForTable *waiter_list = NULL;
+
+/*!
+ * \brief Timer for periodic deadlock scan.
  */
-static std::map<jint, jint> monitor_owners;
+static TTimer *scanTimer = NULL;
 
 /*!
- * \brief Monitor waiters list.
+ * \brief Flag of scan timer is running.
  */
-static std::map<jint, jint> waiter_list;
+static bool isScanning = false;
 
 /*!
- * \brief Mutex for maps
+ * \brief Interval of deadlock scan in msec.
  */
-static pthread_mutex_t mutex = PTHREAD_ADAPTIVE_MUTEX_INITIALIZER_NP;
+static jlong scanInterval = 0;
+
+/*!
+ * \brief Current interval of deadlock scan in msec.
+ *        It is increased while no thread is contended.
+ */
+static jlong currentScanInterval = 0;
+
+/*!
+ * \brief Deadlocks which are already reported.
+ *        Value is minimum thread ID in the cycle.
+ *        This set is used by scan timer thread only.
+ */
+static std::set<jlong> reportedDeadlocks;
 
 
 namespace dldetector {
@@ -151,6 +219,54 @@ namespace dldetector {
     }
   }
 
+  /*!
+   * \brief Get monitor key from monitor object.
+   * \param jvmti   [in] JVMTI environment.
+   * \param monitor [in] Monitor object.
+   * \return Monitor key.
+   */
+  static inline jlong getMonitorKey(jvmtiEnv *jvmti, jobject monitor) {
+    jint monitor_hash = 0;
+    jvmti->GetObjectHashCode(monitor, &monitor_hash);
+    return MONITOR_KEY_TAG | (jlong)(unsigned int)monitor_hash;
+  }
+
+  /*!
+   * \brief Walk wait-for chain from the thread without lock.
+   * \param thread_id   [in]  Thread ID which waits the monitor.
+   * \param monitor_key [in]  Monitor key which the thread waits.
+   * \param min_thread  [out] Minimum thread ID in the cycle.
+   * \return Number of threads in the cycle. Value is 0 if no deadlock.
+   */
+  static int findCycle(jlong thread_id, jlong monitor_key,
+                       jlong *min_thread) {
+    *min_thread = thread_id;
+
+    for (int numThreads = 1; numThreads <= MAX_CHAIN_LENGTH; numThreads++) {
+      jlong owner;
+      if (!monitor_owners->get(monitor_key, &owner)) {
+        return 0;  // No deadlock
+      }
+
+      if (owner == thread_id) {
+        return numThreads;  // Deadlock!!
+      }
+
+      if (owner < *min_thread) {
+        *min_thread = owner;
+      }
+
+      jlong waiting;
+      if (!waiter_list->get(owner, &waiting)) {
+        return 0;  // No deadlock
+      }
+      monitor_key = waiting & ~DEADLOCK_REPORTED;
+    }
+
+    /* Cycle which does not include this thread is found by its member. */
+    return 0;
+  }
+
   /*!
    * \brief Event handler of JVMTI MonitorContendedEnter for finding deadlock.
    * \param jvmti  [in] JVMTI environment.
@@ -161,6 +277,8 @@ namespace dldetector {
    */
   void JNICALL OnMonitorContendedEnter(
                  jvmtiEnv *jvmti, JNIEnv *env, jthread thread, jobject object) {
+    TProcessMark mark(processing);
+
     /* Check owned monitors */
     jint monitor_cnt;
     jobject *owned_monitors;
@@ -171,69 +289,70 @@ namespace dldetector {
                            *(void **)thread);
       return;
     }
-    if (monitor_cnt == 0) { // This thread does not have a monitor.
+
+    /*
+     * This thread does not have other monitor.
+     * The contended monitor might be included. (JDK-8185164)
+     */
+    if ((monitor_cnt == 0) ||
+        ((monitor_cnt == 1) && env->IsSameObject(owned_monitors[0], object))) {
       jvmti->Deallocate((unsigned char *)owned_monitors);
       return;
     }
 
-    jint monitor_hash;
-    jint thread_hash;
-    jvmti->GetObjectHashCode(thread, &thread_hash);
-    jvmti->GetObjectHashCode(object, &monitor_hash);
+    jlong thread_id =
+        TVMFunctions::getInstance()->GetThreadId(*(void **)thread);
+    jlong monitor_key = getMonitorKey(jvmti, object);
 
-    {
-      TMutexLocker locker(&mutex);
-
-      /* Avoid JDK-8185164 */
-      bool canSkip = true;
-
-      /* Store all owned monitors to owner list */
-      for (int idx = 0; idx < monitor_cnt; idx++) {
-        jint current_monitor_hash;
-        jvmti->GetObjectHashCode(owned_monitors[idx], &current_monitor_hash);
-        if (current_monitor_hash == monitor_hash) {
-          continue;
-        }
-        monitor_owners[current_monitor_hash] = thread_hash;
-        canSkip = false;
+    /* Store all owned monitors to owner table */
+    for (int idx = 0; idx < monitor_cnt; idx++) {
+      if (env->IsSameObject(owned_monitors[idx], object)) {
+        continue;
       }
-      jvmti->Deallocate((unsigned char *)owned_monitors);
 
-      if (!canSkip) {
-        /* Add to waiters list */
-        jvmti->GetObjectHashCode(object, &monitor_hash);
-        waiter_list[thread_hash] = monitor_hash;
-
-        /* Check deadlock */
-        int numThreads = 1;
-        while (true) {
-          numThreads++;
-
-          auto owner_itr = monitor_owners.find(monitor_hash);
-          if (owner_itr == monitor_owners.end()) {
-            break;  // No deadlock
-          }
-
-          auto waiter_itr = waiter_list.find(owner_itr->second);
-          if (waiter_itr == waiter_list.end()) {
-            break; // No deadlock
-          }
-
-          owner_itr = monitor_owners.find(waiter_itr->second);
-          if (owner_itr == monitor_owners.end()) {
-            break; // No deadlock
-          }
-
-          if (owner_itr->second == thread_hash) {
-            // Deadlock!!
-            notifyDeadlockOccurrence(jvmti, env, thread, object, numThreads);
-            break;
-          }
-
-          monitor_hash = waiter_itr->second;
-        }
+      if (unlikely(!monitor_owners->put(
+                            getMonitorKey(jvmti, owned_monitors[idx]),
+                            thread_id))) {
+        logger->printDebugMsg("Wait-for table for deadlock is full.");
       }
     }
+    jvmti->Deallocate((unsigned char *)owned_monitors);
+
+    /* Add to waiters table */
+    if (unlikely(!waiter_list->put(thread_id, monitor_key))) {
+      logger->printDebugMsg("Wait-for table for deadlock is full.");
+      return;
+    }
+
+    /*
+     * Check deadlock.
+     * Tables might be changed while walking, so the cycle is confirmed by
+     * second walk. Edges in real deadlock are never removed.
+     */
+    jlong min_thread;
+    int numThreads = findCycle(thread_id, monitor_key, &min_thread);
+    if (likely(numThreads == 0)) {
+      return;
+    }
+
+    jlong confirmed_min;
+    if (findCycle(thread_id, monitor_key, &confirmed_min) != numThreads ||
+        (confirmed_min != min_thread)) {
+      return;
+    }
+
+    /*
+     * Some threads in the cycle might find it at the same time.
+     * Only one thread which marks the waiter entry of minimum thread ID
+     * reports the deadlock.
+     */
+    jlong waiting;
+    if (waiter_list->get(min_thread, &waiting) &&
+        ((waiting & DEADLOCK_REPORTED) == 0) &&
+        waiter_list->replace(min_thread, waiting,
+                             waiting | DEADLOCK_REPORTED)) {
+      notifyDeadlockOccurrence(jvmti, env, thread, object, numThreads);
+    }
   }
 
 
@@ -247,6 +366,8 @@ namespace dldetector {
    */
   void JNICALL OnMonitorContendedEntered(
                  jvmtiEnv *jvmti, JNIEnv *env, jthread thread, jobject object) {
+    TProcessMark mark(processing);
+
     /* Check owned monitors */
     jint monitor_cnt;
     jobject *owned_monitors;
@@ -262,24 +383,234 @@ namespace dldetector {
       return;
     }
 
-    {
-      TMutexLocker locker(&mutex);
+    /* Remove all owned monitors from owner table */
+    for (int idx = 0; idx < monitor_cnt; idx++) {
+      monitor_owners->remove(getMonitorKey(jvmti, owned_monitors[idx]));
+    }
+    jvmti->Deallocate((unsigned char *)owned_monitors);
+
+    /* Remove thread from waiters table */
+    waiter_list->remove(
+               TVMFunctions::getInstance()->GetThreadId(*(void **)thread));
+  }
+
 
-      /* Remove all owned monitors from owner list */
-      for (int idx = 0; idx < monitor_cnt; idx++) {
-        jint monitor_hash;
-        jvmti->GetObjectHashCode(owned_monitors[idx], &monitor_hash);
-        monitor_owners.erase(monitor_hash);
+  /*!
+   * \brief Collect threads which are blocked on monitor enter.
+   * \param jvmti   [in]  JVMTI environment.
+   * \param threads [in]  All live threads.
+   * \param count   [in]  Count of threads.
+   * \param blocked [out] Blocked threads.
+   */
+  static void collectBlockedThreads(jvmtiEnv *jvmti, jthread *threads,
+                                    jint count,
+                                    std::vector<TBlockedThread> &blocked) {
+    TVMFunctions *vmFunc = TVMFunctions::getInstance();
+
+    for (int idx = 0; idx < count; idx++) {
+      jint state;
+      if ((jvmti->GetThreadState(threads[idx], &state) != JVMTI_ERROR_NONE) ||
+          ((state & JVMTI_THREAD_STATE_BLOCKED_ON_MONITOR_ENTER) == 0)) {
+        continue;
+      }
+
+      jobject monitor = NULL;
+      if ((jvmti->GetCurrentContendedMonitor(threads[idx], &monitor) !=
+                                                          JVMTI_ERROR_NONE) ||
+          (monitor == NULL)) {
+        continue;  // Thread has been resumed.
+      }
+
+      TBlockedThread entry;
+      entry.thread = threads[idx];
+      entry.monitor = monitor;
+      entry.threadId = vmFunc->GetThreadId(*(void **)threads[idx]);
+      entry.monitorKey = getMonitorKey(jvmti, monitor);
+      entry.owner = -1;
+      entry.visited = 0;
+      blocked.push_back(entry);
+    }
+  }
+
+  /*!
+   * \brief Link blocked threads to the blocked thread which owns the
+   *        monitor they wait.
+   * \param jvmti   [in]     JVMTI environment.
+   * \param env     [in]     JNI environment of the current thread.
+   * \param blocked [in/out] Blocked threads.
+   */
+  static void linkOwners(jvmtiEnv *jvmti, JNIEnv *env,
+                         std::vector<TBlockedThread> &blocked) {
+    /* Monitor key to pair of owner index and monitor object */
+    std::map<jlong, std::pair<int, jobject> > owners;
+
+    for (int idx = 0; idx < (int)blocked.size(); idx++) {
+      jint monitor_cnt;
+      jobject *owned_monitors;
+      if (jvmti->GetOwnedMonitorInfo(blocked[idx].thread, &monitor_cnt,
+                                     &owned_monitors) != JVMTI_ERROR_NONE) {
+        continue;
+      }
+
+      for (int monIdx = 0; monIdx < monitor_cnt; monIdx++) {
+        /* The contended monitor might be included. (JDK-8185164) */
+        if (env->IsSameObject(owned_monitors[monIdx], blocked[idx].monitor)) {
+          continue;
+        }
+
+        owners[getMonitorKey(jvmti, owned_monitors[monIdx])] =
+                            std::make_pair(idx, owned_monitors[monIdx]);
       }
       jvmti->Deallocate((unsigned char *)owned_monitors);
+    }
 
-      /* Remove thread from waiters list */
-      jint thread_hash;
-      jvmti->GetObjectHashCode(thread, &thread_hash);
-      waiter_list.erase(thread_hash);
+    for (std::vector<TBlockedThread>::iterator itr = blocked.begin();
+         itr != blocked.end(); itr++) {
+      std::map<jlong, std::pair<int, jobject> >::iterator owner =
+                                             owners.find(itr->monitorKey);
+      /* Identity hash might collide. */
+      if ((owner != owners.end()) &&
+          env->IsSameObject(owner->second.second, itr->monitor)) {
+        itr->owner = owner->second.first;
+      }
     }
   }
 
+  /*!
+   * \brief Check threads in the cycle still wait same monitors.
+   * \param jvmti   [in] JVMTI environment.
+   * \param env     [in] JNI environment of the current thread.
+   * \param blocked [in] Blocked threads.
+   * \param start   [in] Index of thread in the cycle.
+   * \return true if all threads are still blocked.
+   */
+  static bool isStillBlocked(jvmtiEnv *jvmti, JNIEnv *env,
+                             std::vector<TBlockedThread> &blocked,
+                             int start) {
+    int idx = start;
+    do {
+      jobject monitor = NULL;
+      if ((jvmti->GetCurrentContendedMonitor(blocked[idx].thread, &monitor) !=
+                                                          JVMTI_ERROR_NONE) ||
+          (monitor == NULL)) {
+        return false;
+      }
+
+      bool isSame = env->IsSameObject(monitor, blocked[idx].monitor);
+      env->DeleteLocalRef(monitor);
+      if (!isSame) {
+        return false;
+      }
+
+      idx = blocked[idx].owner;
+    } while (idx != start);
+
+    return true;
+  }
+
+  /*!
+   * \brief Find cycles in wait-for graph of blocked threads and notify
+   *        deadlocks which are not reported yet.
+   * \param jvmti   [in]     JVMTI environment.
+   * \param env     [in]     JNI environment of the current thread.
+   * \param blocked [in/out] Blocked threads.
+   */
+  static void findDeadlocks(jvmtiEnv *jvmti, JNIEnv *env,
+                            std::vector<TBlockedThread> &blocked) {
+    std::set<jlong> deadlocks;
+
+    /*
+     * Each thread waits only one owner, so each walk ends at thread which is
+     * not blocked, thread which is visited by former walk, or a new cycle.
+     */
+    for (int start = 0; start < (int)blocked.size(); start++) {
+      int idx = start;
+      while ((idx != -1) && (blocked[idx].visited == 0)) {
+        blocked[idx].visited = start + 1;
+        idx = blocked[idx].owner;
+      }
+
+      if ((idx == -1) || (blocked[idx].visited != start + 1)) {
+        continue;  // No deadlock
+      }
+
+      /* Deadlock!! */
+      int numThreads = 0;
+      int minIdx = idx;
+      int cur = idx;
+      do {
+        numThreads++;
+        if (blocked[cur].threadId < blocked[minIdx].threadId) {
+          minIdx = cur;
+        }
+        cur = blocked[cur].owner;
+      } while (cur != idx);
+
+      jlong deadlockId = blocked[minIdx].threadId;
+      if (reportedDeadlocks.find(deadlockId) != reportedDeadlocks.end()) {
+        deadlocks.insert(deadlockId);
+      } else if (isStillBlocked(jvmti, env, blocked, idx)) {
+        deadlocks.insert(deadlockId);
+        notifyDeadlockOccurrence(jvmti, env, blocked[minIdx].thread,
+                                 blocked[minIdx].monitor, numThreads);
+      }
+    }
+
+    /* Forget deadlocks which do not exist anymore. */
+    reportedDeadlocks.swap(deadlocks);
+  }
+
+  /*!
+   * \brief Scan all threads for finding deadlock.<br>
+   *        This function is called by scan timer thread.
+   * \param jvmti [in] JVMTI environment.
+   * \param env   [in] JNI environment of the current thread.
+   * \param cause [in] Cause of invoke function.
+   */
+  static void scanDeadlock(jvmtiEnv *jvmti, JNIEnv *env, TInvokeCause cause) {
+    TProcessMark mark(processing);
+
+    /* Timer thread never returns to Java, so local references must be freed. */
+    if (unlikely(env->PushLocalFrame(SCAN_LOCAL_REFS) != JNI_OK)) {
+      env->ExceptionClear();
+      return;
+    }
+
+    jint thread_cnt;
+    jthread *threads;
+    if (isError(jvmti, jvmti->GetAllThreads(&thread_cnt, &threads))) {
+      logger->printWarnMsg("Could not get threads for deadlock scan.");
+      env->PopLocalFrame(NULL);
+      return;
+    }
+
+    bool isContended = false;
+    try {
+      std::vector<TBlockedThread> blocked;
+      collectBlockedThreads(jvmti, threads, thread_cnt, blocked);
+      isContended = !blocked.empty();
+
+      if (blocked.size() > 1) {
+        linkOwners(jvmti, env, blocked);
+        findDeadlocks(jvmti, env, blocked);
+      } else {
+        reportedDeadlocks.clear();
+      }
+    } catch (...) {
+      logger->printWarnMsg("Could not allocate memory for deadlock scan.");
+    }
+
+    jvmti->Deallocate((unsigned char *)threads);
+    env->PopLocalFrame(NULL);
+
+    /* Scan less frequently while no thread is contended. */
+    if (isContended) {
+      currentScanInterval = scanInterval;
+    } else if (currentScanInterval < scanInterval * MAX_SCAN_BACKOFF) {
+      currentScanInterval *= 2;
+    }
+    scanTimer->setInterval(currentScanInterval);
+  }
 
   /*!
    * \brief Deadlock detector initializer.
@@ -299,6 +630,7 @@ namespace dldetector {
        *   hotspot/src/share/vm/prims/jvmtiManageCapabilities.cpp
        */
       capabilities.can_get_owned_monitor_info = 1;
+      capabilities.can_get_current_contended_monitor = 1;
     }
     TMonitorContendedEnterCallback::mergeCapabilities(&capabilities);
     if (isError(jvmti, jvmti->AddCapabilities(&capabilities))) {
@@ -307,12 +639,39 @@ namespace dldetector {
       return false;
     }
 
+    /* Deadlock is found by scan timer in scan mode. */
+    if (conf->DeadlockScanInterval()->get() > 0) {
+      try {
+        if (scanTimer == NULL) {
+          scanTimer = new TTimer(&scanDeadlock, "HeapStats Deadlock Scanner");
+        }
+      } catch (const char *errMsg) {
+        logger->printCritMsg(errMsg);
+        return false;
+      } catch (...) {
+        logger->printCritMsg("Couldn't create deadlock scanner.");
+        return false;
+      }
+
+      return true;
+    }
+
     /*
      * All JVMTI events are not fired at this point.
-     * So we need not to lock this operation.
+     * Tables are kept after finalization because handlers which are
+     * running might refer them.
      */
-    monitor_owners.clear();
-    waiter_list.clear();
+    try {
+      if (monitor_owners == NULL) {
+        monitor_owners = new TWaitForTable();
+      }
+      if (waiter_list == NULL) {
+        waiter_list = new TWaitForTable();
+      }
+    } catch (...) {
+      logger->printCritMsg("Couldn't allocate wait-for tables.");
+      return false;
+    }
 
     TMonitorContendedEnterCallback::registerCallback(&OnMonitorContendedEnter);
     TMonitorContendedEnterCallback::switchEventNotification(jvmti,
@@ -325,12 +684,51 @@ namespace dldetector {
     return true;
   }
 
+  /*!
+   * \brief Start deadlock scan thread if scan mode is enabled.
+   * \param jvmti [in]  JVMTI environment
+   * \param env   [in]  JNI environment of the current thread.
+   */
+  void start(jvmtiEnv *jvmti, JNIEnv *env) {
+    if ((conf->DeadlockScanInterval()->get() <= 0) || (scanTimer == NULL) ||
+        isScanning) {
+      return;
+    }
+
+    /* These capabilities can be added at OnLoad phase only. */
+    jvmtiCapabilities capabilities = {0};
+    jvmti->GetCapabilities(&capabilities);
+    if (!capabilities.can_get_owned_monitor_info ||
+        !capabilities.can_get_current_contended_monitor) {
+      logger->printWarnMsg(
+          "Deadlock scan is not available. Agent is not loaded at startup.");
+      return;
+    }
+
+    scanInterval = conf->DeadlockScanInterval()->get() * 1000;
+    currentScanInterval = scanInterval;
+    reportedDeadlocks.clear();
+
+    try {
+      scanTimer->start(jvmti, env, scanInterval);
+      isScanning = true;
+    } catch (const char *errMsg) {
+      logger->printWarnMsg(errMsg);
+    }
+  }
+
   /*!
    * \brief Deadlock detector finalizer.
-   *        This function unregisters JVMTI callback for deadlock detection.
+   *        This function unregisters JVMTI callback for deadlock detection,
+   *        and stops deadlock scan thread.
    * \param jvmti [in]  JVMTI environment
    */
   void finalize(jvmtiEnv *jvmti) {
+    if (isScanning) {
+      scanTimer->stop();
+      isScanning = false;
+    }
+
     TMonitorContendedEnterCallback::unregisterCallback(
                                                 &OnMonitorContendedEnter);
     TMonitorContendedEnteredCallback::unregisterCallback(
@@ -343,10 +741,11 @@ namespace dldetector {
       sched_yield();
     }
 
-    {
-      TMutexLocker locker(&mutex);
-      monitor_owners.clear();
-      waiter_list.clear();
+    if (monitor_owners != NULL) {
+      monitor_owners->clear();
+    }
+    if (waiter_list != NULL) {
+      waiter_list->clear();
     }
   }
 
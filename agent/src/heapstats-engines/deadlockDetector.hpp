@@ -60,9 +60,17 @@ namespace dldetector {
    */
   bool initialize(jvmtiEnv *jvmti, bool isOnLoad);
 
+  /*!
+   * \brief Start deadlock scan thread if scan mode is enabled.
+   * \param jvmti [in]  JVMTI environment
+   * \param env   [in]  JNI environment of the current thread.
+   */
+  void start(jvmtiEnv *jvmti, JNIEnv *env);
+
   /*!
    * \brief Deadlock detector finalizer.
-   *        This function unregisters JVMTI callback for deadlock detection.
+   *        This function unregisters JVMTI callback for deadlock detection,
+   *        and stops deadlock scan thread.
    * \param jvmti [in]  JVMTI environment
    */
   void finalize(jvmtiEnv *jvmti);
@@ -20,17 +20,256 @@
  */
 
 #include <fcntl.h>
+#include <sys/ioctl.h>
 #include <sys/sendfile.h>
+#include <sys/syscall.h>
 #include <dirent.h>
 
 #include "globals.hpp"
 #include "fsUtil.hpp"
 
+#ifndef FICLONE
+/*!
+ * \brief ioctl request to share extents of file. (Linux 4.5 or later)
+ */
+#define FICLONE _IOW(0x94, 9, int)
+#endif
+
+/*!
+ * \brief Max size of data which is copied by a system call.
+ */
+#define COPY_CHUNK_SIZE (1 << 30)
+
+/*!
+ * \brief Max size of data which is copied by a system call with guard.<br>
+ *        Guard is held while the chunk is copied, so it is kept small.
+ */
+#define GUARDED_COPY_CHUNK_SIZE (8 * 1024 * 1024)
+
+/*!
+ * \brief Initial size of buffer to copy file in procfs.
+ */
+#define PSEUDO_FILE_BUFFER_MIN (64 * 1024)
+
+/*!
+ * \brief Max size of buffer to copy file in procfs.
+ */
+#define PSEUDO_FILE_BUFFER_MAX (4 * 1024 * 1024)
+
 /*!
  * \brief Mutex of working directory.
  */
 pthread_mutex_t directoryMutex = PTHREAD_ERRORCHECK_MUTEX_INITIALIZER_NP;
 
+/*!
+ * \brief Copy data by copy_file_range(2).
+ * \param sourceFd [in]     File descriptor of source file.
+ * \param pos      [in,out] Offset of source file.
+ * \param destFd   [in]     File descriptor of destination file.
+ * \param len      [in]     Max size of data to copy.
+ * \return Size of copied data.<br>
+ *         Value is -1 and errno is set, if process is failure.
+ */
+static ssize_t copyFileRange(int sourceFd, off64_t *pos, int destFd,
+                             size_t len) {
+#ifdef SYS_copy_file_range
+  return (ssize_t)syscall(SYS_copy_file_range, sourceFd, pos, destFd, NULL,
+                          len, 0);
+#else
+  errno = ENOSYS;
+  return -1;
+#endif
+}
+
+/*!
+ * \brief Copy data in kernel until EOF or limit.<br>
+ *        copy_file_range(2) is tried first, and sendfile(2) is used if it is
+ *        not available. e.g. old kernel, or across file systems.
+ * \param sourceFd [in]     File descriptor of source file.
+ * \param destFd   [in]     File descriptor of destination file.
+ *                          Data is written at its file offset.
+ * \param pos      [in,out] Offset of source file.
+ * \param limit    [in]     Max size of data to copy.
+ *                          Data is copied until EOF, if value is negative.
+ * \param size     [out]    Size of copied data.
+ * \param guard    [in]     Guard of each chunk. It can be null.
+ * \param data     [in]     Data which is passed to guard.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+static int copyInKernel(int sourceFd, int destFd, off64_t *pos, off64_t limit,
+                        off64_t *size, TCopyChunkGuard guard, void *data) {
+  bool useCopyFileRange = true;
+  size_t chunkSize =
+      (guard != NULL) ? GUARDED_COPY_CHUNK_SIZE : COPY_CHUNK_SIZE;
+  *size = 0;
+
+  while ((limit < 0) || (*size < limit)) {
+    size_t len = chunkSize;
+    if ((limit >= 0) && (limit - *size < (off64_t)len)) {
+      len = (size_t)(limit - *size);
+    }
+
+    if (guard != NULL) {
+      int result = guard(data, true);
+      if (unlikely(result != 0)) {
+        return result;
+      }
+    }
+
+    ssize_t copied;
+    if (useCopyFileRange) {
+      copied = copyFileRange(sourceFd, pos, destFd, len);
+    } else {
+      copied = sendfile64(destFd, sourceFd, pos, len);
+    }
+    int err = errno;
+
+    if (guard != NULL) {
+      guard(data, false);
+    }
+    errno = err;
+
+    if (useCopyFileRange && (copied < 0) &&
+        ((errno == ENOSYS) || (errno == EXDEV) || (errno == EINVAL) ||
+         (errno == EOPNOTSUPP) || (errno == EBADF))) {
+      useCopyFileRange = false;
+      continue;
+    }
+
+    if (copied == 0) {
+      /* Source file was truncated, or reached to EOF. */
+      break;
+    } else if (unlikely(copied < 0)) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return errno;
+    }
+
+    *size += copied;
+  }
+
+  return 0;
+}
+
+/*!
+ * \brief Copy regular file.<br>
+ *        Extents are shared by reflink if file system supports it.
+ *        Otherwise destination is preallocated and data is copied in kernel.
+ * \param sourceFd [in] File descriptor of source file.
+ * \param destFd   [in] File descriptor of empty destination file.
+ * \param size     [in] Size of source file.
+ * \param guard    [in] Guard of each chunk. It can be null.
+ * \param data     [in] Data which is passed to guard.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+static int copyRegularFile(int sourceFd, int destFd, off64_t size,
+                           TCopyChunkGuard guard, void *data) {
+  int result = (guard != NULL) ? guard(data, true) : 0;
+  if (unlikely(result != 0)) {
+    return result;
+  }
+
+  /* Any error of reflink is recovered by copy. e.g. EOPNOTSUPP, EXDEV */
+  bool isCloned = (ioctl(destFd, FICLONE, sourceFd) == 0);
+
+  /*
+   * Preallocation is only a hint, but lack of space is reported here
+   * so that disk full can be detected before copy.
+   */
+  if (!isCloned &&
+      unlikely(fallocate64(destFd, FALLOC_FL_KEEP_SIZE, 0, size) != 0) &&
+      isRaisedDiskFull(errno)) {
+    result = errno;
+  }
+
+  if (guard != NULL) {
+    guard(data, false);
+  }
+  if (isCloned || (result != 0)) {
+    return result;
+  }
+
+  off64_t pos = 0;
+  off64_t copied;
+  return copyInKernel(sourceFd, destFd, &pos, size, &copied, guard, data);
+}
+
+/*!
+ * \brief Copy file which has no size. e.g. files in procfs.<br>
+ *        Buffer is grown while source fills it, because seq_file in kernel
+ *        returns as much data as fits in the buffer.
+ * \param sourceFd [in] File descriptor of source file.
+ * \param destFd   [in] File descriptor of destination file.
+ * \param guard    [in] Guard of each chunk. It can be null.
+ * \param data     [in] Data which is passed to guard.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+static int copyPseudoFile(int sourceFd, int destFd, TCopyChunkGuard guard,
+                          void *data) {
+  size_t bufSize = PSEUDO_FILE_BUFFER_MIN;
+  char *buf = (char *)malloc(bufSize);
+  if (unlikely(buf == NULL)) {
+    return ENOMEM;
+  }
+
+  int result = 0;
+  while (true) {
+    ssize_t readSize = read(sourceFd, buf, bufSize);
+    if (readSize == 0) {
+      break;
+    } else if (unlikely(readSize < 0)) {
+      if (errno == EINTR) {
+        continue;
+      }
+      result = errno;
+      break;
+    }
+
+    if (guard != NULL) {
+      result = guard(data, true);
+      if (unlikely(result != 0)) {
+        break;
+      }
+    }
+
+    for (ssize_t written = 0; written < readSize;) {
+      ssize_t writeSize = write(destFd, buf + written, readSize - written);
+      if (unlikely(writeSize < 0)) {
+        if (errno == EINTR) {
+          continue;
+        }
+        result = errno;
+        break;
+      }
+      written += writeSize;
+    }
+
+    if (guard != NULL) {
+      guard(data, false);
+    }
+    if (unlikely(result != 0)) {
+      break;
+    }
+
+    if (((size_t)readSize > bufSize / 2) &&
+        (bufSize < PSEUDO_FILE_BUFFER_MAX)) {
+      /* Current buffer is kept if it cannot be grown. */
+      char *newBuf = (char *)realloc(buf, bufSize * 2);
+      if (likely(newBuf != NULL)) {
+        buf = newBuf;
+        bufSize *= 2;
+      }
+    }
+  }
+
+  free(buf);
+  return result;
+}
+
 /*!
  * \brief Copy data as avoid overwriting.
  * \param sourceFile [in] Path of source file.
@@ -84,17 +323,6 @@ int copyFile(char const *sourceFile, char const *destPath,
     return result;
   }
 
-  /* Get source file size */
-  struct stat st;
-  if (unlikely(fstat(sourceFd, &st) != 0)) {
-    result = errno;
-    logger->printWarnMsgWithErrno("Couldn't open copy destination file.");
-    free(newFile);
-    free(destFile);
-    close(sourceFd);
-    return result;
-  }
-
   /* Open destination file. */
   int destFd = open(destFile, O_CREAT | O_EXCL | O_WRONLY, S_IRUSR | S_IWUSR);
   if (unlikely(destFd < 0)) {
@@ -107,26 +335,10 @@ int copyFile(char const *sourceFile, char const *destPath,
   }
 
   /* Copy data */
-  if (st.st_size > 0) {
-    if (unlikely(sendfile64(destFd, sourceFd, NULL, st.st_size) == -1)) {
-      result = errno;
-      logger->printWarnMsgWithErrno("Couldn't copy file.");
-    }
-  } else { /* This route is for files in procfs */
-    char buf[1024];
-    ssize_t read_size;
-
-    while ((read_size = read(sourceFd, buf, 1024)) > 0) {
-      if (write(destFd, buf, (size_t)read_size) == -1) {
-        read_size = -1;
-        break;
-      }
-    }
-
-    if (read_size == -1) {
-      result = errno;
-      logger->printWarnMsgWithErrno("Couldn't copy file.");
-    }
+  result = copyFileData(sourceFd, destFd);
+  if (unlikely(result != 0)) {
+    errno = result;
+    logger->printWarnMsgWithErrno("Couldn't copy file.");
   }
 
   /* Clean up */
@@ -143,6 +355,56 @@ int copyFile(char const *sourceFile, char const *destPath,
   return result;
 }
 
+/*!
+ * \brief Copy all data of source file.<br>
+ *        Regular file is copied in kernel, and other file (e.g. files in
+ *        procfs, pipe) is copied through buffer.
+ * \param sourceFd [in] File descriptor of source file.
+ * \param destFd   [in] File descriptor of empty destination file.
+ * \param guard    [in] Guard of each chunk. It can be null.
+ * \param data     [in] Data which is passed to guard.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int copyFileData(int sourceFd, int destFd, TCopyChunkGuard guard,
+                 void *data) {
+  struct stat st;
+  if (unlikely(fstat(sourceFd, &st) != 0)) {
+    return errno;
+  }
+
+  /* Files in procfs are regular file, but they have no size. */
+  if (S_ISREG(st.st_mode) && (st.st_size > 0)) {
+    return copyRegularFile(sourceFd, destFd, st.st_size, guard, data);
+  } else {
+    return copyPseudoFile(sourceFd, destFd, guard, data);
+  }
+}
+
+/*!
+ * \brief Copy data from offset to EOF of source file.
+ * \param sourceFd [in]  File descriptor of source file.
+ * \param destFd   [in]  File descriptor of destination file.
+ * \param offset   [in]  Offset of source file to start copy.
+ * \param size     [out] Size of copied data.
+ * \param guard    [in]  Guard of each chunk. It can be null.
+ * \param data     [in]  Data which is passed to guard.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int copyFileTail(int sourceFd, int destFd, off_t offset, off_t *size,
+                 TCopyChunkGuard guard, void *data) {
+  off64_t pos = offset;
+  off64_t copied = 0;
+
+  /* Source file might be growing, so copy until EOF instead of its size. */
+  int result =
+      copyInKernel(sourceFd, destFd, &pos, -1, &copied, guard, data);
+  *size = (off_t)copied;
+
+  return result;
+}
+
 /*!
  * \brief Create filename in expected path.
  * \param basePath [in] Path of directory.
@@ -611,3 +873,30 @@ bool isValidPath(const char *path) {
 
   return result;
 }
+
+/*!
+ * \brief Check that file is opened by this process.
+ * \param dev [in] Device of file.
+ * \param ino [in] Inode of file.
+ * \return File is opened by any file descriptor of this process.
+ */
+bool isOpenedFile(dev_t dev, ino_t ino) {
+  DIR *dir = opendir("/proc/self/fd");
+  if (unlikely(dir == NULL)) {
+    return false;
+  }
+
+  /* Each entry is symbolic link to opened file. */
+  bool result = false;
+  struct dirent *entry;
+  while (!result && ((entry = readdir(dir)) != NULL)) {
+    struct stat st;
+    if ((entry->d_name[0] != '.') &&
+        (fstatat(dirfd(dir), entry->d_name, &st, 0) == 0)) {
+      result = (st.st_dev == dev) && (st.st_ino == ino);
+    }
+  }
+  closedir(dir);
+
+  return result;
+}
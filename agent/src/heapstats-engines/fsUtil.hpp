@@ -22,6 +22,7 @@
 #define _FS_UTIL_H
 
 #include <errno.h>
+#include <sys/types.h>
 
 /*!
  * \brief Copy data as avoid overwriting.
@@ -35,6 +36,46 @@
 int copyFile(char const* sourceFile, char const* destPath,
              char const* destName = NULL);
 
+/*!
+ * \brief Function to guard each chunk of copy.<br>
+ *        It is called with true before a chunk is written, and with false
+ *        after the chunk is written.
+ * \param data    [in] Data which is passed to copy function.
+ * \param isEnter [in] Chunk is going to be written.
+ * \return Value is zero, if the chunk can be written.<br />
+ *         Value is error number to stop copy. It is ignored if isEnter is
+ *         false.
+ */
+typedef int (*TCopyChunkGuard)(void* data, bool isEnter);
+
+/*!
+ * \brief Copy all data of source file.<br>
+ *        Regular file is copied in kernel, and other file (e.g. files in
+ *        procfs, pipe) is copied through buffer.
+ * \param sourceFd [in] File descriptor of source file.
+ * \param destFd   [in] File descriptor of empty destination file.
+ * \param guard    [in] Guard of each chunk. It can be null.
+ * \param data     [in] Data which is passed to guard.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int copyFileData(int sourceFd, int destFd, TCopyChunkGuard guard = NULL,
+                 void* data = NULL);
+
+/*!
+ * \brief Copy data from offset to EOF of source file.
+ * \param sourceFd [in]  File descriptor of source file.
+ * \param destFd   [in]  File descriptor of destination file.
+ * \param offset   [in]  Offset of source file to start copy.
+ * \param size     [out] Size of copied data.
+ * \param guard    [in]  Guard of each chunk. It can be null.
+ * \param data     [in]  Data which is passed to guard.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int copyFileTail(int sourceFd, int destFd, off_t offset, off_t* size,
+                 TCopyChunkGuard guard = NULL, void* data = NULL);
+
 /*!
  * \brief Create filename in expected path.
  * \param basePath [in] Path of directory.
@@ -103,6 +144,14 @@ int isAccessibleDirectory(char const* path, bool needRead, bool needWrite);
  */
 bool isValidPath(const char* path);
 
+/*!
+ * \brief Check that file is opened by this process.
+ * \param dev [in] Device of file.
+ * \param ino [in] Inode of file.
+ * \return File is opened by any file descriptor of this process.
+ */
+bool isOpenedFile(dev_t dev, ino_t ino);
+
 /*!
  * \brief Check disk full error.<br />
  *        If error is disk full, then print alert message.
@@ -35,6 +35,8 @@
 #include "globals.hpp"
 #include "configuration.hpp"
 #include "heapstatsMBean.hpp"
+#include "threadRecorder.hpp"
+#include "contentionProfiler.hpp"
 #include "util.hpp"
 
 /* Variables */
@@ -306,9 +308,18 @@ JNIEXPORT void JNICALL RegisterHeapStatsNative(JNIEnv *env, jclass cls) {
        (void *)InvokeLogCollection},
       {(char *)"invokeAllLogCollection0",
        (char *)"()Z",
-       (void *)InvokeAllLogCollection}};
+       (void *)InvokeAllLogCollection},
+      {(char *)"invokeThreadRecordSnapshot0",
+       (char *)"()Z",
+       (void *)InvokeThreadRecordSnapshot},
+      {(char *)"getIOLatencyStatistics0",
+       (char *)"()Ljava/util/Map;",
+       (void *)GetIOLatencyStatistics},
+      {(char *)"getContendedMonitors0",
+       (char *)"()Ljava/util/Map;",
+       (void *)GetContendedMonitors}};
 
-  if (env->RegisterNatives(cls, methods, 6) != 0) {
+  if (env->RegisterNatives(cls, methods, 9) != 0) {
     raiseException(env, "java/lang/UnsatisfiedLinkError",
                    "Native function for HeapStatsMBean failed.");
     return;
@@ -377,9 +388,18 @@ void UnregisterHeapStatsNatives(JNIEnv *env) {
        (void *)JNIDummy},
       {(char *)"invokeAllLogCollection0",
        (char *)"()Z",
+       (void *)JNIDummy},
+      {(char *)"invokeThreadRecordSnapshot0",
+       (char *)"()Z",
+       (void *)JNIDummy},
+      {(char *)"getIOLatencyStatistics0",
+       (char *)"()Ljava/util/Map;",
+       (void *)JNIDummy},
+      {(char *)"getContendedMonitors0",
+       (char *)"()Ljava/util/Map;",
        (void *)JNIDummy}};
 
-  if (env->RegisterNatives(linkedCls, methods, 6) != 0) {
+  if (env->RegisterNatives(linkedCls, methods, 9) != 0) {
     raiseException(env, "java/lang/UnsatisfiedLinkError",
                    "Could not unregister HeapStats native functions.");
   }
@@ -714,3 +734,151 @@ JNIEXPORT jboolean JNICALL InvokeAllLogCollection(JNIEnv *env, jobject obj) {
                                    (TMSecTime)getNowTimeSec(), "JMX event");
   return ret == 0 ? JNI_TRUE : JNI_FALSE;
 }
+
+/*!
+ * \brief Invoke snapshot of Thread Recorder at libheapstats.
+ *
+ * \param env   Pointer of JNI environment.
+ * \param obj   Instance of HeapStatsMBean implementation.
+ * \return Result of this call.
+ */
+JNIEXPORT jboolean JNICALL
+    InvokeThreadRecordSnapshot(JNIEnv *env, jobject obj) {
+  TProcessMark mark(processing);
+  return TThreadRecorder::requestSnapshot() ? JNI_TRUE : JNI_FALSE;
+}
+
+/*!
+ * \brief Get I/O latency statistics from libheapstats.
+ *        Key is "<I/O kind>.<statistic>", value is Long.
+ *
+ * \param env   Pointer of JNI environment.
+ * \param obj   Instance of HeapStatsMBean implementation.
+ * \return Map of statistics. Map is empty if thread recorder is not working.
+ */
+JNIEXPORT jobject JNICALL GetIOLatencyStatistics(JNIEnv *env, jobject obj) {
+  TProcessMark mark(processing);
+  jobject result = env->NewObject(mapCls, map_ctor);
+  if (result == NULL) {
+    raiseException(env, "java/lang/RuntimeException",
+                   "Cannot create Map instance.");
+    return NULL;
+  }
+
+  TLatencyStatistics stats[NUM_IO_KINDS];
+  if (!TThreadRecorder::getIOLatencyStatistics(stats)) {
+    return result;
+  }
+
+  for (int kind = 0; kind < NUM_IO_KINDS; kind++) {
+    const char *names[] = {"count", "bytes", "mean_ns", "p50_ns",
+                           "p90_ns", "p99_ns", "p999_ns", "max_ns"};
+    jlong values[] = {
+        stats[kind].count,
+        stats[kind].bytes,
+        (stats[kind].count > 0) ? stats[kind].total / stats[kind].count : 0,
+        stats[kind].p50,
+        stats[kind].p90,
+        stats[kind].p99,
+        stats[kind].p999,
+        stats[kind].max};
+
+    for (size_t idx = 0; idx < sizeof(values) / sizeof(jlong); idx++) {
+      char keyName[64];
+      snprintf(keyName, sizeof(keyName), "%s.%s",
+               TThreadRecorder::getIOKindName(kind), names[idx]);
+
+      jstring key = createString(env, keyName);
+      if (key == NULL) {
+        return NULL;
+      }
+
+      jobject value =
+          env->CallStaticObjectMethod(longCls, longValueOf, values[idx]);
+      if (value == NULL) {
+        raiseException(env, "java/lang/RuntimeException",
+                       "Cannot create Long instance.");
+        return NULL;
+      }
+
+      env->CallObjectMethod(result, map_put, key, value);
+      if (env->ExceptionCheck()) {
+        raiseException(env, "java/lang/RuntimeException",
+                       "Cannot put statistics to Map instance.");
+        return NULL;
+      }
+
+      env->DeleteLocalRef(key);
+      env->DeleteLocalRef(value);
+    }
+  }
+
+  return result;
+}
+
+/*!
+ * \brief Get the most contended monitor classes from libheapstats.
+ *        Key is "<class name>.<statistic>", value is Long.
+ *
+ * \param env   Pointer of JNI environment.
+ * \param obj   Instance of HeapStatsMBean implementation.
+ * \return Map of statistics which is ordered by wait time.
+ *         Map is empty if contention profiler is not working.
+ */
+JNIEXPORT jobject JNICALL GetContendedMonitors(JNIEnv *env, jobject obj) {
+  TProcessMark mark(processing);
+  jobject result = env->NewObject(mapCls, map_ctor);
+  if (result == NULL) {
+    raiseException(env, "java/lang/RuntimeException",
+                   "Cannot create Map instance.");
+    return NULL;
+  }
+
+  TContendedMonitor monitors[CONTENTION_TOP_COUNT];
+  int count = ctprofiler::getTopMonitors(monitors, CONTENTION_TOP_COUNT);
+  bool succeeded = true;
+
+  for (int idx = 0; succeeded && (idx < count); idx++) {
+    const char *names[] = {"count", "wait_ns", "max_wait_ns"};
+    jlong values[] = {monitors[idx].count, monitors[idx].waitTime,
+                      monitors[idx].maxWaitTime};
+
+    for (size_t pos = 0; pos < sizeof(values) / sizeof(jlong); pos++) {
+      char keyName[PATH_MAX];
+      snprintf(keyName, sizeof(keyName), "%s.%s", monitors[idx].className,
+               names[pos]);
+
+      jstring key = createString(env, keyName);
+      if (key == NULL) {
+        succeeded = false;
+        break;
+      }
+
+      jobject value =
+          env->CallStaticObjectMethod(longCls, longValueOf, values[pos]);
+      if (value == NULL) {
+        raiseException(env, "java/lang/RuntimeException",
+                       "Cannot create Long instance.");
+        succeeded = false;
+        break;
+      }
+
+      env->CallObjectMethod(result, map_put, key, value);
+      if (env->ExceptionCheck()) {
+        raiseException(env, "java/lang/RuntimeException",
+                       "Cannot put statistics to Map instance.");
+        succeeded = false;
+        break;
+      }
+
+      env->DeleteLocalRef(key);
+      env->DeleteLocalRef(value);
+    }
+  }
+
+  for (int idx = 0; idx < count; idx++) {
+    free(monitors[idx].className);
+  }
+
+  return succeeded ? result : NULL;
+}
@@ -37,6 +37,10 @@ extern "C" {
       ChangeConfiguration(JNIEnv *env, jobject obj, jstring key, jobject value);
   JNIEXPORT jboolean JNICALL InvokeLogCollection(JNIEnv *env, jobject obj);
   JNIEXPORT jboolean JNICALL InvokeAllLogCollection(JNIEnv *env, jobject obj);
+  JNIEXPORT jboolean JNICALL
+      InvokeThreadRecordSnapshot(JNIEnv *env, jobject obj);
+  JNIEXPORT jobject JNICALL GetIOLatencyStatistics(JNIEnv *env, jobject obj);
+  JNIEXPORT jobject JNICALL GetContendedMonitors(JNIEnv *env, jobject obj);
 
 #ifdef __cplusplus
 }
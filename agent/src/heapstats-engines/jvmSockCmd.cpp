@@ -70,21 +70,39 @@ int TJVMSockCmd::exec(char const* cmd, char const* filename) {
   /* Empty paramters. */
   const TJVMSockCmdArgs conf = {{0}, {0}, {0}};
 
-  return execute(cmd, conf, filename);
+  return execute(cmd, conf, filename, -1);
+}
+
+/*!
+ * \brief Execute command without params, and write response to stream.
+ * \param cmd [in] Execute command string.
+ * \param fd  [in] Output file descriptor. It is not closed.
+ * \return Response code of execute commad line.<br>
+ *         Execute command is succeed, if value is 0.<br>
+ *         Value is error code, if failure execute command.<br>
+ *         Even so the stream was written response data, if failure.
+ */
+int TJVMSockCmd::exec(char const* cmd, int fd) {
+  /* Empty paramters. */
+  const TJVMSockCmdArgs conf = {{0}, {0}, {0}};
+
+  return execute(cmd, conf, NULL, fd);
 }
 
 /*!
  * \brief Execute command, and save response.
  * \param cmd      [in] Execute command string.
  * \param conf     [in] Execute command arguments.
- * \param filename [in] Output file path.
+ * \param filename [in] Output file path.<br>
+ *                      Response is written to "fd", if value is null.
+ * \param fd       [in] Output file descriptor. It is not closed.
  * \return Response code of execute commad line.<br>
  *         Execute command is succeed, if value is 0.<br>
  *         Value is error code, if failure execute command.<br>
  *         Even so the file was written response data, if failure.
  */
 int TJVMSockCmd::execute(char const* cmd, const TJVMSockCmdArgs conf,
-                         char const* filename) {
+                         char const* filename, int fd) {
   /* If don't open socket yet. */
   if (unlikely(!isConnectable())) {
     /* If failure open JVM socket. */
@@ -104,12 +122,14 @@ int TJVMSockCmd::execute(char const* cmd, const TJVMSockCmdArgs conf,
 
   int returnCode = 0;
   /* Create response file. */
-  int fd = open(filename, O_CREAT | O_WRONLY | O_EXCL, S_IRUSR | S_IWUSR);
-  if (unlikely(fd < 0)) {
-    returnCode = errno;
-    logger->printWarnMsgWithErrno("Could not create threaddump file");
-    close(socketFD);
-    return returnCode;
+  if (filename != NULL) {
+    fd = open(filename, O_CREAT | O_WRONLY | O_EXCL, S_IRUSR | S_IWUSR);
+    if (unlikely(fd < 0)) {
+      returnCode = errno;
+      logger->printWarnMsgWithErrno("Could not create threaddump file");
+      close(socketFD);
+      return returnCode;
+    }
   }
 
   /*
@@ -189,7 +209,7 @@ int TJVMSockCmd::execute(char const* cmd, const TJVMSockCmdArgs conf,
 
   /* Cleanup. */
   close(socketFD);
-  if (unlikely(close(fd) < 0 && returnCode == 0)) {
+  if (unlikely(filename != NULL && close(fd) < 0 && returnCode == 0)) {
     returnCode = errno;
     logger->printWarnMsgWithErrno("Could not close socket to JVM");
   }
@@ -57,6 +57,17 @@ class TJVMSockCmd {
    */
   int exec(char const* cmd, char const* filename);
 
+  /*!
+   * \brief Execute command without params, and write response to stream.
+   * \param cmd [in] Execute command string.
+   * \param fd  [in] Output file descriptor. It is not closed.
+   * \return Response code of execute commad line.<br>
+   *         Execute command is succeed, if value is 0.<br>
+   *         Value is error code, if failure execute command.<br>
+   *         Even so the stream was written response data, if failure.
+   */
+  int exec(char const* cmd, int fd);
+
   /*!
    * \brief Get connectable socket to JVM.
    * \return Is connectable socket.
@@ -68,14 +79,16 @@ class TJVMSockCmd {
    * \brief Execute command, and save response.
    * \param cmd      [in] Execute command string.
    * \param conf     [in] Execute command arguments.
-   * \param filename [in] Output file path.
+   * \param filename [in] Output file path.<br>
+   *                      Response is written to "fd", if value is null.
+   * \param fd       [in] Output file descriptor. It is not closed.
    * \return Response code of execute commad line.<br>
    *         Execute command is succeed, if value is 0.<br>
    *         Value is error code, if failure execute command.<br>
    *         Even so the file was written response data, if failure.
    */
   virtual int execute(char const* cmd, const TJVMSockCmdArgs conf,
-                      char const* filename);
+                      char const* filename, int fd);
 
   /*!
    * \brief Create JVM socket file.
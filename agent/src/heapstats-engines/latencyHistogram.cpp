@@ -0,0 +1,135 @@
+/*!
+ * \file latencyHistogram.cpp
+ * \brief Lock-free log-linear histogram of latency.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+#include "latencyHistogram.hpp"
+
+/*!
+ * \brief Count of buckets in each power of two.
+ */
+#define HALF_SUB_BUCKETS (1 << (LATENCY_HISTOGRAM_SUB_BITS - 1))
+
+/*!
+ * \brief TLatencyHistogram constructor.
+ */
+TLatencyHistogram::TLatencyHistogram(void)
+    : count(0), total(0), bytes(0), max(0) {
+  for (int idx = 0; idx < LATENCY_HISTOGRAM_BUCKETS; idx++) {
+    buckets[idx] = 0;
+  }
+}
+
+/*!
+ * \brief Get index of bucket for the value.
+ * \param value [in] Value to record.
+ * \return Index of bucket.
+ */
+int TLatencyHistogram::getBucketIndex(jlong value) {
+  if (value < (1 << LATENCY_HISTOGRAM_SUB_BITS)) {
+    return (value < 0) ? 0 : (int)value;
+  } else if (value >> LATENCY_HISTOGRAM_MAX_BITS) {
+    return LATENCY_HISTOGRAM_BUCKETS - 1;
+  }
+
+  /* Top SUB_BITS bits of the value are used as sub-bucket. */
+  int msb = 63 - __builtin_clzll((unsigned long long)value);
+  int shift = msb - (LATENCY_HISTOGRAM_SUB_BITS - 1);
+  int sub = (int)(value >> shift) - HALF_SUB_BUCKETS;
+
+  return (1 << LATENCY_HISTOGRAM_SUB_BITS) + (shift - 1) * HALF_SUB_BUCKETS +
+         sub;
+}
+
+/*!
+ * \brief Get highest value in the bucket.
+ * \param index [in] Index of bucket.
+ * \return Highest value in the bucket.
+ */
+jlong TLatencyHistogram::getBucketHighValue(int index) {
+  if (index < (1 << LATENCY_HISTOGRAM_SUB_BITS)) {
+    return index;
+  }
+
+  index -= (1 << LATENCY_HISTOGRAM_SUB_BITS);
+  int shift = index / HALF_SUB_BUCKETS + 1;
+  jlong mantissa = index % HALF_SUB_BUCKETS + HALF_SUB_BUCKETS;
+
+  return ((mantissa + 1) << shift) - 1;
+}
+
+/*!
+ * \brief Record a value.
+ * \param value [in] Latency in nanoseconds.
+ * \param bytes [in] Bytes which are processed in this latency.
+ */
+void TLatencyHistogram::record(jlong value, jlong bytes) {
+  buckets[getBucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+  this->count.fetch_add(1, std::memory_order_relaxed);
+  this->total.fetch_add(value, std::memory_order_relaxed);
+  if (bytes > 0) {
+    this->bytes.fetch_add(bytes, std::memory_order_relaxed);
+  }
+
+  long long current = this->max.load(std::memory_order_relaxed);
+  while ((value > current) &&
+         !this->max.compare_exchange_weak(current, value,
+                                          std::memory_order_relaxed)) {
+    /* Retry with value which is updated by other thread. */
+  }
+}
+
+/*!
+ * \brief Calculate statistics.<br>
+ *        Buckets are read without lock, so the result might not include
+ *        values which are being recorded.
+ * \param stat [out] Statistics.
+ */
+void TLatencyHistogram::getStatistics(TLatencyStatistics *stat) {
+  long long snapshot[LATENCY_HISTOGRAM_BUCKETS];
+  jlong numValues = 0;
+  for (int idx = 0; idx < LATENCY_HISTOGRAM_BUCKETS; idx++) {
+    snapshot[idx] = buckets[idx].load(std::memory_order_relaxed);
+    numValues += snapshot[idx];
+  }
+
+  stat->count = numValues;
+  stat->total = total.load(std::memory_order_relaxed);
+  stat->bytes = bytes.load(std::memory_order_relaxed);
+  stat->max = max.load(std::memory_order_relaxed);
+
+  /* Percentiles are upper bound of the bucket, and do not exceed max. */
+  const int ratios[4] = {500, 900, 990, 999};  // per mille
+  jlong *results[4] = {&stat->p50, &stat->p90, &stat->p99, &stat->p999};
+  int target = 0;
+  jlong accumulated = 0;
+  for (int idx = 0; (idx < LATENCY_HISTOGRAM_BUCKETS) && (target < 4);
+       idx++) {
+    accumulated += snapshot[idx];
+    while ((target < 4) && (numValues > 0) &&
+           (accumulated * 1000 >= numValues * ratios[target])) {
+      jlong value = getBucketHighValue(idx);
+      *results[target++] = (value < stat->max) ? value : stat->max;
+    }
+  }
+
+  while (target < 4) {
+    *results[target++] = 0;
+  }
+}
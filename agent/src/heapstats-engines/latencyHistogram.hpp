@@ -0,0 +1,137 @@
+/*!
+ * \file latencyHistogram.hpp
+ * \brief Lock-free log-linear histogram of latency.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+#ifndef LATENCY_HISTOGRAM_HPP
+#define LATENCY_HISTOGRAM_HPP
+
+#include <jni.h>
+
+#ifdef HAVE_ATOMIC
+#include <atomic>
+#else
+#include <cstdatomic>
+#endif
+
+/*!
+ * \brief Bits of sub-bucket index.
+ *        Relative error of each bucket is 1/2^(bits-1) at most.
+ */
+#define LATENCY_HISTOGRAM_SUB_BITS 6
+
+/*!
+ * \brief Max bits of recordable value. Larger value is clamped.
+ *        2^40 ns is about 18 minutes.
+ */
+#define LATENCY_HISTOGRAM_MAX_BITS 40
+
+/*!
+ * \brief Count of buckets.
+ */
+#define LATENCY_HISTOGRAM_BUCKETS                                \
+  ((1 << LATENCY_HISTOGRAM_SUB_BITS) +                           \
+   (LATENCY_HISTOGRAM_MAX_BITS - LATENCY_HISTOGRAM_SUB_BITS) *   \
+       (1 << (LATENCY_HISTOGRAM_SUB_BITS - 1)))
+
+/*!
+ * \brief Statistics which are calculated from histogram.
+ */
+typedef struct {
+  jlong count;  /*!< Count of values.            */
+  jlong total;  /*!< Sum of values.              */
+  jlong bytes;  /*!< Sum of bytes.               */
+  jlong max;    /*!< Max value.                  */
+  jlong p50;    /*!< 50th percentile.            */
+  jlong p90;    /*!< 90th percentile.            */
+  jlong p99;    /*!< 99th percentile.            */
+  jlong p999;   /*!< 99.9th percentile.          */
+} TLatencyStatistics;
+
+/*!
+ * \brief This class is histogram of latency in nanoseconds.<br>
+ *        Values are stored to log-linear buckets as like HdrHistogram.
+ *        Values less than 2^SUB_BITS are stored exactly, and each power of
+ *        two above is divided into 2^(SUB_BITS-1) linear buckets.<br>
+ *        record() is lock-free, so it can be called from any thread.
+ */
+class TLatencyHistogram {
+ public:
+  /*!
+   * \brief TLatencyHistogram constructor.
+   */
+  TLatencyHistogram(void);
+
+  /*!
+   * \brief Record a value.
+   * \param value [in] Latency in nanoseconds.
+   * \param bytes [in] Bytes which are processed in this latency.
+   */
+  void record(jlong value, jlong bytes);
+
+  /*!
+   * \brief Calculate statistics.<br>
+   *        Buckets are read without lock, so the result might not include
+   *        values which are being recorded.
+   * \param stat [out] Statistics.
+   */
+  void getStatistics(TLatencyStatistics *stat);
+
+  /*!
+   * \brief Get index of bucket for the value.
+   * \param value [in] Value to record.
+   * \return Index of bucket.
+   */
+  static int getBucketIndex(jlong value);
+
+  /*!
+   * \brief Get highest value in the bucket.
+   * \param index [in] Index of bucket.
+   * \return Highest value in the bucket.
+   */
+  static jlong getBucketHighValue(int index);
+
+ private:
+  /*!
+   * \brief Counts of each bucket.
+   */
+  std::atomic_llong buckets[LATENCY_HISTOGRAM_BUCKETS];
+
+  /*!
+   * \brief Count of values.
+   */
+  std::atomic_llong count;
+
+  /*!
+   * \brief Sum of values.
+   */
+  std::atomic_llong total;
+
+  /*!
+   * \brief Sum of bytes.
+   */
+  std::atomic_llong bytes;
+
+  /*!
+   * \brief Max value.
+   */
+  std::atomic_llong max;
+};
+
+#endif  // LATENCY_HISTOGRAM_HPP
@@ -0,0 +1,186 @@
+/*!
+ * \file leakTrendDetector.cpp
+ * \brief This file is used to detect leak trend of each class.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+#include <stdlib.h>
+
+#include "util.hpp"
+#include "leakTrendDetector.hpp"
+
+/*!
+ * \brief TLeakTrendDetector constructor.
+ * \param window [in] Count of snapshots in the window.
+ */
+TLeakTrendDetector::TLeakTrendDetector(int window) : trendMap() {
+  windowSize = window;
+  current = window - 1;
+  generation = 0;
+  baseTime = -1;
+
+  times = new double[window]();
+}
+
+/*!
+ * \brief TLeakTrendDetector destructor.
+ */
+TLeakTrendDetector::~TLeakTrendDetector(void) {
+  for (auto itr = trendMap.begin(); itr != trendMap.end(); itr++) {
+    free(itr->second);
+  }
+
+  delete[] times;
+}
+
+/*!
+ * \brief Start to add samples of new snapshot.
+ * \param snapShotTime [in] Time of snapshot (msec).
+ */
+void TLeakTrendDetector::beginSnapShot(jlong snapShotTime) {
+  if (unlikely(baseTime < 0)) {
+    baseTime = snapShotTime;
+  }
+
+  generation++;
+  current = (current + 1) % windowSize;
+  times[current] = (double)(snapShotTime - baseTime) / 1000.0;
+}
+
+/*!
+ * \brief Add sample of class to its time series.
+ * \param tag        [in]  Tag of class.
+ * \param usage      [in]  Total size of class.
+ * \param count      [in]  Instance count of class.
+ * \param sizeSlope  [out] Slope of total size (bytes/sec).
+ * \param countSlope [out] Slope of instance count (objects/sec).
+ * \return true if class grew monotonically through the whole window.<br>
+ *         Slopes are set only if this value is true.
+ */
+bool TLeakTrendDetector::addSample(jlong tag, jlong usage, jlong count,
+                                   double *sizeSlope, double *countSlope) {
+  TClassTrend *trend;
+  auto itr = trendMap.find(tag);
+
+  if (itr == trendMap.end()) {
+    /* Series and its rings are allocated at once. */
+    trend = (TClassTrend *)calloc(
+        1, sizeof(TClassTrend) + sizeof(jlong) * windowSize * 2);
+    if (unlikely(trend == NULL)) {
+      return false;
+    }
+
+    trend->sizes = (jlong *)(trend + 1);
+    trend->counts = trend->sizes + windowSize;
+    trendMap[tag] = trend;
+  } else {
+    trend = itr->second;
+  }
+
+  if (trend->numSamples < windowSize) {
+    trend->numSamples++;
+  }
+
+  /* Check monotonic growth from previous sample. Alert is re-armed. */
+  if (trend->numSamples > 1) {
+    int prev = (current - 1 + windowSize) % windowSize;
+    if (usage >= trend->sizes[prev]) {
+      trend->growthRun++;
+    } else {
+      trend->growthRun = 0;
+      trend->isAlerted = false;
+    }
+  }
+
+  /* Slot of current index holds the oldest sample if the ring is full. */
+  trend->sizes[current] = usage;
+  trend->counts[current] = count;
+  trend->generation = generation;
+
+  if ((trend->numSamples < windowSize) ||
+      (trend->growthRun < windowSize - 1)) {
+    return false;
+  }
+
+  *sizeSlope = calculateSlope(trend->sizes);
+  *countSlope = calculateSlope(trend->counts);
+
+  return true;
+}
+
+/*!
+ * \brief Calculate slope of samples in the window by least squares.
+ * \param values [in] Ring of samples. Index is same as times.
+ * \return Slope of samples per second.
+ */
+double TLeakTrendDetector::calculateSlope(const jlong *values) {
+  /*
+   * Time and samples are centered on their means before they are summed.
+   * It keeps precision even if time and usage are large.
+   */
+  double meanX = 0.0;
+  double meanY = 0.0;
+  for (int idx = 0; idx < windowSize; idx++) {
+    meanX += times[idx];
+    meanY += (double)values[idx];
+  }
+  meanX /= windowSize;
+  meanY /= windowSize;
+
+  double sxy = 0.0;
+  double sxx = 0.0;
+  for (int idx = 0; idx < windowSize; idx++) {
+    double dx = times[idx] - meanX;
+    sxy += dx * ((double)values[idx] - meanY);
+    sxx += dx * dx;
+  }
+
+  return (sxx > 0.0) ? sxy / sxx : 0.0;
+}
+
+/*!
+ * \brief Finish to add samples of current snapshot.<br>
+ *        Time series of classes which are not in current snapshot
+ *        (e.g. unloaded classes) are removed.
+ */
+void TLeakTrendDetector::endSnapShot(void) {
+  for (auto itr = trendMap.begin(); itr != trendMap.end();) {
+    if (itr->second->generation != generation) {
+      free(itr->second);
+      itr = trendMap.erase(itr);
+    } else {
+      itr++;
+    }
+  }
+}
+
+/*!
+ * \brief Mark class as alerted.<br>
+ *        Class is alerted only once until its usage decreases.
+ * \param tag [in] Tag of class.
+ * \return true if class was not alerted since its growth started.
+ */
+bool TLeakTrendDetector::setAlerted(jlong tag) {
+  auto itr = trendMap.find(tag);
+  if (unlikely(itr == trendMap.end()) || itr->second->isAlerted) {
+    return false;
+  }
+
+  itr->second->isAlerted = true;
+  return true;
+}
@@ -0,0 +1,148 @@
+/*!
+ * \file leakTrendDetector.hpp
+ * \brief This file is used to detect leak trend of each class.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+#ifndef LEAK_TREND_DETECTOR_HPP
+#define LEAK_TREND_DETECTOR_HPP
+
+#include <jni.h>
+
+#include <unordered_map>
+
+/*!
+ * \brief Time series of a class in the window.
+ *        Samples are stored at the same ring index as the snapshot time.
+ */
+typedef struct {
+  jlong generation; /*!< Generation of snapshot which updated this series. */
+  int numSamples;   /*!< Count of samples in the window.                   */
+  int growthRun;    /*!< Count of consecutive non-decreasing samples.      */
+  bool isAlerted;   /*!< Alert is raised since the growth started.         */
+  jlong *sizes;     /*!< Ring of total size.                               */
+  jlong *counts;    /*!< Ring of instance count.                           */
+} TClassTrend;
+
+/*!
+ * \brief Map of class tag and its time series.
+ */
+typedef std::unordered_map<jlong, TClassTrend *> TClassTrendMap;
+
+/*!
+ * \brief This class detects classes whose usage keeps growing after GC.<br>
+ *        Each class has time series of last N snapshots. Slope of them is
+ *        calculated by linear regression from the rings only when the class
+ *        grew through the whole window. Time is centered on the mean of the
+ *        window, so the result does not drift in long running process.<br>
+ *        This class is not thread-safe.
+ */
+class TLeakTrendDetector {
+ public:
+  /*!
+   * \brief TLeakTrendDetector constructor.
+   * \param window [in] Count of snapshots in the window.
+   */
+  TLeakTrendDetector(int window);
+
+  /*!
+   * \brief TLeakTrendDetector destructor.
+   */
+  virtual ~TLeakTrendDetector(void);
+
+  /*!
+   * \brief Get count of snapshots in the window.
+   * \return Count of snapshots in the window.
+   */
+  inline int getWindowSize(void) { return windowSize; }
+
+  /*!
+   * \brief Start to add samples of new snapshot.
+   * \param snapShotTime [in] Time of snapshot (msec).
+   */
+  void beginSnapShot(jlong snapShotTime);
+
+  /*!
+   * \brief Add sample of class to its time series.
+   * \param tag        [in]  Tag of class.
+   * \param usage      [in]  Total size of class.
+   * \param count      [in]  Instance count of class.
+   * \param sizeSlope  [out] Slope of total size (bytes/sec).
+   * \param countSlope [out] Slope of instance count (objects/sec).
+   * \return true if class grew monotonically through the whole window.<br>
+   *         Slopes are set only if this value is true.
+   */
+  bool addSample(jlong tag, jlong usage, jlong count, double *sizeSlope,
+                 double *countSlope);
+
+  /*!
+   * \brief Finish to add samples of current snapshot.<br>
+   *        Time series of classes which are not in current snapshot
+   *        (e.g. unloaded classes) are removed.
+   */
+  void endSnapShot(void);
+
+  /*!
+   * \brief Mark class as alerted.<br>
+   *        Class is alerted only once until its usage decreases.
+   * \param tag [in] Tag of class.
+   * \return true if class was not alerted since its growth started.
+   */
+  bool setAlerted(jlong tag);
+
+ protected:
+  /*!
+   * \brief Calculate slope of samples in the window by least squares.
+   * \param values [in] Ring of samples. Index is same as times.
+   * \return Slope of samples per second.
+   */
+  double calculateSlope(const jlong *values);
+
+ private:
+  /*!
+   * \brief Count of snapshots in the window.
+   */
+  int windowSize;
+
+  /*!
+   * \brief Ring index of current snapshot.
+   */
+  int current;
+
+  /*!
+   * \brief Generation of current snapshot.
+   */
+  jlong generation;
+
+  /*!
+   * \brief Time of first snapshot (msec).
+   */
+  jlong baseTime;
+
+  /*!
+   * \brief Ring of snapshot time (sec from baseTime).
+   */
+  double *times;
+
+  /*!
+   * \brief Time series of each class.
+   */
+  TClassTrendMap trendMap;
+};
+
+#endif  // LEAK_TREND_DETECTOR_HPP
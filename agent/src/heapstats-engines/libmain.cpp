@@ -33,6 +33,8 @@
 #include "deadlockDetector.hpp"
 #include "callbackRegister.hpp"
 #include "threadRecorder.hpp"
+#include "allocProfiler.hpp"
+#include "contentionProfiler.hpp"
 #include "heapstatsMBean.hpp"
 #include "libmain.hpp"
 
@@ -172,6 +174,18 @@ void ReloadConfigProc(jvmtiEnv *jvmti, JNIEnv *env) {
         TThreadRecorder::finalize(jvmti, env,
                                   conf->ThreadRecordFileName()->get());
       }
+
+      /* Suspend allocation sampling. */
+      if (conf->AllocSamplingEnable()->get()) {
+        allocprofiler::finalize(jvmti, env,
+                                conf->AllocSamplingFileName()->get());
+      }
+
+      /* Suspend contention profiler. */
+      if (conf->ContentionProfileEnable()->get()) {
+        ctprofiler::finalize(jvmti, env,
+                             conf->ContentionProfileFileName()->get());
+      }
     }
 
     /* If config file is designated at initialization. */
@@ -211,6 +225,7 @@ void ReloadConfigProc(jvmtiEnv *jvmti, JNIEnv *env) {
           logger->printCritMsg(
                       "Couldn't set event capabilities for deadlock detector.");
         }
+        dldetector::start(jvmti, env);
       }
 
       /* Start thread status logging. */
@@ -218,6 +233,20 @@ void ReloadConfigProc(jvmtiEnv *jvmti, JNIEnv *env) {
         TThreadRecorder::initialize(
             jvmti, env, conf->ThreadRecordBufferSize()->get() * 1024 * 1024);
       }
+
+      /* Start allocation sampling. */
+      if (conf->AllocSamplingEnable()->get() &&
+          !allocprofiler::initialize(jvmti,
+                                     conf->AllocSamplingInterval()->get())) {
+        conf->AllocSamplingEnable()->set(false);
+      }
+
+      /* Start contention profiler. */
+      if (conf->ContentionProfileEnable()->get() &&
+          !ctprofiler::initialize(jvmti,
+                                  conf->ContentionSampleInterval()->get())) {
+        conf->ContentionProfileEnable()->set(false);
+      }
     }
 
     logger->printInfoMsg("Reloaded configuration file.");
@@ -250,6 +279,11 @@ void intervalSigProc(jvmtiEnv *jvmti, JNIEnv *env, TInvokeCause cause) {
   if (likely(conf->Attach()->get() && conf->TriggerOnLogSignal()->get())) {
     intervalSigProcForLog(jvmti, env);
   }
+
+  /* If snapshot of thread recorder is requested by signal. */
+  if (conf->ThreadRecordEnable()->get()) {
+    TThreadRecorder::checkSnapshotSignal();
+  }
 }
 
 /*!
@@ -324,11 +358,30 @@ void JNICALL OnVMInit(jvmtiEnv *jvmti, JNIEnv *env, jthread thread) {
     /* Set event enable in each function. */
     SetEventEnable(jvmti, true);
 
+    /* Start deadlock scan. */
+    if (conf->CheckDeadlock()->get()) {
+      dldetector::start(jvmti, env);
+    }
+
     /* Start thread status logging. */
     if (conf->ThreadRecordEnable()->get()) {
       TThreadRecorder::initialize(
           jvmti, env, conf->ThreadRecordBufferSize()->get() * 1024 * 1024);
     }
+
+    /* Start allocation sampling. */
+    if (conf->AllocSamplingEnable()->get() &&
+        !allocprofiler::initialize(jvmti,
+                                   conf->AllocSamplingInterval()->get())) {
+      conf->AllocSamplingEnable()->set(false);
+    }
+
+    /* Start contention profiler. */
+    if (conf->ContentionProfileEnable()->get() &&
+        !ctprofiler::initialize(jvmti,
+                                conf->ContentionSampleInterval()->get())) {
+      conf->ContentionProfileEnable()->set(false);
+    }
   }
 
   /* Getting class prepare events. */
@@ -409,6 +462,16 @@ void JNICALL OnVMDeath(jvmtiEnv *jvmti, JNIEnv *env) {
       TThreadRecorder::finalize(jvmti, env,
                                 conf->ThreadRecordFileName()->get());
     }
+
+    if (conf->AllocSamplingEnable()->get()) {
+      allocprofiler::finalize(jvmti, env,
+                              conf->AllocSamplingFileName()->get());
+    }
+
+    if (conf->ContentionProfileEnable()->get()) {
+      ctprofiler::finalize(jvmti, env,
+                           conf->ContentionProfileFileName()->get());
+    }
   }
 
   /* Invoke JVM finalize event of snapshot function. */
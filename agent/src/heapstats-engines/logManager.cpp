@@ -24,13 +24,16 @@
 #include <pthread.h>
 #include <fcntl.h>
 #include <sys/utsname.h>
+#include <sys/stat.h>
 #include <sys/wait.h>
+#include <zlib.h>
 
 #include <queue>
 
 #include "globals.hpp"
 #include "fsUtil.hpp"
 #include "logManager.hpp"
+#include "threadRecorder.hpp"
 
 /* Static variables. */
 
@@ -45,6 +48,18 @@ pthread_mutex_t TLogManager::logMutex = PTHREAD_ADAPTIVE_MUTEX_INITIALIZER_NP;
 pthread_mutex_t TLogManager::archiveMutex =
     PTHREAD_ADAPTIVE_MUTEX_INITIALIZER_NP;
 
+/*!
+ * \brief Mutex of GC log position.
+ */
+pthread_mutex_t TLogManager::gcLogMutex =
+    PTHREAD_ADAPTIVE_MUTEX_INITIALIZER_NP;
+
+/*!
+ * \brief Mutex of abandoned artifact collectors.
+ */
+pthread_mutex_t TLogManager::collectorMutex =
+    PTHREAD_ADAPTIVE_MUTEX_INITIALIZER_NP;
+
 /* Macro defines. */
 
 /*!
@@ -62,6 +77,16 @@ pthread_mutex_t TLogManager::archiveMutex =
  */
 #define GCLOG_FILENAME_SYMBOL "_ZN9Arguments16_gc_log_filenameE"
 
+/*!
+ * \brief Suffix of GC log file which is written now with log rotation.
+ */
+#define GCLOG_CURRENT_SUFFIX ".current"
+
+/*!
+ * \brief Size of GC log data to check that archived part is not changed.
+ */
+#define GCLOG_CHECKSUM_SIZE 4096
+
 /* Util method for log manager. */
 
 /*!
@@ -114,6 +139,16 @@ TLogManager::TLogManager(JNIEnv *env, TJvmInfo *info) {
   jvmCmd = NULL;
   arcMaker = NULL;
   jniArchiver = NULL;
+  zipArchiver = NULL;
+  procSampler = NULL;
+  resourceLogFd = -1;
+  resourceLogPath = NULL;
+  binaryLog = NULL;
+  isBinarySampler = false;
+  memset(&gcLogArchived, 0, sizeof(TGCLogPosition));
+  memset(&gcLogCollected, 0, sizeof(TGCLogPosition));
+  isGCLogCollected = false;
+  gcLogArchiveSeq = 0;
 
   char *tempdirPath = NULL;
   /* Get temporary path of java */
@@ -128,6 +163,13 @@ TLogManager::TLogManager(JNIEnv *env, TJvmInfo *info) {
     /* Archive file maker to use zip library in java. */
     jniArchiver = new TJniZipArchiver();
 
+    /* Archive file maker to use zlib. */
+    zipArchiver = new TZipArchiver();
+
+    /* Resource usage sampler for normal log. */
+    procSampler = new TProcSampler(PROC_SOURCE_FLAG(ProcSourceStat) |
+                                   PROC_SOURCE_FLAG(ProcSourceSysStat));
+
     /* Get GC log filename pointer. */
     gcLogFilename = (char **)symFinder->findSymbol(GCLOG_FILENAME_SYMBOL);
     if (unlikely(gcLogFilename == NULL)) {
@@ -138,6 +180,8 @@ TLogManager::TLogManager(JNIEnv *env, TJvmInfo *info) {
     delete jvmCmd;
     delete arcMaker;
     delete jniArchiver;
+    delete zipArchiver;
+    delete procSampler;
 
     throw "TLogManager initialize failed!";
   }
@@ -148,10 +192,21 @@ TLogManager::TLogManager(JNIEnv *env, TJvmInfo *info) {
  * \brief TLogManager destructor.
  */
 TLogManager::~TLogManager(void) {
+  /* Abandoned tasks refer to this object. */
+  releaseCollectors(true);
+
   /* Destroy instance. */
   delete jvmCmd;
   delete arcMaker;
   delete jniArchiver;
+  delete zipArchiver;
+  delete procSampler;
+
+  if (resourceLogFd != -1) {
+    close(resourceLogFd);
+  }
+  free(resourceLogPath);
+  delete binaryLog;
 }
 
 /*!
@@ -211,26 +266,41 @@ int TLogManager::collectLog(jvmtiEnv *jvmti, JNIEnv *env, TInvokeCause cause,
  */
 int TLogManager::collectNormalLog(TInvokeCause cause, TMSecTime nowTime,
                                   char *archivePath) {
-  int result = EINVAL;
-  TLargeUInt systime = 0;
-  TLargeUInt usrtime = 0;
-  TLargeUInt vmsize = 0;
-  TLargeUInt rssize = 0;
-  TMachineTimes cpuTimes = {0};
+  TProcSample sample;
+  TMutexLocker locker(&logMutex);
+
+  /* Log format might be changed by reloading configuration. */
+  bool isBinary = conf->HeapLogBinary()->get();
+  if (unlikely(isBinary != isBinarySampler)) {
+    switchResourceLogFormat(isBinary);
+  }
 
-  /* Get java process information. */
-  if (unlikely(!getProcInfo(&systime, &usrtime, &vmsize, &rssize))) {
-    logger->printWarnMsg("Failure getting java process information.");
+  /* Get java process information and machine cpu times. */
+  if (unlikely(!procSampler->sample(&sample))) {
+    logger->printWarnMsg("Failure getting resource usage.");
   }
 
-  /* Get machine cpu times. */
-  if (unlikely(!getSysTimes(&cpuTimes))) {
-    logger->printWarnMsg("Failure getting machine cpu times.");
+  if (isBinary) {
+    return writeBinaryResourceLog(&sample, cause, nowTime, archivePath);
   }
 
+  /*
+   * CSV resource log has no notation of unknown value, so fields which
+   * could not be sampled are written as zero like older versions.
+   */
+  TLargeUInt *fields = (TLargeUInt *)&sample;
+  for (size_t idx = 0; idx < sizeof(TProcSample) / sizeof(TLargeUInt);
+       idx++) {
+    if (unlikely(fields[idx] == PROC_SAMPLE_UNKNOWN)) {
+      fields[idx] = 0;
+    }
+  }
+
+  TMachineTimes &cpuTimes = sample.cpuTimes;
+
   /* Make write log line. */
-  char logData[4097] = {0};
-  snprintf(logData, 4096,
+  char logData[4097];
+  int logLen = snprintf(logData, 4096,
            "%lld,%d"              /* Format : Logging information.      */
            ",%llu,%llu,%llu,%llu" /* Format : Java process information. */
            ",%llu,%llu,%llu"      /* Format : Machine CPU times.        */
@@ -242,7 +312,7 @@ int TLogManager::collectNormalLog(TInvokeCause cause, TMSecTime nowTime,
            nowTime,
            logCauseToInt(cause),
            /* Params : Java process information. */
-           usrtime, systime, vmsize, rssize,
+           sample.usrTime, sample.sysTime, sample.vmSize, sample.rsSize,
            /* Params : Machine CPU times. */
            cpuTimes.usrTime, cpuTimes.lowUsrTime, cpuTimes.sysTime,
            cpuTimes.idleTime, cpuTimes.iowaitTime, cpuTimes.irqTime,
@@ -255,35 +325,185 @@ int TLogManager::collectNormalLog(TInvokeCause cause, TMSecTime nowTime,
            /* Params : Archive file name. */
            archivePath);
 
-  {
-    TMutexLocker locker(&logMutex);
+  if (unlikely(logLen > 4096)) {
+    logLen = 4096;
+  }
+
+  return writeResourceLog(logData, logLen);
+}
+
+/*!
+ * \brief Write line to resource log file.<br>
+ *        Log file is kept open while its path is not changed.
+ *        Caller must hold logMutex.
+ * \param line [in] Line to write.
+ * \param len  [in] Length of line.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TLogManager::writeResourceLog(const char *line, size_t len) {
+  char *logPath = conf->HeapLogFile()->get();
+
+  /* Log file might be changed by reloading configuration. */
+  if ((resourceLogFd != -1) && (strcmp(resourceLogPath, logPath) != 0)) {
+    close(resourceLogFd);
+    resourceLogFd = -1;
+  }
 
+  if (resourceLogFd == -1) {
     /* Open log file. */
-    int fd = open(conf->HeapLogFile()->get(), O_CREAT | O_WRONLY | O_APPEND,
-                  S_IRUSR | S_IWUSR);
+    resourceLogFd = open(logPath, O_CREAT | O_WRONLY | O_APPEND | O_CLOEXEC,
+                         S_IRUSR | S_IWUSR);
 
     /* If failure open file. */
-    if (unlikely(fd < 0)) {
-      result = errno;
+    if (unlikely(resourceLogFd < 0)) {
+      int result = errno;
+      resourceLogFd = -1;
       logger->printWarnMsgWithErrno("Could not open log file");
-    } else {
-      result = 0;
+      return result;
+    }
 
-      /* Write line to log file. */
-      if (unlikely(write(fd, logData, strlen(logData)) < 0)) {
-        result = errno;
-        logger->printWarnMsgWithErrno("Could not write to log file");
-      }
+    free(resourceLogPath);
+    resourceLogPath = strdup(logPath);
+    if (unlikely(resourceLogPath == NULL)) {
+      int result = errno;
+      close(resourceLogFd);
+      resourceLogFd = -1;
+      logger->printWarnMsg("Could not allocate memory for log file path.");
+      return result;
+    }
+  }
 
-      /* Cleanup. */
-      if (unlikely(close(fd) < 0 && (result == 0))) {
-        result = errno;
-        logger->printWarnMsgWithErrno("Could not close log file");
+  /* Write line to log file. */
+  if (unlikely(write(resourceLogFd, line, len) < 0)) {
+    int result = errno;
+    logger->printWarnMsgWithErrno("Could not write to log file");
+
+    /* Log file will be opened again at next time. */
+    close(resourceLogFd);
+    resourceLogFd = -1;
+    return result;
+  }
+
+  return 0;
+}
+
+/*!
+ * \brief Write row to binary resource log file.<br>
+ *        Caller must hold logMutex.
+ * \param sample      [in] Resource usage of java process.
+ * \param cause       [in] Invoke function cause.
+ * \param nowTime     [in] Log collect time.
+ * \param archivePath [in] Archive file path.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TLogManager::writeBinaryResourceLog(TProcSample *sample,
+                                        TInvokeCause cause,
+                                        TMSecTime nowTime,
+                                        char *archivePath) {
+  char *logPath = conf->HeapLogFile()->get();
+
+  /* Log file might be changed by reloading configuration. */
+  if ((binaryLog != NULL) &&
+      (strcmp(binaryLog->getFileName(), logPath) != 0)) {
+    delete binaryLog;
+    binaryLog = NULL;
+  }
+
+  if (binaryLog == NULL) {
+    try {
+      binaryLog = new TResourceLogWriter(logPath);
+    } catch (...) {
+      logger->printWarnMsg("Could not open binary resource log: %s",
+                           logPath);
+      return EINVAL;
+    }
+  }
+
+  TMachineTimes &cpuTimes = sample->cpuTimes;
+  uint64_t values[ResourceLogIntColumns];
+  values[ResourceLogTime] = nowTime;
+  values[ResourceLogCause] = logCauseToInt(cause);
+  values[ResourceLogJavaUserTime] = sample->usrTime;
+  values[ResourceLogJavaSysTime] = sample->sysTime;
+  values[ResourceLogJavaVSSize] = sample->vmSize;
+  values[ResourceLogJavaRSSize] = sample->rsSize;
+  values[ResourceLogSystemUserTime] = cpuTimes.usrTime;
+  values[ResourceLogSystemNiceTime] = cpuTimes.lowUsrTime;
+  values[ResourceLogSystemSysTime] = cpuTimes.sysTime;
+  values[ResourceLogSystemIdleTime] = cpuTimes.idleTime;
+  values[ResourceLogSystemIOWaitTime] = cpuTimes.iowaitTime;
+  /* Same order as CSV resource log. */
+  values[ResourceLogSystemIRQTime] = cpuTimes.irqTime;
+  values[ResourceLogSystemSoftIRQTime] = cpuTimes.sortIrqTime;
+  values[ResourceLogSystemStealTime] = cpuTimes.stealTime;
+  values[ResourceLogSystemGuestTime] = cpuTimes.guestTime;
+  values[ResourceLogJvmSyncPark] = jvmInfo->getSyncPark();
+  values[ResourceLogJvmSafepointTime] = jvmInfo->getSafepointTime();
+  values[ResourceLogJvmSafepoints] = jvmInfo->getSafepoints();
+  values[ResourceLogJvmLiveThreads] = jvmInfo->getThreadLive();
+  values[ResourceLogIOReadChars] = sample->readChars;
+  values[ResourceLogIOWriteChars] = sample->writeChars;
+  values[ResourceLogIOReadSyscalls] = sample->readSyscalls;
+  values[ResourceLogIOWriteSyscalls] = sample->writeSyscalls;
+  values[ResourceLogIOReadBytes] = sample->readBytes;
+  values[ResourceLogIOWriteBytes] = sample->writeBytes;
+  values[ResourceLogSchedRunTime] = sample->runTime;
+  values[ResourceLogSchedRunqueueTime] = sample->runqueueTime;
+  values[ResourceLogSchedTimeslices] = sample->timeslices;
+  values[ResourceLogCgroupCpuTime] = sample->cgroupCpuTime;
+  values[ResourceLogCgroupThrottleTime] = sample->cgroupThrottleTime;
+  values[ResourceLogCgroupMemoryUsage] = sample->cgroupMemoryUsage;
+
+  /* I/O latency is available while thread recorder is working. */
+  TLatencyStatistics ioStats[NUM_IO_KINDS];
+  bool hasIOStats = TThreadRecorder::getIOLatencyStatistics(ioStats);
+  for (int kind = 0; kind < NUM_IO_KINDS; kind++) {
+    uint64_t *ioValues = &values[ResourceLogIOLatencyFileWriteCount +
+                                 kind * RESOURCE_LOG_IO_LATENCY_COLUMNS];
+    if (hasIOStats) {
+      ioValues[0] = ioStats[kind].count;
+      ioValues[1] = ioStats[kind].p50;
+      ioValues[2] = ioStats[kind].p99;
+      ioValues[3] = ioStats[kind].max;
+    } else {
+      for (int idx = 0; idx < RESOURCE_LOG_IO_LATENCY_COLUMNS; idx++) {
+        ioValues[idx] = RESOURCE_LOG_UNKNOWN_VALUE;
       }
     }
   }
 
-  return result;
+  return binaryLog->append(values, archivePath);
+}
+
+/*!
+ * \brief Switch resource log format.<br>
+ *        Caller must hold logMutex.
+ * \param isBinary [in] Binary resource log is used.
+ */
+void TLogManager::switchResourceLogFormat(bool isBinary) {
+  /* Binary resource log has columns from all sources. */
+  int sources = isBinary ? (PROC_SOURCE_FLAG(ProcSourceCount) - 1)
+                         : (PROC_SOURCE_FLAG(ProcSourceStat) |
+                            PROC_SOURCE_FLAG(ProcSourceSysStat));
+  try {
+    TProcSampler *newSampler = new TProcSampler(sources);
+    delete procSampler;
+    procSampler = newSampler;
+  } catch (...) {
+    /* Keep current sampler. Columns which are not sampled are unknown. */
+    logger->printWarnMsg("Could not create resource usage sampler.");
+  }
+  isBinarySampler = isBinary;
+
+  /* Close log file of previous format. */
+  if (resourceLogFd != -1) {
+    close(resourceLogFd);
+    resourceLogFd = -1;
+  }
+  delete binaryLog;
+  binaryLog = NULL;
 }
 
 /*!
@@ -308,70 +528,157 @@ int TLogManager::collectAllLog(jvmtiEnv *jvmti, JNIEnv *env, TInvokeCause cause,
   char *basePath = NULL;
   /* Archive file path. */
   char *uniqArcName = NULL;
+  /* Destination of artifacts. */
+  TArtifactSink *sink = NULL;
+  TZipArtifactSink *zipSink = NULL;
+  TDirArtifactSink *dirSink = NULL;
+  TDedupArtifactSink *dedupSink = NULL;
 
-  /* Make directory. */
-  result = createTempDir(&basePath, conf->LogDir()->get());
-  if (unlikely(result != 0)) {
-    logger->printWarnMsg("Failure create working directory.");
-    return result;
+  /*
+   * Artifacts are streamed into archive file directly. Working directory is
+   * used for custom archive_command, or if archive file cannot be created.
+   */
+  const char *archiveCommand = conf->ArchiveCommand()->get();
+  bool isCustomCommand = (archiveCommand != NULL) &&
+                         (archiveCommand[0] != '\0') &&
+                         (strcmp(archiveCommand, DEFAULT_ARCHIVE_COMMAND) != 0);
+  if (conf->ArchiveStreaming()->get() && !isCustomCommand) {
+    /* zipArchiver is used until the archive is finished. */
+    pthread_mutex_lock(&archiveMutex);
+
+    uniqArcName = createArchiveName(nowTime);
+    if (unlikely(uniqArcName == NULL)) {
+      logger->printWarnMsg("Failure create archive name.");
+    } else {
+      try {
+        zipSink = new TZipArtifactSink(zipArchiver, uniqArcName);
+        sink = zipSink;
+      } catch (...) {
+        logger->printWarnMsg("Could not stream artifacts to archive file.");
+      }
+    }
+
+    if (unlikely(zipSink == NULL)) {
+      free(uniqArcName);
+      uniqArcName = NULL;
+      pthread_mutex_unlock(&archiveMutex);
+    }
   }
 
-  try {
-    /* Create enviroment report file. */
-    result = makeEnvironFile(basePath, cause, nowTime, description);
+  if (sink == NULL) {
+    /* Make directory. */
+    result = createTempDir(&basePath, conf->LogDir()->get());
     if (unlikely(result != 0)) {
-      logger->printWarnMsg("Failure create enviroment file.");
+      logger->printWarnMsg("Failure create working directory.");
+      return result;
+    }
 
-      /* If raise disk full error. */
-      if (unlikely(isRaisedDiskFull(result))) {
-        throw 1;
+    try {
+      dirSink = new TDirArtifactSink(basePath);
+      sink = dirSink;
+    } catch (...) {
+      logger->printWarnMsg("Could not create artifact sink.");
+      removeTempDir(basePath);
+      free(basePath);
+      return ENOMEM;
+    }
+  }
+
+  /* Files which are not changed are referred by manifest. */
+  if (conf->ArchiveDedup()->get()) {
+    char *storeDir =
+        createFilename(conf->LogDir()->get(), ARTIFACT_STORE_DIRNAME);
+    if (likely(storeDir != NULL)) {
+      try {
+        dedupSink = new TDedupArtifactSink(
+            sink, storeDir,
+            (off_t)conf->ArchiveStoreSize()->get() * 1024 * 1024);
+        sink->release();
+        sink = dedupSink;
+      } catch (...) {
+        logger->printWarnMsg("Could not use artifact store.");
       }
+      free(storeDir);
     }
+  }
 
-    /* Copy many files. */
-    result = copyInfoFiles(basePath);
-    /* If raise disk full error. */
-    if (unlikely(isRaisedDiskFull(result))) {
-      throw 1;
+  /*
+   * Files of OS are collected by worker threads. Thread dump needs JNI, and
+   * environment file refers to arguments, so they are made on this thread
+   * meanwhile.
+   */
+  TArtifactCollector *collector = NULL;
+  try {
+    collector = new TArtifactCollector(sink);
+    collector->add("distribution release", &distributionFileTask, this);
+    collector->add("process information", &processFilesTask, this);
+    collector->add("system log", &systemLogTask, this);
+    collector->add("standard streams", &standardStreamsTask, this);
+    collector->add("GC log", &gcLogFileTask, this);
+    collector->add("socket owner", &socketOwnerFileTask, this);
+    collector->start(conf->ArchiveTimeout()->get() * 1000);
+  } catch (...) {
+    logger->printWarnMsg("Could not create artifact collector.");
+    if (collector != NULL) {
+      collector->release();
+      collector = NULL;
     }
+  }
 
-    /* Create thread dump file. */
-    result = makeThreadDumpFile(jvmti, env, basePath, cause, nowTime);
-    if (unlikely(result != 0)) {
-      logger->printWarnMsg("Failure thread dumping.");
+  /* Create thread dump file. */
+  int threadDumpResult = makeThreadDumpFile(jvmti, env, sink, cause, nowTime);
+  if (unlikely(threadDumpResult != 0)) {
+    logger->printWarnMsg("Failure thread dumping.");
+  }
 
-      /* If raise disk full error. */
-      if (unlikely(isRaisedDiskFull(result))) {
-        throw 1;
-      }
-    }
+  /* Create enviroment report file. */
+  int environResult = makeEnvironFile(sink, cause, nowTime, description);
+  if (unlikely(environResult != 0)) {
+    logger->printWarnMsg("Failure create enviroment file.");
+  }
 
-    /* Copy gc log file. */
-    result = copyGCLogFile(basePath);
-    if (unlikely(result != 0)) {
-      logger->printWarnMsgWithErrno("Could not copy GC log.");
+  /* Wait for other files. Unfinished files are recorded as skipped. */
+  if (likely(collector != NULL)) {
+    result = collector->wait();
+    keepCollector(collector);
+  }
 
-      /* If raise disk full error. */
-      if (unlikely(isRaisedDiskFull(result))) {
-        throw 1;
+  /* Manifest is stored after all deduplicated files. */
+  if (dedupSink != NULL) {
+    int manifestResult = dedupSink->writeManifest();
+    if (unlikely(manifestResult != 0)) {
+      errno = manifestResult;
+      logger->printWarnMsgWithErrno("Could not create artifact manifest.");
+      /* Archive is useless without manifest. */
+      if (result == 0) {
+        result = manifestResult;
       }
     }
 
-    /* Create socket owner file. */
-    result = makeSocketOwnerFile(basePath);
-    if (unlikely(result != 0)) {
-      logger->printWarnMsgWithErrno("Could not create socket owner file.");
-
-      /* If raise disk full error. */
-      if (unlikely(isRaisedDiskFull(result))) {
-        throw 1;
-      }
+    /* Artifact store is kept within the limit. */
+    int pruneResult = dedupSink->pruneStore();
+    if (unlikely(pruneResult != 0)) {
+      errno = pruneResult;
+      logger->printWarnMsgWithErrno("Could not prune artifact store.");
     }
-  } catch (...) {
-    ; /* Failed collect files by disk full. */
   }
 
-  if (likely(result == 0)) {
+  /* Failed collect files by disk full. */
+  if (unlikely(isRaisedDiskFull(threadDumpResult))) {
+    result = threadDumpResult;
+  } else if (unlikely(isRaisedDiskFull(environResult))) {
+    result = environResult;
+  }
+
+  if (zipSink != NULL) {
+    /* Archive file is removed if it is failed. */
+    result = zipSink->finish(result);
+    pthread_mutex_unlock(&archiveMutex);
+
+    if (unlikely(result != 0)) {
+      logger->printWarnMsg("Failure create archive file.");
+    }
+  } else if (likely(result == 0)) {
     /*
      * Set value mean failed to create archive,
      * For if failed to get "archiveMutex" mutex.
@@ -387,15 +694,29 @@ int TLogManager::collectAllLog(jvmtiEnv *jvmti, JNIEnv *env, TInvokeCause cause,
         /* Failure make archive uniq name. */
         logger->printWarnMsg("Failure create archive name.");
       } else {
-        /* Execute archive. */
-        arcMaker->setTarget(basePath);
-        result = arcMaker->doArchive(env, uniqArcName);
-
-        /* If failure create archive file. */
-        if (unlikely(result != 0)) {
-          /* Execute archive to use jniArchiver. */
-          jniArchiver->setTarget(basePath);
-          result = jniArchiver->doArchive(env, uniqArcName);
+        /*
+         * Forking archive command and allocating Java heap are likely to
+         * fail when resource is exhausted. So zipArchiver is tried first.
+         * It is also preferred when it can compress by multiple threads.
+         */
+        TArchiveMaker *archivers[3];
+        if ((cause == ResourceExhausted) || (cause == ThreadExhausted) ||
+            (conf->ArchiveThreads()->get() > 1)) {
+          archivers[0] = zipArchiver;
+          archivers[1] = arcMaker;
+        } else {
+          archivers[0] = arcMaker;
+          archivers[1] = zipArchiver;
+        }
+        archivers[2] = jniArchiver;
+
+        /* Execute archive. Next archiver is used if failure. */
+        for (int idx = 0; idx < 3; idx++) {
+          archivers[idx]->setTarget(basePath);
+          result = archivers[idx]->doArchive(env, uniqArcName);
+          if (likely(result == 0)) {
+            break;
+          }
         }
       }
     }
@@ -406,6 +727,18 @@ int TLogManager::collectAllLog(jvmtiEnv *jvmti, JNIEnv *env, TInvokeCause cause,
     }
   }
 
+  /*
+   * Working directory is needless if archive is created. It is removed
+   * after abandoned workers release it.
+   */
+  if (likely((result == 0) && (dirSink != NULL))) {
+    dirSink->removeOnRelease();
+  }
+  sink->release();
+
+  /* GC log in this archive is not collected again. */
+  commitGCLogPosition(result == 0);
+
   char *sendPath = uniqArcName;
   bool flagDirectory = false;
   /* If archive process is succeed. */
@@ -423,22 +756,20 @@ int TLogManager::collectAllLog(jvmtiEnv *jvmti, JNIEnv *env, TInvokeCause cause,
   } else {
     /* If failure execute command. */
 
-    /* Send working directory path to make up for archive file. */
+    /*
+     * Send working directory path to make up for archive file.
+     * Nothing is left if artifacts were streamed.
+     */
     sendPath = basePath;
     flagDirectory = true;
   }
 
   /* Send log archive trap. */
-  if (unlikely(!sendLogArchiveTrap(cause, nowTime, sendPath, flagDirectory))) {
+  if (likely(sendPath != NULL) &&
+      unlikely(!sendLogArchiveTrap(cause, nowTime, sendPath, flagDirectory))) {
     logger->printWarnMsg("Send SNMP log archive trap failed!");
   }
 
-  /* If execute command is succeed. */
-  if (likely(result == 0)) {
-    /* Remove needless working directory. */
-    removeTempDir(basePath);
-  }
-
   /* If allocated archive file path. */
   if (likely(uniqArcName != NULL)) {
     free(uniqArcName);
@@ -452,7 +783,7 @@ int TLogManager::collectAllLog(jvmtiEnv *jvmti, JNIEnv *env, TInvokeCause cause,
 
 /*!
  * \brief Create file about JVM running environment.
- * \param basePath [in] Path of directory put report file.
+ * \param sink     [in] Destination of artifacts.
  * \param cause    [in] Invoke function cause.<br>
  *                      E.g. Signal, ResourceExhausted, Interval.
  * \param nowTime  [in] Log collect time.
@@ -460,7 +791,7 @@ int TLogManager::collectAllLog(jvmtiEnv *jvmti, JNIEnv *env, TInvokeCause cause,
  * \return Value is zero, if process is succeed.<br />
  *         Value is error number a.k.a. "errno", if process is failure.
  */
-int TLogManager::makeEnvironFile(char *basePath, TInvokeCause cause,
+int TLogManager::makeEnvironFile(TArtifactSink *sink, TInvokeCause cause,
                                  TMSecTime nowTime, const char *description) {
   int raisedErrNum = 0;
 
@@ -481,25 +812,13 @@ int TLogManager::makeEnvironFile(char *basePath, TInvokeCause cause,
     logger->printWarnMsgWithErrno("Could not get glibc version.");
   }
 
-  /* Create filename. */
-  char *envInfoName = createFilename(basePath, "envInfo.txt");
-  /* If failure create file name. */
-  if (unlikely(envInfoName == NULL)) {
-    raisedErrNum = errno;
-    logger->printWarnMsgWithErrno(
-        "Could not allocate memory for envInfo.txt .");
-    return raisedErrNum;
-  }
-
   /* Create envInfo.txt. */
-  int fd = open(envInfoName, O_CREAT | O_WRONLY | O_EXCL, S_IRUSR | S_IWUSR);
+  int fd = sink->openEntry("envInfo.txt");
   if (unlikely(fd < 0)) {
     raisedErrNum = errno;
     logger->printWarnMsgWithErrno("Could not create envInfo.txt .");
-    free(envInfoName);
     return raisedErrNum;
   }
-  free(envInfoName);
 
   /* Output enviroment information. */
   try {
@@ -571,8 +890,10 @@ int TLogManager::makeEnvironFile(char *basePath, TInvokeCause cause,
   }
 
   /* Cleanup. */
-  if (unlikely(close(fd) < 0 && raisedErrNum == 0)) {
-    raisedErrNum = errno;
+  int closeResult = sink->closeEntry("envInfo.txt", fd);
+  if (unlikely(closeResult != 0 && raisedErrNum == 0)) {
+    raisedErrNum = closeResult;
+    errno = closeResult;
     logger->printWarnMsgWithErrno("Could not create environment file.");
   }
 
@@ -583,12 +904,13 @@ int TLogManager::makeEnvironFile(char *basePath, TInvokeCause cause,
  * \brief Dump thread and stack information to stream.
  * \param jvmti     [in] JVMTI environment object.
  * \param env       [in] JNI environment object.
- * \param fd        [in] Output file descriptor.
+ * \param writer    [in] Writer of thread dump.
  * \param stackInfo [in] Stack frame of java thread.
  * \return Value is zero, if process is succeed.<br />
  *         Value is error number a.k.a. "errno", if process is failure.
  */
-int TLogManager::dumpThreadInformation(jvmtiEnv *jvmti, JNIEnv *env, int fd,
+int TLogManager::dumpThreadInformation(jvmtiEnv *jvmti, JNIEnv *env,
+                                       TThreadDumpWriter *writer,
                                        jvmtiStackInfo stackInfo) {
   /* Get JVMTI capabilities for getting monitor information. */
   jvmtiCapabilities capabilities;
@@ -601,24 +923,24 @@ int TLogManager::dumpThreadInformation(jvmtiEnv *jvmti, JNIEnv *env, int fd,
   getThreadDetailInfo(jvmti, env, stackInfo.thread, &threadInfo);
 
   char const EMPTY_STR[] = "";
-  char lineBuf[PATH_MAX + 1] = {0};
 
   /* Output thread information. */
 
   try {
     /* Output thread name, thread type and priority. */
-    snprintf(lineBuf, PATH_MAX, "\"%s\"%s prio=%d\n",
-             ((threadInfo.name != NULL) ? threadInfo.name : EMPTY_STR),
-             ((threadInfo.isDaemon) ? " daemon" : EMPTY_STR),
-             threadInfo.priority);
-    if (unlikely(write(fd, lineBuf, strlen(lineBuf)) < 0)) {
+    errno = writer->print(
+        "\"%s\"%s prio=%d\n",
+        ((threadInfo.name != NULL) ? threadInfo.name : EMPTY_STR),
+        ((threadInfo.isDaemon) ? " daemon" : EMPTY_STR), threadInfo.priority);
+    if (unlikely(errno != 0)) {
       throw 1;
     }
 
     /* Output thread state. */
-    snprintf(lineBuf, PATH_MAX, "   java.lang.Thread.State: %s\n",
-             ((threadInfo.state != NULL) ? threadInfo.state : EMPTY_STR));
-    if (unlikely(write(fd, lineBuf, strlen(lineBuf)) < 0)) {
+    errno = writer->print(
+        "   java.lang.Thread.State: %s\n",
+        ((threadInfo.state != NULL) ? threadInfo.state : EMPTY_STR));
+    if (unlikely(errno != 0)) {
       throw 1;
     }
   } catch (...) {
@@ -652,40 +974,30 @@ int TLogManager::dumpThreadInformation(jvmtiEnv *jvmti, JNIEnv *env, int fd,
       jvmtiFrameInfo frameInfo = stackInfo.frame_buffer[flameIdx];
       TJavaStackMethodInfo methodInfo = {0};
 
-      /* Get method information. */
-      getMethodFrameInfo(jvmti, env, frameInfo, &methodInfo);
+      /* Get method information. Strings are owned by writer. */
+      writer->getFrameInfo(frameInfo, &methodInfo);
 
       /* Output method class, name and source file location. */
-
-      char *srcLocation = NULL;
-      if (!methodInfo.isNative) {
-        char locationBuf[PATH_MAX + 1] = {0};
-        if (likely(methodInfo.lineNumber >= 0)) {
-          snprintf(locationBuf, PATH_MAX, "%d", methodInfo.lineNumber);
-          srcLocation = strdup(locationBuf);
-        }
-
-        snprintf(locationBuf, PATH_MAX, "%s:%s",
-                 (methodInfo.sourceFile != NULL) ? methodInfo.sourceFile
-                                                 : "UnknownFile",
-                 (srcLocation != NULL) ? srcLocation : "UnknownLine");
-        free(srcLocation);
-        srcLocation = strdup(locationBuf);
+      const char *className = (methodInfo.className != NULL)
+                                  ? methodInfo.className
+                                  : "UnknownClass";
+      const char *methodName = (methodInfo.methodName != NULL)
+                                   ? methodInfo.methodName
+                                   : "UnknownMethod";
+      const char *sourceFile = (methodInfo.sourceFile != NULL)
+                                   ? methodInfo.sourceFile
+                                   : "UnknownFile";
+      if (methodInfo.isNative) {
+        errno = writer->print("\tat %s.%s(Native method)\n", className,
+                              methodName);
+      } else if (likely(methodInfo.lineNumber >= 0)) {
+        errno = writer->print("\tat %s.%s(%s:%d)\n", className, methodName,
+                              sourceFile, methodInfo.lineNumber);
+      } else {
+        errno = writer->print("\tat %s.%s(%s:UnknownLine)\n", className,
+                              methodName, sourceFile);
       }
-      snprintf(lineBuf, PATH_MAX, "\tat %s.%s(%s)\n",
-               (methodInfo.className != NULL) ? methodInfo.className
-                                              : "UnknownClass",
-               (methodInfo.methodName != NULL) ? methodInfo.methodName
-                                               : "UnknownMethod",
-               (srcLocation != NULL) ? srcLocation : "Native method");
-
-      /* Cleanup. */
-      free(methodInfo.className);
-      free(methodInfo.methodName);
-      free(methodInfo.sourceFile);
-      free(srcLocation);
-
-      if (unlikely(write(fd, lineBuf, strlen(lineBuf)) < 0)) {
+      if (unlikely(errno != 0)) {
         throw 1;
       }
 
@@ -734,9 +1046,9 @@ int TLogManager::dumpThreadInformation(jvmtiEnv *jvmti, JNIEnv *env, int fd,
           env->DeleteLocalRef(jMonitor);
 
           /* Output contented monitor information. */
-          snprintf(lineBuf, PATH_MAX, "\t- waiting to lock <owner:%s> (a %s)\n",
-                   ownerThreadName, monitorClsName);
-          if (unlikely(write(fd, lineBuf, strlen(lineBuf)) < 0)) {
+          errno = writer->print("\t- waiting to lock <owner:%s> (a %s)\n",
+                                ownerThreadName, monitorClsName);
+          if (unlikely(errno != 0)) {
             throw 1;
           }
         }
@@ -771,8 +1083,8 @@ int TLogManager::dumpThreadInformation(jvmtiEnv *jvmti, JNIEnv *env, int fd,
           }
 
           /* Output owned monitor information. */
-          snprintf(lineBuf, PATH_MAX, "\t- locked (a %s)\n", monitorClsName);
-          if (unlikely(write(fd, lineBuf, strlen(lineBuf)) < 0)) {
+          errno = writer->print("\t- locked (a %s)\n", monitorClsName);
+          if (unlikely(errno != 0)) {
             throw 1;
           }
         }
@@ -780,8 +1092,8 @@ int TLogManager::dumpThreadInformation(jvmtiEnv *jvmti, JNIEnv *env, int fd,
     }
 
     /* Output separator for each thread. */
-    snprintf(lineBuf, PATH_MAX, "\n");
-    if (unlikely(write(fd, lineBuf, strlen(lineBuf)) < 0)) {
+    errno = writer->print("\n");
+    if (unlikely(errno != 0)) {
       throw 1;
     }
   } catch (...) {
@@ -805,53 +1117,90 @@ int TLogManager::dumpThreadInformation(jvmtiEnv *jvmti, JNIEnv *env, int fd,
  * \brief Create thread dump with JVMTI.
  * \param jvmti    [in] JVMTI environment object.
  * \param env      [in] JNI environment object.
- * \param filename [in] Path of thread dump file.
+ * \param fd       [in] Output file descriptor.
  * \param nowTime  [in] Log collect time.
  * \return Value is zero, if process is succeed.<br />
  *         Value is error number a.k.a. "errno", if process is failure.
  */
-int TLogManager::makeJvmtiThreadDump(jvmtiEnv *jvmti, JNIEnv *env,
-                                     char *filename, TMSecTime nowTime) {
+int TLogManager::makeJvmtiThreadDump(jvmtiEnv *jvmti, JNIEnv *env, int fd,
+                                     TMSecTime nowTime) {
   int result = 0;
-  /* Open thread dump file. */
-  int fd = open(filename, O_CREAT | O_WRONLY | O_EXCL, S_IRUSR | S_IWUSR);
-  /* If failure open file. */
-  if (unlikely(fd < 0)) {
-    result = errno;
-    logger->printWarnMsgWithErrno("Could not create %s", filename);
-    return result;
-  }
 
   const jint MAX_STACK_COUNT = 100;
-  jvmtiStackInfo *stackList = NULL;
+  /* Stack traces are got in batches to keep each safepoint short. */
+  const jint THREAD_BATCH_COUNT = 256;
+
+  jthread *threadList = NULL;
   jint threadCount = 0;
-  /* If failure get all stack traces. */
-  if (unlikely(
-          isError(jvmti, jvmti->GetAllStackTraces(MAX_STACK_COUNT, &stackList,
-                                                  &threadCount)))) {
+  /* If failure get all threads. */
+  if (unlikely(isError(jvmti, jvmti->GetAllThreads(&threadCount,
+                                                   &threadList)))) {
     logger->printWarnMsg("Couldn't get thread stack trace.");
-    close(fd);
     return -1;
   }
 
+  TThreadDumpWriter *writer = NULL;
+  try {
+    writer = new TThreadDumpWriter(jvmti, env, fd);
+  } catch (...) {
+    logger->printWarnMsg("Could not create threaddump through JVMTI.");
+    result = ENOMEM;
+  }
+
   /* Output stack trace. */
-  for (jint i = 0; i < threadCount; i++) {
-    jvmtiStackInfo stackInfo = stackList[i];
+  for (jint top = 0; (result == 0) && (top < threadCount);
+       top += THREAD_BATCH_COUNT) {
+    jint batchCount = threadCount - top;
+    if (batchCount > THREAD_BATCH_COUNT) {
+      batchCount = THREAD_BATCH_COUNT;
+    }
 
-    /* Output thread information. */
-    result = dumpThreadInformation(jvmti, env, fd, stackInfo);
-    if (unlikely(result != 0)) {
+    jvmtiStackInfo *stackList = NULL;
+    if (unlikely(isError(jvmti, jvmti->GetThreadListStackTraces(
+                                    batchCount, &threadList[top],
+                                    MAX_STACK_COUNT, &stackList)))) {
+      logger->printWarnMsg("Couldn't get thread stack trace.");
+      result = -1;
       break;
     }
+
+    for (jint i = 0; i < batchCount; i++) {
+      jvmtiStackInfo stackInfo = stackList[i];
+
+      /* Thread which is terminated after GetAllThreads() is skipped. */
+      if (unlikely((stackInfo.state & JVMTI_THREAD_STATE_ALIVE) == 0)) {
+        continue;
+      }
+
+      /* Output thread information. */
+      result = dumpThreadInformation(jvmti, env, writer, stackInfo);
+      if (unlikely(result != 0)) {
+        break;
+      }
+    }
+
+    jvmti->Deallocate((unsigned char *)stackList);
   }
 
-  /* Cleanup. */
-  if (unlikely(close(fd) < 0 && result == 0)) {
-    result = errno;
-    logger->printWarnMsgWithErrno("Could not create threaddump through JVMTI.");
+  /* Output remaining data in buffer, even if dumping is failed. */
+  if (likely(writer != NULL)) {
+    int flushResult = writer->flush();
+    if (unlikely(flushResult != 0)) {
+      errno = flushResult;
+      logger->printWarnMsgWithErrno(
+          "Could not create threaddump through JVMTI.");
+      if (result == 0) {
+        result = flushResult;
+      }
+    }
+    delete writer;
   }
 
-  jvmti->Deallocate((unsigned char *)stackList);
+  /* Cleanup. */
+  for (jint i = 0; i < threadCount; i++) {
+    env->DeleteLocalRef(threadList[i]);
+  }
+  jvmti->Deallocate((unsigned char *)threadList);
 
   return result;
 }
@@ -860,7 +1209,7 @@ int TLogManager::makeJvmtiThreadDump(jvmtiEnv *jvmti, JNIEnv *env,
  * \brief Create thread dump file.
  * \param jvmti    [in] JVMTI environment object.
  * \param env      [in] JNI environment object.
- * \param basePath [in] Path of directory put report file.
+ * \param sink     [in] Destination of artifacts.
  * \param cause    [in] Invoke function cause.<br>
  *                      E.g. Signal, ResourceExhausted, Interval.
  * \param nowTime  [in] Log collect time.
@@ -868,166 +1217,53 @@ int TLogManager::makeJvmtiThreadDump(jvmtiEnv *jvmti, JNIEnv *env,
  *         Value is error number a.k.a. "errno", if process is failure.
  */
 int TLogManager::makeThreadDumpFile(jvmtiEnv *jvmti, JNIEnv *env,
-                                    char *basePath, TInvokeCause cause,
+                                    TArtifactSink *sink, TInvokeCause cause,
                                     TMSecTime nowTime) {
   /* Dump thread information. */
 
   int result = -1;
 
-  /* Create dump filename. */
-  char *dumpName = createFilename((char *)basePath, "threaddump.txt");
-  if (unlikely(dumpName == NULL)) {
-    logger->printWarnMsg("Couldn't allocate thread dump file path.");
-  } else {
-    if (unlikely(cause == ThreadExhausted && !jvmCmd->isConnectable())) {
-      /*
-       * JVM is aborted when reserve signal SIGQUIT,
-       * if JVM can't make new thread (e.g. RLIMIT_NPROC).
-       * So we need avoid to send SIGQUIT signal.
-       */
-      ;
-    } else {
-      /* Create thread dump file. */
-      result = jvmCmd->exec("threaddump", dumpName);
-    }
-
-    /* If disk isn't full. */
-    if (unlikely(!isRaisedDiskFull(result))) {
-      /* If need original thread dump. */
-      if (unlikely((result != 0) && (jvmti != NULL))) {
-        result = makeJvmtiThreadDump(jvmti, env, dumpName, nowTime);
-      }
-    }
-
-    free(dumpName);
-  }
-  return result;
-}
-
-/*!
- * \brief Getting java process information.
- * \param systime [out] System used cpu time in java process.
- * \param usrtime [out] User and java used cpu time in java process.
- * \param vmsize  [out] Virtual memory size of java process.
- * \param rssize  [out] Memory size of java process on main memory.
- * \return Prosess is succeed or failure.
- */
-bool TLogManager::getProcInfo(TLargeUInt *systime, TLargeUInt *usrtime,
-                              TLargeUInt *vmsize, TLargeUInt *rssize) {
-  /* Get page size. */
-  long pageSize = 0;
-  /* If failure get page size from sysconf. */
-  if (unlikely(systemPageSize <= 0)) {
-    /* Assume page size is 4 KiByte. */
-    systemPageSize = 1 << 12;
-    logger->printWarnMsg("System page size not found.");
-  }
-  /* Use sysconf return value. */
-  pageSize = systemPageSize;
-
-  /* Initialize. */
-  *usrtime = -1;
-  *systime = -1;
-  *vmsize = -1;
-  *rssize = -1;
-
-  /* Make path of process status file. */
-  char path[256] = {0};
-  snprintf(path, 255, "/proc/%d/stat", getpid());
-  /* Open process status file. */
-  FILE *proc = fopen(path, "r");
-
-  /* If failure open process status file. */
-  if (unlikely(proc == NULL)) {
-    logger->printWarnMsgWithErrno("Could not open process status.");
-    return false;
+  /* Create dump file. */
+  int fd = sink->openEntry("threaddump.txt");
+  if (unlikely(fd < 0)) {
+    result = errno;
+    logger->printWarnMsgWithErrno("Could not create threaddump.txt .");
+    return result;
   }
 
-  char *line = NULL;
-  size_t len = 0;
-  /* Get line from process status file. */
-  if (likely(getline(&line, &len, proc) > 0)) {
-    /* Parse line. */
-    if (likely(
-            sscanf(
-                line,
-                "%*d %*s %*c %*d %*d %*d %*d %*d %*u %*u"
-                " %*u %*u %*u %llu %llu %*d %*d %*d %*d %*d %*d %*u %llu %llu",
-                usrtime, systime, vmsize, rssize) == 4)) {
-      /* Convert real page count to real page size. */
-      *rssize = *rssize * pageSize;
-    } else {
-      /* Kernel may be old or customized. */
-      logger->printWarnMsg("Process data has shortage.");
-    }
+  if (unlikely(cause == ThreadExhausted && !jvmCmd->isConnectable())) {
+    /*
+     * JVM is aborted when reserve signal SIGQUIT,
+     * if JVM can't make new thread (e.g. RLIMIT_NPROC).
+     * So we need avoid to send SIGQUIT signal.
+     */
+    ;
   } else {
-    logger->printWarnMsg("Couldn't read process status.");
-  }
-
-  /* Cleanup. */
-  if (likely(line != NULL)) {
-    free(line);
-  }
-  fclose(proc);
-  return true;
-}
-
-/*!
- * \brief Getting machine cpu times.
- * \param times [out] Machine cpu times information.
- * \return Prosess is succeed or failure.
- */
-bool TLogManager::getSysTimes(TMachineTimes *times) {
-  /* Initialize. */
-  memset(times, 0, sizeof(TMachineTimes));
-
-  /* Open machine status file. */
-  FILE *proc = fopen("/proc/stat", "r");
-  /* If failure open machine status file. */
-  if (unlikely(proc == NULL)) {
-    logger->printWarnMsgWithErrno("Could not open /proc/stat");
-    return false;
+    /* Create thread dump file. */
+    result = jvmCmd->exec("threaddump", fd);
   }
 
-  char *line = NULL;
-  size_t len = 0;
-  bool flagFound = false;
-
-  /* Loop for find "cpu" line. */
-  while (likely(getline(&line, &len, proc) > 0)) {
-    /* Check line. */
-    if (unlikely(strncmp(line, "cpu ", 4) != 0)) {
-      /* This line is non-target. */
-      continue;
-    }
-
-    /* Parse cpu time information. */
-    if (unlikely(sscanf(line,
-                        "cpu %llu %llu %llu %llu %llu %llu %llu %llu %llu",
-                        &times->usrTime, &times->lowUsrTime, &times->sysTime,
-                        &times->idleTime, &times->iowaitTime,
-                        &times->sortIrqTime, &times->irqTime, &times->stealTime,
-                        &times->guestTime) != 9)) {
-      /* Maybe the kernel is old version. */
-      logger->printWarnMsg("CPU status data has shortage.");
+  /* If disk isn't full. */
+  if (unlikely(!isRaisedDiskFull(result))) {
+    /* If need original thread dump. */
+    if (unlikely((result != 0) && (jvmti != NULL))) {
+      /* Discard response which might be written partially. */
+      if (likely((ftruncate(fd, 0) == 0) && (lseek(fd, 0, SEEK_SET) == 0))) {
+        result = makeJvmtiThreadDump(jvmti, env, fd, nowTime);
+      }
     }
-
-    flagFound = true;
-    break;
   }
 
-  /* If not found cpu information. */
-  if (unlikely(!flagFound)) {
-    /* Maybe the kernel is modified. */
-    logger->printWarnMsg("Not found cpu status data.");
+  int closeResult = sink->closeEntry("threaddump.txt", fd);
+  if (unlikely(closeResult != 0)) {
+    errno = closeResult;
+    logger->printWarnMsgWithErrno("Could not create threaddump.txt .");
+    if (result == 0) {
+      result = closeResult;
+    }
   }
 
-  /* Cleanup. */
-  if (likely(line != NULL)) {
-    free(line);
-  }
-  fclose(proc);
-  return flagFound;
+  return result;
 }
 
 /*!
@@ -1114,12 +1350,12 @@ bool TLogManager::sendLogArchiveTrap(TInvokeCause cause, TMSecTime nowTime,
 }
 
 /*!
- * \brief Collect files about JVM enviroment.
- * \param basePath [in] Temporary working directory.
+ * \brief Copy distribution release file.
+ * \param sink [in] Destination of artifacts.
  * \return Value is zero, if process is succeed.<br />
  *         Value is error number a.k.a. "errno", if process is failure.
  */
-int TLogManager::copyInfoFiles(char const *basePath) {
+int TLogManager::copyDistributionFile(TArtifactSink *sink) {
   int result = 0;
 
   /* Copy distribution file list. */
@@ -1143,7 +1379,7 @@ int TLogManager::copyInfoFiles(char const *basePath) {
 
   /* Copy distribution file. */
   for (int i = 0; strlen(distFileList[i]) > 0; i++) {
-    result = copyFile(distFileList[i], basePath);
+    result = sink->copyFile(distFileList[i]);
 
     if ((result == 0) || isRaisedDiskFull(result)) {
       flagCopyedDistFile = (result == 0);
@@ -1156,10 +1392,17 @@ int TLogManager::copyInfoFiles(char const *basePath) {
     logger->printWarnMsgWithErrno("Could not copy distribution release file.");
   }
 
-  /* If disk is full. */
-  if (unlikely(isRaisedDiskFull(result))) {
-    return result;
-  }
+  return result;
+}
+
+/*!
+ * \brief Copy process and network information files in procfs.
+ * \param sink [in] Destination of artifacts.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TLogManager::copyProcessFiles(TArtifactSink *sink) {
+  int result = 0;
 
   /* Copy file list. */
   const char copyFileList[][255] = {/* Process information. */
@@ -1178,7 +1421,7 @@ int TLogManager::copyInfoFiles(char const *basePath) {
   /* Copy files in list. */
   for (int i = 0; strlen(copyFileList[i]) > 0; i++) {
     /* Copy file. */
-    result = copyFile(copyFileList[i], basePath);
+    result = sink->copyFile(copyFileList[i]);
     if (unlikely(result != 0)) {
       logger->printWarnMsg("Could not copy file: %s", copyFileList[i]);
 
@@ -1189,13 +1432,25 @@ int TLogManager::copyInfoFiles(char const *basePath) {
     }
   }
 
+  return result;
+}
+
+/*!
+ * \brief Copy syslog, or collect systemd-journald log.
+ * \param sink [in] Destination of artifacts.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TLogManager::copySystemLog(TArtifactSink *sink) {
+  int result = 0;
+
   /* Collect Syslog or Systemd-Journald */
   /*
    * Try to copy syslog at first, because journal daemon will forward all
    * received
    * log messages to a traditional syslog by default.
    */
-  result = copyFile("/var/log/messages", basePath);
+  result = sink->copyFile("/var/log/messages");
   if (unlikely(result != 0)) {
     errno = result;
     logger->printWarnMsgWithErrno("Could not copy /var/log/messages");
@@ -1214,24 +1469,24 @@ int TLogManager::copyInfoFiles(char const *basePath) {
      * function
      * does not copy but shares all memory with its parent, including the stack.
      */
+    int pipeFd[2];
+    if (unlikely(pipe2(pipeFd, O_CLOEXEC) != 0)) {
+      result = errno;
+      logger->printWarnMsgWithErrno(
+          "Could not collect systemd-journald log by pipe().");
+      return result;
+    }
+
     pid_t child = vfork();
     if (child == 0) {
       /* Child process */
-      /* logfile name shows what command is used to output it.*/
-      char logfile[PATH_MAX];
-      sprintf(logfile, "%s%s", basePath,
-              "/journalctl_-q_--all_--this-boot_--no-pager_-o_verbose.log");
-      /* Redirect child process' stdout/stderr to logfile */
-      int fd = open(logfile, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
-      if (dup2(fd, 1) < 0) {
-        close(fd);
+      /* Redirect child process' stdout/stderr to pipe */
+      if (dup2(pipeFd[1], 1) < 0) {
         _exit(errno);
       }
-      if (dup2(fd, 2) < 0) {
-        close(fd);
+      if (dup2(pipeFd[1], 2) < 0) {
         _exit(errno);
       }
-      close(fd);
       /* Use execve() for journalctl to prevent command injection */
       const char *argv[] = {"journalctl", "-q", "--all",   "--this-boot",
                             "--no-pager", "-o", "verbose", NULL};
@@ -1244,8 +1499,19 @@ int TLogManager::copyInfoFiles(char const *basePath) {
       result = errno;
       logger->printWarnMsgWithErrno(
           "Could not collect systemd-journald log by vfork().");
+      close(pipeFd[0]);
+      close(pipeFd[1]);
     } else {
       /* Parent process */
+      close(pipeFd[1]);
+
+      /* Artifact name shows what command is used to output it. */
+      int streamResult = sink->addStream(
+          "journalctl_-q_--all_--this-boot_--no-pager_-o_verbose.log",
+          pipeFd[0]);
+      /* journalctl is terminated by SIGPIPE if the stream is aborted. */
+      close(pipeFd[0]);
+
       int status;
       if (waitpid(child, &status, 0) < 0) {
         /* The child process failed. */
@@ -1257,7 +1523,12 @@ int TLogManager::copyInfoFiles(char const *basePath) {
           return result;
         }
       }
-      if (WIFEXITED(status)) {
+      if (unlikely(streamResult != 0)) {
+        result = streamResult;
+        errno = streamResult;
+        logger->printWarnMsgWithErrno(
+            "Could not store systemd-journald log.");
+      } else if (WIFEXITED(status)) {
         /* The child exited normally, get the returns as result. */
         result = WEXITSTATUS(status);
         if (result != 0) {
@@ -1272,6 +1543,18 @@ int TLogManager::copyInfoFiles(char const *basePath) {
     }
   }
 
+  return result;
+}
+
+/*!
+ * \brief Copy files of stdout and stderr.
+ * \param sink [in] Destination of artifacts.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TLogManager::copyStandardStreams(TArtifactSink *sink) {
+  int result = 0;
+
   /* Copy file descriptors, i.e. stdout and stderr, as avoid double work. */
   const int fdNum = 2;
   const char streamList[fdNum][255] = {/* Standard streams */
@@ -1294,7 +1577,7 @@ int TLogManager::copyInfoFiles(char const *basePath) {
        * file again. */
       break;
     } else {
-      result = copyFile(streamList[i], basePath, fdFile[i]);
+      result = sink->copyFile(streamList[i], fdFile[i]);
     }
 
     /* If catch a failure during the copy process, show warn messages. */
@@ -1314,11 +1597,11 @@ int TLogManager::copyInfoFiles(char const *basePath) {
 
 /*!
  * \brief Copy GC log file.
- * \param basePath [in] Path of temporary directory.
+ * \param sink [in] Destination of artifacts.
  * \return Value is zero, if process is succeed.<br />
  *         Value is error number a.k.a. "errno", if process is failure.
  */
-int TLogManager::copyGCLogFile(char const *basePath) {
+int TLogManager::copyGCLogFile(TArtifactSink *sink) {
   char *aGCLogFile = (*gcLogFilename);
 
   /* If GC log filename isn't specified. */
@@ -1326,31 +1609,366 @@ int TLogManager::copyGCLogFile(char const *basePath) {
     return 0;
   }
 
-  /* Copy file. */
-  return copyFile(aGCLogFile, basePath);
+  TGCLogPosition archived;
+  unsigned int archiveSeq;
+  {
+    TMutexLocker locker(&gcLogMutex);
+    archived = gcLogArchived;
+    archiveSeq = gcLogArchiveSeq;
+  }
+
+  char *currentFile = NULL;
+  char *rotatedFile = NULL;
+  int result =
+      findGCLogFiles(aGCLogFile, &archived, &currentFile, &rotatedFile);
+  if (unlikely(result != 0)) {
+    return result;
+  }
+
+  /* Rest of GC log file which was rotated after the last archive. */
+  if (rotatedFile != NULL) {
+    result = copyGCLogTail(sink, rotatedFile, &archived, NULL);
+    free(rotatedFile);
+
+    if (unlikely(result != 0)) {
+      errno = result;
+      logger->printWarnMsgWithErrno("Could not copy rotated GC log.");
+      /* If disk is full. */
+      if (unlikely(isRaisedDiskFull(result))) {
+        free(currentFile);
+        return result;
+      }
+    }
+  }
+
+  TGCLogPosition collected;
+  result = copyGCLogTail(sink, currentFile, &archived, &collected);
+  free(currentFile);
+
+  if (likely(result == 0)) {
+    TMutexLocker locker(&gcLogMutex);
+
+    /* Task which is abandoned by the archive must not publish position. */
+    if (likely(archiveSeq == gcLogArchiveSeq)) {
+      gcLogCollected = collected;
+      isGCLogCollected = true;
+    }
+  }
+
+  return result;
 }
 
 /*!
- * \brief Create file about using socket by JVM.
- * \param basePath [in] Path of directory put report file.
+ * \brief Find GC log file which is written now, and GC log file which
+ *        was stored in the last archive if it has been rotated.
+ * \param gcLogFile   [in]  Path of GC log file in the option.
+ * \param archived    [in]  Part of GC log in the last archive.
+ * \param currentFile [out] Path of GC log file which is written now.
+ * \param rotatedFile [out] Path of rotated GC log file, or null.
  * \return Value is zero, if process is succeed.<br />
  *         Value is error number a.k.a. "errno", if process is failure.
  */
-int TLogManager::makeSocketOwnerFile(char const *basePath) {
+int TLogManager::findGCLogFiles(char const *gcLogFile,
+                                TGCLogPosition *archived, char **currentFile,
+                                char **rotatedFile) {
+  *currentFile = NULL;
+  *rotatedFile = NULL;
+
+  /* GC log file is not rotated by JVM. */
+  struct stat st;
+  if (stat(gcLogFile, &st) == 0) {
+    *currentFile = strdup(gcLogFile);
+    if (unlikely(*currentFile == NULL)) {
+      return ENOMEM;
+    }
+
+    /* Archived file is not rotated by others. */
+    if ((archived->offset == 0) ||
+        ((st.st_dev == archived->dev) && (st.st_ino == archived->ino))) {
+      return 0;
+    }
+  }
+
+  /*
+   * With -XX:+UseGCLogFileRotation, JVM writes "<file>.<n>.current", and
+   * renames it to "<file>.<n>" when it is rotated. Archived file is found
+   * by its inode, because it might be renamed.
+   */
+  char *dirPath = getParentDirectoryPath(gcLogFile);
+  if (unlikely(dirPath == NULL)) {
+    free(*currentFile);
+    *currentFile = NULL;
+    return ENOMEM;
+  }
+
+  char const *baseName = strrchr(gcLogFile, '/');
+  baseName = (baseName == NULL) ? gcLogFile : baseName + 1;
+  size_t baseLen = strlen(baseName);
+  size_t suffixLen = strlen(GCLOG_CURRENT_SUFFIX);
+
+  DIR *dir = opendir(dirPath);
+  if (unlikely(dir == NULL)) {
+    int result = errno;
+    free(dirPath);
+    free(*currentFile);
+    *currentFile = NULL;
+    return result;
+  }
+
+  /*
+   * Files of previous JVM might be left as "*.current". The file which is
+   * opened by this process is current, or the newest one is used.
+   */
+  bool findCurrent = (*currentFile == NULL);
+  bool isCurrentOpened = false;
+  bool isCurrentArchived = false;
+  time_t currentMTime = 0;
+
   int result = 0;
+  struct dirent *entry;
+  while ((result == 0) && ((entry = readdir(dir)) != NULL)) {
+    size_t nameLen = strlen(entry->d_name);
+    if ((nameLen <= baseLen) ||
+        (strncmp(entry->d_name, baseName, baseLen) != 0) ||
+        (entry->d_name[baseLen] != '.')) {
+      continue;
+    }
 
-  /* Create filename. */
-  char *sockOwnName = createFilename(basePath, "sockowner");
-  /* If failure create file name. */
-  if (unlikely(sockOwnName == NULL)) {
-    result = errno;
-    logger->printWarnMsg("Couldn't allocate filename.");
+    char *path = createFilename(dirPath, entry->d_name);
+    if (unlikely(path == NULL)) {
+      result = ENOMEM;
+      break;
+    }
+
+    if ((stat(path, &st) != 0) || !S_ISREG(st.st_mode)) {
+      free(path);
+      continue;
+    }
+
+    bool isArchived = (archived->offset > 0) && (st.st_dev == archived->dev) &&
+                      (st.st_ino == archived->ino);
+    bool isCurrent =
+        (nameLen > suffixLen) &&
+        (strcmp(entry->d_name + nameLen - suffixLen, GCLOG_CURRENT_SUFFIX) ==
+         0);
+
+    bool isOpened = findCurrent && isCurrent &&
+                    isOpenedFile(st.st_dev, st.st_ino);
+    if (findCurrent && isCurrent &&
+        ((*currentFile == NULL) || (isOpened && !isCurrentOpened) ||
+         ((isOpened == isCurrentOpened) && (st.st_mtime > currentMTime)))) {
+      /* Replaced file is treated as rotated one. */
+      if (isCurrentArchived && (*rotatedFile == NULL)) {
+        *rotatedFile = *currentFile;
+      } else {
+        free(*currentFile);
+      }
+      *currentFile = path;
+      isCurrentArchived = isArchived;
+      isCurrentOpened = isOpened;
+      currentMTime = st.st_mtime;
+    } else if ((*rotatedFile == NULL) && isArchived) {
+      *rotatedFile = path;
+    } else {
+      free(path);
+    }
+  }
+  closedir(dir);
+  free(dirPath);
+
+  /* Archived file is written still. */
+  if ((*currentFile != NULL) && (*rotatedFile != NULL) &&
+      (stat(*currentFile, &st) == 0) && (st.st_dev == archived->dev) &&
+      (st.st_ino == archived->ino)) {
+    free(*rotatedFile);
+    *rotatedFile = NULL;
+  }
+
+  if (likely(result == 0) && unlikely(*currentFile == NULL)) {
+    result = ENOENT;
+  }
+
+  if (unlikely(result != 0)) {
+    free(*currentFile);
+    free(*rotatedFile);
+    *currentFile = NULL;
+    *rotatedFile = NULL;
+  }
+
+  return result;
+}
+
+/*!
+ * \brief Copy data of GC log file which is not in the last archive.
+ * \param sink      [in]  Destination of artifacts.
+ * \param path      [in]  Path of GC log file.
+ * \param archived  [in]  Part of GC log in the last archive.
+ * \param collected [out] Part of GC log which is collected. It can be null.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TLogManager::copyGCLogTail(TArtifactSink *sink, char const *path,
+                               TGCLogPosition *archived,
+                               TGCLogPosition *collected) {
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (unlikely(fd < 0)) {
+    return errno;
+  }
+
+  struct stat st;
+  if (unlikely(fstat(fd, &st) != 0)) {
+    int result = errno;
+    close(fd);
     return result;
   }
 
+  /*
+   * Archived data is skipped if the file is the same one and is not
+   * truncated or rewritten after the last archive.
+   */
+  off_t offset = 0;
+  if ((archived->offset > 0) && (st.st_dev == archived->dev) &&
+      (st.st_ino == archived->ino) && (st.st_size >= archived->offset)) {
+    uint32_t checksum;
+    if ((getGCLogChecksum(fd, archived->offset, &checksum) == 0) &&
+        (checksum == archived->checksum)) {
+      offset = archived->offset;
+    } else {
+      logger->printDebugMsg("GC log was rewritten. Whole file is copied.");
+    }
+  }
+
+  /* Name shows offset of data, if it is a part of GC log. */
+  char const *baseName = strrchr(path, '/');
+  baseName = (baseName == NULL) ? path : baseName + 1;
+  char name[PATH_MAX];
+  if (offset == 0) {
+    snprintf(name, PATH_MAX, "%s", baseName);
+  } else {
+    snprintf(name, PATH_MAX, "%s.from_%lld", baseName, (long long)offset);
+  }
+
+  off_t size = 0;
+  int result = sink->copyFileTail(name, fd, offset, &size);
+  if (likely(result == 0) && (collected != NULL)) {
+    collected->dev = st.st_dev;
+    collected->ino = st.st_ino;
+    collected->offset = offset + size;
+    result = getGCLogChecksum(fd, collected->offset, &collected->checksum);
+  }
+  close(fd);
+
+  return result;
+}
+
+/*!
+ * \brief Calculate checksum of GC log data just before the offset.
+ * \param fd       [in]  File descriptor of GC log file.
+ * \param offset   [in]  End of data.
+ * \param checksum [out] CRC-32 of data.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TLogManager::getGCLogChecksum(int fd, off_t offset, uint32_t *checksum) {
+  unsigned char buf[GCLOG_CHECKSUM_SIZE];
+  off_t start = (offset > GCLOG_CHECKSUM_SIZE) ? offset - GCLOG_CHECKSUM_SIZE
+                                               : 0;
+  size_t len = (size_t)(offset - start);
+
+  size_t readLen = 0;
+  while (readLen < len) {
+    ssize_t readSize = pread(fd, buf + readLen, len - readLen,
+                             start + readLen);
+    if (unlikely(readSize < 0)) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return errno;
+    } else if (unlikely(readSize == 0)) {
+      /* File is truncated. */
+      return EIO;
+    }
+
+    readLen += readSize;
+  }
+
+  *checksum = crc32(crc32(0L, Z_NULL, 0), buf, (uInt)len);
+  return 0;
+}
+
+/*!
+ * \brief Remember part of GC log which is collected, if log archive is
+ *        made. The next archive has only data after it.
+ * \param isArchived [in] Log archive is made.
+ */
+void TLogManager::commitGCLogPosition(bool isArchived) {
+  TMutexLocker locker(&gcLogMutex);
+
+  if (isArchived && isGCLogCollected) {
+    gcLogArchived = gcLogCollected;
+  }
+  isGCLogCollected = false;
+  gcLogArchiveSeq++;
+}
+
+/*!
+ * \brief Release artifact collector after wait().<br>
+ *        If its workers are abandoned, it is kept until they exit.
+ * \param collector [in] Artifact collector.
+ */
+void TLogManager::keepCollector(TArtifactCollector *collector) {
+  /* Collectors of previous archives are released if workers exited. */
+  releaseCollectors(false);
+
+  if (likely(!collector->hasRunningWorkers())) {
+    collector->release();
+    return;
+  }
+
+  try {
+    TMutexLocker locker(&collectorMutex);
+    abandonedCollectors.push_back(collector);
+  } catch (...) {
+    /* Workers have been rejected by sink, so they stop soon. */
+    collector->join();
+    collector->release();
+  }
+}
+
+/*!
+ * \brief Release abandoned artifact collectors.
+ * \param isJoin [in] Wait for running workers.<br>
+ *                    Collectors which have running workers are kept if false.
+ */
+void TLogManager::releaseCollectors(bool isJoin) {
+  TMutexLocker locker(&collectorMutex);
+
+  std::vector<TArtifactCollector *>::iterator itr =
+      abandonedCollectors.begin();
+  while (itr != abandonedCollectors.end()) {
+    if (isJoin) {
+      (*itr)->join();
+    } else if ((*itr)->hasRunningWorkers()) {
+      ++itr;
+      continue;
+    }
+
+    (*itr)->release();
+    itr = abandonedCollectors.erase(itr);
+  }
+}
+
+/*!
+ * \brief Create file about using socket by JVM.
+ * \param sink [in] Destination of artifacts.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TLogManager::makeSocketOwnerFile(TArtifactSink *sink) {
+  int result = 0;
+
   /* Create sockowner. */
-  int fd = open(sockOwnName, O_CREAT | O_WRONLY | O_EXCL, S_IRUSR | S_IWUSR);
-  free(sockOwnName);
+  int fd = sink->openEntry("sockowner");
   if (unlikely(fd < 0)) {
     result = errno;
     logger->printWarnMsgWithErrno("Could not open socket owner file.");
@@ -1365,7 +1983,7 @@ int TLogManager::makeSocketOwnerFile(char const *basePath) {
   if (unlikely(dir == NULL)) {
     result = errno;
     logger->printWarnMsgWithErrno("Could not open directory: /proc/self/fd");
-    close(fd);
+    sink->closeEntry("sockowner", fd);
     return result;
   }
 
@@ -1407,8 +2025,10 @@ int TLogManager::makeSocketOwnerFile(char const *basePath) {
   }
 
   /* If failure in read directory. */
-  if (unlikely(close(fd) != 0 && result == 0)) {
-    result = errno;
+  int closeResult = sink->closeEntry("sockowner", fd);
+  if (unlikely(closeResult != 0 && result == 0)) {
+    result = closeResult;
+    errno = closeResult;
     logger->printWarnMsgWithErrno("Could not close socket owner.");
   }
 
@@ -1418,6 +2038,84 @@ int TLogManager::makeSocketOwnerFile(char const *basePath) {
   return result;
 }
 
+/*!
+ * \brief Task of TArtifactCollector to copy distribution release file.
+ * \param data [in] TLogManager object.
+ * \param sink [in] Destination of artifacts.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TLogManager::distributionFileTask(void *data, TArtifactSink *sink) {
+  return ((TLogManager *)data)->copyDistributionFile(sink);
+}
+
+/*!
+ * \brief Task of TArtifactCollector to copy files in procfs.
+ * \param data [in] TLogManager object.
+ * \param sink [in] Destination of artifacts.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TLogManager::processFilesTask(void *data, TArtifactSink *sink) {
+  return ((TLogManager *)data)->copyProcessFiles(sink);
+}
+
+/*!
+ * \brief Task of TArtifactCollector to collect system log.
+ * \param data [in] TLogManager object.
+ * \param sink [in] Destination of artifacts.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TLogManager::systemLogTask(void *data, TArtifactSink *sink) {
+  return ((TLogManager *)data)->copySystemLog(sink);
+}
+
+/*!
+ * \brief Task of TArtifactCollector to copy stdout and stderr.
+ * \param data [in] TLogManager object.
+ * \param sink [in] Destination of artifacts.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TLogManager::standardStreamsTask(void *data, TArtifactSink *sink) {
+  return ((TLogManager *)data)->copyStandardStreams(sink);
+}
+
+/*!
+ * \brief Task of TArtifactCollector to copy GC log file.
+ * \param data [in] TLogManager object.
+ * \param sink [in] Destination of artifacts.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TLogManager::gcLogFileTask(void *data, TArtifactSink *sink) {
+  int result = ((TLogManager *)data)->copyGCLogFile(sink);
+  if (unlikely(result != 0)) {
+    errno = result;
+    logger->printWarnMsgWithErrno("Could not copy GC log.");
+  }
+
+  return result;
+}
+
+/*!
+ * \brief Task of TArtifactCollector to create socket owner file.
+ * \param data [in] TLogManager object.
+ * \param sink [in] Destination of artifacts.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TLogManager::socketOwnerFileTask(void *data, TArtifactSink *sink) {
+  int result = ((TLogManager *)data)->makeSocketOwnerFile(sink);
+  if (unlikely(result != 0)) {
+    errno = result;
+    logger->printWarnMsgWithErrno("Could not create socket owner file.");
+  }
+
+  return result;
+}
+
 /*!
  * \brief Create archive file path.
  * \param nowTime [in] Log collect time.
@@ -23,27 +23,29 @@
 #define _LOG_MANAGER_H
 
 #include <queue>
+#include <vector>
 
+#include "artifactCollector.hpp"
+#include "artifactSink.hpp"
 #include "cmdArchiver.hpp"
 #include "jniZipArchiver.hpp"
 #include "jvmSockCmd.hpp"
 #include "jvmInfo.hpp"
+#include "procSampler.hpp"
+#include "resourceLogWriter.hpp"
+#include "threadDumpWriter.hpp"
 #include "util.hpp"
+#include "zipArchiver.hpp"
 
 /*!
- * \brief This structure is used to get and store machine cpu time.
+ * \brief Part of GC log file which is stored in log archive.
  */
 typedef struct {
-  TLargeUInt usrTime;     /*!< Time used by user work.                     */
-  TLargeUInt lowUsrTime;  /*!< Time used by user work under low priority.  */
-  TLargeUInt sysTime;     /*!< Time used by kernel work.                   */
-  TLargeUInt idleTime;    /*!< Time used by waiting task work.             */
-  TLargeUInt iowaitTime;  /*!< Time used by waiting IO work.               */
-  TLargeUInt sortIrqTime; /*!< Time used by sort intercept work.           */
-  TLargeUInt irqTime;     /*!< Time used by intercept work.                */
-  TLargeUInt stealTime;   /*!< Time used by other OS.                      */
-  TLargeUInt guestTime;   /*!< Time used by guest OS under kernel control. */
-} TMachineTimes;
+  dev_t dev;         /*!< Device of GC log file.                  */
+  ino_t ino;         /*!< Inode of GC log file.                   */
+  off_t offset;      /*!< End of data which is stored.            */
+  uint32_t checksum; /*!< CRC-32 of data just before the offset.  */
+} TGCLogPosition;
 
 /*!
  * \brief This class collect and make log.
@@ -110,7 +112,7 @@ class TLogManager {
 
   /*!
    * \brief Create file about JVM running environment.
-   * \param basePath [in] Path of directory put report file.
+   * \param sink     [in] Destination of artifacts.
    * \param cause    [in] Invoke function cause.<br>
    *                      E.g. Signal, ResourceExhausted, Interval.
    * \param nowTime  [in] Log collect time.
@@ -118,64 +120,79 @@ class TLogManager {
    * \return Value is zero, if process is succeed.<br />
    *         Value is error number a.k.a. "errno", if process is failure.
    */
-  virtual int makeEnvironFile(char *basePath, TInvokeCause cause,
+  virtual int makeEnvironFile(TArtifactSink *sink, TInvokeCause cause,
                               TMSecTime nowTime, const char *description);
 
   /*!
    * \brief Dump thread and stack information to stream.
    * \param jvmti     [in] JVMTI environment object.
    * \param env       [in] JNI environment object.
-   * \param fd        [in] Output file descriptor.
+   * \param writer    [in] Writer of thread dump.
    * \param stackInfo [in] Stack frame of java thread.
    * \return Value is zero, if process is succeed.<br />
    *         Value is error number a.k.a. "errno", if process is failure.
    */
-  virtual int dumpThreadInformation(jvmtiEnv *jvmti, JNIEnv *env, int fd,
+  virtual int dumpThreadInformation(jvmtiEnv *jvmti, JNIEnv *env,
+                                    TThreadDumpWriter *writer,
                                     jvmtiStackInfo stackInfo);
 
   /*!
    * \brief Create thread dump with JVMTI.
    * \param jvmti    [in] JVMTI environment object.
    * \param env      [in] JNI environment object.
-   * \param filename [in] Path of thread dump file.
+   * \param fd       [in] Output file descriptor.
    * \param nowTime  [in] Log collect time.
    * \return Value is zero, if process is succeed.<br />
    *         Value is error number a.k.a. "errno", if process is failure.
    */
-  virtual int makeJvmtiThreadDump(jvmtiEnv *jvmti, JNIEnv *env, char *filename,
+  virtual int makeJvmtiThreadDump(jvmtiEnv *jvmti, JNIEnv *env, int fd,
                                   TMSecTime nowTime);
 
   /*!
    * \brief Create thread dump file.
    * \param jvmti    [in] JVMTI environment object.
    * \param env      [in] JNI environment object.
-   * \param basePath [in] Path of directory put report file.
+   * \param sink     [in] Destination of artifacts.
    * \param cause    [in] Invoke function cause.<br>
    *                      E.g. Signal, ResourceExhausted, Interval.
    * \param nowTime  [in] Log collect time.
    * \return Value is zero, if process is succeed.<br />
    *         Value is error number a.k.a. "errno", if process is failure.
    */
-  virtual int makeThreadDumpFile(jvmtiEnv *jvmti, JNIEnv *env, char *basePath,
-                                 TInvokeCause cause, TMSecTime nowTime);
+  virtual int makeThreadDumpFile(jvmtiEnv *jvmti, JNIEnv *env,
+                                 TArtifactSink *sink, TInvokeCause cause,
+                                 TMSecTime nowTime);
 
   /*!
-   * \brief Getting java process information.
-   * \param systime [out] System used cpu time in java process.
-   * \param usrtime [out] User and java used cpu time in java process.
-   * \param vmsize  [out] Virtual memory size of java process.
-   * \param rssize  [out] Memory size of java process on main memory.
-   * \return Prosess is succeed or failure.
+   * \brief Write line to resource log file.<br>
+   *        Log file is kept open while its path is not changed.
+   *        Caller must hold logMutex.
+   * \param line [in] Line to write.
+   * \param len  [in] Length of line.
+   * \return Value is zero, if process is succeed.<br />
+   *         Value is error number a.k.a. "errno", if process is failure.
+   */
+  virtual int writeResourceLog(const char *line, size_t len);
+
+  /*!
+   * \brief Write row to binary resource log file.<br>
+   *        Caller must hold logMutex.
+   * \param sample      [in] Resource usage of java process.
+   * \param cause       [in] Invoke function cause.
+   * \param nowTime     [in] Log collect time.
+   * \param archivePath [in] Archive file path.
+   * \return Value is zero, if process is succeed.<br />
+   *         Value is error number a.k.a. "errno", if process is failure.
    */
-  virtual bool getProcInfo(TLargeUInt *systime, TLargeUInt *usrtime,
-                           TLargeUInt *vmsize, TLargeUInt *rssize);
+  virtual int writeBinaryResourceLog(TProcSample *sample, TInvokeCause cause,
+                                     TMSecTime nowTime, char *archivePath);
 
   /*!
-   * \brief Getting machine cpu times.
-   * \param times [out] Machine cpu times information.
-   * \return Prosess is succeed or failure.
+   * \brief Switch resource log format.<br>
+   *        Caller must hold logMutex.
+   * \param isBinary [in] Binary resource log is used.
    */
-  virtual bool getSysTimes(TMachineTimes *times);
+  virtual void switchResourceLogFormat(bool isBinary);
 
   /*!
    * \brief Send log archive trap.
@@ -190,28 +207,123 @@ class TLogManager {
                                   char *path, bool isDirectory);
 
   /*!
-   * \brief Collect files about JVM enviroment.
-   * \param basePath [in] Temporary working directory.
+   * \brief Copy distribution release file.
+   * \param sink [in] Destination of artifacts.
+   * \return Value is zero, if process is succeed.<br />
+   *         Value is error number a.k.a. "errno", if process is failure.
+   */
+  virtual int copyDistributionFile(TArtifactSink *sink);
+
+  /*!
+   * \brief Copy process and network information files in procfs.
+   * \param sink [in] Destination of artifacts.
+   * \return Value is zero, if process is succeed.<br />
+   *         Value is error number a.k.a. "errno", if process is failure.
+   */
+  virtual int copyProcessFiles(TArtifactSink *sink);
+
+  /*!
+   * \brief Copy syslog, or collect systemd-journald log.
+   * \param sink [in] Destination of artifacts.
+   * \return Value is zero, if process is succeed.<br />
+   *         Value is error number a.k.a. "errno", if process is failure.
+   */
+  virtual int copySystemLog(TArtifactSink *sink);
+
+  /*!
+   * \brief Copy files of stdout and stderr.
+   * \param sink [in] Destination of artifacts.
    * \return Value is zero, if process is succeed.<br />
    *         Value is error number a.k.a. "errno", if process is failure.
    */
-  virtual int copyInfoFiles(char const *basePath);
+  virtual int copyStandardStreams(TArtifactSink *sink);
 
   /*!
    * \brief Copy GC log file.
-   * \param basePath [in] Path of temporary directory.
+   * \param sink [in] Destination of artifacts.
+   * \return Value is zero, if process is succeed.<br />
+   *         Value is error number a.k.a. "errno", if process is failure.
+   */
+  virtual int copyGCLogFile(TArtifactSink *sink);
+
+  /*!
+   * \brief Find GC log file which is written now, and GC log file which
+   *        was stored in the last archive if it has been rotated.
+   * \param gcLogFile   [in]  Path of GC log file in the option.
+   * \param archived    [in]  Part of GC log in the last archive.
+   * \param currentFile [out] Path of GC log file which is written now.
+   * \param rotatedFile [out] Path of rotated GC log file, or null.
    * \return Value is zero, if process is succeed.<br />
    *         Value is error number a.k.a. "errno", if process is failure.
    */
-  virtual int copyGCLogFile(char const *basePath);
+  virtual int findGCLogFiles(char const *gcLogFile, TGCLogPosition *archived,
+                             char **currentFile, char **rotatedFile);
+
+  /*!
+   * \brief Copy data of GC log file which is not in the last archive.
+   * \param sink      [in]  Destination of artifacts.
+   * \param path      [in]  Path of GC log file.
+   * \param archived  [in]  Part of GC log in the last archive.
+   * \param collected [out] Part of GC log which is collected. It can be null.
+   * \return Value is zero, if process is succeed.<br />
+   *         Value is error number a.k.a. "errno", if process is failure.
+   */
+  virtual int copyGCLogTail(TArtifactSink *sink, char const *path,
+                            TGCLogPosition *archived,
+                            TGCLogPosition *collected);
+
+  /*!
+   * \brief Calculate checksum of GC log data just before the offset.
+   * \param fd       [in]  File descriptor of GC log file.
+   * \param offset   [in]  End of data.
+   * \param checksum [out] CRC-32 of data.
+   * \return Value is zero, if process is succeed.<br />
+   *         Value is error number a.k.a. "errno", if process is failure.
+   */
+  virtual int getGCLogChecksum(int fd, off_t offset, uint32_t *checksum);
+
+  /*!
+   * \brief Remember part of GC log which is collected, if log archive is
+   *        made. The next archive has only data after it.
+   * \param isArchived [in] Log archive is made.
+   */
+  virtual void commitGCLogPosition(bool isArchived);
+
+  /*!
+   * \brief Release artifact collector after wait().<br>
+   *        If its workers are abandoned, it is kept until they exit.
+   * \param collector [in] Artifact collector.
+   */
+  virtual void keepCollector(TArtifactCollector *collector);
+
+  /*!
+   * \brief Release abandoned artifact collectors.
+   * \param isJoin [in] Wait for running workers.<br>
+   *                    Collectors which have running workers are kept if false.
+   */
+  virtual void releaseCollectors(bool isJoin);
 
   /*!
    * \brief Create file about using socket by JVM.
-   * \param basePath [in] Path of directory put report file.
+   * \param sink [in] Destination of artifacts.
+   * \return Value is zero, if process is succeed.<br />
+   *         Value is error number a.k.a. "errno", if process is failure.
+   */
+  virtual int makeSocketOwnerFile(TArtifactSink *sink);
+
+  /*!
+   * \brief Tasks of TArtifactCollector. They call above functions.
+   * \param data     [in] TLogManager object.
+   * \param sink [in] Destination of artifacts.
    * \return Value is zero, if process is succeed.<br />
    *         Value is error number a.k.a. "errno", if process is failure.
    */
-  virtual int makeSocketOwnerFile(char const *basePath);
+  static int distributionFileTask(void *data, TArtifactSink *sink);
+  static int processFilesTask(void *data, TArtifactSink *sink);
+  static int systemLogTask(void *data, TArtifactSink *sink);
+  static int standardStreamsTask(void *data, TArtifactSink *sink);
+  static int gcLogFileTask(void *data, TArtifactSink *sink);
+  static int socketOwnerFileTask(void *data, TArtifactSink *sink);
 
   /*!
    * \brief Create archive file path.
@@ -232,6 +344,16 @@ class TLogManager {
    */
   static pthread_mutex_t archiveMutex;
 
+  /*!
+   * \brief Mutex of GC log position.
+   */
+  static pthread_mutex_t gcLogMutex;
+
+  /*!
+   * \brief Mutex of abandoned artifact collectors.
+   */
+  static pthread_mutex_t collectorMutex;
+
   /*!
    * \brief Archive file maker.
    */
@@ -242,6 +364,11 @@ class TLogManager {
    */
   TJniZipArchiver *jniArchiver;
 
+  /*!
+   * \brief Archive file maker to use zlib without Java heap.
+   */
+  TZipArchiver *zipArchiver;
+
   /*!
    * \brief Dump thread information object.
    */
@@ -256,6 +383,60 @@ class TLogManager {
    * \brief Pointer of string of GC log file path.
    */
   char **gcLogFilename;
+
+  /*!
+   * \brief Part of GC log file which is stored in the last archive.
+   */
+  TGCLogPosition gcLogArchived;
+
+  /*!
+   * \brief Part of GC log file which is collected for archive being made.
+   */
+  TGCLogPosition gcLogCollected;
+
+  /*!
+   * \brief GC log is collected for archive being made.
+   */
+  bool isGCLogCollected;
+
+  /*!
+   * \brief Sequence number of archive which GC log is collected for.<br>
+   *        It is incremented when the archive is finished, so positions
+   *        collected by abandoned tasks are dropped.
+   */
+  unsigned int gcLogArchiveSeq;
+
+  /*!
+   * \brief Artifact collectors whose workers are abandoned.<br>
+   *        Their tasks refer to this object, so they are joined before it
+   *        is destroyed.
+   */
+  std::vector<TArtifactCollector *> abandonedCollectors;
+
+  /*!
+   * \brief Sampler of resource usage of java process.
+   */
+  TProcSampler *procSampler;
+
+  /*!
+   * \brief File descriptor of resource log file. -1 if it is not opened.
+   */
+  int resourceLogFd;
+
+  /*!
+   * \brief Path of resource log file which is opened.
+   */
+  char *resourceLogPath;
+
+  /*!
+   * \brief Writer of binary resource log. NULL if it is not opened.
+   */
+  TResourceLogWriter *binaryLog;
+
+  /*!
+   * \brief procSampler samples all sources for binary resource log.
+   */
+  bool isBinarySampler;
 };
 
 #endif  // _LOG_MANAGER_H
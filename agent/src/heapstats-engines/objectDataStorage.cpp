@@ -0,0 +1,219 @@
+/*!
+ * \file objectDataStorage.cpp
+ * \brief This file is used to store class information in compact slabs.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "globals.hpp"
+#include "objectDataStorage.hpp"
+
+#if PROCESSOR_ARCH == X86
+#include "arch/x86/lock.inline.hpp"
+#elif PROCESSOR_ARCH == ARM
+#include "arch/arm/lock.inline.hpp"
+#endif
+
+/*!
+ * \brief Size of a chunk of class name arena.
+ */
+#define CLASS_NAME_CHUNK_SIZE (64 * 1024)
+
+/*!
+ * \brief TObjectDataStorage constructor.
+ */
+TObjectDataStorage::TObjectDataStorage(void)
+    : freeIndexes(), nameArena(CLASS_NAME_CHUNK_SIZE), nameSet() {
+  memset(hotChunks, 0, sizeof(hotChunks));
+  memset(coldChunks, 0, sizeof(coldChunks));
+  nextIndex = 0;
+  lockVal = 0;
+}
+
+/*!
+ * \brief TObjectDataStorage destructor.
+ */
+TObjectDataStorage::~TObjectDataStorage(void) {
+  for (int idx = 0; idx < OBJECT_DATA_MAX_CHUNKS; idx++) {
+    free(hotChunks[idx]);
+    free(coldChunks[idx]);
+  }
+}
+
+/*!
+ * \brief Allocate new class information.
+ * \param symbol    [in] Symbol body of class name.
+ * \param symbolLen [in] Length of symbol body.
+ * \return New class information which is filled by zero
+ *         except tag, index and class name.<br>
+ *         Value is null, if process is failure.
+ */
+TObjectData *TObjectDataStorage::allocate(const char *symbol,
+                                          unsigned short symbolLen) {
+  TObjectData *result = NULL;
+  TObjectColdData *cold = NULL;
+
+  spinLockWait(&lockVal);
+  {
+    TClassNameEntry *name = internName(symbol, symbolLen);
+
+    if (likely(name != NULL)) {
+      unsigned int index;
+      bool isReused = !freeIndexes.empty();
+      if (isReused) {
+        index = freeIndexes.back();
+      } else {
+        index = nextIndex;
+      }
+
+      unsigned int chunkIdx = index / OBJECT_DATA_CHUNK_ENTRIES;
+      if (unlikely((chunkIdx < OBJECT_DATA_MAX_CHUNKS) &&
+                   (hotChunks[chunkIdx] == NULL))) {
+        void *hot = NULL;
+        if (likely(posix_memalign(&hot, 64, sizeof(TObjectData) *
+                                                OBJECT_DATA_CHUNK_ENTRIES) ==
+                   0)) {
+          coldChunks[chunkIdx] = (TObjectColdData *)calloc(
+              OBJECT_DATA_CHUNK_ENTRIES, sizeof(TObjectColdData));
+          if (unlikely(coldChunks[chunkIdx] == NULL)) {
+            free(hot);
+          } else {
+            hotChunks[chunkIdx] = (TObjectData *)hot;
+          }
+        }
+      }
+
+      if (likely((chunkIdx < OBJECT_DATA_MAX_CHUNKS) &&
+                 (hotChunks[chunkIdx] != NULL))) {
+        if (isReused) {
+          freeIndexes.pop_back();
+        } else {
+          nextIndex++;
+        }
+
+        unsigned int offset = index & (OBJECT_DATA_CHUNK_ENTRIES - 1);
+        result = &hotChunks[chunkIdx][offset];
+        cold = &coldChunks[chunkIdx][offset];
+
+        memset(result, 0, sizeof(TObjectData));
+        result->tag = (uintptr_t)result;
+        result->index = index;
+
+        memset(cold, 0, sizeof(TObjectColdData));
+        cold->className = name->name;
+        cold->classNameLen = name->length;
+      } else {
+        releaseName(name->name);
+      }
+    }
+  }
+  spinLockRelease(&lockVal);
+
+  return result;
+}
+
+/*!
+ * \brief Release class information.
+ * \param objData [in] Class information to release.
+ */
+void TObjectDataStorage::release(TObjectData *objData) {
+  TObjectColdData *cold = getColdData(objData);
+
+  spinLockWait(&lockVal);
+  {
+    if (likely(cold->className != NULL)) {
+      releaseName(cold->className);
+      cold->className = NULL;
+    }
+    freeIndexes.push_back(objData->index);
+  }
+  spinLockRelease(&lockVal);
+}
+
+/*!
+ * \brief Intern class name into arena.<br>
+ *        "L" and ";" are added if the class is instance class.
+ * \param symbol    [in] Symbol body of class name.
+ * \param symbolLen [in] Length of symbol body.
+ * \return Interned name entry. Value is null, if process is failure.
+ */
+TClassNameEntry *TObjectDataStorage::internName(const char *symbol,
+                                                unsigned short symbolLen) {
+  bool isInstanceClass = (*symbol != '[');
+  unsigned int length = symbolLen + (isInstanceClass ? 2 : 0);
+  size_t entrySize = offsetof(TClassNameEntry, name) + length + 1;
+
+  /* Build candidate entry at the tail of current chunk. */
+  TClassNameEntry *entry = (TClassNameEntry *)nameArena.reserve(entrySize);
+  if (unlikely(entry == NULL)) {
+    return NULL;
+  }
+
+  if (isInstanceClass) {
+    /* As like "instanceKlass::signature_name()". */
+    entry->name[0] = 'L';
+    __builtin_memcpy(&entry->name[1], symbol, symbolLen);
+    entry->name[symbolLen + 1] = ';';
+  } else {
+    __builtin_memcpy(entry->name, symbol, symbolLen);
+  }
+  entry->name[length] = '\0';
+  entry->length = length;
+
+  /* FNV-1a */
+  size_t hash = 2166136261U;
+  for (unsigned int idx = 0; idx < length; idx++) {
+    hash = (hash ^ (unsigned char)entry->name[idx]) * 16777619U;
+  }
+  entry->hash = hash;
+
+  TClassNameSet::iterator itr = nameSet.find(entry);
+  if (itr != nameSet.end()) {
+    /* Candidate is discarded because same name is already interned. */
+    (*itr)->refCount++;
+    return *itr;
+  }
+
+  entry->refCount = 1;
+  try {
+    nameSet.insert(entry);
+  } catch (...) {
+    return NULL;
+  }
+  entry->chunk = nameArena.commit(entrySize);
+
+  return entry;
+}
+
+/*!
+ * \brief Drop a reference of interned class name.<br>
+ *        Chunk is released when all names in it are not referred.
+ * \param name [in] Interned class name.
+ */
+void TObjectDataStorage::releaseName(char *name) {
+  TClassNameEntry *entry =
+      (TClassNameEntry *)(name - offsetof(TClassNameEntry, name));
+  if (--entry->refCount > 0) {
+    return;
+  }
+
+  nameSet.erase(entry);
+  nameArena.release(entry->chunk);
+}
@@ -0,0 +1,213 @@
+/*!
+ * \file objectDataStorage.hpp
+ * \brief This file is used to store class information in compact slabs.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+#ifndef OBJECT_DATA_STORAGE_HPP
+#define OBJECT_DATA_STORAGE_HPP
+
+#include <jni.h>
+#include <stddef.h>
+
+#include <unordered_set>
+#include <vector>
+
+#include "oopUtil.hpp"
+#include "chunkArena.hpp"
+
+/*!
+ * \brief Pointer type of klassOop.
+ */
+typedef void* PKlassOop;
+
+/*!
+ * \brief This structure stores class information which is referred
+ *        on every object in heap iteration.<br>
+ *        Two entries share one cache line.
+ */
+typedef struct {
+  jlong tag;          /*!< Class tag.                                 */
+  PKlassOop klassOop; /*!< Java inner class object.                   */
+  jlong instanceSize; /*!< Class size if this class is instanceKlass. */
+  TOopType oopType;   /*!< Type of class.                             */
+  unsigned int index; /*!< Index of entry in TObjectDataStorage.      */
+} __attribute__((aligned(32))) TObjectData;
+
+/*!
+ * \brief This structure stores class information which is referred
+ *        only when snapshot is written.
+ */
+typedef struct {
+  jlong classNameLen; /*!< Class name length.                         */
+  char *className;    /*!< Class name (interned).                     */
+  jlong oldTotalSize; /*!< Class old total use size.                  */
+  jlong clsLoaderId;  /*!< Class loader instance id.                  */
+  jlong clsLoaderTag; /*!< Class loader class tag.                    */
+} TObjectColdData;
+
+/*!
+ * \brief Count of entries in a chunk. This value must be power of 2.
+ */
+#define OBJECT_DATA_CHUNK_ENTRIES 1024
+
+/*!
+ * \brief Max count of chunks.
+ */
+#define OBJECT_DATA_MAX_CHUNKS 4096
+
+/*!
+ * \brief Interned class name.
+ */
+typedef struct {
+  TArenaChunk *chunk;     /*!< Chunk which contains this entry.    */
+  size_t hash;            /*!< Hash value of name.                 */
+  unsigned int refCount;  /*!< Count of classes which refer name.  */
+  unsigned int length;    /*!< Length of name.                     */
+  char name[];            /*!< Class name terminated by NULL.      */
+} TClassNameEntry;
+
+/*!
+ * \brief Hasher of interned class name.
+ */
+struct TClassNameHasher {
+  size_t operator()(const TClassNameEntry *entry) const { return entry->hash; }
+};
+
+/*!
+ * \brief Comparator of interned class name.
+ */
+struct TClassNameEqual {
+  bool operator()(const TClassNameEntry *a, const TClassNameEntry *b) const {
+    return (a->hash == b->hash) && (a->length == b->length) &&
+           (__builtin_memcmp(a->name, b->name, a->length) == 0);
+  }
+};
+
+/*!
+ * \brief Set of interned class names.
+ */
+typedef std::unordered_set<TClassNameEntry *, TClassNameHasher,
+                           TClassNameEqual> TClassNameSet;
+
+/*!
+ * \brief This class stores class information.<br>
+ *        TObjectData is allocated from chunks of contiguous array, and
+ *        TObjectColdData which has same index is allocated from parallel
+ *        array. Class names are interned into arena.<br>
+ *        Entries are never moved, so pointer of TObjectData is used as
+ *        class tag.
+ */
+class TObjectDataStorage {
+ public:
+  /*!
+   * \brief TObjectDataStorage constructor.
+   */
+  TObjectDataStorage(void);
+  /*!
+   * \brief TObjectDataStorage destructor.
+   */
+  virtual ~TObjectDataStorage(void);
+
+  /*!
+   * \brief Allocate new class information.
+   * \param symbol    [in] Symbol body of class name.
+   * \param symbolLen [in] Length of symbol body.
+   * \return New class information which is filled by zero
+   *         except tag, index and class name.<br>
+   *         Value is null, if process is failure.
+   */
+  TObjectData *allocate(const char *symbol, unsigned short symbolLen);
+
+  /*!
+   * \brief Release class information.
+   * \param objData [in] Class information to release.
+   */
+  void release(TObjectData *objData);
+
+  /*!
+   * \brief Get class information which is not referred by heap iteration.
+   * \param objData [in] Class information.
+   * \return Cold part of class information.
+   */
+  inline TObjectColdData *getColdData(const TObjectData *objData) {
+    return &coldChunks[objData->index / OBJECT_DATA_CHUNK_ENTRIES]
+                      [objData->index & (OBJECT_DATA_CHUNK_ENTRIES - 1)];
+  }
+
+  /*!
+   * \brief Get size of class name arena.
+   * \return Total size of chunks in class name arena.
+   */
+  inline size_t getNameArenaSize(void) {
+    return nameArena.getSize();
+  }
+
+ private:
+  /*!
+   * \brief Intern class name into arena.<br>
+   *        "L" and ";" are added if the class is instance class.
+   * \param symbol    [in] Symbol body of class name.
+   * \param symbolLen [in] Length of symbol body.
+   * \return Interned name entry. Value is null, if process is failure.
+   */
+  TClassNameEntry *internName(const char *symbol, unsigned short symbolLen);
+
+  /*!
+   * \brief Drop a reference of interned class name.
+   * \param name [in] Interned class name.
+   */
+  void releaseName(char *name);
+
+  /*!
+   * \brief Chunks of hot part of class information.
+   */
+  TObjectData *hotChunks[OBJECT_DATA_MAX_CHUNKS];
+
+  /*!
+   * \brief Chunks of cold part of class information.
+   */
+  TObjectColdData *coldChunks[OBJECT_DATA_MAX_CHUNKS];
+
+  /*!
+   * \brief Index of next entry which has never been used.
+   */
+  unsigned int nextIndex;
+
+  /*!
+   * \brief Indexes of released entries.
+   */
+  std::vector<unsigned int> freeIndexes;
+
+  /*!
+   * \brief Arena of class names.
+   */
+  TChunkArena nameArena;
+
+  /*!
+   * \brief Set of interned class names.
+   */
+  TClassNameSet nameSet;
+
+  /*!
+   * \brief Lock of this storage.
+   */
+  volatile int lockVal;
+};
+
+#endif  // OBJECT_DATA_STORAGE_HPP
@@ -113,12 +113,13 @@ void *getKlassOopFromOop(void *oop) {
 }
 
 /*!
- * \brief Getting class's name form java inner class.
- * \param klass [in] Java class object(Inner class format).
- * \return String of object class name.<br>
- *         Don't forget deallocate if value isn't null.
+ * \brief Getting class's symbol body form java inner class.
+ * \param klass [in]  Java class object(Inner class format).
+ * \param len   [out] Length of symbol body.
+ * \return Pointer to symbol body which is not terminated by NULL.<br>
+ *         Value is null, if failed to get symbol.
  */
-char *getClassName(void *klass) {
+const char *getClassSymbol(void *klass, unsigned short *len) {
   TVMVariables *vmVal = TVMVariables::getInstance();
 
   /* Sanity check. */
@@ -138,11 +139,26 @@ char *getClassName(void *klass) {
     return NULL;
   }
 
-  bool isInstanceClass = (*name != '[');
-
   /* Get class name size. */
-  unsigned short len = *(unsigned short *)incAddress(
+  *len = *(unsigned short *)incAddress(
                            (*klassSymbol), vmVal->getOfsLengthAtSymbol());
+  return name;
+}
+
+/*!
+ * \brief Getting class's name form java inner class.
+ * \param klass [in] Java class object(Inner class format).
+ * \return String of object class name.<br>
+ *         Don't forget deallocate if value isn't null.
+ */
+char *getClassName(void *klass) {
+  unsigned short len;
+  const char *name = getClassSymbol(klass, &len);
+  if (unlikely(name == NULL)) {
+    return NULL;
+  }
+
+  bool isInstanceClass = (*name != '[');
 
   char *str = NULL;
   /* If class is instance class. */
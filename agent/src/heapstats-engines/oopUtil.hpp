@@ -78,6 +78,15 @@ void *getKlassFromKlassOop(void *klassOop);
  */
 void *getKlassOopFromOop(void *oop);
 
+/*!
+ * \brief Getting class's symbol body form java inner class.
+ * \param klass [in]  Java class object(Inner class format).
+ * \param len   [out] Length of symbol body.
+ * \return Pointer to symbol body which is not terminated by NULL.<br>
+ *         Value is null, if failed to get symbol.
+ */
+const char *getClassSymbol(void *klass, unsigned short *len);
+
 /*!
  * \brief Getting class's name form java inner class.
  * \param klass [in] Java class object(Inner class format).
@@ -0,0 +1,361 @@
+/*!
+ * \file parallelDeflater.cpp
+ * \brief This file is used to compress data by multiple threads.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ *
+ */
+
+#include <errno.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include "globals.hpp"
+#include "parallelDeflater.hpp"
+
+/*!
+ * \brief TParallelDeflater constructor.
+ * \param threads [in] Count of worker threads.
+ * \param nice    [in] Nice value of worker threads.
+ */
+TParallelDeflater::TParallelDeflater(int threads, int nice) {
+  if (threads > PARALLEL_DEFLATE_MAX_THREADS) {
+    threads = PARALLEL_DEFLATE_MAX_THREADS;
+  }
+
+  numWorkers = 0;
+  niceValue = nice;
+  isTerminating = false;
+
+  /* Two chunks per worker, so caller can read while workers compress. */
+  numChunks = threads * 2;
+  outSize = compressBound(PARALLEL_DEFLATE_CHUNK_SIZE) + 64;
+  chunks = (TDeflateChunk *)calloc(numChunks, sizeof(TDeflateChunk));
+  if (unlikely(chunks == NULL)) {
+    throw "Could not allocate memory for parallel deflate.";
+  }
+
+  for (int idx = 0; idx < numChunks; idx++) {
+    TDeflateChunk *chunk = &chunks[idx];
+    chunk->in = (unsigned char *)malloc(PARALLEL_DEFLATE_CHUNK_SIZE);
+    chunk->dict = (unsigned char *)malloc(PARALLEL_DEFLATE_DICT_SIZE);
+    chunk->out = (unsigned char *)malloc(outSize);
+    chunk->state = DeflateChunkFree;
+
+    if (unlikely((chunk->in == NULL) || (chunk->dict == NULL) ||
+                 (chunk->out == NULL))) {
+      for (int pos = 0; pos <= idx; pos++) {
+        free(chunks[pos].in);
+        free(chunks[pos].dict);
+        free(chunks[pos].out);
+      }
+      free(chunks);
+      throw "Could not allocate memory for parallel deflate.";
+    }
+  }
+
+  pthread_mutex_init(&mutex, NULL);
+  pthread_cond_init(&readyCond, NULL);
+  pthread_cond_init(&doneCond, NULL);
+
+  /* Signals should be handled by threads of JVM. */
+  sigset_t allSignals;
+  sigset_t oldSignals;
+  sigfillset(&allSignals);
+  pthread_sigmask(SIG_SETMASK, &allSignals, &oldSignals);
+
+  for (int idx = 0; idx < threads; idx++) {
+    int result =
+        pthread_create(&workers[idx], NULL, workerEntryPoint, this);
+    if (unlikely(result != 0)) {
+      logger->printDebugMsg("Could not create deflate thread: %s",
+                            strerror(result));
+      break;
+    }
+
+    numWorkers++;
+  }
+
+  pthread_sigmask(SIG_SETMASK, &oldSignals, NULL);
+
+  if (unlikely(numWorkers == 0)) {
+    pthread_cond_destroy(&doneCond);
+    pthread_cond_destroy(&readyCond);
+    pthread_mutex_destroy(&mutex);
+
+    for (int idx = 0; idx < numChunks; idx++) {
+      free(chunks[idx].in);
+      free(chunks[idx].dict);
+      free(chunks[idx].out);
+    }
+    free(chunks);
+    throw "Could not create deflate thread.";
+  }
+}
+
+/*!
+ * \brief TParallelDeflater destructor.
+ */
+TParallelDeflater::~TParallelDeflater(void) {
+  {
+    TMutexLocker locker(&mutex);
+    isTerminating = true;
+    pthread_cond_broadcast(&readyCond);
+  }
+
+  for (int idx = 0; idx < numWorkers; idx++) {
+    pthread_join(workers[idx], NULL);
+  }
+  numWorkers = 0;
+
+  pthread_cond_destroy(&doneCond);
+  pthread_cond_destroy(&readyCond);
+  pthread_mutex_destroy(&mutex);
+
+  for (int idx = 0; idx < numChunks; idx++) {
+    free(chunks[idx].in);
+    free(chunks[idx].dict);
+    free(chunks[idx].out);
+  }
+  free(chunks);
+}
+
+/*!
+ * \brief Entry point of worker thread.
+ * \param data [in] TParallelDeflater object.
+ * \return Always NULL.
+ */
+void *TParallelDeflater::workerEntryPoint(void *data) {
+  TParallelDeflater *deflater = (TParallelDeflater *)data;
+
+  /* Nice value is per thread on Linux. */
+  if (unlikely(setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid),
+                           deflater->niceValue) != 0)) {
+    logger->printDebugMsg("Could not set nice value of deflate thread.");
+  }
+
+  deflater->workerMain();
+  return NULL;
+}
+
+/*!
+ * \brief Compress chunks until the pool is terminated.
+ */
+void TParallelDeflater::workerMain(void) {
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  bool isInitialized =
+      (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8,
+                    Z_DEFAULT_STRATEGY) == Z_OK);
+
+  while (true) {
+    TDeflateChunk *chunk = NULL;
+    {
+      TMutexLocker locker(&mutex);
+
+      while (!isTerminating) {
+        for (int idx = 0; idx < numChunks; idx++) {
+          if (chunks[idx].state == DeflateChunkReady) {
+            chunk = &chunks[idx];
+            break;
+          }
+        }
+
+        if (chunk != NULL) {
+          chunk->state = DeflateChunkBusy;
+          break;
+        }
+        pthread_cond_wait(&readyCond, &mutex);
+      }
+    }
+
+    if (chunk == NULL) {
+      break;
+    }
+
+    chunk->result = 0;
+    chunk->outLen = 0;
+    if (unlikely(!isInitialized)) {
+      chunk->result = ENOMEM;
+    } else {
+      deflateReset(&stream);
+      if (chunk->dictLen > 0) {
+        deflateSetDictionary(&stream, chunk->dict, (uInt)chunk->dictLen);
+      }
+
+      /*
+       * Sync flush ends the chunk at byte boundary without final block,
+       * so the next chunk can be appended to it.
+       */
+      stream.next_in = chunk->in;
+      stream.avail_in = (uInt)chunk->inLen;
+      stream.next_out = chunk->out;
+      stream.avail_out = (uInt)outSize;
+      int ret = deflate(&stream, chunk->isLast ? Z_FINISH : Z_SYNC_FLUSH);
+
+      bool isCompleted = chunk->isLast ? (ret == Z_STREAM_END)
+                                       : ((ret == Z_OK) &&
+                                          (stream.avail_out > 0));
+      if (unlikely(!isCompleted || (stream.avail_in != 0))) {
+        chunk->result = EIO;
+      } else {
+        chunk->outLen = outSize - stream.avail_out;
+      }
+    }
+
+    {
+      TMutexLocker locker(&mutex);
+      chunk->state = DeflateChunkDone;
+      pthread_cond_broadcast(&doneCond);
+    }
+  }
+
+  if (likely(isInitialized)) {
+    deflateEnd(&stream);
+  }
+}
+
+/*!
+ * \brief Wait until all submitted chunks are compressed, and free them.
+ * \param from [in] Sequence number of the oldest chunk not written.
+ * \param to   [in] Sequence number of the next chunk to fill.
+ */
+void TParallelDeflater::drain(uint64_t from, uint64_t to) {
+  TMutexLocker locker(&mutex);
+
+  for (uint64_t seq = from; seq < to; seq++) {
+    TDeflateChunk *chunk = &chunks[seq % numChunks];
+    while (chunk->state != DeflateChunkDone) {
+      pthread_cond_wait(&doneCond, &mutex);
+    }
+    chunk->state = DeflateChunkFree;
+  }
+}
+
+/*!
+ * \brief Compress file to raw deflate data.
+ * \param srcFd  [in]  File descriptor of source file.
+ * \param writer [in]  Function to write compressed data.
+ * \param data   [in]  Data which is passed to writer.
+ * \param crc    [out] CRC-32 of source data.
+ * \param size   [out] Size of source data.
+ * \param csize  [out] Size of compressed data.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TParallelDeflater::compress(int srcFd, TDeflateWriter writer, void *data,
+                                uint32_t *crc, uint64_t *size,
+                                uint64_t *csize) {
+  int result = 0;
+  bool isEOF = false;
+  uint64_t filled = 0;
+  uint64_t written = 0;
+  TDeflateChunk *prev = NULL;
+
+  *crc = crc32(0L, Z_NULL, 0);
+  *size = 0;
+  *csize = 0;
+
+  while ((result == 0) && (!isEOF || (written < filled))) {
+    /* Fill a free chunk while the ring has room. */
+    if (!isEOF && (filled - written < (uint64_t)numChunks)) {
+      TDeflateChunk *chunk = &chunks[filled % numChunks];
+
+      size_t len = 0;
+      while (len < PARALLEL_DEFLATE_CHUNK_SIZE) {
+        ssize_t readSize =
+            read(srcFd, chunk->in + len, PARALLEL_DEFLATE_CHUNK_SIZE - len);
+        if (unlikely(readSize < 0)) {
+          if (errno == EINTR) {
+            continue;
+          }
+          result = errno;
+          break;
+        } else if (readSize == 0) {
+          isEOF = true;
+          break;
+        }
+
+        len += readSize;
+      }
+
+      if (unlikely(result != 0)) {
+        break;
+      }
+
+      chunk->inLen = len;
+      chunk->isLast = isEOF;
+      *crc = crc32(*crc, chunk->in, (uInt)len);
+      *size += len;
+
+      /*
+       * Previous chunk is not refilled until this chunk is written,
+       * because chunks are written in order.
+       */
+      chunk->dictLen = 0;
+      if (prev != NULL) {
+        chunk->dictLen = (prev->inLen < PARALLEL_DEFLATE_DICT_SIZE)
+                             ? prev->inLen
+                             : PARALLEL_DEFLATE_DICT_SIZE;
+        memcpy(chunk->dict, prev->in + prev->inLen - chunk->dictLen,
+               chunk->dictLen);
+      }
+      prev = chunk;
+
+      {
+        TMutexLocker locker(&mutex);
+        chunk->state = DeflateChunkReady;
+        pthread_cond_signal(&readyCond);
+      }
+      filled++;
+      continue;
+    }
+
+    /* Write the oldest chunk in order. */
+    TDeflateChunk *chunk = &chunks[written % numChunks];
+    {
+      TMutexLocker locker(&mutex);
+      while (chunk->state != DeflateChunkDone) {
+        pthread_cond_wait(&doneCond, &mutex);
+      }
+    }
+
+    result = chunk->result;
+    if (likely(result == 0)) {
+      result = writer(data, chunk->out, chunk->outLen);
+      *csize += chunk->outLen;
+    }
+
+    {
+      TMutexLocker locker(&mutex);
+      chunk->state = DeflateChunkFree;
+    }
+    written++;
+  }
+
+  /* Chunks in flight must be finished before they are reused. */
+  if (unlikely(result != 0)) {
+    drain(written, filled);
+  }
+
+  return result;
+}
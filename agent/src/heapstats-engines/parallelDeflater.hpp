@@ -0,0 +1,195 @@
+/*!
+ * \file parallelDeflater.hpp
+ * \brief This file is used to compress data by multiple threads.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ *
+ */
+
+#ifndef _PARALLEL_DEFLATER_H
+#define _PARALLEL_DEFLATER_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/*!
+ * \brief Size of input chunk which is compressed by a worker.
+ */
+#define PARALLEL_DEFLATE_CHUNK_SIZE (128 * 1024)
+
+/*!
+ * \brief Size of dictionary which is taken from previous chunk.
+ */
+#define PARALLEL_DEFLATE_DICT_SIZE (32 * 1024)
+
+/*!
+ * \brief Max count of worker threads.
+ */
+#define PARALLEL_DEFLATE_MAX_THREADS 64
+
+/*!
+ * \brief Function to write compressed data.
+ * \param data [in] Data which is passed to compress().
+ * \param buf  [in] Compressed data.
+ * \param size [in] Size of compressed data.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+typedef int (*TDeflateWriter)(void *data, const void *buf, size_t size);
+
+/*!
+ * \brief State of chunk.
+ */
+typedef enum {
+  DeflateChunkFree,   /*!< Chunk can be filled by caller.   */
+  DeflateChunkReady,  /*!< Chunk waits for a worker.        */
+  DeflateChunkBusy,   /*!< Chunk is compressed by a worker. */
+  DeflateChunkDone    /*!< Chunk waits to be written.       */
+} TDeflateChunkState;
+
+/*!
+ * \brief Chunk of input data and its compressed data.
+ */
+typedef struct {
+  unsigned char *in;        /*!< Input data.                          */
+  size_t inLen;             /*!< Size of input data.                  */
+  unsigned char *dict;      /*!< Tail of previous chunk.              */
+  size_t dictLen;           /*!< Size of dictionary.                  */
+  unsigned char *out;       /*!< Compressed data.                     */
+  size_t outLen;            /*!< Size of compressed data.             */
+  bool isLast;              /*!< Chunk is the last of the stream.     */
+  int result;               /*!< Result of compression.               */
+  TDeflateChunkState state; /*!< State of chunk.                      */
+} TDeflateChunk;
+
+/*!
+ * \brief This class compresses a stream to raw deflate data by multiple
+ *        threads in the way of pigz.<br>
+ *        Input is split into chunks, and each chunk is compressed
+ *        independently with the tail of previous chunk as dictionary.
+ *        Chunks except the last one are terminated by sync flush, so the
+ *        concatenated output is a single standard deflate stream.<br>
+ *        Only one thread can call compress() at a time.
+ */
+class TParallelDeflater {
+ public:
+  /*!
+   * \brief TParallelDeflater constructor.
+   * \param threads [in] Count of worker threads.
+   * \param nice    [in] Nice value of worker threads.
+   */
+  TParallelDeflater(int threads, int nice);
+
+  /*!
+   * \brief TParallelDeflater destructor.
+   */
+  virtual ~TParallelDeflater(void);
+
+  /*!
+   * \brief Compress file to raw deflate data.
+   * \param srcFd  [in]  File descriptor of source file.
+   * \param writer [in]  Function to write compressed data.
+   * \param data   [in]  Data which is passed to writer.
+   * \param crc    [out] CRC-32 of source data.
+   * \param size   [out] Size of source data.
+   * \param csize  [out] Size of compressed data.
+   * \return Value is zero, if process is succeed.<br />
+   *         Value is error number a.k.a. "errno", if process is failure.
+   */
+  int compress(int srcFd, TDeflateWriter writer, void *data, uint32_t *crc,
+               uint64_t *size, uint64_t *csize);
+
+  /*!
+   * \brief Get count of worker threads.
+   * \return Count of worker threads.
+   */
+  inline int getWorkers(void) { return numWorkers; }
+
+ protected:
+  /*!
+   * \brief Entry point of worker thread.
+   * \param data [in] TParallelDeflater object.
+   * \return Always NULL.
+   */
+  static void *workerEntryPoint(void *data);
+
+  /*!
+   * \brief Compress chunks until the pool is terminated.
+   */
+  void workerMain(void);
+
+  /*!
+   * \brief Wait until all submitted chunks are compressed, and free them.
+   * \param from [in] Sequence number of the oldest chunk not written.
+   * \param to   [in] Sequence number of the next chunk to fill.
+   */
+  void drain(uint64_t from, uint64_t to);
+
+ private:
+  /*!
+   * \brief Chunks in ring order.
+   */
+  TDeflateChunk *chunks;
+
+  /*!
+   * \brief Count of chunks.
+   */
+  int numChunks;
+
+  /*!
+   * \brief Size of buffer for compressed data of a chunk.
+   */
+  size_t outSize;
+
+  /*!
+   * \brief Worker threads.
+   */
+  pthread_t workers[PARALLEL_DEFLATE_MAX_THREADS];
+
+  /*!
+   * \brief Count of worker threads.
+   */
+  int numWorkers;
+
+  /*!
+   * \brief Nice value of worker threads.
+   */
+  int niceValue;
+
+  /*!
+   * \brief Workers should exit.
+   */
+  bool isTerminating;
+
+  /*!
+   * \brief Mutex of chunk states.
+   */
+  pthread_mutex_t mutex;
+
+  /*!
+   * \brief Condition which is signaled when a chunk is ready.
+   */
+  pthread_cond_t readyCond;
+
+  /*!
+   * \brief Condition which is signaled when a chunk is done.
+   */
+  pthread_cond_t doneCond;
+};
+
+#endif  // _PARALLEL_DEFLATER_H
@@ -0,0 +1,465 @@
+/*!
+ * \file procSampler.cpp
+ * \brief This file is used to sample resource usage from procfs and cgroup.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ *
+ */
+
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "globals.hpp"
+#include "procSampler.hpp"
+
+/*!
+ * \brief Size of buffer to read a source.
+ */
+#define PROC_SAMPLER_BUFFER_SIZE 1024
+
+/*!
+ * \brief Mount point of cgroup file system.
+ */
+#define CGROUP_ROOT "/sys/fs/cgroup"
+
+/*!
+ * \brief Field index of utime in /proc/self/stat counted from state.
+ */
+#define STAT_UTIME_INDEX 11
+
+/*!
+ * \brief Field index of vsize in /proc/self/stat counted from state.
+ */
+#define STAT_VSIZE_INDEX 20
+
+/* Integer scanners. */
+
+/*!
+ * \brief Parse unsigned decimal integer.
+ * \param ptr   [in]  Pointer to text. Leading blanks are skipped.
+ * \param value [out] Parsed value.
+ * \return Pointer to next of the integer. NULL if no integer exists.
+ */
+static inline const char *parseUInt(const char *ptr, TLargeUInt *value) {
+  while ((*ptr == ' ') || (*ptr == '\t')) {
+    ptr++;
+  }
+
+  if ((*ptr < '0') || (*ptr > '9')) {
+    return NULL;
+  }
+
+  TLargeUInt result = 0;
+  while ((*ptr >= '0') && (*ptr <= '9')) {
+    result = result * 10 + (*ptr - '0');
+    ptr++;
+  }
+
+  *value = result;
+  return ptr;
+}
+
+/*!
+ * \brief Skip a field which is separated by space.
+ * \param ptr [in] Pointer to text.
+ * \return Pointer to next of the field.
+ */
+static inline const char *skipField(const char *ptr) {
+  while (*ptr == ' ') {
+    ptr++;
+  }
+
+  while ((*ptr != '\0') && (*ptr != ' ') && (*ptr != '\n')) {
+    ptr++;
+  }
+
+  return ptr;
+}
+
+/*!
+ * \brief Find line which starts with key.
+ * \param buf [in] Text to find.
+ * \param key [in] Key of line.
+ * \return Pointer to next of the key. NULL if the key is not found.
+ */
+static const char *findKey(const char *buf, const char *key) {
+  size_t keyLen = strlen(key);
+  const char *line = buf;
+
+  while (*line != '\0') {
+    if (strncmp(line, key, keyLen) == 0) {
+      return line + keyLen;
+    }
+
+    line = strchr(line, '\n');
+    if (line == NULL) {
+      break;
+    }
+    line++;
+  }
+
+  return NULL;
+}
+
+/*!
+ * \brief Parse value of key in "key value" formatted file.
+ * \param buf   [in]  Text to find.
+ * \param key   [in]  Key of line.
+ * \param value [out] Parsed value. It is not changed if the key is not found.
+ */
+static inline void parseKeyValue(const char *buf, const char *key,
+                                 TLargeUInt *value) {
+  const char *ptr = findKey(buf, key);
+  if (ptr != NULL) {
+    parseUInt(ptr, value);
+  }
+}
+
+/*!
+ * \brief Open file to read with pread.
+ * \param path [in] Path of file.
+ * \return File descriptor. -1 if failed.
+ */
+static inline int openSourceFile(const char *path) {
+  /* Don't pass descriptors to child process of log collection. */
+  return open(path, O_RDONLY | O_CLOEXEC);
+}
+
+/* Class method. */
+
+/*!
+ * \brief TProcSampler constructor.
+ * \param sources [in] Flags of sources to sample.
+ */
+TProcSampler::TProcSampler(int sources) {
+  for (int idx = 0; idx < ProcSourceCount; idx++) {
+    fds[idx] = -1;
+  }
+  isCpuStatV2 = false;
+
+  /* If failure get page size from sysconf. */
+  if (unlikely(systemPageSize <= 0)) {
+    /* Assume page size is 4 KiByte. */
+    systemPageSize = 1 << 12;
+    logger->printWarnMsg("System page size not found.");
+  }
+
+  if (sources & PROC_SOURCE_FLAG(ProcSourceStat)) {
+    fds[ProcSourceStat] = openSourceFile("/proc/self/stat");
+    if (unlikely(fds[ProcSourceStat] == -1)) {
+      logger->printWarnMsgWithErrno("Could not open process status.");
+    }
+  }
+
+  if (sources & PROC_SOURCE_FLAG(ProcSourceSysStat)) {
+    fds[ProcSourceSysStat] = openSourceFile("/proc/stat");
+    if (unlikely(fds[ProcSourceSysStat] == -1)) {
+      logger->printWarnMsgWithErrno("Could not open /proc/stat");
+    }
+  }
+
+  /* Following sources depend on kernel configuration. */
+  if (sources & PROC_SOURCE_FLAG(ProcSourceIO)) {
+    fds[ProcSourceIO] = openSourceFile("/proc/self/io");
+  }
+
+  if (sources & PROC_SOURCE_FLAG(ProcSourceSchedStat)) {
+    fds[ProcSourceSchedStat] = openSourceFile("/proc/self/schedstat");
+  }
+
+  if (sources & (PROC_SOURCE_FLAG(ProcSourceCgroupCpu) |
+                 PROC_SOURCE_FLAG(ProcSourceCgroupMemory))) {
+    openCgroupSources(sources);
+  }
+}
+
+/*!
+ * \brief TProcSampler destructor.
+ */
+TProcSampler::~TProcSampler(void) {
+  for (int idx = 0; idx < ProcSourceCount; idx++) {
+    if (fds[idx] != -1) {
+      close(fds[idx]);
+    }
+  }
+}
+
+/*!
+ * \brief Open files of cgroup which the process belongs to.
+ * \param sources [in] Flags of sources to sample.
+ */
+void TProcSampler::openCgroupSources(int sources) {
+  char buf[PROC_SAMPLER_BUFFER_SIZE * 4];
+  int fd = openSourceFile("/proc/self/cgroup");
+  if (fd == -1) {
+    return;
+  }
+
+  ssize_t len = read(fd, buf, sizeof(buf) - 1);
+  close(fd);
+  if (len <= 0) {
+    return;
+  }
+  buf[len] = '\0';
+
+  /*
+   * Each line is "hierarchy-ID:controller-list:cgroup-path".
+   * Controller list of cgroup v2 is empty. v1 controller is preferred on
+   * hybrid hierarchy because v2 hierarchy might not have controllers.
+   */
+  const char *cpuPath = NULL;
+  const char *memoryPath = NULL;
+  const char *unifiedPath = NULL;
+  for (char *line = buf; (line != NULL) && (*line != '\0');) {
+    char *next = strchr(line, '\n');
+    if (next != NULL) {
+      *next++ = '\0';
+    }
+
+    char *controllers = strchr(line, ':');
+    char *path = (controllers == NULL) ? NULL : strchr(controllers + 1, ':');
+    if (path != NULL) {
+      *path++ = '\0';
+      controllers++;
+
+      if (*controllers == '\0') {
+        unifiedPath = path;
+      } else {
+        /* Controller list is comma separated. */
+        char *saveptr = NULL;
+        for (char *ctrl = strtok_r(controllers, ",", &saveptr); ctrl != NULL;
+             ctrl = strtok_r(NULL, ",", &saveptr)) {
+          if (strcmp(ctrl, "cpuacct") == 0) {
+            cpuPath = path;
+          } else if (strcmp(ctrl, "memory") == 0) {
+            memoryPath = path;
+          }
+        }
+      }
+    }
+
+    line = next;
+  }
+
+  char path[PATH_MAX];
+  if (sources & PROC_SOURCE_FLAG(ProcSourceCgroupCpu)) {
+    if (cpuPath != NULL) {
+      snprintf(path, PATH_MAX, CGROUP_ROOT "/cpuacct%s/cpuacct.usage",
+               cpuPath);
+      fds[ProcSourceCgroupCpu] = openSourceFile(path);
+      if (fds[ProcSourceCgroupCpu] == -1) {
+        /* Cgroup namespace hides the path. */
+        fds[ProcSourceCgroupCpu] =
+            openSourceFile(CGROUP_ROOT "/cpuacct/cpuacct.usage");
+      }
+    } else if (unifiedPath != NULL) {
+      snprintf(path, PATH_MAX, CGROUP_ROOT "%s/cpu.stat", unifiedPath);
+      fds[ProcSourceCgroupCpu] = openSourceFile(path);
+      if (fds[ProcSourceCgroupCpu] == -1) {
+        fds[ProcSourceCgroupCpu] = openSourceFile(CGROUP_ROOT "/cpu.stat");
+      }
+      isCpuStatV2 = true;
+    }
+  }
+
+  if (sources & PROC_SOURCE_FLAG(ProcSourceCgroupMemory)) {
+    if (memoryPath != NULL) {
+      snprintf(path, PATH_MAX, CGROUP_ROOT "/memory%s/memory.usage_in_bytes",
+               memoryPath);
+      fds[ProcSourceCgroupMemory] = openSourceFile(path);
+      if (fds[ProcSourceCgroupMemory] == -1) {
+        fds[ProcSourceCgroupMemory] =
+            openSourceFile(CGROUP_ROOT "/memory/memory.usage_in_bytes");
+      }
+    } else if (unifiedPath != NULL) {
+      snprintf(path, PATH_MAX, CGROUP_ROOT "%s/memory.current", unifiedPath);
+      fds[ProcSourceCgroupMemory] = openSourceFile(path);
+      /* Root cgroup of v2 does not have memory.current. */
+    }
+  }
+}
+
+/*!
+ * \brief Read whole source file from the top.
+ * \param source [in]  Source to read.
+ * \param buf    [out] Buffer to store content. It is terminated by NUL.
+ * \param size   [in]  Size of buffer.
+ * \return true if succeeded.
+ */
+bool TProcSampler::readSource(TProcSource source, char *buf, size_t size) {
+  /* procfs and cgroupfs regenerate content when it is read from the top. */
+  ssize_t len = pread(fds[source], buf, size - 1, 0);
+  if (unlikely(len <= 0)) {
+    return false;
+  }
+
+  buf[len] = '\0';
+  return true;
+}
+
+/*!
+ * \brief Parse /proc/self/stat.
+ * \param buf    [in]  Content of file.
+ * \param sample [out] Resource usage.
+ * \return true if succeeded.
+ */
+bool TProcSampler::parseStat(const char *buf, TProcSample *sample) {
+  /* Command name might contain spaces and parentheses. */
+  const char *ptr = strrchr(buf, ')');
+  if (unlikely(ptr == NULL)) {
+    return false;
+  }
+  ptr++;
+
+  for (int idx = 0; idx < STAT_UTIME_INDEX; idx++) {
+    ptr = skipField(ptr);
+  }
+
+  TLargeUInt usrTime, sysTime, vmSize, rsSize;
+  if (unlikely(((ptr = parseUInt(ptr, &usrTime)) == NULL) ||
+               ((ptr = parseUInt(ptr, &sysTime)) == NULL))) {
+    return false;
+  }
+
+  for (int idx = STAT_UTIME_INDEX + 2; idx < STAT_VSIZE_INDEX; idx++) {
+    ptr = skipField(ptr);
+  }
+
+  if (unlikely(((ptr = parseUInt(ptr, &vmSize)) == NULL) ||
+               ((ptr = parseUInt(ptr, &rsSize)) == NULL))) {
+    return false;
+  }
+
+  sample->usrTime = usrTime;
+  sample->sysTime = sysTime;
+  sample->vmSize = vmSize;
+  sample->rsSize = rsSize * systemPageSize;
+  return true;
+}
+
+/*!
+ * \brief Parse /proc/stat.
+ * \param buf   [in]  Content of file.
+ * \param times [out] Machine cpu times.
+ * \return true if succeeded.
+ */
+bool TProcSampler::parseSysStat(const char *buf, TMachineTimes *times) {
+  const char *ptr = findKey(buf, "cpu ");
+  if (unlikely(ptr == NULL)) {
+    /* Maybe the kernel is modified. */
+    logger->printWarnMsg("Not found cpu status data.");
+    return false;
+  }
+
+  TLargeUInt *fields[] = {&times->usrTime,     &times->lowUsrTime,
+                          &times->sysTime,     &times->idleTime,
+                          &times->iowaitTime,  &times->sortIrqTime,
+                          &times->irqTime,     &times->stealTime,
+                          &times->guestTime};
+  for (size_t idx = 0; idx < sizeof(fields) / sizeof(fields[0]); idx++) {
+    ptr = parseUInt(ptr, fields[idx]);
+    if (unlikely(ptr == NULL)) {
+      /* Maybe the kernel is old version. */
+      logger->printWarnMsg("CPU status data has shortage.");
+      break;
+    }
+  }
+
+  return true;
+}
+
+/*!
+ * \brief Sample resource usage.<br>
+ *        This function is thread-safe.
+ * \param sample [out] Resource usage.
+ * \return true if process and machine cpu times are sampled.
+ */
+bool TProcSampler::sample(TProcSample *sample) {
+  char buf[PROC_SAMPLER_BUFFER_SIZE];
+  bool result = true;
+
+  memset(sample, 0xff, sizeof(TProcSample));
+  memset(&sample->cpuTimes, 0, sizeof(TMachineTimes));
+
+  /* Java process information. */
+  if (unlikely((fds[ProcSourceStat] == -1) ||
+               !readSource(ProcSourceStat, buf, sizeof(buf)))) {
+    logger->printWarnMsg("Couldn't read process status.");
+    result = false;
+  } else if (unlikely(!parseStat(buf, sample))) {
+    /* Kernel may be old or customized. */
+    logger->printWarnMsg("Process data has shortage.");
+  }
+
+  /* Machine cpu times. The first line is needed only. */
+  if (unlikely((fds[ProcSourceSysStat] == -1) ||
+               !readSource(ProcSourceSysStat, buf, sizeof(buf)) ||
+               !parseSysStat(buf, &sample->cpuTimes))) {
+    result = false;
+  }
+
+  /* I/O accounting. */
+  if ((fds[ProcSourceIO] != -1) &&
+      readSource(ProcSourceIO, buf, sizeof(buf))) {
+    parseKeyValue(buf, "rchar:", &sample->readChars);
+    parseKeyValue(buf, "wchar:", &sample->writeChars);
+    parseKeyValue(buf, "syscr:", &sample->readSyscalls);
+    parseKeyValue(buf, "syscw:", &sample->writeSyscalls);
+    parseKeyValue(buf, "read_bytes:", &sample->readBytes);
+    parseKeyValue(buf, "write_bytes:", &sample->writeBytes);
+  }
+
+  /* Scheduler statistics. */
+  if ((fds[ProcSourceSchedStat] != -1) &&
+      readSource(ProcSourceSchedStat, buf, sizeof(buf))) {
+    const char *ptr = buf;
+    if (((ptr = parseUInt(ptr, &sample->runTime)) != NULL) &&
+        ((ptr = parseUInt(ptr, &sample->runqueueTime)) != NULL)) {
+      parseUInt(ptr, &sample->timeslices);
+    }
+  }
+
+  /* Cgroup cpu usage. */
+  if ((fds[ProcSourceCgroupCpu] != -1) &&
+      readSource(ProcSourceCgroupCpu, buf, sizeof(buf))) {
+    if (isCpuStatV2) {
+      TLargeUInt usec;
+      const char *ptr = findKey(buf, "usage_usec");
+      if ((ptr != NULL) && (parseUInt(ptr, &usec) != NULL)) {
+        sample->cgroupCpuTime = usec * 1000;
+      }
+
+      ptr = findKey(buf, "throttled_usec");
+      if ((ptr != NULL) && (parseUInt(ptr, &usec) != NULL)) {
+        sample->cgroupThrottleTime = usec * 1000;
+      }
+    } else {
+      parseUInt(buf, &sample->cgroupCpuTime);
+    }
+  }
+
+  /* Cgroup memory usage. */
+  if ((fds[ProcSourceCgroupMemory] != -1) &&
+      readSource(ProcSourceCgroupMemory, buf, sizeof(buf))) {
+    parseUInt(buf, &sample->cgroupMemoryUsage);
+  }
+
+  return result;
+}
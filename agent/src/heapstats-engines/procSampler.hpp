@@ -0,0 +1,160 @@
+/*!
+ * \file procSampler.hpp
+ * \brief This file is used to sample resource usage from procfs and cgroup.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ *
+ */
+
+#ifndef _PROC_SAMPLER_H
+#define _PROC_SAMPLER_H
+
+#include "util.hpp"
+
+/*!
+ * \brief Value of field which could not be sampled.
+ */
+#define PROC_SAMPLE_UNKNOWN ((TLargeUInt)-1)
+
+/*!
+ * \brief Sources of resource usage.
+ */
+typedef enum {
+  ProcSourceStat = 0,      /*!< /proc/self/stat                  */
+  ProcSourceSysStat,       /*!< /proc/stat                       */
+  ProcSourceIO,            /*!< /proc/self/io                    */
+  ProcSourceSchedStat,     /*!< /proc/self/schedstat             */
+  ProcSourceCgroupCpu,     /*!< cpu.stat or cpuacct.usage        */
+  ProcSourceCgroupMemory,  /*!< memory.current or usage_in_bytes */
+  ProcSourceCount          /*!< Count of sources.                */
+} TProcSource;
+
+/*!
+ * \brief Flag of source for TProcSampler constructor.
+ */
+#define PROC_SOURCE_FLAG(source) (1 << (source))
+
+/*!
+ * \brief This structure is used to get and store machine cpu time.
+ */
+typedef struct {
+  TLargeUInt usrTime;     /*!< Time used by user work.                     */
+  TLargeUInt lowUsrTime;  /*!< Time used by user work under low priority.  */
+  TLargeUInt sysTime;     /*!< Time used by kernel work.                   */
+  TLargeUInt idleTime;    /*!< Time used by waiting task work.             */
+  TLargeUInt iowaitTime;  /*!< Time used by waiting IO work.               */
+  TLargeUInt sortIrqTime; /*!< Time used by sort intercept work.           */
+  TLargeUInt irqTime;     /*!< Time used by intercept work.                */
+  TLargeUInt stealTime;   /*!< Time used by other OS.                      */
+  TLargeUInt guestTime;   /*!< Time used by guest OS under kernel control. */
+} TMachineTimes;
+
+/*!
+ * \brief This structure is used to store resource usage of java process.
+ *        Fields of source which is not sampled are PROC_SAMPLE_UNKNOWN.
+ */
+typedef struct {
+  TLargeUInt usrTime;            /*!< User cpu time of process.          */
+  TLargeUInt sysTime;            /*!< System cpu time of process.        */
+  TLargeUInt vmSize;             /*!< Virtual memory size in bytes.      */
+  TLargeUInt rsSize;             /*!< Resident set size in bytes.        */
+  TMachineTimes cpuTimes;        /*!< Machine cpu times.                 */
+  TLargeUInt readChars;          /*!< Bytes read by read syscalls.       */
+  TLargeUInt writeChars;         /*!< Bytes written by write syscalls.   */
+  TLargeUInt readSyscalls;       /*!< Count of read syscalls.            */
+  TLargeUInt writeSyscalls;      /*!< Count of write syscalls.           */
+  TLargeUInt readBytes;          /*!< Bytes read from storage.           */
+  TLargeUInt writeBytes;         /*!< Bytes written to storage.          */
+  TLargeUInt runTime;            /*!< Time on cpu in nanoseconds.        */
+  TLargeUInt runqueueTime;       /*!< Time on runqueue in nanoseconds.   */
+  TLargeUInt timeslices;         /*!< Count of timeslices.               */
+  TLargeUInt cgroupCpuTime;      /*!< Cpu time of cgroup in nanoseconds. */
+  TLargeUInt cgroupThrottleTime; /*!< Throttled time in nanoseconds.     */
+  TLargeUInt cgroupMemoryUsage;  /*!< Memory usage of cgroup in bytes.   */
+} TProcSample;
+
+/*!
+ * \brief This class samples resource usage of java process.<br>
+ *        Files are kept open, and they are read by pread(2) into a buffer
+ *        on stack. So sampling does not allocate memory, and it needs only
+ *        one syscall per source.
+ */
+class TProcSampler {
+ public:
+  /*!
+   * \brief TProcSampler constructor.
+   * \param sources [in] Flags of sources to sample.
+   */
+  TProcSampler(int sources);
+
+  /*!
+   * \brief TProcSampler destructor.
+   */
+  virtual ~TProcSampler(void);
+
+  /*!
+   * \brief Sample resource usage.<br>
+   *        This function is thread-safe.
+   * \param sample [out] Resource usage.
+   * \return true if process and machine cpu times are sampled.
+   */
+  bool sample(TProcSample *sample);
+
+ protected:
+  /*!
+   * \brief Open files of cgroup which the process belongs to.
+   * \param sources [in] Flags of sources to sample.
+   */
+  void openCgroupSources(int sources);
+
+  /*!
+   * \brief Read whole source file from the top.
+   * \param source [in]  Source to read.
+   * \param buf    [out] Buffer to store content. It is terminated by NUL.
+   * \param size   [in]  Size of buffer.
+   * \return true if succeeded.
+   */
+  bool readSource(TProcSource source, char *buf, size_t size);
+
+  /*!
+   * \brief Parse /proc/self/stat.
+   * \param buf    [in]  Content of file.
+   * \param sample [out] Resource usage.
+   * \return true if succeeded.
+   */
+  bool parseStat(const char *buf, TProcSample *sample);
+
+  /*!
+   * \brief Parse /proc/stat.
+   * \param buf   [in]  Content of file.
+   * \param times [out] Machine cpu times.
+   * \return true if succeeded.
+   */
+  bool parseSysStat(const char *buf, TMachineTimes *times);
+
+  /*!
+   * \brief File descriptors of each source. -1 means not available.
+   */
+  int fds[ProcSourceCount];
+
+  /*!
+   * \brief cpu.stat of cgroup v2 is used for cgroup cpu source.
+   */
+  bool isCpuStatV2;
+};
+
+#endif  // _PROC_SAMPLER_H
@@ -0,0 +1,253 @@
+/*!
+ * \file resourceLogFormat.hpp
+ * \brief Format of binary resource log file.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ *
+ */
+
+#ifndef RESOURCE_LOG_FORMAT_HPP
+#define RESOURCE_LOG_FORMAT_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*!
+ * \brief Magic number of binary resource log file.
+ */
+#define RESOURCE_LOG_MAGIC "HSRL"
+
+/*!
+ * \brief Format version of binary resource log file.<br>
+ *        All integers are little endian. Layout is as below.
+ *        <ul>
+ *          <li>char[4]: RESOURCE_LOG_MAGIC</li>
+ *          <li>uint8: Format version</li>
+ *          <li>uint8: Count of columns, and each column as uint8
+ *              TResourceLogColumnType, uint8 length of name and name</li>
+ *          <li>Blocks. Each block is as below.
+ *            <ul>
+ *              <li>uint64: RESOURCE_LOG_SYNC_MARKER</li>
+ *              <li>uint32: Size of block after this field</li>
+ *              <li>uint16: Count of rows</li>
+ *              <li>Each integer column as uint8 width of value (0, 1, 2, 4
+ *                  or 8), uint64 base value, and values of rows as
+ *                  difference from base value</li>
+ *              <li>Each string column as uint16 length and string for
+ *                  each row</li>
+ *            </ul>
+ *          </li>
+ *        </ul>
+ *        Values in a column of block have same width, so a value can be
+ *        read from mapped file directly. Sync marker is used to find next
+ *        block when a block is broken. Rows of the last block are written
+ *        as blocks of a row, and they are packed into a block when it is
+ *        filled.
+ */
+#define RESOURCE_LOG_FORMAT_VERSION 1
+
+/*!
+ * \brief Sync marker at the top of each block. ("HSRLSYNC")
+ */
+#define RESOURCE_LOG_SYNC_MARKER 0x434e59534c525348ULL
+
+/*!
+ * \brief Size of block header. (sync marker, block size and row count)
+ */
+#define RESOURCE_LOG_BLOCK_HEADER_SIZE (8 + 4 + 2)
+
+/*!
+ * \brief Value of unsigned integer column which could not be sampled.
+ */
+#define RESOURCE_LOG_UNKNOWN_VALUE UINT64_MAX
+
+/*!
+ * \brief Max count of rows in a block.
+ */
+#define RESOURCE_LOG_MAX_BLOCK_ROWS 64
+
+/*!
+ * \brief Type of column.
+ */
+typedef enum {
+  ResourceLogUInt = 0,   /*!< Unsigned integer.  */
+  ResourceLogInt = 1,    /*!< Signed integer.    */
+  ResourceLogString = 2  /*!< String.            */
+} TResourceLogColumnType;
+
+/*!
+ * \brief Integer columns of binary resource log.<br>
+ *        The first RESOURCE_LOG_CSV_COLUMNS columns are same as CSV
+ *        resource log.
+ */
+typedef enum {
+  ResourceLogTime = 0,
+  ResourceLogCause,
+  ResourceLogJavaUserTime,
+  ResourceLogJavaSysTime,
+  ResourceLogJavaVSSize,
+  ResourceLogJavaRSSize,
+  ResourceLogSystemUserTime,
+  ResourceLogSystemNiceTime,
+  ResourceLogSystemSysTime,
+  ResourceLogSystemIdleTime,
+  ResourceLogSystemIOWaitTime,
+  ResourceLogSystemIRQTime,
+  ResourceLogSystemSoftIRQTime,
+  ResourceLogSystemStealTime,
+  ResourceLogSystemGuestTime,
+  ResourceLogJvmSyncPark,
+  ResourceLogJvmSafepointTime,
+  ResourceLogJvmSafepoints,
+  ResourceLogJvmLiveThreads,
+  ResourceLogIOReadChars,
+  ResourceLogIOWriteChars,
+  ResourceLogIOReadSyscalls,
+  ResourceLogIOWriteSyscalls,
+  ResourceLogIOReadBytes,
+  ResourceLogIOWriteBytes,
+  ResourceLogSchedRunTime,
+  ResourceLogSchedRunqueueTime,
+  ResourceLogSchedTimeslices,
+  ResourceLogCgroupCpuTime,
+  ResourceLogCgroupThrottleTime,
+  ResourceLogCgroupMemoryUsage,
+  ResourceLogIOLatencyFileWriteCount,
+  ResourceLogIOLatencyFileWriteP50,
+  ResourceLogIOLatencyFileWriteP99,
+  ResourceLogIOLatencyFileWriteMax,
+  ResourceLogIOLatencyFileReadCount,
+  ResourceLogIOLatencyFileReadP50,
+  ResourceLogIOLatencyFileReadP99,
+  ResourceLogIOLatencyFileReadMax,
+  ResourceLogIOLatencySocketWriteCount,
+  ResourceLogIOLatencySocketWriteP50,
+  ResourceLogIOLatencySocketWriteP99,
+  ResourceLogIOLatencySocketWriteMax,
+  ResourceLogIOLatencySocketReadCount,
+  ResourceLogIOLatencySocketReadP50,
+  ResourceLogIOLatencySocketReadP99,
+  ResourceLogIOLatencySocketReadMax,
+  ResourceLogIntColumns
+} TResourceLogColumn;
+
+/*!
+ * \brief Count of I/O latency columns of each I/O kind of thread recorder.
+ *        They are count, p50, p99 and max in nanoseconds since recorder
+ *        was started.
+ */
+#define RESOURCE_LOG_IO_LATENCY_COLUMNS 4
+
+/*!
+ * \brief Count of integer columns which are in CSV resource log.
+ */
+#define RESOURCE_LOG_CSV_COLUMNS (ResourceLogJvmLiveThreads + 1)
+
+/*!
+ * \brief Name of string column for archive file name.
+ */
+#define RESOURCE_LOG_ARCHIVE_COLUMN "archive"
+
+/*!
+ * \brief Column definition.
+ */
+typedef struct {
+  const char *name;             /*!< Name of column. */
+  TResourceLogColumnType type;  /*!< Type of column. */
+} TResourceLogColumnDef;
+
+/*!
+ * \brief Definitions of integer columns in order of TResourceLogColumn.
+ *        Archive file name column follows them.
+ */
+static const TResourceLogColumnDef resourceLogColumns[] = {
+    {"time", ResourceLogInt},
+    {"cause", ResourceLogInt},
+    {"java_user_time", ResourceLogUInt},
+    {"java_sys_time", ResourceLogUInt},
+    {"java_vssize", ResourceLogUInt},
+    {"java_rssize", ResourceLogUInt},
+    {"system_user_time", ResourceLogUInt},
+    {"system_nice_time", ResourceLogUInt},
+    {"system_sys_time", ResourceLogUInt},
+    {"system_idle_time", ResourceLogUInt},
+    {"system_iowait_time", ResourceLogUInt},
+    {"system_irq_time", ResourceLogUInt},
+    {"system_softirq_time", ResourceLogUInt},
+    {"system_steal_time", ResourceLogUInt},
+    {"system_guest_time", ResourceLogUInt},
+    {"jvm_sync_park", ResourceLogInt},
+    {"jvm_safepoint_time", ResourceLogInt},
+    {"jvm_safepoints", ResourceLogInt},
+    {"jvm_live_threads", ResourceLogInt},
+    {"io_read_chars", ResourceLogUInt},
+    {"io_write_chars", ResourceLogUInt},
+    {"io_read_syscalls", ResourceLogUInt},
+    {"io_write_syscalls", ResourceLogUInt},
+    {"io_read_bytes", ResourceLogUInt},
+    {"io_write_bytes", ResourceLogUInt},
+    {"sched_run_time", ResourceLogUInt},
+    {"sched_runqueue_time", ResourceLogUInt},
+    {"sched_timeslices", ResourceLogUInt},
+    {"cgroup_cpu_time", ResourceLogUInt},
+    {"cgroup_throttle_time", ResourceLogUInt},
+    {"cgroup_memory_usage", ResourceLogUInt},
+    {"io_latency_file_write_count", ResourceLogUInt},
+    {"io_latency_file_write_p50", ResourceLogUInt},
+    {"io_latency_file_write_p99", ResourceLogUInt},
+    {"io_latency_file_write_max", ResourceLogUInt},
+    {"io_latency_file_read_count", ResourceLogUInt},
+    {"io_latency_file_read_p50", ResourceLogUInt},
+    {"io_latency_file_read_p99", ResourceLogUInt},
+    {"io_latency_file_read_max", ResourceLogUInt},
+    {"io_latency_socket_write_count", ResourceLogUInt},
+    {"io_latency_socket_write_p50", ResourceLogUInt},
+    {"io_latency_socket_write_p99", ResourceLogUInt},
+    {"io_latency_socket_write_max", ResourceLogUInt},
+    {"io_latency_socket_read_count", ResourceLogUInt},
+    {"io_latency_socket_read_p50", ResourceLogUInt},
+    {"io_latency_socket_read_p99", ResourceLogUInt},
+    {"io_latency_socket_read_max", ResourceLogUInt}};
+
+/*!
+ * \brief Store integer as little endian.
+ * \param dest  [out] Destination.
+ * \param value [in]  Value to store.
+ * \param width [in]  Width of value in bytes.
+ */
+inline void storeLittleEndian(unsigned char *dest, uint64_t value,
+                              int width) {
+  for (int idx = 0; idx < width; idx++) {
+    dest[idx] = (unsigned char)(value >> (idx * 8));
+  }
+}
+
+/*!
+ * \brief Load little endian integer.
+ * \param src   [in] Source.
+ * \param width [in] Width of value in bytes.
+ * \return Loaded value.
+ */
+inline uint64_t loadLittleEndian(const unsigned char *src, int width) {
+  uint64_t value = 0;
+  for (int idx = width - 1; idx >= 0; idx--) {
+    value = (value << 8) | src[idx];
+  }
+  return value;
+}
+
+#endif  // RESOURCE_LOG_FORMAT_HPP
@@ -0,0 +1,391 @@
+/*!
+ * \file resourceLogWriter.cpp
+ * \brief This file is used to write binary resource log.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ *
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "globals.hpp"
+#include "resourceLogWriter.hpp"
+
+/*!
+ * \brief Max size of file header.
+ *        Magic, version, column count and each column.
+ */
+#define RESOURCE_LOG_MAX_HEADER_SIZE \
+  (4 + 1 + 1 + (ResourceLogIntColumns + 1) * 34)
+
+/*!
+ * \brief Max length of archive file name in a row.
+ */
+#define RESOURCE_LOG_MAX_ARCHIVE_LEN 0xffff
+
+/*!
+ * \brief Get width to store value.
+ * \param value [in] Max value in column of block.
+ * \return Width in bytes.
+ */
+static inline int getValueWidth(uint64_t value) {
+  if (value == 0) {
+    return 0;
+  } else if (value <= 0xffULL) {
+    return 1;
+  } else if (value <= 0xffffULL) {
+    return 2;
+  } else if (value <= 0xffffffffULL) {
+    return 4;
+  }
+
+  return 8;
+}
+
+/*!
+ * \brief Make file header.
+ * \param header [out] Buffer to store header.
+ * \return Size of header.
+ */
+static size_t makeHeader(unsigned char *header) {
+  size_t pos = 0;
+
+  memcpy(header, RESOURCE_LOG_MAGIC, 4);
+  pos += 4;
+  header[pos++] = RESOURCE_LOG_FORMAT_VERSION;
+  header[pos++] = ResourceLogIntColumns + 1;
+
+  for (int idx = 0; idx <= ResourceLogIntColumns; idx++) {
+    const char *name;
+    TResourceLogColumnType type;
+    if (idx < ResourceLogIntColumns) {
+      name = resourceLogColumns[idx].name;
+      type = resourceLogColumns[idx].type;
+    } else {
+      name = RESOURCE_LOG_ARCHIVE_COLUMN;
+      type = ResourceLogString;
+    }
+
+    size_t nameLen = strlen(name);
+    header[pos++] = (unsigned char)type;
+    header[pos++] = (unsigned char)nameLen;
+    memcpy(header + pos, name, nameLen);
+    pos += nameLen;
+  }
+
+  return pos;
+}
+
+/*!
+ * \brief Write whole buffer to file at offset.
+ * \param fd     [in] File descriptor.
+ * \param buf    [in] Buffer to write.
+ * \param size   [in] Size of buffer.
+ * \param offset [in] Offset of file to write.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+static int writeFully(int fd, const unsigned char *buf, size_t size,
+                      off_t offset) {
+  while (size > 0) {
+    ssize_t written = pwrite(fd, buf, size, offset);
+    if (unlikely(written < 0)) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return errno;
+    }
+
+    buf += written;
+    size -= written;
+    offset += written;
+  }
+
+  return 0;
+}
+
+/*!
+ * \brief TResourceLogWriter constructor.
+ * \param fname [in] Path of log file.
+ */
+TResourceLogWriter::TResourceLogWriter(const char *fname) {
+  blockOffset = 0;
+  tailOffset = 0;
+  rows = 0;
+  memset(archives, 0, sizeof(archives));
+
+  /* Block of integer columns and archive file name lengths. */
+  bufferSize = RESOURCE_LOG_BLOCK_HEADER_SIZE +
+               ResourceLogIntColumns *
+                   (1 + 8 + RESOURCE_LOG_MAX_BLOCK_ROWS * sizeof(uint64_t)) +
+               RESOURCE_LOG_MAX_BLOCK_ROWS * 2;
+  buffer = (unsigned char *)malloc(bufferSize);
+  fileName = strdup(fname);
+  if (unlikely((buffer == NULL) || (fileName == NULL))) {
+    free(buffer);
+    free(fileName);
+    throw "Could not allocate memory for binary resource log.";
+  }
+
+  /* Packed block is written over rows, so O_APPEND is not used. */
+  fd = open(fname, O_CREAT | O_RDWR | O_CLOEXEC, S_IRUSR | S_IWUSR);
+  if (unlikely(fd < 0)) {
+    logger->printWarnMsgWithErrno("Could not open log file");
+    free(buffer);
+    free(fileName);
+    throw "Could not open binary resource log.";
+  }
+
+  if (unlikely(!prepareHeader())) {
+    close(fd);
+    free(buffer);
+    free(fileName);
+    throw "Could not use binary resource log.";
+  }
+}
+
+/*!
+ * \brief TResourceLogWriter destructor.
+ */
+TResourceLogWriter::~TResourceLogWriter(void) {
+  closeBlock();
+  close(fd);
+
+  free(buffer);
+  free(fileName);
+}
+
+/*!
+ * \brief Write file header, or check header of existing file.
+ * \return true if the file can be appended.
+ */
+bool TResourceLogWriter::prepareHeader(void) {
+  unsigned char header[RESOURCE_LOG_MAX_HEADER_SIZE];
+  size_t headerSize = makeHeader(header);
+
+  struct stat st;
+  if (unlikely(fstat(fd, &st) != 0)) {
+    logger->printWarnMsgWithErrno("Could not get status of log file");
+    return false;
+  }
+
+  if (st.st_size == 0) {
+    errno = writeFully(fd, header, headerSize, 0);
+    if (unlikely(errno != 0)) {
+      logger->printWarnMsgWithErrno("Could not write to log file");
+      return false;
+    }
+
+    return true;
+  }
+
+  /* Existing file must have same schema. e.g. It is not CSV. */
+  unsigned char existing[RESOURCE_LOG_MAX_HEADER_SIZE];
+  if (unlikely((pread(fd, existing, headerSize, 0) != (ssize_t)headerSize) ||
+               (memcmp(existing, header, headerSize) != 0))) {
+    logger->printWarnMsg("Log file is not binary resource log: %s",
+                         fileName);
+    return false;
+  }
+
+  return true;
+}
+
+/*!
+ * \brief Append a row, and write it to log file.
+ * \param values  [in] Values of integer columns.
+ * \param archive [in] Archive file name. It might be empty.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TResourceLogWriter::append(const uint64_t values[ResourceLogIntColumns],
+                               const char *archive) {
+  /* New block starts at the end of file. */
+  if (rows == 0) {
+    blockOffset = lseek(fd, 0, SEEK_END);
+    if (unlikely(blockOffset < 0)) {
+      int result = errno;
+      logger->printWarnMsgWithErrno("Could not seek log file");
+      return result;
+    }
+    tailOffset = blockOffset;
+  }
+
+  for (int idx = 0; idx < ResourceLogIntColumns; idx++) {
+    columns[idx][rows] = values[idx];
+  }
+
+  if ((archive != NULL) && (archive[0] != '\0')) {
+    archives[rows] = strndup(archive, RESOURCE_LOG_MAX_ARCHIVE_LEN);
+  }
+  rows++;
+
+  /* Only the new row is written. It is packed in closeBlock(). */
+  int result = 0;
+  size_t size = encodeBlock(rows - 1, 1, 0);
+  if (unlikely(size == 0)) {
+    result = ENOMEM;
+    logger->printWarnMsg("Could not allocate memory for binary resource log.");
+  } else {
+    result = writeFully(fd, buffer, size, tailOffset);
+    if (unlikely(result != 0)) {
+      errno = result;
+      logger->printWarnMsgWithErrno("Could not write to log file");
+    } else {
+      tailOffset += size;
+    }
+  }
+
+  if (rows >= RESOURCE_LOG_MAX_BLOCK_ROWS) {
+    closeBlock();
+  }
+
+  return result;
+}
+
+/*!
+ * \brief Encode rows of current block.
+ * \return Size of block.
+ */
+size_t TResourceLogWriter::encodeBlock(int from, int count, size_t reserve) {
+  int to = from + count;
+  size_t required = bufferSize;
+  for (int row = from; row < to; row++) {
+    if (archives[row] != NULL) {
+      required += strlen(archives[row]);
+    }
+  }
+  if (required < reserve) {
+    required = reserve;
+  }
+
+  /* Grow buffer for archive file names. */
+  if (unlikely(required > bufferSize)) {
+    unsigned char *newBuffer = (unsigned char *)realloc(buffer, required);
+    if (unlikely(newBuffer == NULL)) {
+      return 0;
+    }
+
+    buffer = newBuffer;
+    bufferSize = required;
+  }
+
+  size_t pos = RESOURCE_LOG_BLOCK_HEADER_SIZE;
+  for (int idx = 0; idx < ResourceLogIntColumns; idx++) {
+    uint64_t *values = columns[idx];
+
+    /* Values are stored as difference from minimum value. */
+    uint64_t base = values[from];
+    for (int row = from + 1; row < to; row++) {
+      if (values[row] < base) {
+        base = values[row];
+      }
+    }
+
+    uint64_t maxDiff = 0;
+    for (int row = from; row < to; row++) {
+      if (values[row] - base > maxDiff) {
+        maxDiff = values[row] - base;
+      }
+    }
+
+    int width = getValueWidth(maxDiff);
+    buffer[pos++] = (unsigned char)width;
+    storeLittleEndian(buffer + pos, base, 8);
+    pos += 8;
+
+    if (width > 0) {
+      for (int row = from; row < to; row++) {
+        storeLittleEndian(buffer + pos, values[row] - base, width);
+        pos += width;
+      }
+    }
+  }
+
+  for (int row = from; row < to; row++) {
+    size_t len = (archives[row] == NULL) ? 0 : strlen(archives[row]);
+    storeLittleEndian(buffer + pos, len, 2);
+    pos += 2;
+    if (len > 0) {
+      memcpy(buffer + pos, archives[row], len);
+      pos += len;
+    }
+  }
+
+  storeLittleEndian(buffer, RESOURCE_LOG_SYNC_MARKER, 8);
+  storeLittleEndian(buffer + 8, pos - 12, 4);
+  storeLittleEndian(buffer + 12, count, 2);
+
+  return pos;
+}
+
+/*!
+ * \brief Pack rows of current block, and write it over blocks of a row.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TResourceLogWriter::packBlock(void) {
+  /*
+   * Packed block is smaller than blocks of a row, because each of them has
+   * block header and base values. Rest of them is filled with zero in the
+   * same write, so rows are not read twice even if truncate is not done.
+   */
+  size_t tailSize = (size_t)(tailOffset - blockOffset);
+  size_t size = encodeBlock(0, rows, tailSize);
+  if (unlikely(size == 0)) {
+    return ENOMEM;
+  }
+
+  /* Packed block is larger only if some rows could not be written. */
+  size_t writeSize = size;
+  if (likely(tailSize > size)) {
+    memset(buffer + size, 0, tailSize - size);
+    writeSize = tailSize;
+  }
+
+  int result = writeFully(fd, buffer, writeSize, blockOffset);
+  if (likely(result == 0) &&
+      unlikely(ftruncate(fd, blockOffset + size) != 0)) {
+    result = errno;
+  }
+
+  return result;
+}
+
+/*!
+ * \brief Close current block. Next row is written to new block.
+ */
+void TResourceLogWriter::closeBlock(void) {
+  if (rows > 1) {
+    int result = packBlock();
+    if (unlikely(result != 0)) {
+      errno = result;
+      logger->printWarnMsgWithErrno("Could not pack block of log file");
+    }
+  }
+
+  for (int row = 0; row < rows; row++) {
+    free(archives[row]);
+    archives[row] = NULL;
+  }
+  rows = 0;
+}
@@ -0,0 +1,144 @@
+/*!
+ * \file resourceLogWriter.hpp
+ * \brief This file is used to write binary resource log.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ *
+ */
+
+#ifndef _RESOURCE_LOG_WRITER_H
+#define _RESOURCE_LOG_WRITER_H
+
+#include <sys/types.h>
+
+#include "resourceLogFormat.hpp"
+#include "util.hpp"
+
+/*!
+ * \brief This class appends rows to binary resource log.<br>
+ *        Each row is written as a block of a row as soon as it is appended,
+ *        so no row is lost when the process crashes. When the block is
+ *        closed, its rows are packed into a block which is written over
+ *        them. So each row is written about twice.<br>
+ *        This class is not thread-safe, and the file must not be written
+ *        by others.
+ */
+class TResourceLogWriter {
+ public:
+  /*!
+   * \brief TResourceLogWriter constructor.
+   * \param fname [in] Path of log file.
+   */
+  TResourceLogWriter(const char *fname);
+
+  /*!
+   * \brief TResourceLogWriter destructor.
+   */
+  virtual ~TResourceLogWriter(void);
+
+  /*!
+   * \brief Append a row, and write it to log file.
+   * \param values  [in] Values of integer columns.
+   * \param archive [in] Archive file name. It might be empty.
+   * \return Value is zero, if process is succeed.<br />
+   *         Value is error number a.k.a. "errno", if process is failure.
+   */
+  int append(const uint64_t values[ResourceLogIntColumns],
+             const char *archive);
+
+  /*!
+   * \brief Close current block. Next row is written to new block.
+   */
+  void closeBlock(void);
+
+  /*!
+   * \brief Get path of log file.
+   * \return Path of log file.
+   */
+  inline const char *getFileName(void) { return fileName; }
+
+ protected:
+  /*!
+   * \brief Write file header, or check header of existing file.
+   * \return true if the file can be appended.
+   */
+  bool prepareHeader(void);
+
+  /*!
+   * \brief Encode rows of current block.
+   * \param from    [in] Index of the first row to encode.
+   * \param count   [in] Count of rows to encode.
+   * \param reserve [in] Buffer is grown to this size at least.
+   * \return Size of block. Value is zero if buffer cannot be grown.
+   */
+  size_t encodeBlock(int from, int count, size_t reserve);
+
+  /*!
+   * \brief Pack rows of current block, and write it over blocks of a row.
+   * \return Value is zero, if process is succeed.<br />
+   *         Value is error number a.k.a. "errno", if process is failure.
+   */
+  int packBlock(void);
+
+ private:
+  /*!
+   * \brief File descriptor of log file.
+   */
+  int fd;
+
+  /*!
+   * \brief Path of log file.
+   */
+  char *fileName;
+
+  /*!
+   * \brief Offset of current block in log file.
+   */
+  off_t blockOffset;
+
+  /*!
+   * \brief End of blocks of a row which are written for current block.
+   */
+  off_t tailOffset;
+
+  /*!
+   * \brief Count of rows in current block.
+   */
+  int rows;
+
+  /*!
+   * \brief Values of current block in column order.
+   */
+  uint64_t columns[ResourceLogIntColumns][RESOURCE_LOG_MAX_BLOCK_ROWS];
+
+  /*!
+   * \brief Archive file names of current block. NULL means empty.
+   */
+  char *archives[RESOURCE_LOG_MAX_BLOCK_ROWS];
+
+  /*!
+   * \brief Buffer to encode block.
+   */
+  unsigned char *buffer;
+
+  /*!
+   * \brief Size of buffer.
+   */
+  size_t bufferSize;
+};
+
+#endif  // _RESOURCE_LOG_WRITER_H
@@ -123,7 +123,8 @@ void TSnapShotContainer::releaseInstance(TSnapShotContainer *instance) {
 /*!
  * \brief TSnapshotContainer constructor.
  */
-TSnapShotContainer::TSnapShotContainer(void) : counterMap(), childrenMap() {
+TSnapShotContainer::TSnapShotContainer(void)
+    : counterMap(), childrenMap(), matchedClasses() {
   /* Header setting. */
   this->_header.magicNumber = conf->CollectRefTree()->get()
                                 ? EXTENDED_REFTREE_SNAPSHOT
@@ -134,6 +135,8 @@ TSnapShotContainer::TSnapShotContainer(void) : counterMap(), childrenMap() {
   memset((void *)&this->_header.gcCause[0], 0, 80);
 
   this->isCleared = true;
+  this->isFiltered = false;
+  this->matchedClassesLock = 0;
 }
 
 /*!
@@ -296,6 +299,13 @@ void TSnapShotContainer::setJvmInfo(TJvmInfo *info) {
  * \brief Clear snapshot data.
  */
 void TSnapShotContainer::clear(bool isForce) {
+  this->isFiltered = false;
+  spinLockWait(&matchedClassesLock);
+  {
+    this->matchedClasses.clear();
+  }
+  spinLockRelease(&matchedClassesLock);
+
   if (!isForce && this->isCleared) {
     return;
   }
@@ -362,6 +372,12 @@ void TSnapShotContainer::removeObjectData(TClassInfoSet &unloadedList) {
    */
   for (auto itr = unloadedList.unsafe_begin();
        itr != unloadedList.unsafe_end(); itr++) {
+    spinLockWait(&matchedClassesLock);
+    {
+      matchedClasses.erase(*itr);
+    }
+    spinLockRelease(&matchedClassesLock);
+
     TSizeMap::const_accessor acc;
     if (counterMap.find(acc, *itr)) {
       TClassCounter *clsCounter = acc->second;
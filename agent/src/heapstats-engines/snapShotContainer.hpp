@@ -26,6 +26,7 @@
 #include <tbb/concurrent_queue.h>
 
 #include <algorithm>
+#include <unordered_set>
 
 #include "jvmInfo.hpp"
 #include "oopUtil.hpp"
@@ -49,12 +50,15 @@
  *                 It contains snapshot and metaspace data.
  *     0b00000001: This SnapShot contains reference data.
  *     0b00000010: This SnapShot contains safepoint time.
- *       Other fields (bit 2 - 6) are reserved.
+ *     0b00000100: This SnapShot contains only classes which are matched
+ *                 to class filter. Other classes are not measured.
+ *       Other fields (bit 3 - 6) are reserved.
  * \warning Don't change output snapshot format, if you change this value.
  */
 #define EXTENDED_SNAPSHOT         0x80  // 0b10000000
 #define EXTENDED_REFTREE_SNAPSHOT 0x81  // 0b10000001
 #define EXTENDED_SAFEPOINT_TIME   0x82  // 0b10000010
+#define EXTENDED_FILTERED_SNAPSHOT 0x84  // 0b10000100
 
 /*!
  * \brief This structure stored class size and number of class-instance.
@@ -286,6 +290,48 @@ class TSnapShotContainer {
    */
   inline void setIsCleared(bool flag) { this->isCleared = flag; }
 
+  /*!
+   * \brief Set "isFiltered" flag.
+   */
+  inline void setIsFiltered(bool flag) { this->isFiltered = flag; }
+
+  /*!
+   * \brief Is this snapshot counted only classes matched to class filter ?
+   */
+  inline bool getIsFiltered(void) { return this->isFiltered; }
+
+  /*!
+   * \brief Mark class as matched to class filter.
+   * \param objData [in] Class information which is matched.
+   * \warning Please call this function before counting objects.
+   */
+  inline void addMatchedClass(TObjectData *objData) {
+    spinLockWait(&matchedClassesLock);
+    {
+      try {
+        this->matchedClasses.insert(objData);
+      } catch (...) {
+        /* Class is not written to snapshot if memory is exhausted. */
+      }
+    }
+    spinLockRelease(&matchedClassesLock);
+  }
+
+  /*!
+   * \brief Is the class matched to class filter ?
+   * \param objData [in] Class information.
+   * \return Value is true if the class is counted in this snapshot.
+   */
+  inline bool isMatchedClass(TObjectData *objData) {
+    bool result;
+    spinLockWait(&matchedClassesLock);
+    {
+      result = this->matchedClasses.count(objData) > 0;
+    }
+    spinLockRelease(&matchedClassesLock);
+    return result;
+  }
+
   /*!
    * \brief Remove unloaded TObjectData in this snapshot container.
    *        This function should be called at safepoint.
@@ -359,6 +405,22 @@ class TSnapShotContainer {
    */
   volatile bool isCleared;
 
+  /*!
+   * \brief Is this container counted by class filter ?
+   */
+  volatile bool isFiltered;
+
+  /*!
+   * \brief Set of classes which are matched to class filter.
+   */
+  std::unordered_set<TObjectData *> matchedClasses;
+
+  /*!
+   * \brief Lock of matchedClasses.<br>
+   *        Classes are removed from it by GC thread while class unloading.
+   */
+  volatile int matchedClassesLock;
+
   /*!
    * \brief Set of active TSnapShotContainer set
    */
@@ -32,10 +32,27 @@
 #include "elapsedTimer.hpp"
 #include "util.hpp"
 #include "callbackRegister.hpp"
+#include "allocProfiler.hpp"
+#include "contentionProfiler.hpp"
 #include "snapShotMain.hpp"
 
+#if USE_PCRE
+#include "pcreRegex.hpp"
+#else
+#include "cppRegex.hpp"
+#endif
+
 /* Struct defines. */
 
+/*!
+ * \brief Regex type for class filter of JVMTI snapshot.
+ */
+#if USE_PCRE
+typedef TPCRERegex TClassFilterRegex;
+#else
+typedef TCPPRegex TClassFilterRegex;
+#endif
+
 /*!
  * \brief This structure is stored snapshot and class heap usage.
  */
@@ -467,6 +484,166 @@ void HeapObjectCallbackOnJvmti(void *oop, void *data) {
   calculateObjectUsage(snapshotByJvmti, oop);
 }
 
+/*!
+ * \brief Compiled regex of class filter for JVMTI snapshot.<br>
+ *        This variable is guarded by jvmtiMutex.
+ */
+static TClassFilterRegex *classFilterRegex = NULL;
+
+/*!
+ * \brief Pattern string which classFilterRegex is compiled from.<br>
+ *        This variable is guarded by jvmtiMutex.
+ */
+static char *classFilterPattern = NULL;
+
+/*!
+ * \brief Get compiled regex of class filter.<br>
+ *        Regex is compiled again only when the pattern is changed.
+ * \param pattern [in] Regex pattern of class filter.
+ * \return Compiled regex.<br>
+ *         Value is NULL if the pattern is invalid.
+ * \warning Please call this function with jvmtiMutex.
+ */
+static TClassFilterRegex *getClassFilterRegex(const char *pattern) {
+  if ((classFilterPattern != NULL) &&
+      (strcmp(classFilterPattern, pattern) == 0)) {
+    return classFilterRegex;
+  }
+
+  delete classFilterRegex;
+  classFilterRegex = NULL;
+  free(classFilterPattern);
+  classFilterPattern = strdup(pattern);
+
+  try {
+#if USE_PCRE
+    classFilterRegex = new TClassFilterRegex(pattern, 3);
+#else
+    classFilterRegex = new TClassFilterRegex(pattern);
+#endif
+  } catch (...) {
+    logger->printWarnMsg("Invalid class filter: %s", pattern);
+    classFilterRegex = NULL;
+  }
+
+  return classFilterRegex;
+}
+
+/*!
+ * \brief Count object size in heap by JVMTI IterateThroughHeap.<br>
+ *        Class tag of object is pointer of TObjectData.
+ * \param clsTag   [in] Tag of class of object.
+ * \param size     [in] Size of object.
+ * \param objTag   [in,out] Tag of object.
+ * \param length   [in] Length of array if object is array.
+ * \param userData [in] Snapshot instance.
+ * \return Visit control flag.
+ */
+jint JNICALL HeapIterationCallbackWithFilter(jlong clsTag, jlong size,
+                                             jlong *objTag, jint length,
+                                             void *userData) {
+  TSnapShotContainer *snapshot = (TSnapShotContainer *)userData;
+  TObjectData *clsData = (TObjectData *)clsTag;
+
+  TClassCounter *clsCounter = snapshot->findClass(clsData);
+  if (unlikely(clsCounter == NULL)) {
+    /* Push new loaded class. */
+    clsCounter = snapshot->pushNewClass(clsData);
+
+    if (unlikely(clsCounter == NULL)) {
+      logger->printCritMsg("Couldn't get class counter!");
+      return JVMTI_VISIT_ABORT;
+    }
+  }
+
+  /* Count class size and instance count. */
+  snapshot->setIsCleared(false);
+  snapshot->FastInc(clsCounter->counter, size);
+
+  return JVMTI_VISIT_OBJECTS;
+}
+
+/*!
+ * \brief Count objects of classes which are matched to class filter.<br>
+ *        Matched classes are tagged with their TObjectData, and only
+ *        their instances are counted through IterateThroughHeap.
+ *        Reference tree is not collected in this mode.
+ * \param jvmti    [in] JVMTI environment object.
+ * \param env      [in] JNI environment object. This value might be NULL.
+ * \param snapshot [in] Snapshot instance.
+ * \param filter   [in] Compiled regex of class filter.
+ * \return Result of JVMTI function.
+ * \warning Please call this function with jvmtiMutex.
+ */
+static jvmtiError takeFilteredSnapShot(jvmtiEnv *jvmti, JNIEnv *env,
+                                       TSnapShotContainer *snapshot,
+                                       TClassFilterRegex *filter) {
+  jint classCount = 0;
+  jclass *classes = NULL;
+
+  jvmtiError error = jvmti->GetLoadedClasses(&classCount, &classes);
+  if (isError(jvmti, error)) {
+    return error;
+  }
+
+  /* Tag matched classes. */
+  TVMFunctions *vmFunc = TVMFunctions::getInstance();
+  jint taggedCount = 0;
+  for (jint idx = 0; idx < classCount; idx++) {
+    /*
+     * Wait if VM is at a safepoint which includes safepoint synchronizing,
+     * because jclass (oop in JNIHandle) might be relocated.
+     */
+    while (!isAtNormalExecution()) {
+      sched_yield();
+    }
+
+    void *klassOop = vmFunc->AsKlassOop(*(void **)classes[idx]);
+    if (unlikely(klassOop == NULL)) {
+      continue;
+    }
+
+    TObjectData *clsData = getObjectDataFromKlassOop(klassOop);
+    if (likely(clsData != NULL) &&
+        filter->find(clsContainer->getColdData(clsData)->className)) {
+      if (likely(jvmti->SetTag(classes[idx], (jlong)clsData) ==
+                 JVMTI_ERROR_NONE)) {
+        snapshot->addMatchedClass(clsData);
+        classes[taggedCount++] = classes[idx];
+        continue;
+      }
+    }
+
+    if (env != NULL) {
+      env->DeleteLocalRef(classes[idx]);
+    }
+  }
+
+  /* Count instances of tagged classes only. */
+  if (taggedCount > 0) {
+    jvmtiHeapCallbacks callbacks;
+    memset(&callbacks, 0, sizeof(jvmtiHeapCallbacks));
+    callbacks.heap_iteration_callback = &HeapIterationCallbackWithFilter;
+
+    error = jvmti->IterateThroughHeap(JVMTI_HEAP_FILTER_CLASS_UNTAGGED, NULL,
+                                      &callbacks, snapshot);
+  }
+
+  /* Untag classes. */
+  for (jint idx = 0; idx < taggedCount; idx++) {
+    jvmti->SetTag(classes[idx], 0);
+
+    if (env != NULL) {
+      env->DeleteLocalRef(classes[idx]);
+    }
+  }
+
+  jvmti->Deallocate((unsigned char *)classes);
+  snapshot->setIsFiltered(true);
+
+  return error;
+}
+
 /*!
  * \brief This function is for class oop adjust callback by GC.
  * \param oldOop [in] Old pointer of java class object(KlassOopDesc).
@@ -594,19 +771,30 @@ void TakeSnapShot(jvmtiEnv *jvmti, JNIEnv *env, TInvokeCause cause) {
       /* Lock to avoid doubling call JVMTI. */
       TMutexLocker locker(&jvmtiMutex);
 
-      snapshotByJvmti = snapshot;
+      char *pattern = conf->SnapShotClassFilter()->get();
+      TClassFilterRegex *filter = NULL;
+      if ((pattern != NULL) && (strlen(pattern) > 0)) {
+        filter = getClassFilterRegex(pattern);
+      }
+
+      if (filter != NULL) {
+        /* Count object size of filtered classes only. */
+        error = takeFilteredSnapShot(jvmti, env, snapshot, filter);
+      } else {
+        snapshotByJvmti = snapshot;
 
-      /* Enable JVMTI hooking. */
-      if (likely(setJvmtiHookState(true))) {
-        /* Count object size on heap. */
-        error = jvmti->IterateOverHeap(JVMTI_HEAP_OBJECT_EITHER,
-                                       &HeapObjectCallBack, NULL);
+        /* Enable JVMTI hooking. */
+        if (likely(setJvmtiHookState(true))) {
+          /* Count object size on heap. */
+          error = jvmti->IterateOverHeap(JVMTI_HEAP_OBJECT_EITHER,
+                                         &HeapObjectCallBack, NULL);
 
-        /* Disable JVMTI hooking. */
-        setJvmtiHookState(false);
-      }
+          /* Disable JVMTI hooking. */
+          setJvmtiHookState(false);
+        }
 
-      snapshotByJvmti = NULL;
+        snapshotByJvmti = NULL;
+      }
     }
 
     if (likely(error == JVMTI_ERROR_NONE)) {
@@ -646,6 +834,18 @@ void TakeSnapShot(jvmtiEnv *jvmti, JNIEnv *env, TInvokeCause cause) {
       /* Notify to processor. */
       notifySnapShot(snapshot);
     }
+
+    /* Output allocation sites alongside snapshot. */
+    if (conf->AllocSamplingEnable()->get() && (env != NULL)) {
+      allocprofiler::dumpAllocSites(jvmti, env,
+                                    conf->AllocSamplingFileName()->get());
+    }
+
+    /* Output contended monitors alongside snapshot. */
+    if (conf->ContentionProfileEnable()->get() && (env != NULL)) {
+      ctprofiler::dumpContendedMonitors(
+          jvmti, env, conf->ContentionProfileFileName()->get());
+    }
   }
 
   /* Phase3: Reset Timer. */
@@ -892,6 +1092,12 @@ void onAgentFinalForSnapShot(JNIEnv *env) {
   /* Finalize and deallocate old snapshot containers. */
   TSnapShotContainer::globalFinalize();
 
+  /* Destroy class filter. */
+  delete classFilterRegex;
+  classFilterRegex = NULL;
+  free(classFilterPattern);
+  classFilterPattern = NULL;
+
   /* Destroy object that is for snapshot. */
   delete clsContainer;
   clsContainer = NULL;
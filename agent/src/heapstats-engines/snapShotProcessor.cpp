@@ -247,7 +247,8 @@ void TSnapShotProcessor::showRanking(const TSnapShotFileHeader *hdr,
     logger->printInfoMsg("%4d  %15lld  %15lld  %s",
 #endif
                          Cnt + 1, aNode->value.usage, aNode->value.delta,
-                         ((TObjectData *)aNode->value.tag)->className);
+                         _container->getColdData(
+                             (TObjectData *)aNode->value.tag)->className);
   }
 
   /* Clean up after ranking output. */
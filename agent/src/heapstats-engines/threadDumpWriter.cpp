@@ -0,0 +1,223 @@
+/*!
+ * \file threadDumpWriter.cpp
+ * \brief This file is used to write thread dump through JVMTI.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ *
+ */
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "globals.hpp"
+#include "threadDumpWriter.hpp"
+
+/*!
+ * \brief TThreadDumpWriter constructor.
+ * \param jvmti [in] JVMTI environment object.
+ * \param env   [in] JNI environment object.
+ * \param fd    [in] Output file descriptor.
+ */
+TThreadDumpWriter::TThreadDumpWriter(jvmtiEnv *jvmti, JNIEnv *env, int fd)
+    : methodCache() {
+  this->jvmti = jvmti;
+  this->env = env;
+  this->fd = fd;
+  this->bufferUsed = 0;
+
+  this->buffer = (char *)malloc(THREAD_DUMP_BUFFER_SIZE);
+  if (unlikely(this->buffer == NULL)) {
+    throw "Could not allocate buffer of thread dump.";
+  }
+}
+
+/*!
+ * \brief TThreadDumpWriter destructor.<br>
+ *        Buffered data which is not flushed is discarded.
+ */
+TThreadDumpWriter::~TThreadDumpWriter(void) {
+  for (TMethodInfoCache::iterator itr = methodCache.begin();
+       itr != methodCache.end(); itr++) {
+    TCachedMethodInfo *info = &itr->second;
+    jvmti->Deallocate((unsigned char *)info->className);
+    jvmti->Deallocate((unsigned char *)info->methodName);
+    jvmti->Deallocate((unsigned char *)info->sourceFile);
+    jvmti->Deallocate((unsigned char *)info->lines);
+  }
+
+  free(buffer);
+}
+
+/*!
+ * \brief Append formatted string to buffer.<br>
+ *        Buffer is flushed if the string does not fit in it.
+ * \param format [in] Format string of printf.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TThreadDumpWriter::print(const char *format, ...) {
+  va_list args;
+
+  va_start(args, format);
+  int len = vsnprintf(buffer + bufferUsed, THREAD_DUMP_BUFFER_SIZE - bufferUsed,
+                      format, args);
+  va_end(args);
+
+  if (unlikely(len < 0)) {
+    return errno;
+  } else if (likely((size_t)len < THREAD_DUMP_BUFFER_SIZE - bufferUsed)) {
+    bufferUsed += len;
+    return 0;
+  }
+
+  /* String is formatted again after flush. */
+  int result = flush();
+  if (unlikely(result != 0)) {
+    return result;
+  }
+
+  va_start(args, format);
+  len = vsnprintf(buffer, THREAD_DUMP_BUFFER_SIZE, format, args);
+  va_end(args);
+
+  if (unlikely(len < 0)) {
+    return errno;
+  }
+
+  /* Too long string is truncated to the size of buffer. */
+  bufferUsed = ((size_t)len < THREAD_DUMP_BUFFER_SIZE)
+                   ? len
+                   : THREAD_DUMP_BUFFER_SIZE - 1;
+  return 0;
+}
+
+/*!
+ * \brief Write buffered data to file.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TThreadDumpWriter::flush(void) {
+  size_t written = 0;
+  while (written < bufferUsed) {
+    ssize_t writeSize = write(fd, buffer + written, bufferUsed - written);
+    if (unlikely(writeSize < 0)) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return errno;
+    }
+
+    written += writeSize;
+  }
+
+  bufferUsed = 0;
+  return 0;
+}
+
+/*!
+ * \brief Get method information in designed stack frame.
+ * \param frame [in]  Method stack frame.
+ * \param info  [out] Record stored method information in stack frame.<br>
+ *                    Strings are owned by this writer, so caller must
+ *                    not free them.
+ */
+void TThreadDumpWriter::getFrameInfo(jvmtiFrameInfo frame,
+                                     TJavaStackMethodInfo *info) {
+  TMethodInfoCache::iterator itr = methodCache.find(frame.method);
+  if (itr == methodCache.end()) {
+    TCachedMethodInfo methodInfo;
+    loadMethodInfo(frame.method, &methodInfo);
+    itr = methodCache.insert(std::make_pair(frame.method, methodInfo)).first;
+  }
+
+  TCachedMethodInfo *methodInfo = &itr->second;
+  info->className = methodInfo->className;
+  info->methodName = methodInfo->methodName;
+  info->sourceFile = methodInfo->sourceFile;
+  info->isNative = methodInfo->isNative;
+  info->lineNumber = -1;
+
+  if (likely(methodInfo->lineCount > 0)) {
+    /* Search running line. */
+    jint lineIdx = 0;
+    jint lastIdx = methodInfo->lineCount - 1;
+    for (; lineIdx < lastIdx; lineIdx++) {
+      if (frame.location <= methodInfo->lines[lineIdx].start_location) {
+        break;
+      }
+    }
+
+    info->lineNumber = methodInfo->lines[lineIdx].line_number;
+  }
+}
+
+/*!
+ * \brief Get method information from JVMTI.
+ * \param method [in]  Method to look up.
+ * \param info   [out] Method information.
+ */
+void TThreadDumpWriter::loadMethodInfo(jmethodID method,
+                                       TCachedMethodInfo *info) {
+  info->className = NULL;
+  info->methodName = NULL;
+  info->sourceFile = NULL;
+  info->isNative = true;
+  info->lineCount = 0;
+  info->lines = NULL;
+
+  /* Get method class. */
+  jclass declareClass = NULL;
+  if (likely(!isError(jvmti,
+                      jvmti->GetMethodDeclaringClass(method, &declareClass)))) {
+    /* Get class signature. */
+    if (unlikely(isError(jvmti, jvmti->GetClassSignature(
+                                    declareClass, &info->className, NULL)))) {
+      info->className = NULL;
+    }
+
+    /* Get source filename. */
+    if (unlikely(isError(jvmti, jvmti->GetSourceFileName(
+                                    declareClass, &info->sourceFile)))) {
+      info->sourceFile = NULL;
+    }
+
+    env->DeleteLocalRef(declareClass);
+  }
+
+  /* Get method name. */
+  if (unlikely(isError(jvmti, jvmti->GetMethodName(method, &info->methodName,
+                                                   NULL, NULL)))) {
+    info->methodName = NULL;
+  }
+
+  /* Check method is native. */
+  jboolean isNativeMethod = JNI_TRUE;
+  jvmti->IsMethodNative(method, &isNativeMethod);
+  info->isNative = (isNativeMethod == JNI_TRUE);
+
+  /* Get source code line table. */
+  if (!info->isNative &&
+      unlikely(isError(jvmti, jvmti->GetLineNumberTable(
+                                  method, &info->lineCount, &info->lines)))) {
+    /* Method location is unknown. */
+    info->lineCount = 0;
+    info->lines = NULL;
+  }
+}
@@ -0,0 +1,145 @@
+/*!
+ * \file threadDumpWriter.hpp
+ * \brief This file is used to write thread dump through JVMTI.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ *
+ */
+
+#ifndef THREAD_DUMP_WRITER_HPP
+#define THREAD_DUMP_WRITER_HPP
+
+#include <jvmti.h>
+#include <jni.h>
+
+#include <stddef.h>
+
+#include <unordered_map>
+
+#include "util.hpp"
+
+/*!
+ * \brief Size of output buffer of thread dump.
+ */
+#define THREAD_DUMP_BUFFER_SIZE (1024 * 1024)
+
+/*!
+ * \brief Method information which is cached while dumping threads.<br>
+ *        Strings and line table are allocated by JVMTI.
+ */
+typedef struct {
+  char *className;               /*!< Signature of declaring class.   */
+  char *methodName;              /*!< Name of method.                 */
+  char *sourceFile;              /*!< Source file of declaring class. */
+  bool isNative;                 /*!< Flag of method is native.       */
+  jint lineCount;                /*!< Count of line table entries.    */
+  jvmtiLineNumberEntry *lines;   /*!< Line table of method.           */
+} TCachedMethodInfo;
+
+/*!
+ * \brief Map of cached method information.
+ */
+typedef std::unordered_map<jmethodID, TCachedMethodInfo> TMethodInfoCache;
+
+/*!
+ * \brief This class writes thread dump to file through buffer.<br>
+ *        Method information is looked up by JVMTI only once per method
+ *        in a dump, because same methods appear in many threads.
+ */
+class TThreadDumpWriter {
+ public:
+  /*!
+   * \brief TThreadDumpWriter constructor.
+   * \param jvmti [in] JVMTI environment object.
+   * \param env   [in] JNI environment object.
+   * \param fd    [in] Output file descriptor.
+   */
+  TThreadDumpWriter(jvmtiEnv *jvmti, JNIEnv *env, int fd);
+
+  /*!
+   * \brief TThreadDumpWriter destructor.<br>
+   *        Buffered data which is not flushed is discarded.
+   */
+  virtual ~TThreadDumpWriter(void);
+
+  /*!
+   * \brief Append formatted string to buffer.<br>
+   *        Buffer is flushed if the string does not fit in it.
+   * \param format [in] Format string of printf.
+   * \return Value is zero, if process is succeed.<br />
+   *         Value is error number a.k.a. "errno", if process is failure.
+   */
+  int print(const char *format, ...)
+      __attribute__((format(printf, 2, 3)));
+
+  /*!
+   * \brief Write buffered data to file.
+   * \return Value is zero, if process is succeed.<br />
+   *         Value is error number a.k.a. "errno", if process is failure.
+   */
+  int flush(void);
+
+  /*!
+   * \brief Get method information in designed stack frame.
+   * \param frame [in]  Method stack frame.
+   * \param info  [out] Record stored method information in stack frame.<br>
+   *                    Strings are owned by this writer, so caller must
+   *                    not free them.
+   */
+  void getFrameInfo(jvmtiFrameInfo frame, TJavaStackMethodInfo *info);
+
+ protected:
+  /*!
+   * \brief Get method information from JVMTI.
+   * \param method [in]  Method to look up.
+   * \param info   [out] Method information.
+   */
+  void loadMethodInfo(jmethodID method, TCachedMethodInfo *info);
+
+ private:
+  /*!
+   * \brief JVMTI environment object.
+   */
+  jvmtiEnv *jvmti;
+
+  /*!
+   * \brief JNI environment object.
+   */
+  JNIEnv *env;
+
+  /*!
+   * \brief Output file descriptor.
+   */
+  int fd;
+
+  /*!
+   * \brief Output buffer.
+   */
+  char *buffer;
+
+  /*!
+   * \brief Size of data in buffer.
+   */
+  size_t bufferUsed;
+
+  /*!
+   * \brief Method information which is looked up in this dump.
+   */
+  TMethodInfoCache methodCache;
+};
+
+#endif  // THREAD_DUMP_WRITER_HPP
@@ -0,0 +1,455 @@
+/*!
+ * \file threadNameTable.cpp
+ * \brief Thread name table for HeapStats Thread Recorder.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "globals.hpp"
+#include "vmFunctions.hpp"
+#include "threadNameTable.hpp"
+
+#if PROCESSOR_ARCH == X86
+#include "arch/x86/lock.inline.hpp"
+#elif PROCESSOR_ARCH == ARM
+#include "arch/arm/lock.inline.hpp"
+#endif
+
+/*!
+ * \brief Size of a chunk of thread name arena.
+ */
+#define THREAD_NAME_ARENA_CHUNK_SIZE (16 * 1024)
+
+/*!
+ * \brief TThreadNameTable constructor.
+ * \param jvmti [in] JVMTI environment to resolve thread names.
+ */
+TThreadNameTable::TThreadNameTable(jvmtiEnv *jvmti)
+    : nameArena(THREAD_NAME_ARENA_CHUNK_SIZE) {
+  this->jvmti = jvmti;
+  this->vm = NULL;
+  memset(slotChunks, 0, sizeof(slotChunks));
+  nextIndex = 0;
+  freeHead = -1;
+  numPending = 0;
+  lockVal = 0;
+}
+
+/*!
+ * \brief TThreadNameTable destructor.
+ */
+TThreadNameTable::~TThreadNameTable(void) {
+  /* Release thread objects which are still kept. */
+  JNIEnv *env = getCurrentEnv();
+  if (env != NULL) {
+    for (int idx = 0; idx < nextIndex; idx++) {
+      TThreadNameSlot *slot = getSlot(idx);
+      if ((slot->state == ThreadSlotPending) && (slot->thread != NULL)) {
+        env->DeleteGlobalRef(slot->thread);
+      }
+    }
+  }
+
+  for (int idx = 0; idx < THREAD_NAME_MAX_CHUNKS; idx++) {
+    free(slotChunks[idx]);
+  }
+}
+
+/*!
+ * \brief Acquire new slot for thread.<br>
+ *        Returned slot has a reference for the thread.
+ * \param threadId [in] Thread ID.
+ * \return Index of slot. Value is -1 if no slot is available.
+ */
+int TThreadNameTable::acquire(jlong threadId) {
+  int result = -1;
+
+  spinLockWait(&lockVal);
+  {
+    if (freeHead != -1) {
+      result = freeHead;
+      freeHead = getSlot(result)->nextFree;
+    } else {
+      int chunkIdx = nextIndex / THREAD_NAME_CHUNK_SLOTS;
+      if (unlikely((chunkIdx < THREAD_NAME_MAX_CHUNKS) &&
+                   (slotChunks[chunkIdx] == NULL))) {
+        slotChunks[chunkIdx] = (TThreadNameSlot *)calloc(
+            THREAD_NAME_CHUNK_SLOTS, sizeof(TThreadNameSlot));
+      }
+
+      if (likely((chunkIdx < THREAD_NAME_MAX_CHUNKS) &&
+                 (slotChunks[chunkIdx] != NULL))) {
+        result = nextIndex++;
+      }
+    }
+
+    if (likely(result != -1)) {
+      TThreadNameSlot *slot = getSlot(result);
+      slot->refs.store(1, std::memory_order_relaxed);
+      slot->state = ThreadSlotPending;
+      slot->threadId = threadId;
+      slot->name = NULL;
+      slot->nameLen = 0;
+      slot->chunk = NULL;
+      slot->thread = NULL;
+      numPending++;
+    }
+  }
+  spinLockRelease(&lockVal);
+
+  return result;
+}
+
+/*!
+ * \brief Drop reference of slot.<br>
+ *        Slot and its name are reclaimed when no one refers it.
+ * \param index [in] Index of slot.
+ */
+void TThreadNameTable::release(int index) {
+  if (unlikely(index < 0)) {
+    return;
+  }
+
+  TThreadNameSlot *slot = getSlot(index);
+  if (slot->refs.fetch_sub(1, std::memory_order_acq_rel) > 1) {
+    return;
+  }
+
+  jthread thread = NULL;
+  spinLockWait(&lockVal);
+  {
+    if (slot->state == ThreadSlotNamed) {
+      dropName(slot);
+    } else {
+      thread = slot->thread;
+      slot->thread = NULL;
+      numPending--;
+    }
+
+    slot->state = ThreadSlotFree;
+    slot->nextFree = freeHead;
+    freeHead = index;
+  }
+  spinLockRelease(&lockVal);
+
+  /* Name of ended thread is not needed anymore. */
+  if (unlikely(thread != NULL)) {
+    JNIEnv *env = getCurrentEnv();
+    if (likely(env != NULL)) {
+      env->DeleteGlobalRef(thread);
+    }
+  }
+}
+
+/*!
+ * \brief Keep thread object of ending thread if its name is not resolved
+ *        yet. The name is resolved by resolvePending() later.<br>
+ *        This function does not call JVMTI, so it can be called in the
+ *        event path.
+ * \param index  [in] Index of slot.
+ * \param env    [in] JNI environment of the thread.
+ * \param thread [in] jthread object of the thread.
+ */
+void TThreadNameTable::keepThread(int index, JNIEnv *env, jthread thread) {
+  if (unlikely(index < 0)) {
+    return;
+  }
+
+  TThreadNameSlot *slot = getSlot(index);
+
+  /* Slot is referred by caller, so it is not released while keeping. */
+  spinLockWait(&lockVal);
+  bool isPending = (slot->state == ThreadSlotPending);
+  spinLockRelease(&lockVal);
+
+  if (!isPending) {
+    return;
+  }
+
+  if (unlikely(vm == NULL) && (env->GetJavaVM(&vm) != JNI_OK)) {
+    vm = NULL;
+    return;
+  }
+
+  jthread ref = (jthread)env->NewGlobalRef(thread);
+  if (unlikely(ref == NULL)) {
+    return;
+  }
+
+  spinLockWait(&lockVal);
+  {
+    if ((slot->state == ThreadSlotPending) && (slot->thread == NULL)) {
+      slot->thread = ref;
+      ref = NULL;
+    }
+  }
+  spinLockRelease(&lockVal);
+
+  if (unlikely(ref != NULL)) {
+    /* Name has been resolved by writer. */
+    env->DeleteGlobalRef(ref);
+  }
+}
+
+/*!
+ * \brief Resolve names of all live and kept threads which are not
+ *        resolved yet.<br>
+ *        Caller must be attached to JVM.
+ */
+void TThreadNameTable::resolvePending(void) {
+  std::vector<std::pair<jlong, int> > pending;
+  std::vector<std::pair<jthread, std::pair<jlong, int> > > kept;
+  JNIEnv *env = getCurrentEnv();
+
+  spinLockWait(&lockVal);
+  if (numPending > 0) {
+    try {
+      pending.reserve(numPending);
+      kept.reserve(numPending);
+      for (int idx = 0; idx < nextIndex; idx++) {
+        TThreadNameSlot *slot = getSlot(idx);
+        if (slot->state != ThreadSlotPending) {
+          continue;
+        }
+
+        if (slot->thread == NULL) {
+          pending.push_back(std::make_pair(slot->threadId, idx));
+        } else if (env != NULL) {
+          /* Kept thread object is owned by this function from now. */
+          kept.push_back(std::make_pair(
+              slot->thread, std::make_pair(slot->threadId, idx)));
+          slot->thread = NULL;
+        }
+      }
+    } catch (...) {
+      /* Names are resolved at next time. */
+      pending.clear();
+    }
+  }
+  spinLockRelease(&lockVal);
+
+  /* Ended threads. */
+  for (size_t idx = 0; idx < kept.size(); idx++) {
+    jvmtiThreadInfo threadInfo;
+    if (jvmti->GetThreadInfo(kept[idx].first, &threadInfo) ==
+        JVMTI_ERROR_NONE) {
+      setName(kept[idx].second.second, kept[idx].second.first,
+              threadInfo.name);
+      jvmti->Deallocate((unsigned char *)threadInfo.name);
+    }
+    env->DeleteGlobalRef(kept[idx].first);
+  }
+
+  if (pending.empty()) {
+    return;
+  }
+
+  std::sort(pending.begin(), pending.end());
+
+  jint thread_count;
+  jthread *threads;
+  if (jvmti->GetAllThreads(&thread_count, &threads) != JVMTI_ERROR_NONE) {
+    return;
+  }
+
+  TVMFunctions *vmFunc = TVMFunctions::getInstance();
+  for (int Cnt = 0; Cnt < thread_count; Cnt++) {
+    jlong id = vmFunc->GetThreadId(*(void **)threads[Cnt]);
+    std::vector<std::pair<jlong, int> >::iterator itr = std::lower_bound(
+        pending.begin(), pending.end(), std::make_pair(id, -1));
+
+    for (; (itr != pending.end()) && (itr->first == id); itr++) {
+      jvmtiThreadInfo threadInfo;
+      if (jvmti->GetThreadInfo(threads[Cnt], &threadInfo) ==
+          JVMTI_ERROR_NONE) {
+        setName(itr->second, id, threadInfo.name);
+        jvmti->Deallocate((unsigned char *)threadInfo.name);
+      }
+    }
+  }
+
+  jvmti->Deallocate((unsigned char *)threads);
+}
+
+/*!
+ * \brief Get thread name of slot.
+ * \param index    [in]  Index of slot.
+ * \param threadId [in]  Thread ID which the name belongs to.
+ * \param name     [out] Thread name.
+ * \return true if the slot has name of the thread.
+ */
+bool TThreadNameTable::getName(int index, jlong threadId, std::string *name) {
+  if (unlikely(index < 0)) {
+    return false;
+  }
+
+  TThreadNameSlot *slot = getSlot(index);
+  bool result = false;
+
+  spinLockWait(&lockVal);
+  {
+    if ((slot->state == ThreadSlotNamed) && (slot->threadId == threadId)) {
+      try {
+        name->assign(slot->name, slot->nameLen);
+        result = true;
+      } catch (...) {
+        /* Name is not available. */
+      }
+    }
+  }
+  spinLockRelease(&lockVal);
+
+  return result;
+}
+
+/*!
+ * \brief Write thread list to file.<br>
+ *        Thread list is count of threads and pairs of thread ID and
+ *        length-prefixed name.
+ * \param fd      [in]  File descriptor to write.
+ * \param written [out] IDs of threads in the list. Value can be NULL.
+ */
+void TThreadNameTable::write(int fd, std::unordered_set<jlong> *written) {
+  char *buf = NULL;
+  size_t bufSize = 0;
+  int count = 0;
+
+  /* Names are copied under the lock because they may be reclaimed. */
+  spinLockWait(&lockVal);
+  {
+    size_t required = 0;
+    for (int idx = 0; idx < nextIndex; idx++) {
+      TThreadNameSlot *slot = getSlot(idx);
+      if (slot->state == ThreadSlotNamed) {
+        required += sizeof(jlong) + sizeof(int) + slot->nameLen;
+      }
+    }
+
+    buf = (char *)malloc((required > 0) ? required : 1);
+    if (likely(buf != NULL)) {
+      for (int idx = 0; idx < nextIndex; idx++) {
+        TThreadNameSlot *slot = getSlot(idx);
+        if (slot->state == ThreadSlotNamed) {
+          memcpy(buf + bufSize, &slot->threadId, sizeof(jlong));
+          bufSize += sizeof(jlong);
+          memcpy(buf + bufSize, &slot->nameLen, sizeof(int));
+          bufSize += sizeof(int);
+          memcpy(buf + bufSize, slot->name, slot->nameLen);
+          bufSize += slot->nameLen;
+          count++;
+        }
+      }
+    }
+  }
+  spinLockRelease(&lockVal);
+
+  if (unlikely(buf == NULL)) {
+    logger->printWarnMsg("Could not allocate memory for thread list.");
+  }
+
+  ::write(fd, &count, sizeof(int));
+  if (bufSize > 0) {
+    ::write(fd, buf, bufSize);
+  }
+
+  if (written != NULL) {
+    size_t pos = 0;
+    while (pos < bufSize) {
+      jlong threadId;
+      int nameLen;
+      memcpy(&threadId, buf + pos, sizeof(jlong));
+      memcpy(&nameLen, buf + pos + sizeof(jlong), sizeof(int));
+      written->insert(threadId);
+      pos += sizeof(jlong) + sizeof(int) + nameLen;
+    }
+  }
+
+  free(buf);
+}
+
+/*!
+ * \brief Store thread name to slot.<br>
+ *        Caller must hold the lock.
+ * \param slot [in] Slot which is pending.
+ * \param name [in] Thread name.
+ */
+void TThreadNameTable::storeName(TThreadNameSlot *slot, const char *name) {
+  size_t length = strlen(name);
+  slot->name = (char *)nameArena.reserve(length + 1);
+  if (unlikely(slot->name == NULL)) {
+    return;
+  }
+
+  __builtin_memcpy(slot->name, name, length + 1);
+  slot->nameLen = length;
+  slot->chunk = nameArena.commit(length + 1);
+  slot->state = ThreadSlotNamed;
+  numPending--;
+}
+
+/*!
+ * \brief Set thread name of slot if the slot is still pending for the
+ *        thread.
+ * \param index    [in] Index of slot.
+ * \param threadId [in] Thread ID which the name belongs to.
+ * \param name     [in] Thread name.
+ */
+void TThreadNameTable::setName(int index, jlong threadId, const char *name) {
+  TThreadNameSlot *slot = getSlot(index);
+
+  spinLockWait(&lockVal);
+  {
+    if ((slot->state == ThreadSlotPending) && (slot->threadId == threadId)) {
+      storeName(slot, name);
+    }
+  }
+  spinLockRelease(&lockVal);
+}
+
+/*!
+ * \brief Get JNI environment of current thread.
+ * \return JNI environment. Value is NULL if current thread is not
+ *         attached to JVM.
+ */
+JNIEnv *TThreadNameTable::getCurrentEnv(void) {
+  JNIEnv *env = NULL;
+  if ((vm == NULL) ||
+      (vm->GetEnv((void **)&env, JNI_VERSION_1_6) != JNI_OK)) {
+    return NULL;
+  }
+
+  return env;
+}
+
+/*!
+ * \brief Drop thread name of slot from arena.<br>
+ *        Caller must hold the lock.
+ * \param slot [in] Slot which has name.
+ */
+void TThreadNameTable::dropName(TThreadNameSlot *slot) {
+  nameArena.release(slot->chunk);
+  slot->name = NULL;
+  slot->chunk = NULL;
+}
@@ -0,0 +1,237 @@
+/*!
+ * \file threadNameTable.hpp
+ * \brief Thread name table for HeapStats Thread Recorder.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+#ifndef THREAD_NAME_TABLE_HPP
+#define THREAD_NAME_TABLE_HPP
+
+#include <jvmti.h>
+#include <jni.h>
+
+#include <stddef.h>
+
+#include <string>
+#include <unordered_set>
+
+#include "util.hpp"
+#include "chunkArena.hpp"
+
+/*!
+ * \brief Count of slots in a chunk. This value must be power of 2.
+ */
+#define THREAD_NAME_CHUNK_SLOTS 1024
+
+/*!
+ * \brief Max count of slot chunks.
+ */
+#define THREAD_NAME_MAX_CHUNKS 64
+
+/*!
+ * \brief State of thread name slot.
+ */
+typedef enum {
+  ThreadSlotFree = 0, /*!< Slot is not used.                      */
+  ThreadSlotPending,  /*!< Slot is used, but name is not resolved. */
+  ThreadSlotNamed,    /*!< Slot has thread name.                   */
+} TThreadSlotState;
+
+/*!
+ * \brief Slot of thread name.<br>
+ *        Slot is referred by its thread while the thread is alive, and by
+ *        each ring segment which is owned by the thread.
+ */
+typedef struct {
+  std::atomic_int refs;    /*!< Count of references.                  */
+  int state;               /*!< Value presents TThreadSlotState.      */
+  int nextFree;            /*!< Index of next free slot.              */
+  int nameLen;             /*!< Length of thread name.                */
+  jlong threadId;          /*!< Thread ID.                            */
+  char *name;              /*!< Thread name in arena.                 */
+  TArenaChunk *chunk;      /*!< Chunk which contains thread name.     */
+  jthread thread;          /*!< Global reference of ended thread which
+                                name is not resolved yet.             */
+} TThreadNameSlot;
+
+/*!
+ * \brief This class stores thread names for thread recorder.<br>
+ *        Each thread has small index to slot, so event path does not need
+ *        hash lookup. Names are resolved through JVMTI in deferred, and
+ *        are appended to arena. Slot and name are reclaimed when the last
+ *        ring segment which refers the slot is recycled.
+ */
+class TThreadNameTable {
+ public:
+  /*!
+   * \brief TThreadNameTable constructor.
+   * \param jvmti [in] JVMTI environment to resolve thread names.
+   */
+  TThreadNameTable(jvmtiEnv *jvmti);
+
+  /*!
+   * \brief TThreadNameTable destructor.
+   */
+  virtual ~TThreadNameTable(void);
+
+  /*!
+   * \brief Acquire new slot for thread.<br>
+   *        Returned slot has a reference for the thread.
+   * \param threadId [in] Thread ID.
+   * \return Index of slot. Value is -1 if no slot is available.
+   */
+  int acquire(jlong threadId);
+
+  /*!
+   * \brief Add reference to slot.
+   * \param index [in] Index of slot.
+   */
+  inline void addRef(int index) {
+    if (likely(index >= 0)) {
+      getSlot(index)->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  /*!
+   * \brief Drop reference of slot.<br>
+   *        Slot and its name are reclaimed when no one refers it.
+   * \param index [in] Index of slot.
+   */
+  void release(int index);
+
+  /*!
+   * \brief Keep thread object of ending thread if its name is not resolved
+   *        yet. The name is resolved by resolvePending() later.<br>
+   *        This function does not call JVMTI, so it can be called in the
+   *        event path.
+   * \param index  [in] Index of slot.
+   * \param env    [in] JNI environment of the thread.
+   * \param thread [in] jthread object of the thread.
+   */
+  void keepThread(int index, JNIEnv *env, jthread thread);
+
+  /*!
+   * \brief Resolve names of all live and kept threads which are not
+   *        resolved yet.<br>
+   *        Caller must be attached to JVM.
+   */
+  void resolvePending(void);
+
+  /*!
+   * \brief Get thread name of slot.
+   * \param index    [in]  Index of slot.
+   * \param threadId [in]  Thread ID which the name belongs to.
+   * \param name     [out] Thread name.
+   * \return true if the slot has name of the thread.
+   */
+  bool getName(int index, jlong threadId, std::string *name);
+
+  /*!
+   * \brief Write thread list to file.<br>
+   *        Thread list is count of threads and pairs of thread ID and
+   *        length-prefixed name.
+   * \param fd      [in]  File descriptor to write.
+   * \param written [out] IDs of threads in the list. Value can be NULL.
+   */
+  void write(int fd, std::unordered_set<jlong> *written = NULL);
+
+ private:
+  /*!
+   * \brief Get slot by index.
+   * \param index [in] Index of slot.
+   * \return Slot.
+   */
+  inline TThreadNameSlot *getSlot(int index) {
+    return &slotChunks[index / THREAD_NAME_CHUNK_SLOTS]
+                      [index & (THREAD_NAME_CHUNK_SLOTS - 1)];
+  }
+
+  /*!
+   * \brief Store thread name to slot.<br>
+   *        Caller must hold the lock.
+   * \param slot [in] Slot which is pending.
+   * \param name [in] Thread name.
+   */
+  void storeName(TThreadNameSlot *slot, const char *name);
+
+  /*!
+   * \brief Set thread name of slot if the slot is still pending for the
+   *        thread.
+   * \param index    [in] Index of slot.
+   * \param threadId [in] Thread ID which the name belongs to.
+   * \param name     [in] Thread name.
+   */
+  void setName(int index, jlong threadId, const char *name);
+
+  /*!
+   * \brief Drop thread name of slot from arena.<br>
+   *        Caller must hold the lock.
+   * \param slot [in] Slot which has name.
+   */
+  void dropName(TThreadNameSlot *slot);
+
+  /*!
+   * \brief Get JNI environment of current thread.
+   * \return JNI environment. Value is NULL if current thread is not
+   *         attached to JVM.
+   */
+  JNIEnv *getCurrentEnv(void);
+
+  /*!
+   * \brief JVMTI environment to resolve thread names.
+   */
+  jvmtiEnv *jvmti;
+
+  /*!
+   * \brief JVM to release kept thread objects.
+   *        Value is NULL until a thread object is kept.
+   */
+  JavaVM *vm;
+
+  /*!
+   * \brief Chunks of slots.
+   */
+  TThreadNameSlot *slotChunks[THREAD_NAME_MAX_CHUNKS];
+
+  /*!
+   * \brief Index of next slot which has never been used.
+   */
+  int nextIndex;
+
+  /*!
+   * \brief Index of first free slot. Value is -1 if there is no free slot.
+   */
+  int freeHead;
+
+  /*!
+   * \brief Count of pending slots.
+   */
+  int numPending;
+
+  /*!
+   * \brief Arena of thread names.
+   */
+  TChunkArena nameArena;
+
+  /*!
+   * \brief Lock of this table.
+   */
+  volatile int lockVal;
+};
+
+#endif  // THREAD_NAME_TABLE_HPP
@@ -0,0 +1,190 @@
+/*!
+ * \file threadRecordFormat.hpp
+ * \brief Format of thread record data.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+#ifndef THREAD_RECORD_FORMAT_HPP
+#define THREAD_RECORD_FORMAT_HPP
+
+#include <jni.h>
+
+/*!
+ * \brief Event record information.
+ *        This is decoded form of a compact record in ring segment.
+ */
+typedef struct {
+  jlong time;  // Monotonic clock in nanoseconds.
+  jlong thread_id;
+  jlong event;  // This value presents TThreadEvent.
+  jlong additionalData;
+} TEventRecord;
+
+/*!
+ * \brief Magic number of thread record file.
+ *        Legacy file (version 1) does not have this magic.
+ */
+#define THREAD_RECORD_MAGIC "HTRC"
+
+/*!
+ * \brief Format version of thread record file.<br>
+ *        Layout of version 3 is as below. All values are native byte order.
+ *        <ul>
+ *          <li>char: Byte order mark ('L' or 'B')</li>
+ *          <li>char[4]: THREAD_RECORD_MAGIC</li>
+ *          <li>int: Format version</li>
+ *          <li>jlong[2]: Wall-clock and monotonic clock in nanoseconds</li>
+ *          <li>int: Count of threads, and each thread as jlong ID,
+ *              int length of name and name</li>
+ *          <li>int: Count of entries, and each entry as jlong thread ID,
+ *              jlong time of first record, int size of records and
+ *              compact records. Entry which has THREAD_NAME_ENTRY_TIME
+ *              as time is thread name which is not in thread list.</li>
+ *        </ul>
+ */
+#define THREAD_RECORD_FORMAT_VERSION 3
+
+/*!
+ * \brief Time of first record in entry which presents thread name.<br>
+ *        Streaming file has this entry before the first segment of thread
+ *        which started after the file was opened. Size of records is length
+ *        of the name.
+ */
+#define THREAD_NAME_ENTRY_TIME ((jlong)-1)
+
+/*!
+ * \brief Flag in event byte which presents additional data follows.
+ */
+#define EVENT_HAS_ADDITIONAL_DATA 0x80
+
+/*!
+ * \brief Max size of a compact record.
+ *        Event byte, varint of time delta and varint of additional data.
+ */
+#define MAX_COMPACT_RECORD_SIZE 21
+
+/*!
+ * \brief Event definition.
+ */
+typedef enum {
+  /* JVMTI event */
+  ThreadStart = 1,
+  ThreadEnd,
+  MonitorWait,
+  MonitorWaited,
+  MonitorContendedEnter,
+  MonitorContendedEntered,
+
+  /* JNI function hook */
+  ThreadSleepStart,
+  ThreadSleepEnd,
+  Park,
+  Unpark,
+
+  /* IoTrace */
+  FileWriteStart,
+  FileWriteEnd,
+  FileReadStart,
+  FileReadEnd,
+  SocketWriteStart,
+  SocketWriteEnd,
+  SocketReadStart,
+  SocketReadEnd,
+} TThreadEvent;
+
+/*!
+ * \brief Encode an event to compact record.
+ *
+ * \param buf [out] Buffer which has MAX_COMPACT_RECORD_SIZE bytes at least.
+ * \param delta [in] Time delta from previous record in nanoseconds.
+ * \param event [in] Thread event.
+ * \param additionalData [in] Additional data.
+ * \return Size of record in bytes.
+ */
+inline int encodeCompactRecord(unsigned char *buf, jlong delta, int event,
+                               jlong additionalData) {
+  unsigned char *pos = buf;
+  *pos++ = (unsigned char)event |
+           ((additionalData != 0) ? EVENT_HAS_ADDITIONAL_DATA : 0);
+
+  unsigned long long value = (unsigned long long)delta;
+  while (value >= 0x80) {
+    *pos++ = (unsigned char)(value | 0x80);
+    value >>= 7;
+  }
+  *pos++ = (unsigned char)value;
+
+  if (additionalData != 0) {
+    value = ((unsigned long long)additionalData << 1) ^
+            (unsigned long long)(additionalData >> 63);
+    while (value >= 0x80) {
+      *pos++ = (unsigned char)(value | 0x80);
+      value >>= 7;
+    }
+    *pos++ = (unsigned char)value;
+  }
+
+  return pos - buf;
+}
+
+/*!
+ * \brief Decode a compact record.
+ *
+ * \param buf [in] Top of the record.
+ * \param end [in] End of the segment.
+ * \param record [in,out] Decoded record. time must be the time of previous
+ *                        record, and thread_id is not changed.
+ * \return Size of record in bytes. Value is 0 if the record is broken.
+ */
+inline int decodeCompactRecord(const unsigned char *buf,
+                               const unsigned char *end,
+                               TEventRecord *record) {
+  const unsigned char *pos = buf;
+  if (pos >= end) {
+    return 0;
+  }
+
+  unsigned char eventByte = *pos++;
+  unsigned long long values[2] = {0, 0};
+  int num_values = (eventByte & EVENT_HAS_ADDITIONAL_DATA) ? 2 : 1;
+
+  for (int idx = 0; idx < num_values; idx++) {
+    int shift = 0;
+    while (true) {
+      if ((pos >= end) || (shift > 63)) {
+        return 0;
+      }
+
+      unsigned char byte = *pos++;
+      values[idx] |= (unsigned long long)(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) {
+        break;
+      }
+      shift += 7;
+    }
+  }
+
+  record->time += (jlong)values[0];
+  record->event = eventByte & ~EVENT_HAS_ADDITIONAL_DATA;
+  record->additionalData =
+      (jlong)(values[1] >> 1) ^ -(jlong)(values[1] & 1);
+
+  return pos - buf;
+}
+
+#endif  // THREAD_RECORD_FORMAT_HPP
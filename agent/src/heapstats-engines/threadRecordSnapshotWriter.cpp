@@ -0,0 +1,160 @@
+/*!
+ * \file threadRecordSnapshotWriter.cpp
+ * \brief Writing live snapshot of thread recorder.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "globals.hpp"
+#include "fsUtil.hpp"
+#include "threadRecordSnapshotWriter.hpp"
+
+/*!
+ * \brief TThreadRecordSnapshotWriter constructor.
+ * \param recorder [in] Thread recorder to take snapshot.
+ * \param fname    [in] Base name of snapshot files.
+ */
+TThreadRecordSnapshotWriter::TThreadRecordSnapshotWriter(
+    TThreadRecorder *recorder, const char *fname)
+    : TAgentThread("HeapStats Thread Record Snapshot Writer") {
+  this->recorder = recorder;
+  this->fileName = strdup(fname);
+  if (unlikely(this->fileName == NULL)) {
+    throw "Could not allocate name of thread record snapshot.";
+  }
+}
+
+/*!
+ * \brief TThreadRecordSnapshotWriter destructor.
+ */
+TThreadRecordSnapshotWriter::~TThreadRecordSnapshotWriter(void) {
+  free(fileName);
+}
+
+/*!
+ * \brief Start parallel work by JThread.
+ * \param jvmti [in] JVMTI environment information.
+ * \param env   [in] JNI environment information.
+ */
+void TThreadRecordSnapshotWriter::start(jvmtiEnv *jvmti, JNIEnv *env) {
+  TAgentThread::start(jvmti, env, TThreadRecordSnapshotWriter::entryPoint,
+                      this, JVMTI_THREAD_MIN_PRIORITY);
+}
+
+/*!
+ * \brief Parallel work function by JThread.
+ * \param jvmti [in] JVMTI environment information.
+ * \param jni   [in] JNI environment information.
+ * \param data  [in] Instance of TThreadRecordSnapshotWriter.
+ */
+void JNICALL TThreadRecordSnapshotWriter::entryPoint(jvmtiEnv *jvmti,
+                                                     JNIEnv *jni,
+                                                     void *data) {
+  /* Get self. */
+  TThreadRecordSnapshotWriter *controller =
+      (TThreadRecordSnapshotWriter *)data;
+  /* Change running state. */
+  controller->_isRunning = true;
+
+  while (true) {
+    {
+      TMutexLocker locker(&controller->mutex);
+
+      if (unlikely(controller->_terminateRequest)) {
+        break;
+      }
+
+      if (likely(controller->_numRequests == 0)) {
+        /* Wait for notification or termination. */
+        pthread_cond_wait(&controller->mutexCond, &controller->mutex);
+      }
+
+      if (unlikely(controller->_terminateRequest)) {
+        /* Recorder dumps all records at finalization. */
+        break;
+      }
+
+      if (controller->_numRequests == 0) {
+        continue;
+      }
+
+      /* Requests until now are served by one snapshot. */
+      controller->_numRequests = 0;
+    }
+
+    char *fname = controller->createSnapshotName();
+    if (unlikely(fname == NULL)) {
+      logger->printWarnMsg("Could not create name of thread record snapshot.");
+      continue;
+    }
+
+    if (controller->recorder->writeSnapshot(fname)) {
+      logger->printInfoMsg("Thread record snapshot is written: %s", fname);
+    }
+    free(fname);
+  }
+
+  /* Change running state. */
+  controller->_isRunning = false;
+}
+
+/*!
+ * \brief Create unique name of snapshot file.
+ * \return Name of snapshot file. It should be released by free().<br>
+ *         Value is null, if process is failure.
+ */
+char *TThreadRecordSnapshotWriter::createSnapshotName(void) {
+  struct tm time_struct = {0};
+  char time_str[20] = {0};
+  char snapName[PATH_MAX] = {0};
+  char extPart[PATH_MAX] = {0};
+  char namePart[PATH_MAX] = {0};
+
+  /* Search extension. */
+  char *extPos = strrchr(fileName, '.');
+  if (likely(extPos != NULL)) {
+    /* Path and extension store each other. */
+    strncpy(extPart, extPos, PATH_MAX - 1);
+    strncpy(namePart, fileName, (extPos - fileName));
+  } else {
+    /* Not found extension in path. */
+    strncpy(namePart, fileName, PATH_MAX - 1);
+  }
+
+  /* Get now datetime and convert to string. */
+  time_t nowTimeSec = (time_t)(getNowTimeSec() / 1000);
+  localtime_r((const time_t *)&nowTimeSec, &time_struct);
+  strftime(time_str, 20, "%y%m%d%H%M%S", &time_struct);
+
+  /* Create file name. */
+  int ret =
+      snprintf(snapName, PATH_MAX, "%s%s%s", namePart, time_str, extPart);
+  if (ret >= PATH_MAX) {
+    logger->printWarnMsg("Thread record snapshot name is too long: %s",
+                         snapName);
+    return NULL;
+  }
+
+  /* Create unique file name. */
+  return createUniquePath(snapName, false);
+}
@@ -0,0 +1,88 @@
+/*!
+ * \file threadRecordSnapshotWriter.hpp
+ * \brief Writing live snapshot of thread recorder.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+#ifndef THREAD_RECORD_SNAPSHOT_WRITER_HPP
+#define THREAD_RECORD_SNAPSHOT_WRITER_HPP
+
+#include <jvmti.h>
+#include <jni.h>
+
+#include "agentThread.hpp"
+#include "threadRecorder.hpp"
+
+/*!
+ * \brief This class writes live snapshot of thread recorder in background.
+ *        Snapshot is written to timestamped file which is made from
+ *        thread_record_filename. Requests which arrive while writing are
+ *        merged into next snapshot.
+ */
+class TThreadRecordSnapshotWriter : public TAgentThread {
+ public:
+  /*!
+   * \brief TThreadRecordSnapshotWriter constructor.
+   * \param recorder [in] Thread recorder to take snapshot.
+   * \param fname    [in] Base name of snapshot files.
+   */
+  TThreadRecordSnapshotWriter(TThreadRecorder *recorder, const char *fname);
+
+  /*!
+   * \brief TThreadRecordSnapshotWriter destructor.
+   */
+  virtual ~TThreadRecordSnapshotWriter(void);
+
+  using TAgentThread::start;
+
+  /*!
+   * \brief Start parallel work by JThread.
+   * \param jvmti [in] JVMTI environment information.
+   * \param env   [in] JNI environment information.
+   */
+  void start(jvmtiEnv *jvmti, JNIEnv *env);
+
+ protected:
+  /*!
+   * \brief Parallel work function by JThread.
+   * \param jvmti [in] JVMTI environment information.
+   * \param jni   [in] JNI environment information.
+   * \param data  [in] Instance of TThreadRecordSnapshotWriter.
+   */
+  static void JNICALL entryPoint(jvmtiEnv *jvmti, JNIEnv *jni, void *data);
+
+  /*!
+   * \brief Create unique name of snapshot file.
+   * \return Name of snapshot file. It should be released by free().<br>
+   *         Value is null, if process is failure.
+   */
+  char *createSnapshotName(void);
+
+  RELEASE_ONLY(private :)
+  /*!
+   * \brief Thread recorder to take snapshot.
+   */
+  TThreadRecorder *recorder;
+
+  /*!
+   * \brief Base name of snapshot files.
+   */
+  char *fileName;
+};
+
+#endif  // THREAD_RECORD_SNAPSHOT_WRITER_HPP
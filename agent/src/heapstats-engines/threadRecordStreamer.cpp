@@ -0,0 +1,279 @@
+/*!
+ * \file threadRecordStreamer.cpp
+ * \brief Streaming thread record data to rolling files.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "globals.hpp"
+#include "threadRecordStreamer.hpp"
+
+/*!
+ * \brief TThreadRecordStreamer constructor.
+ * \param recorder    [in] Thread recorder which owns segments.
+ * \param fname       [in] Base name of streaming files.
+ * \param file_size   [in] Size of each file in bytes.
+ * \param num_files   [in] Count of rolling files.
+ * \param max_pending [in] Max count of segments in queue.
+ */
+TThreadRecordStreamer::TThreadRecordStreamer(TThreadRecorder *recorder,
+                                             const char *fname,
+                                             off_t file_size, int num_files,
+                                             int max_pending)
+    : TAgentThread("HeapStats Thread Record Streamer"),
+      namedThreads(),
+      queue(),
+      pending(0),
+      droppedSegments(0) {
+  this->recorder = recorder;
+  this->fileName = strdup(fname);
+  this->maxFileSize = file_size;
+  this->numFiles = num_files;
+  this->nextFileIndex = 0;
+  this->fd = -1;
+  this->fileSize = 0;
+  this->countOffset = 0;
+  this->numSegments = 0;
+  this->flushedOffset = 0;
+  this->maxPending = max_pending;
+}
+
+/*!
+ * \brief TThreadRecordStreamer destructor.
+ */
+TThreadRecordStreamer::~TThreadRecordStreamer(void) {
+  closeFile();
+  free(fileName);
+}
+
+/*!
+ * \brief Start parallel work by JThread.
+ * \param jvmti [in] JVMTI environment information.
+ * \param env   [in] JNI environment information.
+ */
+void TThreadRecordStreamer::start(jvmtiEnv *jvmti, JNIEnv *env) {
+  TAgentThread::start(jvmti, env, TThreadRecordStreamer::entryPoint, this,
+                      JVMTI_THREAD_MIN_PRIORITY);
+}
+
+/*!
+ * \brief Offer retired segment to writer.
+ *        State of the segment is changed to SegmentStreaming if accepted.
+ * \param segment [in] Retired segment.
+ * \return true if the segment is queued.
+ */
+bool TThreadRecordStreamer::offer(TRecordSegment *segment) {
+  if (unlikely(pending.fetch_add(1) >= maxPending)) {
+    /* Writer falls behind. */
+    pending--;
+    droppedSegments++;
+    return false;
+  }
+
+  segment->state.store(SegmentStreaming, std::memory_order_release);
+  queue.push(segment);
+  notify();
+
+  return true;
+}
+
+/*!
+ * \brief Parallel work function by JThread.
+ * \param jvmti [in] JVMTI environment information.
+ * \param jni   [in] JNI environment information.
+ * \param data  [in] Instance of TThreadRecordStreamer.
+ */
+void JNICALL TThreadRecordStreamer::entryPoint(jvmtiEnv *jvmti, JNIEnv *jni,
+                                               void *data) {
+  /* Get self. */
+  TThreadRecordStreamer *controller = (TThreadRecordStreamer *)data;
+  /* Change running state. */
+  controller->_isRunning = true;
+
+  while (true) {
+    {
+      TMutexLocker locker(&controller->mutex);
+
+      if (unlikely(controller->_terminateRequest &&
+                   controller->queue.empty())) {
+        break;
+      }
+
+      if (likely((controller->_numRequests == 0) &&
+                 !controller->_terminateRequest)) {
+        /* Wait for notification or termination. */
+        pthread_cond_wait(&controller->mutexCond, &controller->mutex);
+      }
+
+      controller->_numRequests = 0;
+    }
+
+    TRecordSegment *segment;
+    while (controller->queue.try_pop(segment)) {
+      controller->writeSegment(segment);
+    }
+  }
+
+  controller->closeFile();
+  if (controller->droppedSegments > 0) {
+    logger->printWarnMsg("Thread record streamer dropped %ld segments.",
+                         (long)controller->droppedSegments.load());
+  }
+
+  /* Change running state. */
+  controller->_isRunning = false;
+}
+
+/*!
+ * \brief Open next rolling file and write header.
+ * \return true if succeeded.
+ */
+bool TThreadRecordStreamer::openNextFile(void) {
+  char path[PATH_MAX];
+  snprintf(path, PATH_MAX, "%s.%d", fileName, nextFileIndex);
+  nextFileIndex = (nextFileIndex + 1) % numFiles;
+
+  fd = open(path, O_WRONLY | O_CREAT | O_TRUNC,
+            S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+  if (unlikely(fd == -1)) {
+    logger->printWarnMsgWithErrno("Could not open thread record stream: %s",
+                                  path);
+    return false;
+  }
+
+  /* Count of segments is updated whenever a segment is written. */
+  namedThreads.clear();
+  recorder->writeHeader(fd, &namedThreads);
+  numSegments = 0;
+  countOffset = lseek(fd, 0, SEEK_CUR);
+  if (unlikely((countOffset == -1) ||
+               (write(fd, &numSegments, sizeof(int)) != sizeof(int)))) {
+    logger->printWarnMsgWithErrno("Could not write thread record stream: %s",
+                                  path);
+    closeFile();
+    return false;
+  }
+
+  fileSize = countOffset + sizeof(int);
+  flushedOffset = 0;
+  return true;
+}
+
+/*!
+ * \brief Close current file.
+ */
+void TThreadRecordStreamer::closeFile(void) {
+  if (fd != -1) {
+    /* Keep page cache clean. */
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+    fd = -1;
+  }
+}
+
+/*!
+ * \brief Write a segment to current file, and release the segment.
+ * \param segment [in] Segment to write.
+ */
+void TThreadRecordStreamer::writeSegment(TRecordSegment *segment) {
+  bool isWritten = false;
+
+  if ((fd != -1) || openNextFile()) {
+    int used = segment->used.load(std::memory_order_acquire);
+    struct iovec iov[8];
+    int iovcnt = 0;
+    ssize_t size = 0;
+
+    /*
+     * Thread which started after the file was opened is not in thread list
+     * of the file. So its name is written before its first segment.
+     */
+    std::string name;
+    jlong nameEntryTime = THREAD_NAME_ENTRY_TIME;
+    int nameLen = 0;
+    if (namedThreads.insert(segment->thread_id).second &&
+        recorder->getThreadName(segment, &name)) {
+      nameLen = name.size();
+      iov[iovcnt++] = {&segment->thread_id, sizeof(jlong)};
+      iov[iovcnt++] = {&nameEntryTime, sizeof(jlong)};
+      iov[iovcnt++] = {&nameLen, sizeof(int)};
+      iov[iovcnt++] = {(void *)name.data(), (size_t)nameLen};
+      size += sizeof(jlong) * 2 + sizeof(int) + nameLen;
+      numSegments++;
+    }
+
+    iov[iovcnt++] = {&segment->thread_id, sizeof(jlong)};
+    iov[iovcnt++] = {&segment->base_time, sizeof(jlong)};
+    iov[iovcnt++] = {&used, sizeof(int)};
+    iov[iovcnt++] = {segment->data, (size_t)used};
+    size += sizeof(jlong) * 2 + sizeof(int) + used;
+
+    numSegments++;
+    if (unlikely((writev(fd, iov, iovcnt) != size) ||
+                 (pwrite(fd, &numSegments, sizeof(int), countOffset) !=
+                  sizeof(int)))) {
+      logger->printWarnMsgWithErrno("Could not write thread record stream.");
+      closeFile();
+      droppedSegments++;
+    } else {
+      isWritten = true;
+      fileSize += size;
+
+      /*
+       * Start writeback of new data, and drop older data from page cache
+       * which writeback has been started at previous call.
+       */
+      sync_file_range(fd, flushedOffset, fileSize - flushedOffset,
+                      SYNC_FILE_RANGE_WRITE);
+      if (flushedOffset > 0) {
+        posix_fadvise(fd, 0, flushedOffset, POSIX_FADV_DONTNEED);
+      }
+      flushedOffset = fileSize;
+
+      if (fileSize >= maxFileSize) {
+        closeFile();
+      }
+    }
+  } else {
+    droppedSegments++;
+  }
+
+  if (isWritten) {
+    /*
+     * Records are in the file, so they are discarded from ring buffer.
+     * Snapshot readers retry while sequence number is odd.
+     */
+    unsigned int seq = segment->seq.load(std::memory_order_relaxed);
+    segment->seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    segment->used.store(0, std::memory_order_release);
+    segment->seq.store(seq + 2, std::memory_order_release);
+  }
+
+  /* Segment can be reused by producers. */
+  segment->state.store(SegmentRetired, std::memory_order_release);
+  pending--;
+}
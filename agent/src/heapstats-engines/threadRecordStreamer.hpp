@@ -0,0 +1,185 @@
+/*!
+ * \file threadRecordStreamer.hpp
+ * \brief Streaming thread record data to rolling files.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+#ifndef THREAD_RECORD_STREAMER_HPP
+#define THREAD_RECORD_STREAMER_HPP
+
+#include <jvmti.h>
+#include <jni.h>
+
+#include <sys/types.h>
+
+#include <string>
+#include <unordered_set>
+
+#include <tbb/concurrent_queue.h>
+
+#include "agentThread.hpp"
+#include "threadRecorder.hpp"
+
+/*!
+ * \brief This class writes retired ring segments of thread recorder to
+ *        rolling files in background.<br>
+ *        Each file is complete thread record file which has own header.
+ *        Producers never wait I/O. If the writer falls behind, segments
+ *        are not queued and they are counted as dropped.
+ */
+class TThreadRecordStreamer : public TAgentThread {
+ public:
+  /*!
+   * \brief TThreadRecordStreamer constructor.
+   * \param recorder    [in] Thread recorder which owns segments.
+   * \param fname       [in] Base name of streaming files.
+   * \param file_size   [in] Size of each file in bytes.
+   * \param num_files   [in] Count of rolling files.
+   * \param max_pending [in] Max count of segments in queue.
+   */
+  TThreadRecordStreamer(TThreadRecorder *recorder, const char *fname,
+                        off_t file_size, int num_files, int max_pending);
+
+  /*!
+   * \brief TThreadRecordStreamer destructor.
+   */
+  virtual ~TThreadRecordStreamer(void);
+
+  using TAgentThread::start;
+
+  /*!
+   * \brief Start parallel work by JThread.
+   * \param jvmti [in] JVMTI environment information.
+   * \param env   [in] JNI environment information.
+   */
+  void start(jvmtiEnv *jvmti, JNIEnv *env);
+
+  /*!
+   * \brief Offer retired segment to writer.
+   *        State of the segment is changed to SegmentStreaming if accepted.
+   * \param segment [in] Retired segment.
+   * \return true if the segment is queued.
+   */
+  bool offer(TRecordSegment *segment);
+
+ protected:
+  /*!
+   * \brief Parallel work function by JThread.
+   * \param jvmti [in] JVMTI environment information.
+   * \param jni   [in] JNI environment information.
+   * \param data  [in] Instance of TThreadRecordStreamer.
+   */
+  static void JNICALL entryPoint(jvmtiEnv *jvmti, JNIEnv *jni, void *data);
+
+  /*!
+   * \brief Open next rolling file and write header.
+   * \return true if succeeded.
+   */
+  bool openNextFile(void);
+
+  /*!
+   * \brief Close current file.
+   */
+  void closeFile(void);
+
+  /*!
+   * \brief Write a segment to current file, and release the segment.<br>
+   *        Records in the segment are discarded after they are written,
+   *        so they are not written to dump of thread recorder again.
+   * \param segment [in] Segment to write.
+   */
+  void writeSegment(TRecordSegment *segment);
+
+  RELEASE_ONLY(private :)
+  /*!
+   * \brief Thread recorder which owns segments.
+   */
+  TThreadRecorder *recorder;
+
+  /*!
+   * \brief Base name of streaming files.
+   */
+  char *fileName;
+
+  /*!
+   * \brief Size of each file in bytes.
+   */
+  off_t maxFileSize;
+
+  /*!
+   * \brief Count of rolling files.
+   */
+  int numFiles;
+
+  /*!
+   * \brief Index of next file.
+   */
+  int nextFileIndex;
+
+  /*!
+   * \brief File descriptor of current file.
+   */
+  int fd;
+
+  /*!
+   * \brief Size of current file.
+   */
+  off_t fileSize;
+
+  /*!
+   * \brief Offset of count of segments in current file.
+   */
+  off_t countOffset;
+
+  /*!
+   * \brief Count of segments in current file.
+   */
+  int numSegments;
+
+  /*!
+   * \brief Offset which has been flushed and dropped from page cache.
+   */
+  off_t flushedOffset;
+
+  /*!
+   * \brief IDs of threads which names are in current file.
+   */
+  std::unordered_set<jlong> namedThreads;
+
+  /*!
+   * \brief Queue of segments to write.
+   */
+  tbb::concurrent_queue<TRecordSegment *> queue;
+
+  /*!
+   * \brief Count of segments in queue.
+   */
+  std::atomic_int pending;
+
+  /*!
+   * \brief Max count of segments in queue.
+   */
+  int maxPending;
+
+  /*!
+   * \brief Count of segments which are not streamed.
+   */
+  std::atomic_long droppedSegments;
+};
+
+#endif  // THREAD_RECORD_STREAMER_HPP
@@ -29,9 +29,14 @@
 #include <stdlib.h>
 #include <string.h>
 #include <pthread.h>
-#include <sys/time.h>
+#include <time.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <sched.h>
+#include <signal.h>
+
+#include <algorithm>
+#include <vector>
 
 #ifdef HAVE_ATOMIC
 #include <atomic>
@@ -45,6 +50,9 @@
 #include "callbackRegister.hpp"
 #include "jniCallbackRegister.hpp"
 #include "threadRecorder.hpp"
+#include "threadRecordStreamer.hpp"
+#include "threadRecordSnapshotWriter.hpp"
+#include "signalManager.hpp"
 
 #if PROCESSOR_ARCH == X86
 #include "arch/x86/lock.inline.hpp"
@@ -60,6 +68,78 @@ jclass threadClass;
 jmethodID currentThreadMethod;
 static std::atomic_int processing(0);
 
+/*!
+ * \brief Flag whether the recorder is finalizing.
+ *        Exiting threads do not touch segments after this flag is set.
+ */
+static std::atomic_bool finalizing(false);
+
+/*!
+ * \brief Signal manager to take snapshot of thread recorder by signal.
+ */
+static TSignalManager *snapshotSigMngr = NULL;
+
+/*!
+ * \brief Flag of snapshot request by signal.
+ */
+static volatile sig_atomic_t flagSnapshotSignal = 0;
+
+/*!
+ * \brief Start time of I/O which is in progress on this thread.
+ *        Index is TIOKind. Value is 0 if no I/O is in progress.
+ */
+static __thread jlong ioStartTime[NUM_IO_KINDS];
+
+/*!
+ * \brief Slot of this thread in thread name table.
+ *        Value is -1 if this thread does not have slot.
+ */
+static __thread int currentThreadIndex = -1;
+
+/*!
+ * \brief Generation of recorder which currentThreadIndex belongs to.
+ */
+static __thread int currentThreadGeneration = 0;
+
+/*!
+ * \brief Generation of current recorder.
+ *        It is incremented whenever the recorder is re-created, so slots
+ *        which are acquired from previous thread name table are ignored.
+ */
+static std::atomic_int recorderGeneration(0);
+
+/*!
+ * \brief Names of I/O kinds.
+ */
+static const char *ioKindNames[NUM_IO_KINDS] = {"file_write", "file_read",
+                                               "socket_write", "socket_read"};
+
+/*!
+ * \brief Max count of retry to copy a segment which is being reset.
+ */
+#define SNAPSHOT_MAX_RETRY 16
+
+/*!
+ * \brief Copy of ring segment in snapshot.
+ */
+typedef struct {
+  jlong base_time;
+  jlong thread_id;
+  int used;
+  unsigned char *data;
+} TSegmentCopy;
+
+/*!
+ * \brief Compare copies of ring segment by time of their first event.
+ *
+ * \param a [in] Copy of ring segment.
+ * \param b [in] Copy of ring segment.
+ * \return true if a is older than b.
+ */
+static bool compareSegmentCopy(const TSegmentCopy &a, const TSegmentCopy &b) {
+  return a.base_time < b.base_time;
+}
+
 /* JVMTI event handler */
 
 /*!
@@ -71,9 +151,7 @@ static std::atomic_int processing(0);
  */
 void JNICALL OnThreadStart(jvmtiEnv *jvmti, JNIEnv *env, jthread thread) {
   TProcessMark mark(processing);
-  TThreadRecorder *recorder = TThreadRecorder::getInstance();
-  recorder->registerNewThread(jvmti, thread);
-  recorder->putEvent(thread, ThreadStart, 0);
+  TThreadRecorder::getInstance()->putEvent(thread, ThreadStart, 0);
 }
 
 /*!
@@ -85,7 +163,9 @@ void JNICALL OnThreadStart(jvmtiEnv *jvmti, JNIEnv *env, jthread thread) {
  */
 void JNICALL OnThreadEnd(jvmtiEnv *jvmti, JNIEnv *env, jthread thread) {
   TProcessMark mark(processing);
-  TThreadRecorder::getInstance()->putEvent(thread, ThreadEnd, 0);
+  TThreadRecorder *recorder = TThreadRecorder::getInstance();
+  recorder->putEvent(thread, ThreadEnd, 0);
+  recorder->releaseThreadName(env, thread);
 }
 
 /*!
@@ -159,6 +239,18 @@ void JNICALL OnDataDumpRequestForDumpThreadRecordData(jvmtiEnv *jvmti) {
   TThreadRecorder::inst->dump(conf->ThreadRecordFileName()->get());
 }
 
+/*!
+ * \brief Handle signal express user wanna take snapshot of thread recorder.
+ * \param signo   [in] Number of received signal.
+ * \param siginfo [in] Information of received signal.
+ * \param data    [in] Data of received signal.
+ */
+void ThreadRecordSnapshotSigProc(int signo, siginfo_t *siginfo, void *data) {
+  /* Enable flag. */
+  flagSnapshotSignal = 1;
+  NOTIFY_CATCH_SIGNAL;
+}
+
 /* Support function. */
 
 /*!
@@ -344,15 +436,26 @@ JNIEXPORT void JNICALL IoTrace_fileWriteEnd(JNIEnv *env, jclass cls,
 
 /* Class member functions */
 
+/*!
+ * \brief Max size of a ring segment.
+ */
+#define MAX_SEGMENT_SIZE (64 * 1024)
+
+/*!
+ * \brief Min count of ring segments if buffer size is enough.
+ */
+#define MIN_SEGMENTS 1024
+
 /*!
  * \brief Constructor of TThreadRecorder.
  *
+ * \param jvmti [in] JVMTI environment.
  * \param buffer_size [in] Size of ring buffer.
  *                         Ring buffer size will be aligned to page size.
  */
-TThreadRecorder::TThreadRecorder(size_t buffer_size) : threadIDMap() {
+TThreadRecorder::TThreadRecorder(jvmtiEnv *jvmti, size_t buffer_size)
+    : next_segment(0), dropped_events(0), threadNames(jvmti) {
   aligned_buffer_size = ALIGN_SIZE_UP(buffer_size, systemPageSize);
-  bufferLockVal = 0;
 
   /* manpage of mmap(2):
    *
@@ -367,21 +470,154 @@ TThreadRecorder::TThreadRecorder(size_t buffer_size) : threadIDMap() {
     throw errno;
   }
 
-  top_of_buffer = (TEventRecord *)record_buffer;
-  end_of_buffer =
-      (TEventRecord *)((unsigned char *)record_buffer + aligned_buffer_size);
+  /*
+   * Segment is small enough to share the buffer with many threads,
+   * but is not smaller than page.
+   */
+  size_t size = ALIGN_SIZE_UP(aligned_buffer_size / MIN_SEGMENTS,
+                               systemPageSize);
+  if (size < (size_t)systemPageSize) {
+    size = systemPageSize;
+  } else if (size > MAX_SEGMENT_SIZE) {
+    size = MAX_SEGMENT_SIZE;
+  }
+  segment_size = size;
+  num_segments = aligned_buffer_size / size;
+
+  segments = new TRecordSegment[num_segments];
+  for (int idx = 0; idx < num_segments; idx++) {
+    segments[idx].seq = 0;
+    segments[idx].state = SegmentFree;
+    segments[idx].used = 0;
+    segments[idx].thread_index = -1;
+    segments[idx].data = (unsigned char *)record_buffer + size * idx;
+  }
+
+  streamer = NULL;
+  snapshotWriter = NULL;
+
+  if (pthread_key_create(&segment_key, &onThreadExit) != 0) {
+    int err = errno;
+    delete[] segments;
+    munmap(record_buffer, aligned_buffer_size);
+    throw err;
+  }
 }
 
 /*!
  * \brief Destructor of TThreadRecorder.
  */
 TThreadRecorder::~TThreadRecorder() {
+  pthread_key_delete(segment_key);
+  delete[] segments;
   munmap(record_buffer, aligned_buffer_size);
+}
+
+/*!
+ * \brief Callback for pthread key destructor.
+ *        Segment of exited thread is retired if the recorder is alive.
+ *
+ * \param data [in] Segment of exited thread.
+ */
+void TThreadRecorder::onThreadExit(void *data) {
+  /*
+   * finalize() sets the flag before it waits for processing, so the
+   * recorder is alive while this mark is held if the flag is not set.
+   */
+  TProcessMark mark(processing);
+  if (finalizing.load()) {
+    return;
+  }
+
+  retireSegment(data);
+}
 
-  /* Deallocate memory for thread name. */
-  for (auto itr = threadIDMap.begin(); itr != threadIDMap.end(); itr++) {
-    free(itr->second);
+/*!
+ * \brief Retire segment.
+ *        Caller must keep the recorder alive.
+ *
+ * \param data [in] Segment to retire.
+ */
+void TThreadRecorder::retireSegment(void *data) {
+  TRecordSegment *seg = (TRecordSegment *)data;
+
+  /* Hand over the segment to streamer if streaming is enabled. */
+  TThreadRecordStreamer *streamer = (inst != NULL) ? inst->streamer : NULL;
+  if ((streamer != NULL) &&
+      (seg->used.load(std::memory_order_relaxed) > 0) &&
+      streamer->offer(seg)) {
+    return;
   }
+
+  seg->state.store(SegmentRetired, std::memory_order_release);
+}
+
+/*!
+ * \brief Claim new ring segment for current thread.
+ *
+ * \param current [in] Current segment of this thread. It will be retired.
+ * \param thread_id [in] Thread ID of current thread.
+ * \param time [in] Time of the event which will be put to new segment.
+ * \return New segment. Value is NULL if all segments are in use.
+ */
+TRecordSegment *TThreadRecorder::switchSegment(TRecordSegment *current,
+                                               jlong thread_id, jlong time) {
+  if (current != NULL) {
+    retireSegment(current);
+  }
+
+  /* Name of this thread is resolved later. */
+  int generation = recorderGeneration.load(std::memory_order_relaxed);
+  if (unlikely((currentThreadIndex == -1) ||
+               (currentThreadGeneration != generation))) {
+    currentThreadIndex = threadNames.acquire(thread_id);
+    currentThreadGeneration = generation;
+  }
+
+  TRecordSegment *result = NULL;
+  for (int Cnt = 0; Cnt < num_segments; Cnt++) {
+    unsigned int ticket = next_segment.fetch_add(1);
+    unsigned int idx = ticket % num_segments;
+    if (unlikely((idx == 0) && (ticket != 0))) {
+      logger->printDebugMsg(
+                    "Ring buffer for Thread Recorder has been rewinded.");
+    }
+
+    TRecordSegment *seg = &segments[idx];
+    int state = seg->state.load(std::memory_order_acquire);
+    if ((state != SegmentActive) && (state != SegmentStreaming) &&
+        seg->state.compare_exchange_strong(state, SegmentActive)) {
+      /*
+       * Records of previous owner are overwritten. Its name is reclaimed
+       * if no other segment refers it and the thread has ended.
+       */
+      if (state == SegmentRetired) {
+        threadNames.release(seg->thread_index);
+      }
+
+      /*
+       * Snapshot readers retry if sequence number is odd or is changed
+       * while they copy this segment.
+       */
+      unsigned int seq = seg->seq.load(std::memory_order_relaxed);
+      seg->seq.store(seq + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+
+      seg->used.store(0, std::memory_order_release);
+      seg->thread_index = currentThreadIndex;
+      seg->thread_id = thread_id;
+      seg->base_time = time;
+      seg->last_time = time;
+      threadNames.addRef(currentThreadIndex);
+
+      seg->seq.store(seq + 2, std::memory_order_release);
+      result = seg;
+      break;
+    }
+  }
+
+  pthread_setspecific(segment_key, result);
+  return result;
 }
 
 /*!
@@ -606,13 +842,71 @@ void TThreadRecorder::UnregisterIOTracer(JNIEnv *env) {
  */
 void TThreadRecorder::initialize(jvmtiEnv *jvmti, JNIEnv *env, size_t buf_sz) {
   if (likely(inst == NULL)) {
-    inst = new TThreadRecorder(buf_sz);
+    inst = new TThreadRecorder(jvmti, buf_sz);
+    recorderGeneration++;
+    finalizing.store(false);
 
     registerHookPoint(jvmti, env);
     registerJNIHookPoint(env);
     registerIOTracer(jvmti, env);
 
-    inst->registerAllThreads(jvmti);
+    /* Start streaming of retired segments. */
+    jlong stream_size = conf->ThreadRecordStreamFileSize()->get();
+    if (stream_size > 0) {
+      TThreadRecordStreamer *streamer = NULL;
+      try {
+        streamer = new TThreadRecordStreamer(
+            inst, conf->ThreadRecordFileName()->get(),
+            stream_size * 1024 * 1024, conf->ThreadRecordStreamFiles()->get(),
+            inst->num_segments / 2);
+        streamer->start(jvmti, env);
+        inst->streamer = streamer;
+      } catch (const char *errMsg) {
+        logger->printWarnMsg(errMsg);
+        logger->printWarnMsg("Turn off streaming of thread records.");
+        delete streamer;
+      } catch (...) {
+        logger->printWarnMsg("Turn off streaming of thread records.");
+        delete streamer;
+      }
+    }
+
+    /* Start writer of live snapshot. */
+    TThreadRecordSnapshotWriter *writer = NULL;
+    try {
+      writer = new TThreadRecordSnapshotWriter(
+          inst, conf->ThreadRecordFileName()->get());
+      writer->start(jvmti, env);
+      inst->snapshotWriter = writer;
+    } catch (const char *errMsg) {
+      logger->printWarnMsg(errMsg);
+      logger->printWarnMsg("Turn off snapshot of thread records.");
+      delete writer;
+    } catch (...) {
+      logger->printWarnMsg("Turn off snapshot of thread records.");
+      delete writer;
+    }
+
+    /* Signal handler setup */
+    flagSnapshotSignal = 0;
+    char *snapshotSig = conf->ThreadRecordSnapshotSignal()->get();
+    if ((inst->snapshotWriter != NULL) && (snapshotSig != NULL)) {
+      try {
+        snapshotSigMngr = new TSignalManager(snapshotSig);
+        if (!snapshotSigMngr->addHandler(&ThreadRecordSnapshotSigProc)) {
+          logger->printWarnMsg(
+              "Thread record snapshot signal handler setup is failed.");
+          conf->ThreadRecordSnapshotSignal()->set(NULL);
+        }
+      } catch (const char *errMsg) {
+        logger->printWarnMsg(errMsg);
+        conf->ThreadRecordSnapshotSignal()->set(NULL);
+      } catch (...) {
+        logger->printWarnMsg(
+            "Thread record snapshot signal handler setup is failed.");
+        conf->ThreadRecordSnapshotSignal()->set(NULL);
+      }
+    }
   }
 
   /* Start to hook JVMTI event */
@@ -629,40 +923,308 @@ void TThreadRecorder::initialize(jvmtiEnv *jvmti, JNIEnv *env, size_t buf_sz) {
   TUnsafeParkCallback::switchCallback(env, true);
 }
 
+/*!
+ * \brief Copy ring segments to scratch buffer.
+ *        Producers are not paused. Each segment is copied under sequence
+ *        number protocol, and is retried if its owner resets it while
+ *        copying.
+ *
+ * \param segments [in] Ring segments.
+ * \param num_segments [in] Count of ring segments.
+ * \param scratch [in] Buffer which is as large as record buffer.
+ * \param work [out] Copies of segments which have records.
+ * \return Count of segments which could not be copied.
+ */
+static int copySegments(TRecordSegment *segments, int num_segments,
+                        unsigned char *scratch,
+                        std::vector<TSegmentCopy> *work) {
+  unsigned char *pos = scratch;
+  int skipped = 0;
+  for (int idx = 0; idx < num_segments; idx++) {
+    TRecordSegment *seg = &segments[idx];
+    bool copied = false;
+
+    for (int retry = 0; retry < SNAPSHOT_MAX_RETRY; retry++) {
+      unsigned int seq = seg->seq.load(std::memory_order_acquire);
+      if (unlikely((seq & 1) != 0)) {
+        /* Owner is resetting this segment. */
+        sched_yield();
+        continue;
+      }
+
+      TSegmentCopy copy;
+      copy.thread_id = seg->thread_id;
+      copy.base_time = seg->base_time;
+      copy.used = seg->used.load(std::memory_order_acquire);
+      copy.data = pos;
+      memcpy(pos, seg->data, copy.used);
+
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (likely(seg->seq.load(std::memory_order_relaxed) == seq)) {
+        if (copy.used > 0) {
+          work->push_back(copy);
+          pos += copy.used;
+        }
+        copied = true;
+        break;
+      }
+    }
+
+    if (unlikely(!copied)) {
+      skipped++;
+    }
+  }
+
+  return skipped;
+}
+
+/*!
+ * \brief Write copies of ring segments in order of their first event.
+ *        Each segment is written as thread ID, time of first event, size of
+ *        records and compact records.
+ *
+ * \param fd [in] File descriptor to write.
+ * \param work [in] Copies of segments. They are sorted in this function.
+ * \return true if succeeded.
+ */
+static bool writeSegmentCopies(int fd, std::vector<TSegmentCopy> *work) {
+  std::sort(work->begin(), work->end(), compareSegmentCopy);
+
+  int num_work = work->size();
+  if (unlikely(write(fd, &num_work, sizeof(int)) != sizeof(int))) {
+    return false;
+  }
+
+  for (auto itr = work->begin(); itr != work->end(); itr++) {
+    struct iovec iov[4] = {{&itr->thread_id, sizeof(jlong)},
+                           {&itr->base_time, sizeof(jlong)},
+                           {&itr->used, sizeof(int)},
+                           {itr->data, (size_t)itr->used}};
+    ssize_t size = sizeof(jlong) * 2 + sizeof(int) + itr->used;
+    if (unlikely(writev(fd, iov, 4) != size)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
 /*!
  * \brief Dump record data to file.
  *
  * \param fname [in] File name to dump record data.
  */
 void TThreadRecorder::dump(const char *fname) {
-  int fd = creat(fname, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+  /* Segments are copied as same as snapshot, because producers may run. */
+  unsigned char *scratch =
+      (unsigned char *)mmap(NULL, aligned_buffer_size, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (scratch == MAP_FAILED) {
+    logger->printWarnMsgWithErrno("Thread Recorder dump failed.");
+    throw errno;
+  }
+
+  std::vector<TSegmentCopy> work;
+  int skipped = copySegments(segments, num_segments, scratch, &work);
 
+  int fd = creat(fname, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
   if (fd == -1) {
+    int raisedErrNum = errno;
     logger->printWarnMsgWithErrno("Thread Recorder dump failed.");
-    throw errno;
+    munmap(scratch, aligned_buffer_size);
+    throw raisedErrNum;
+  }
+
+  writeHeader(fd);
+  if (unlikely(!writeSegmentCopies(fd, &work))) {
+    logger->printWarnMsgWithErrno("Could not write thread record data: %s",
+                                  fname);
+  }
+
+  if (skipped > 0) {
+    logger->printWarnMsg(
+        "Thread Recorder dump skipped %d segments which were being reset.",
+        skipped);
+  }
+
+  if (dropped_events > 0) {
+    logger->printWarnMsg(
+        "Thread Recorder dropped %ld events because all segments were in use.",
+        (long)dropped_events.load());
+  }
+
+  close(fd);
+  munmap(scratch, aligned_buffer_size);
+}
+
+/*!
+ * \brief Write consistent copy of current ring segments to file.
+ *        Producers are not paused. Each segment is copied under
+ *        sequence number protocol, and is retried if its owner resets it
+ *        while copying.
+ *
+ * \param fname [in] File name to write snapshot.
+ * \return true if succeeded.
+ */
+bool TThreadRecorder::writeSnapshot(const char *fname) {
+  /* Pages of scratch buffer are allocated on demand by copy. */
+  unsigned char *scratch =
+      (unsigned char *)mmap(NULL, aligned_buffer_size, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (scratch == MAP_FAILED) {
+    logger->printWarnMsgWithErrno(
+        "Could not allocate buffer for thread record snapshot.");
+    return false;
+  }
+
+  std::vector<TSegmentCopy> work;
+  int skipped = copySegments(segments, num_segments, scratch, &work);
+
+  bool result = true;
+  int fd = creat(fname, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+  if (fd == -1) {
+    logger->printWarnMsgWithErrno("Could not create thread record snapshot: %s",
+                                  fname);
+    result = false;
+  } else {
+    /* Layout is same as dump(). */
+    writeHeader(fd);
+    if (unlikely(!writeSegmentCopies(fd, &work))) {
+      logger->printWarnMsgWithErrno(
+          "Could not write thread record snapshot: %s", fname);
+      result = false;
+    }
+
+    close(fd);
+  }
+
+  if (skipped > 0) {
+    logger->printWarnMsg(
+        "Thread record snapshot skipped %d segments which were being reset.",
+        skipped);
   }
 
+  munmap(scratch, aligned_buffer_size);
+  return result;
+}
+
+/*!
+ * \brief Request snapshot of thread recorder.
+ *        Snapshot is written by background thread.
+ *
+ * \return true if the request is accepted.
+ */
+bool TThreadRecorder::requestSnapshot(void) {
+  TProcessMark mark(processing);
+
+  TThreadRecordSnapshotWriter *writer =
+      (inst != NULL) ? inst->snapshotWriter : NULL;
+  if (writer == NULL) {
+    logger->printWarnMsg("Thread recorder is not working.");
+    return false;
+  }
+
+  writer->notify();
+  return true;
+}
+
+/*!
+ * \brief Get latency statistics of each I/O kind.
+ *
+ * \param stats [out] Statistics. Index is TIOKind.
+ * \return true if thread recorder is working.
+ */
+bool TThreadRecorder::getIOLatencyStatistics(TLatencyStatistics *stats) {
+  TProcessMark mark(processing);
+
+  TThreadRecorder *recorder = inst;
+  if (recorder == NULL) {
+    return false;
+  }
+
+  for (int kind = 0; kind < NUM_IO_KINDS; kind++) {
+    recorder->ioHistograms[kind].getStatistics(&stats[kind]);
+  }
+
+  return true;
+}
+
+/*!
+ * \brief Get name of I/O kind.
+ *
+ * \param kind [in] I/O kind.
+ * \return Name of I/O kind.
+ */
+const char *TThreadRecorder::getIOKindName(int kind) {
+  return ioKindNames[kind];
+}
+
+/*!
+ * \brief Check snapshot signal, and request snapshot if it was caught.
+ *        This function is called by signal watcher thread.
+ */
+void TThreadRecorder::checkSnapshotSignal(void) {
+  if (unlikely(flagSnapshotSignal != 0)) {
+    flagSnapshotSignal = 0;
+    requestSnapshot();
+  }
+}
+
+/*!
+ * \brief Write header of thread record file.
+ *        Header contains byte order mark, magic number, format version,
+ *        clock anchor and thread list.
+ *
+ * \param fd [in] File descriptor to write.
+ * \param written [out] IDs of threads in thread list. Value can be NULL.
+ */
+void TThreadRecorder::writeHeader(int fd, std::unordered_set<jlong> *written) {
   /* Write byte order mark. */
   char bom = BOM;
   write(fd, &bom, sizeof(char));
 
-  /* Dump thread list. */
-  auto workIDMap(threadIDMap);
-  int threadIDMapSize = workIDMap.size();
-  write(fd, &threadIDMapSize, sizeof(int));
+  /* Write magic number and format version. */
+  write(fd, THREAD_RECORD_MAGIC, 4);
+  int version = THREAD_RECORD_FORMAT_VERSION;
+  write(fd, &version, sizeof(int));
 
-  for (auto itr = workIDMap.begin(); itr != workIDMap.end(); itr++) {
-    jlong id = itr->first;
-    int classname_length = strlen(itr->second);
-    write(fd, &id, sizeof(jlong));
-    write(fd, &classname_length, sizeof(int));
-    write(fd, itr->second, classname_length);
-  }
+  /*
+   * Write pair of wall-clock and monotonic clock in nanoseconds.
+   * Parser converts time of each event to wall-clock through this anchor.
+   */
+  struct timespec before, wall, after;
+  clock_gettime(CLOCK_MONOTONIC, &before);
+  clock_gettime(CLOCK_REALTIME, &wall);
+  clock_gettime(CLOCK_MONOTONIC, &after);
+  jlong anchor[2];
+  anchor[0] = (jlong)wall.tv_sec * 1000000000L + wall.tv_nsec;
+  anchor[1] = (((jlong)before.tv_sec * 1000000000L + before.tv_nsec) +
+               ((jlong)after.tv_sec * 1000000000L + after.tv_nsec)) / 2;
+  write(fd, anchor, sizeof(anchor));
+
+  /* Dump thread list. Names of live threads are resolved at here. */
+  threadNames.resolvePending();
+  threadNames.write(fd, written);
+}
 
-  /* Dump thread event. */
-  write(fd, record_buffer, aligned_buffer_size);
+/*!
+ * \brief Get name of thread which owns the segment.
+ *        Names of live threads are resolved if it is not resolved yet.
+ *        This function must be called by JThread.
+ *
+ * \param segment [in] Ring segment.
+ * \param name [out] Thread name.
+ * \return true if the name is available.
+ */
+bool TThreadRecorder::getThreadName(TRecordSegment *segment,
+                                    std::string *name) {
+  /* Slot is referred by the segment until the segment is reused. */
+  if (threadNames.getName(segment->thread_index, segment->thread_id, name)) {
+    return true;
+  }
 
-  close(fd);
+  threadNames.resolvePending();
+  return threadNames.getName(segment->thread_index, segment->thread_id, name);
 }
 
 /*!
@@ -709,11 +1271,49 @@ void TThreadRecorder::finalize(jvmtiEnv *jvmti, JNIEnv *env,
   /* Stop IoTrace hook */
   UnregisterIOTracer(env);
 
+  /* Stop snapshot requests. */
+  if (snapshotSigMngr != NULL) {
+    delete snapshotSigMngr;
+    snapshotSigMngr = NULL;
+  }
+  TThreadRecordSnapshotWriter *writer = inst->snapshotWriter;
+  inst->snapshotWriter = NULL;
+
+  /* Exiting threads do not retire their segments from now. */
+  finalizing.store(true);
+
   /* Wait until all tasks are finished. */
   while (processing > 0) {
     sched_yield();
   }
 
+  /* Stop snapshot writer. Snapshot in progress is finished. */
+  if (writer != NULL) {
+    writer->terminate();
+    delete writer;
+  }
+
+  /* Stop streaming. Remaining segments in queue are written. */
+  if (inst->streamer != NULL) {
+    TThreadRecordStreamer *streamer = inst->streamer;
+    inst->streamer = NULL;
+    streamer->terminate();
+    delete streamer;
+  }
+
+  /* Show I/O latency. */
+  for (int kind = 0; kind < NUM_IO_KINDS; kind++) {
+    TLatencyStatistics stat;
+    inst->ioHistograms[kind].getStatistics(&stat);
+    if (stat.count > 0) {
+      logger->printInfoMsg(
+          "I/O latency of %s: count = %ld, mean = %ld ns, p50 = %ld ns, "
+          "p99 = %ld ns, max = %ld ns",
+          ioKindNames[kind], (long)stat.count, (long)(stat.total / stat.count),
+          (long)stat.p50, (long)stat.p99, (long)stat.max);
+    }
+  }
+
   /* Stop HeapStats Thread Recorder */
   inst->dump(fname);
 
@@ -732,48 +1332,6 @@ void TThreadRecorder::setCapabilities(jvmtiCapabilities *capabilities) {
   capabilities->can_redefine_any_class = 1;
 }
 
-/*!
- * \brief Register new thread to thread id map.
- *
- * \param jvmti [in] JVMTI environment.
- * \param thread [in] jthread object of new thread.
- */
-void TThreadRecorder::registerNewThread(jvmtiEnv *jvmti, jthread thread) {
-  void *thread_oop = *(void **)thread;
-  jlong id = TVMFunctions::getInstance()->GetThreadId(thread_oop);
-
-  jvmtiThreadInfo threadInfo;
-  jvmti->GetThreadInfo(thread, &threadInfo);
-
-  {
-    TThreadIDMap::accessor acc;
-    if (!threadIDMap.insert(acc, id)) {
-      free(acc->second);
-    }
-    acc->second = strdup(threadInfo.name);
-  }
-
-  jvmti->Deallocate((unsigned char *)threadInfo.name);
-}
-
-/*!
- * \brief Register all existed threads to thread id map.
- *
- * \param jvmti [in] JVMTI environment.
- */
-void TThreadRecorder::registerAllThreads(jvmtiEnv *jvmti) {
-  jint thread_count;
-  jthread *threads;
-
-  jvmti->GetAllThreads(&thread_count, &threads);
-
-  for (int Cnt = 0; Cnt < thread_count; Cnt++) {
-    registerNewThread(jvmti, threads[Cnt]);
-  }
-
-  jvmti->Deallocate((unsigned char *)threads);
-}
-
 /*!
  * \brief Enqueue new event.
  *
@@ -783,35 +1341,69 @@ void TThreadRecorder::registerAllThreads(jvmtiEnv *jvmti) {
  */
 void TThreadRecorder::putEvent(jthread thread, TThreadEvent event,
                                jlong additionalData) {
-  struct timeval tv;
-  gettimeofday(&tv, NULL);
-
-  TEventRecord eventRecord __attribute__((aligned(32))); // for YMM vmovdqa
-
-  eventRecord.time = (tv.tv_sec * 1000) + (tv.tv_usec / 1000);
-  eventRecord.thread_id =
-      TVMFunctions::getInstance()->GetThreadId(*(void **)thread);
-  eventRecord.event = event;
-  eventRecord.additionalData = additionalData;
-
-  if (unlikely(top_of_buffer->event == ThreadEnd)) {
-    TThreadIDMap::accessor acc;
-    if (threadIDMap.find(acc, top_of_buffer->thread_id)) {
-      free(acc->second);
-      threadIDMap.erase(acc);
+  /* CLOCK_MONOTONIC is served by vDSO, and it is not affected by NTP jump. */
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  jlong time = (jlong)ts.tv_sec * 1000000000L + ts.tv_nsec;
+
+  /* Pair I/O events on this thread, and feed latency to histogram. */
+  if (unlikely(event >= FileWriteStart)) {
+    int kind = (event - FileWriteStart) / 2;
+    if (((event - FileWriteStart) & 1) == 0) {
+      ioStartTime[kind] = time;
+    } else if (likely(ioStartTime[kind] != 0)) {
+      ioHistograms[kind].record(time - ioStartTime[kind], additionalData);
+      ioStartTime[kind] = 0;
     }
   }
 
-  spinLockWait(&bufferLockVal);
-  {
-    memcpy32(top_of_buffer, &eventRecord);
+  jlong thread_id = TVMFunctions::getInstance()->GetThreadId(*(void **)thread);
 
-    if (unlikely(++top_of_buffer == end_of_buffer)) {
-      logger->printDebugMsg(
-                    "Ring buffer for Thread Recorder has been rewinded.");
-      top_of_buffer = (TEventRecord *)record_buffer;
+  TRecordSegment *seg = (TRecordSegment *)pthread_getspecific(segment_key);
+  if (unlikely((seg == NULL) || (seg->thread_id != thread_id) ||
+               (segment_size - seg->used.load(std::memory_order_relaxed) <
+                MAX_COMPACT_RECORD_SIZE))) {
+    seg = switchSegment(seg, thread_id, time);
+  }
+
+  if (likely(seg != NULL)) {
+    /* Only this thread writes to the segment. So we need not any lock. */
+    int used = seg->used.load(std::memory_order_relaxed);
+    jlong delta = time - seg->last_time;
+    int size = encodeCompactRecord(seg->data + used, (delta > 0) ? delta : 0,
+                                   event, additionalData);
+    seg->last_time += (delta > 0) ? delta : 0;
+    seg->used.store(used + size, std::memory_order_release);
+  } else {
+    dropped_events++;
+  }
+
+  if (unlikely(event == ThreadEnd)) {
+    /* Segment of ended thread can be reused by other threads. */
+    if (seg != NULL) {
+      retireSegment(seg);
+      pthread_setspecific(segment_key, NULL);
     }
   }
-  spinLockRelease(&bufferLockVal);
 }
 
+/*!
+ * \brief Release name slot of ending thread.
+ *
+ * \param env [in] JNI environment of ending thread.
+ * \param thread [in] jthread object of ending thread.
+ */
+void TThreadRecorder::releaseThreadName(JNIEnv *env, jthread thread) {
+  /*
+   * Name is needed only if this thread ended before any thread list is
+   * written. It is resolved by writer later, because JVMTI is too heavy
+   * for event path. Slot is kept by segments which have records of this
+   * thread. Slot of previous recorder has already gone with its table.
+   */
+  if (currentThreadGeneration == recorderGeneration.load()) {
+    threadNames.keepThread(currentThreadIndex, env, thread);
+    threadNames.release(currentThreadIndex);
+  }
+  currentThreadIndex = -1;
+}
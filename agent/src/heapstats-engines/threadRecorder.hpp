@@ -26,8 +26,12 @@
 #include <jni.h>
 
 #include <stddef.h>
+#include <pthread.h>
 
-#include <tbb/concurrent_hash_map.h>
+#include "util.hpp"
+#include "threadRecordFormat.hpp"
+#include "threadNameTable.hpp"
+#include "latencyHistogram.hpp"
 
 /*!
  * \brief Header of recording data.
@@ -40,49 +44,55 @@ typedef struct {
 } TRecordHeader;
 
 /*!
- * \brief Event record information.
+ * \brief State of ring segment.
+ */
+typedef enum {
+  SegmentFree = 0, /*!< Segment has never been used.             */
+  SegmentActive,   /*!< Segment is owned by a thread.            */
+  SegmentRetired,  /*!< Segment is full or its owner has exited. */
+  SegmentStreaming, /*!< Segment is waiting to be written to file. */
+} TSegmentState;
+
+/*!
+ * \brief Ring segment of compact event records.
+ *        Each segment is written by its owner thread only, so thread ID is
+ *        stored once per segment. Each record is an event byte, varint of
+ *        time delta from previous record and optional zigzag varint of
+ *        additional data.
  */
 typedef struct {
-  jlong time;
-  jlong thread_id;
-  jlong event;  // This value presents TThreadEvent.
-  jlong additionalData;
-} TEventRecord;
+  std::atomic_uint seq;   /*!< Sequence number for snapshot readers.
+                               It is odd while the owner resets header. */
+  std::atomic_int state;  /*!< Value presents TSegmentState.           */
+  std::atomic_int used;   /*!< Size of published records in bytes.     */
+  int thread_index;       /*!< Slot of owner in thread name table.     */
+  jlong thread_id;        /*!< Thread ID of owner.                     */
+  jlong base_time;        /*!< Time of first record.                   */
+  jlong last_time;        /*!< Time of last record (owner only).       */
+  unsigned char *data;    /*!< Records in this segment.                */
+} TRecordSegment;
 
 /*!
- * \brief Event definition.
+ * \brief Kind of I/O which is traced by IoTrace.
+ *        Order is same as pairs of start and end events in TThreadEvent.
  */
 typedef enum {
-  /* JVMTI event */
-  ThreadStart = 1,
-  ThreadEnd,
-  MonitorWait,
-  MonitorWaited,
-  MonitorContendedEnter,
-  MonitorContendedEntered,
-
-  /* JNI function hook */
-  ThreadSleepStart,
-  ThreadSleepEnd,
-  Park,
-  Unpark,
-
-  /* IoTrace */
-  FileWriteStart,
-  FileWriteEnd,
-  FileReadStart,
-  FileReadEnd,
-  SocketWriteStart,
-  SocketWriteEnd,
-  SocketReadStart,
-  SocketReadEnd,
-} TThreadEvent;
+  IOFileWrite = 0,
+  IOFileRead,
+  IOSocketWrite,
+  IOSocketRead,
+  NUM_IO_KINDS
+} TIOKind;
 
 /*!
- * \brief Type of ThreadID-ThreadName map.
+ * \brief Forward declaration in threadRecordStreamer.hpp
  */
-typedef tbb::concurrent_hash_map<jlong, char *, TNumericalHasher<jlong> >
-                                                                  TThreadIDMap;
+class TThreadRecordStreamer;
+
+/*!
+ * \brief Forward declaration in threadRecordSnapshotWriter.hpp
+ */
+class TThreadRecordSnapshotWriter;
 
 /*!
  * \brief Implementation of HeapStats Thread Recorder.
@@ -101,28 +111,61 @@ class TThreadRecorder {
   void *record_buffer;
 
   /*!
-   * \brief Pointer of record buffer.
-   *        Record buffer is ring buffer. So this pointer must be increment
-   *        in each writing event, and return to top of buffer when this
-   *        pointer reaches end of buffer.
+   * \brief Ring segments in record buffer.
+   *        Record buffer is divided into segments. Each thread appends
+   *        events to its own segment without lock, and claims next segment
+   *        in round-robin when the segment is full. So the oldest retired
+   *        segment is overwritten as like ring buffer.
+   */
+  TRecordSegment *segments;
+
+  /*!
+   * \brief Count of ring segments.
+   */
+  int num_segments;
+
+  /*!
+   * \brief Size of a ring segment in bytes.
+   */
+  int segment_size;
+
+  /*!
+   * \brief Counter to choose next segment.
    */
-  TEventRecord *top_of_buffer;
+  std::atomic_uint next_segment;
 
   /*!
-   * \brief End of record buffer.
+   * \brief Count of events which are dropped because all segments are
+   *        in use.
    */
-  TEventRecord *end_of_buffer;
+  std::atomic_long dropped_events;
 
   /*!
-   * \brief ThreadID-ThreadName map.
-   *        Key is thread ID, Value is thread name.
+   * \brief Pthread key to store current segment of each thread.
    */
-  TThreadIDMap threadIDMap;
+  pthread_key_t segment_key;
 
   /*!
-   * \brief SpinLock variable for Ring Buffer operation.
+   * \brief Writer of retired segments. Value is NULL if streaming is
+   *        disabled.
    */
-  volatile int bufferLockVal;
+  TThreadRecordStreamer *streamer;
+
+  /*!
+   * \brief Writer of live snapshot. Value is NULL if recorder is finalizing.
+   */
+  TThreadRecordSnapshotWriter *snapshotWriter;
+
+  /*!
+   * \brief Names of threads which own segments.
+   */
+  TThreadNameTable threadNames;
+
+  /*!
+   * \brief Latency histograms of each I/O kind.
+   *        Start and end events are paired by each thread in putEvent().
+   */
+  TLatencyHistogram ioHistograms[NUM_IO_KINDS];
 
   /*!
    * \brief Instance of TThreadRecorder.
@@ -133,25 +176,38 @@ class TThreadRecorder {
   /*!
    * \brief Constructor of TThreadRecorder.
    *
+   * \param jvmti [in] JVMTI environment.
    * \param buffer_size [in] Size of ring buffer.
    *                         Ring buffer size will be aligned to page size.
    */
-  TThreadRecorder(size_t buffer_size);
+  TThreadRecorder(jvmtiEnv *jvmti, size_t buffer_size);
 
   /*!
-   * \brief Register new thread to thread id map.
+   * \brief Claim new ring segment for current thread.
    *
-   * \param jvmti [in] JVMTI environment.
-   * \param thread [in] jthread object of new thread.
+   * \param current [in] Current segment of this thread. It will be retired.
+   * \param thread_id [in] Thread ID of current thread.
+   * \param time [in] Time of the event which will be put to new segment.
+   * \return New segment. Value is NULL if all segments are in use.
    */
-  void registerNewThread(jvmtiEnv *jvmti, jthread thread);
+  TRecordSegment *switchSegment(TRecordSegment *current, jlong thread_id,
+                                jlong time);
 
   /*!
-   * \brief Register all existed threads to thread id map.
+   * \brief Callback for pthread key destructor.
+   *        Segment of exited thread is retired if the recorder is alive.
    *
-   * \param jvmti [in] JVMTI environment.
+   * \param data [in] Segment of exited thread.
+   */
+  static void onThreadExit(void *data);
+
+  /*!
+   * \brief Retire segment.
+   *        Caller must keep the recorder alive.
+   *
+   * \param data [in] Segment to retire.
    */
-  void registerAllThreads(jvmtiEnv *jvmti);
+  static void retireSegment(void *data);
 
   /*!
    * \brief Register JVMTI hook point.
@@ -240,6 +296,68 @@ class TThreadRecorder {
    */
   void dump(const char *fname);
 
+  /*!
+   * \brief Write consistent copy of current ring segments to file.
+   *        Producers are not paused. Each segment is copied under
+   *        sequence number protocol, and is retried if its owner resets it
+   *        while copying.
+   *
+   * \param fname [in] File name to write snapshot.
+   * \return true if succeeded.
+   */
+  bool writeSnapshot(const char *fname);
+
+  /*!
+   * \brief Request snapshot of thread recorder.
+   *        Snapshot is written by background thread.
+   *
+   * \return true if the request is accepted.
+   */
+  static bool requestSnapshot(void);
+
+  /*!
+   * \brief Get latency statistics of each I/O kind.
+   *
+   * \param stats [out] Statistics. Index is TIOKind.
+   * \return true if thread recorder is working.
+   */
+  static bool getIOLatencyStatistics(TLatencyStatistics *stats);
+
+  /*!
+   * \brief Get name of I/O kind.
+   *
+   * \param kind [in] I/O kind.
+   * \return Name of I/O kind.
+   */
+  static const char *getIOKindName(int kind);
+
+  /*!
+   * \brief Check snapshot signal, and request snapshot if it was caught.
+   *        This function is called by signal watcher thread.
+   */
+  static void checkSnapshotSignal(void);
+
+  /*!
+   * \brief Write header of thread record file.
+   *        Header contains byte order mark, magic number, format version,
+   *        clock anchor and thread list.
+   *
+   * \param fd [in] File descriptor to write.
+   * \param written [out] IDs of threads in thread list. Value can be NULL.
+   */
+  void writeHeader(int fd, std::unordered_set<jlong> *written = NULL);
+
+  /*!
+   * \brief Get name of thread which owns the segment.
+   *        Names of live threads are resolved if it is not resolved yet.
+   *        This function must be called by JThread.
+   *
+   * \param segment [in] Ring segment.
+   * \param name [out] Thread name.
+   * \return true if the name is available.
+   */
+  bool getThreadName(TRecordSegment *segment, std::string *name);
+
   /*!
    * \brief Get singleton instance of TThreadRecorder.
    *
@@ -256,6 +374,14 @@ class TThreadRecorder {
    */
   inline void putEvent(jthread thread, TThreadEvent event,
                        jlong additionalData);
+
+  /*!
+   * \brief Release name slot of ending thread.
+   *
+   * \param env [in] JNI environment of ending thread.
+   * \param thread [in] jthread object of ending thread.
+   */
+  void releaseThreadName(JNIEnv *env, jthread thread);
 };
 
 #endif  // THREAD_RECORDER_HPP
@@ -63,11 +63,6 @@ void JNICALL TTimer::entryPoint(jvmtiEnv *jvmti, JNIEnv *jni, void *data) {
   /* Get self. */
   TTimer *controller = (TTimer *)data;
 
-  /* Create increment time. */
-  struct timespec incTs = {0};
-  incTs.tv_sec = controller->timerInterval / 1000;
-  incTs.tv_nsec = (controller->timerInterval % 1000) * 1000;
-
   /* Change running state. */
   controller->_isRunning = true;
 
@@ -83,6 +78,11 @@ void JNICALL TTimer::entryPoint(jvmtiEnv *jvmti, JNIEnv *jni, void *data) {
         break;
       }
 
+      /* Create increment time. Interval might be changed by callback. */
+      struct timespec incTs = {0};
+      incTs.tv_sec = controller->timerInterval / 1000;
+      incTs.tv_nsec = (controller->timerInterval % 1000) * 1000;
+
       /* Create limit datetime. */
       struct timespec limitTs = {0};
       struct timeval nowTv = {0};
@@ -178,6 +178,21 @@ void TTimer::notify(void) {
   }
 }
 
+/*!
+ * \brief Change interval of timer.<br>
+ *        New interval is used from next waiting.
+ *        Timer which is started with 0 interval cannot be changed.
+ * \param interval [in] Interval of invoke timer event.
+ */
+void TTimer::setInterval(jlong interval) {
+  if ((this->timerInterval == 0) || (interval <= 0)) {
+    return;
+  }
+
+  TMutexLocker locker(&this->mutex);
+  this->timerInterval = interval;
+}
+
 /*!
  * \brief Notify stop to this thread from other thread.
  */
@@ -69,6 +69,13 @@ class TTimer : public TAgentThread {
    * \brief Notify stop to this thread from other thread.
    */
   void stop(void);
+  /*!
+   * \brief Change interval of timer.<br>
+   *        New interval is used from next waiting.
+   *        Timer which is started with 0 interval cannot be changed.
+   * \param interval [in] Interval of invoke timer event.
+   */
+  void setInterval(jlong interval);
 
  protected:
   /*!
@@ -0,0 +1,282 @@
+/*!
+ * \file waitForTable.cpp
+ * \brief This file is used to store edges of wait-for graph.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ *
+ */
+
+#include <sched.h>
+#include <stdlib.h>
+
+#include "waitForTable.hpp"
+
+#if PROCESSOR_ARCH == X86
+#include "arch/x86/lock.inline.hpp"
+#elif PROCESSOR_ARCH == ARM
+#include "arch/arm/lock.inline.hpp"
+#endif
+
+/*!
+ * \brief Get shard of hash value.
+ */
+#define SHARD_OF(hash) ((hash) & (WAIT_FOR_SHARDS - 1))
+
+/*!
+ * \brief Get home slot of hash value.
+ */
+#define HOME_SLOT_OF(hash) (((hash) >> 6) & (WAIT_FOR_SHARD_SLOTS - 1))
+
+/*!
+ * \brief Get next slot in linear probing.
+ */
+#define NEXT_SLOT(idx) (((idx) + 1) & (WAIT_FOR_SHARD_SLOTS - 1))
+
+/*!
+ * \brief TWaitForTable constructor.
+ */
+TWaitForTable::TWaitForTable(void) {
+  void *mem = NULL;
+  if (unlikely(posix_memalign(&mem, 64,
+                              sizeof(TWaitForShard) * WAIT_FOR_SHARDS) != 0)) {
+    throw "Could not allocate wait-for table.";
+  }
+
+  shards = (TWaitForShard *)mem;
+  for (int idx = 0; idx < WAIT_FOR_SHARDS; idx++) {
+    shards[idx].seq = 0;
+    shards[idx].lockVal = 0;
+    for (int slot = 0; slot < WAIT_FOR_SHARD_SLOTS; slot++) {
+      shards[idx].keys[slot] = 0;
+      shards[idx].values[slot] = 0;
+    }
+  }
+}
+
+/*!
+ * \brief TWaitForTable destructor.
+ */
+TWaitForTable::~TWaitForTable(void) { free(shards); }
+
+/*!
+ * \brief Find slot of key in shard.<br>
+ *        Caller must hold the lock of the shard.
+ * \param shard [in] Shard of the key.
+ * \param key   [in] Key of entry.
+ * \param hash  [in] Hash value of the key.
+ * \return Index of slot. Value is -1 if the key does not exist.
+ */
+int TWaitForTable::findSlot(TWaitForShard *shard, jlong key,
+                            unsigned long long int hash) {
+  int idx = HOME_SLOT_OF(hash);
+
+  for (int probe = 0; probe < WAIT_FOR_SHARD_SLOTS; probe++) {
+    jlong cur = shard->keys[idx].load(std::memory_order_relaxed);
+    if (cur == key) {
+      return idx;
+    } else if (cur == 0) {
+      break;
+    }
+
+    idx = NEXT_SLOT(idx);
+  }
+
+  return -1;
+}
+
+/*!
+ * \brief Insert or update entry.
+ * \param key   [in] Key of entry. It must not be 0.
+ * \param value [in] Value of entry.
+ * \return true if succeeded. false means the shard is full.
+ */
+bool TWaitForTable::put(jlong key, jlong value) {
+  unsigned long long int hash = hashKey(key);
+  TWaitForShard *shard = &shards[SHARD_OF(hash)];
+  bool result = false;
+
+  spinLockWait(&shard->lockVal);
+  {
+    int idx = findSlot(shard, key, hash);
+    if (idx != -1) {
+      /* Readers see either old or new value. */
+      shard->values[idx].store(value, std::memory_order_release);
+      result = true;
+    } else {
+      idx = HOME_SLOT_OF(hash);
+      for (int probe = 0; probe < WAIT_FOR_SHARD_SLOTS; probe++) {
+        if (shard->keys[idx].load(std::memory_order_relaxed) == 0) {
+          unsigned int seq = shard->seq.load(std::memory_order_relaxed);
+          shard->seq.store(seq + 1, std::memory_order_relaxed);
+          std::atomic_thread_fence(std::memory_order_release);
+
+          shard->values[idx].store(value, std::memory_order_relaxed);
+          shard->keys[idx].store(key, std::memory_order_relaxed);
+
+          shard->seq.store(seq + 2, std::memory_order_release);
+          result = true;
+          break;
+        }
+
+        idx = NEXT_SLOT(idx);
+      }
+    }
+  }
+  spinLockRelease(&shard->lockVal);
+
+  return result;
+}
+
+/*!
+ * \brief Remove entry.
+ * \param key [in] Key of entry.
+ */
+void TWaitForTable::remove(jlong key) {
+  unsigned long long int hash = hashKey(key);
+  TWaitForShard *shard = &shards[SHARD_OF(hash)];
+
+  spinLockWait(&shard->lockVal);
+  {
+    int hole = findSlot(shard, key, hash);
+    if (hole != -1) {
+      unsigned int seq = shard->seq.load(std::memory_order_relaxed);
+      shard->seq.store(seq + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+
+      /*
+       * Backward shift deletion.
+       * Following entries in the cluster are moved into the hole if their
+       * home slot is not between the hole and themselves.
+       * Full shard has no empty slot, so other slots are probed once.
+       */
+      int idx = hole;
+      for (int probe = 1; probe < WAIT_FOR_SHARD_SLOTS; probe++) {
+        idx = NEXT_SLOT(idx);
+        jlong cur = shard->keys[idx].load(std::memory_order_relaxed);
+        if (cur == 0) {
+          break;
+        }
+
+        int home = HOME_SLOT_OF(hashKey(cur));
+        bool stay = (hole <= idx) ? ((hole < home) && (home <= idx))
+                                  : ((hole < home) || (home <= idx));
+        if (!stay) {
+          shard->keys[hole].store(cur, std::memory_order_relaxed);
+          shard->values[hole].store(
+              shard->values[idx].load(std::memory_order_relaxed),
+              std::memory_order_relaxed);
+          hole = idx;
+        }
+      }
+      shard->keys[hole].store(0, std::memory_order_relaxed);
+
+      shard->seq.store(seq + 2, std::memory_order_release);
+    }
+  }
+  spinLockRelease(&shard->lockVal);
+}
+
+/*!
+ * \brief Find value of key without lock.
+ * \param key   [in]  Key of entry.
+ * \param value [out] Value of entry.
+ * \return true if the entry exists.
+ */
+bool TWaitForTable::get(jlong key, jlong *value) {
+  unsigned long long int hash = hashKey(key);
+  TWaitForShard *shard = &shards[SHARD_OF(hash)];
+
+  while (true) {
+    unsigned int seq = shard->seq.load(std::memory_order_acquire);
+    if (unlikely((seq & 1) != 0)) {
+      /* Writer is moving entries. */
+      sched_yield();
+      continue;
+    }
+
+    bool found = false;
+    jlong result = 0;
+    int idx = HOME_SLOT_OF(hash);
+    for (int probe = 0; probe < WAIT_FOR_SHARD_SLOTS; probe++) {
+      jlong cur = shard->keys[idx].load(std::memory_order_relaxed);
+      if (cur == key) {
+        result = shard->values[idx].load(std::memory_order_relaxed);
+        found = true;
+        break;
+      } else if (cur == 0) {
+        break;
+      }
+
+      idx = NEXT_SLOT(idx);
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (likely(shard->seq.load(std::memory_order_relaxed) == seq)) {
+      *value = result;
+      return found;
+    }
+  }
+}
+
+/*!
+ * \brief Replace value of entry if current value is expected one.
+ * \param key      [in] Key of entry.
+ * \param expected [in] Expected value.
+ * \param value    [in] New value.
+ * \return true if value is replaced.
+ */
+bool TWaitForTable::replace(jlong key, jlong expected, jlong value) {
+  unsigned long long int hash = hashKey(key);
+  TWaitForShard *shard = &shards[SHARD_OF(hash)];
+  bool result = false;
+
+  spinLockWait(&shard->lockVal);
+  {
+    int idx = findSlot(shard, key, hash);
+    if ((idx != -1) &&
+        (shard->values[idx].load(std::memory_order_relaxed) == expected)) {
+      shard->values[idx].store(value, std::memory_order_release);
+      result = true;
+    }
+  }
+  spinLockRelease(&shard->lockVal);
+
+  return result;
+}
+
+/*!
+ * \brief Remove all entries.
+ */
+void TWaitForTable::clear(void) {
+  for (int idx = 0; idx < WAIT_FOR_SHARDS; idx++) {
+    TWaitForShard *shard = &shards[idx];
+
+    spinLockWait(&shard->lockVal);
+    {
+      unsigned int seq = shard->seq.load(std::memory_order_relaxed);
+      shard->seq.store(seq + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+
+      for (int slot = 0; slot < WAIT_FOR_SHARD_SLOTS; slot++) {
+        shard->keys[slot].store(0, std::memory_order_relaxed);
+      }
+
+      shard->seq.store(seq + 2, std::memory_order_release);
+    }
+    spinLockRelease(&shard->lockVal);
+  }
+}
@@ -0,0 +1,141 @@
+/*!
+ * \file waitForTable.hpp
+ * \brief This file is used to store edges of wait-for graph.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ *
+ */
+
+#ifndef _WAIT_FOR_TABLE_H
+#define _WAIT_FOR_TABLE_H
+
+#include <jni.h>
+
+#include "util.hpp"
+
+/*!
+ * \brief Count of shards. This value must be power of 2.
+ */
+#define WAIT_FOR_SHARDS 64
+
+/*!
+ * \brief Count of slots in a shard. This value must be power of 2.
+ */
+#define WAIT_FOR_SHARD_SLOTS 128
+
+/*!
+ * \brief Shard of wait-for table.<br>
+ *        Writers are serialized by spin lock of each shard. Readers do not
+ *        take the lock, and retry if sequence number is odd or is changed
+ *        while probing.
+ */
+typedef struct {
+  std::atomic_uint seq;                        /*!< Sequence number.      */
+  volatile int lockVal;                        /*!< Lock for writers.     */
+  std::atomic<jlong> keys[WAIT_FOR_SHARD_SLOTS];   /*!< 0 is empty slot. */
+  std::atomic<jlong> values[WAIT_FOR_SHARD_SLOTS]; /*!< Values of keys.  */
+} __attribute__((aligned(64))) TWaitForShard;
+
+/*!
+ * \brief This class is map of non-zero key to value for edges of wait-for
+ *        graph, e.g. monitor to owner thread, or thread to contended
+ *        monitor.<br>
+ *        Entries are sharded by key, so writers to other entries rarely
+ *        wait each other, and lookup never takes lock.
+ */
+class TWaitForTable {
+ public:
+  /*!
+   * \brief TWaitForTable constructor.
+   */
+  TWaitForTable(void);
+
+  /*!
+   * \brief TWaitForTable destructor.
+   */
+  virtual ~TWaitForTable(void);
+
+  /*!
+   * \brief Insert or update entry.
+   * \param key   [in] Key of entry. It must not be 0.
+   * \param value [in] Value of entry.
+   * \return true if succeeded. false means the shard is full.
+   */
+  bool put(jlong key, jlong value);
+
+  /*!
+   * \brief Remove entry.
+   * \param key [in] Key of entry.
+   */
+  void remove(jlong key);
+
+  /*!
+   * \brief Find value of key without lock.
+   * \param key   [in]  Key of entry.
+   * \param value [out] Value of entry.
+   * \return true if the entry exists.
+   */
+  bool get(jlong key, jlong *value);
+
+  /*!
+   * \brief Replace value of entry if current value is expected one.
+   * \param key      [in] Key of entry.
+   * \param expected [in] Expected value.
+   * \param value    [in] New value.
+   * \return true if value is replaced.
+   */
+  bool replace(jlong key, jlong expected, jlong value);
+
+  /*!
+   * \brief Remove all entries.
+   */
+  void clear(void);
+
+ private:
+  /*!
+   * \brief Calculate hash value of key.
+   * \param key [in] Key of entry.
+   * \return Hash value.
+   */
+  static inline unsigned long long int hashKey(jlong key) {
+    /* Finalizer of MurmurHash3 */
+    unsigned long long int hash = (unsigned long long int)key;
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+  }
+
+  /*!
+   * \brief Find slot of key in shard.<br>
+   *        Caller must hold the lock of the shard.
+   * \param shard [in] Shard of the key.
+   * \param key   [in] Key of entry.
+   * \param hash  [in] Hash value of the key.
+   * \return Index of slot. Value is -1 if the key does not exist.
+   */
+  int findSlot(TWaitForShard *shard, jlong key, unsigned long long int hash);
+
+  /*!
+   * \brief Shards of this table.
+   */
+  TWaitForShard *shards;
+};
+
+#endif  // _WAIT_FOR_TABLE_H
@@ -0,0 +1,918 @@
+/*!
+ * \file zipArchiver.cpp
+ * \brief This file is used create archive file by zlib.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ *
+ */
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "globals.hpp"
+#include "fsUtil.hpp"
+#include "zipArchiver.hpp"
+
+/*!
+ * \brief Signature of local file header.
+ */
+#define ZIP_LOCAL_HEADER_SIG 0x04034b50
+
+/*!
+ * \brief Signature of central directory file header.
+ */
+#define ZIP_CENTRAL_HEADER_SIG 0x02014b50
+
+/*!
+ * \brief Signature of end of central directory record.
+ */
+#define ZIP_END_OF_CENTRAL_SIG 0x06054b50
+
+/*!
+ * \brief Size of local file header without file name.
+ */
+#define ZIP_LOCAL_HEADER_SIZE 30
+
+/*!
+ * \brief Size of central directory file header without file name.
+ */
+#define ZIP_CENTRAL_HEADER_SIZE 46
+
+/*!
+ * \brief Size of end of central directory record.
+ */
+#define ZIP_END_OF_CENTRAL_SIZE 22
+
+/*!
+ * \brief Signature of zip64 end of central directory record.
+ */
+#define ZIP64_END_OF_CENTRAL_SIG 0x06064b50
+
+/*!
+ * \brief Size of zip64 end of central directory record.
+ */
+#define ZIP64_END_OF_CENTRAL_SIZE 56
+
+/*!
+ * \brief Signature of zip64 end of central directory locator.
+ */
+#define ZIP64_LOCATOR_SIG 0x07064b50
+
+/*!
+ * \brief Size of zip64 end of central directory locator.
+ */
+#define ZIP64_LOCATOR_SIZE 20
+
+/*!
+ * \brief Header ID of zip64 extended information extra field.
+ */
+#define ZIP64_EXTRA_ID 0x0001
+
+/*!
+ * \brief Size of zip64 extra field in local file header.
+ *        (Header ID, data size, original size and compressed size)
+ */
+#define ZIP64_LOCAL_EXTRA_SIZE 20
+
+/*!
+ * \brief Version needed to extract. (4.5: zip64)
+ */
+#define ZIP_VERSION 45
+
+/*!
+ * \brief Version made by. (UNIX, 2.0)
+ */
+#define ZIP_VERSION_MADE_BY ((3 << 8) | ZIP_VERSION)
+
+/*!
+ * \brief Compression method. (deflate)
+ */
+#define ZIP_METHOD_DEFLATE 8
+
+/*!
+ * \brief Value of 32 bits field which means value is in zip64 extra field.
+ */
+#define ZIP_MAX_SIZE 0xffffffffULL
+
+/*!
+ * \brief Value of 16 bits field which means value is in zip64 record.
+ */
+#define ZIP_MAX_COUNT 0xffff
+
+/*!
+ * \brief Store 16 bits integer as little endian.
+ * \param dest  [out] Destination.
+ * \param value [in]  Value to store.
+ */
+static inline void putUInt16(unsigned char *dest, uint16_t value) {
+  dest[0] = (unsigned char)value;
+  dest[1] = (unsigned char)(value >> 8);
+}
+
+/*!
+ * \brief Store 32 bits integer as little endian.
+ * \param dest  [out] Destination.
+ * \param value [in]  Value to store.
+ */
+static inline void putUInt32(unsigned char *dest, uint32_t value) {
+  putUInt16(dest, (uint16_t)value);
+  putUInt16(dest + 2, (uint16_t)(value >> 16));
+}
+
+/*!
+ * \brief Store 64 bits integer as little endian.
+ * \param dest  [out] Destination.
+ * \param value [in]  Value to store.
+ */
+static inline void putUInt64(unsigned char *dest, uint64_t value) {
+  putUInt32(dest, (uint32_t)value);
+  putUInt32(dest + 4, (uint32_t)(value >> 32));
+}
+
+/*!
+ * \brief Store 32 bits field of zip record.
+ * \param dest  [out] Destination.
+ * \param value [in]  Value to store.
+ * \return Value is stored in zip64 extra field.
+ */
+static inline bool putZipField(unsigned char *dest, uint64_t value) {
+  bool isZip64 = (value >= ZIP_MAX_SIZE);
+  putUInt32(dest, isZip64 ? (uint32_t)ZIP_MAX_SIZE : (uint32_t)value);
+  return isZip64;
+}
+
+/*!
+ * \brief Convert time to MS-DOS form.
+ * \param mtime   [in]  Modification time.
+ * \param dosTime [out] Time in MS-DOS form.
+ * \param dosDate [out] Date in MS-DOS form.
+ */
+static void toDosTime(time_t mtime, uint16_t *dosTime, uint16_t *dosDate) {
+  struct tm tm;
+  localtime_r(&mtime, &tm);
+
+  /* MS-DOS date starts from 1980. */
+  if (unlikely(tm.tm_year < 80)) {
+    tm.tm_year = 80;
+    tm.tm_mon = 0;
+    tm.tm_mday = 1;
+    tm.tm_hour = tm.tm_min = tm.tm_sec = 0;
+  }
+
+  *dosTime = (uint16_t)((tm.tm_hour << 11) | (tm.tm_min << 5) |
+                        (tm.tm_sec >> 1));
+  *dosDate = (uint16_t)(((tm.tm_year - 80) << 9) | ((tm.tm_mon + 1) << 5) |
+                        tm.tm_mday);
+}
+
+/*!
+ * \brief TZipArchiver constructor.
+ */
+TZipArchiver::TZipArchiver(void) : TArchiveMaker(), entries() {
+  fd = -1;
+  archivePath = NULL;
+  archiveSize = 0;
+  deflater = NULL;
+  isAborted = false;
+
+  /* Buffers are allocated in advance for OutOfMemoryError. */
+  inBuf = (unsigned char *)malloc(ZIP_ARCHIVER_BUFFER_SIZE);
+  outBuf = (unsigned char *)malloc(ZIP_ARCHIVER_BUFFER_SIZE);
+  if (unlikely((inBuf == NULL) || (outBuf == NULL))) {
+    free(inBuf);
+    free(outBuf);
+    throw "Couldn't allocate buffers of zip archiver.";
+  }
+
+  /* Raw deflate stream. Zip container has its own header. */
+  memset(&stream, 0, sizeof(stream));
+  if (unlikely(deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                            -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)) {
+    free(inBuf);
+    free(outBuf);
+    throw "Couldn't initialize deflate stream.";
+  }
+}
+
+/*!
+ * \brief TZipArchiver destructor.
+ */
+TZipArchiver::~TZipArchiver(void) {
+  deflateEnd(&stream);
+  free(inBuf);
+  free(outBuf);
+}
+
+/*!
+ * \brief Do file archive and create archive file.
+ * \param env         [in] JNI environment object. It is not used.
+ * \param archiveFile [in] archive file name.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TZipArchiver::doArchive(JNIEnv *env, char const *archiveFile) {
+  /* Sanity check. */
+  if (unlikely(strlen(this->getTarget()) == 0 || archiveFile == NULL ||
+               strlen(archiveFile) == 0)) {
+    logger->printWarnMsg("Illegal archive paramter.");
+    clear();
+    return -1;
+  }
+
+  /* Execute archive. */
+  int result = execute(archiveFile);
+
+  /* Cleanup. */
+  clear();
+
+  return result;
+}
+
+/*!
+ * \brief Execute archive.
+ * \param archiveFile [in] archive file name.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TZipArchiver::execute(char const *archiveFile) {
+  DIR *dir = opendir(this->getTarget());
+  if (unlikely(dir == NULL)) {
+    int result = errno;
+    logger->printWarnMsgWithErrno("Could not open directory: %s",
+                                  this->getTarget());
+    return result;
+  }
+
+  int result = openArchive(archiveFile);
+  if (unlikely(result != 0)) {
+    closedir(dir);
+    return result;
+  }
+
+  struct dirent *entry = NULL;
+  while ((entry = readdir(dir)) != NULL) {
+    /* Check file name. */
+    if (strcmp(entry->d_name, "..") == 0 || strcmp(entry->d_name, ".") == 0) {
+      continue;
+    }
+
+    /* Create source file path. */
+    char *filePath = createFilename(this->getTarget(), entry->d_name);
+    if (unlikely(filePath == NULL)) {
+      result = ENOMEM;
+      break;
+    }
+
+    /* Entry name is file name without directory path. */
+    result = addFile(filePath, entry->d_name);
+    free(filePath);
+    if (unlikely(result != 0)) {
+      break;
+    }
+  }
+  closedir(dir);
+
+  return closeArchive(result);
+}
+
+/*!
+ * \brief Create archive file to add entries.
+ * \param archiveFile [in] archive file name.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TZipArchiver::openArchive(char const *archiveFile) {
+  archivePath = strdup(archiveFile);
+  if (unlikely(archivePath == NULL)) {
+    return ENOMEM;
+  }
+
+  fd = open(archiveFile, O_CREAT | O_WRONLY | O_TRUNC | O_CLOEXEC,
+            S_IRUSR | S_IWUSR);
+  if (unlikely(fd < 0)) {
+    int result = errno;
+    logger->printWarnMsgWithErrno("Could not create zip archive");
+    free(archivePath);
+    archivePath = NULL;
+    return result;
+  }
+  archiveSize = 0;
+  isAborted = false;
+
+  /* Large files are compressed by multiple threads if configured. */
+  int threads = conf->ArchiveThreads()->get();
+  if (threads > 1) {
+    try {
+      deflater = new TParallelDeflater(threads, conf->ArchiveNice()->get());
+    } catch (...) {
+      /* Files are compressed by caller thread. */
+      logger->printDebugMsg("Could not use parallel deflate.");
+      deflater = NULL;
+    }
+  }
+
+  return 0;
+}
+
+/*!
+ * \brief Finish archive file.<br>
+ *        Archive file is removed if result is not zero.
+ * \param result [in] Result of adding entries.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TZipArchiver::closeArchive(int result) {
+  delete deflater;
+  deflater = NULL;
+
+  if (likely(result == 0)) {
+    result = writeCentralDirectory();
+  }
+
+  if (unlikely(close(fd) != 0) && (result == 0)) {
+    result = errno;
+  }
+  fd = -1;
+
+  /* If failure any process. */
+  if (unlikely(result != 0)) {
+    errno = result;
+    logger->printWarnMsgWithErrno("Could not write to zip archive");
+
+    /* Remove file. Because it's maybe broken. */
+    unlink(archivePath);
+  }
+
+  clearEntries();
+  free(archivePath);
+  archivePath = NULL;
+
+  return result;
+}
+
+/*!
+ * \brief Add file to archive. It is ignored if it is not regular file.
+ * \param path [in] Path of source file.
+ * \param name [in] Entry name in archive.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TZipArchiver::addFile(char const *path, char const *name) {
+  int srcFd = open(path, O_RDONLY | O_CLOEXEC);
+  if (unlikely(srcFd < 0)) {
+    int result = errno;
+    logger->printWarnMsgWithErrno("Could not open zip source file");
+    return result;
+  }
+
+  struct stat st;
+  if (unlikely(fstat(srcFd, &st) != 0)) {
+    int result = errno;
+    close(srcFd);
+    return result;
+  }
+
+  /* Working directory has only regular files. */
+  int result = 0;
+  if (likely(S_ISREG(st.st_mode))) {
+    result = addStream(srcFd, name);
+  }
+  close(srcFd);
+
+  return result;
+}
+
+/*!
+ * \brief Add data which is read from file descriptor until EOF.<br>
+ *        Entry is removed from archive if process is failure.
+ * \param srcFd    [in]  File descriptor of source. e.g. file or pipe.
+ * \param name     [in]  Entry name in archive.
+ * \param dataSize [out] Size of data which is read. It can be null.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TZipArchiver::addStream(int srcFd, char const *name, uint64_t *dataSize) {
+  struct stat st;
+  if (unlikely(fstat(srcFd, &st) != 0)) {
+    return errno;
+  }
+
+  /* Pipe has neither file mode nor modification time to keep. */
+  if (!S_ISREG(st.st_mode)) {
+    st.st_mode = S_IFREG | S_IRUSR | S_IWUSR;
+    st.st_mtime = time(NULL);
+  }
+
+  size_t nameLen = strlen(name);
+
+  TZipEntryInfo info;
+  info.name = strdup(name);
+  if (unlikely(info.name == NULL)) {
+    return ENOMEM;
+  }
+  info.crc = crc32(0L, Z_NULL, 0);
+  info.size = 0;
+  info.csize = 0;
+  info.offset = archiveSize;
+  info.mode = st.st_mode;
+  toDosTime(st.st_mtime, &info.dosTime, &info.dosDate);
+
+  /* CRC and sizes are written after data. */
+  int result = writeLocalHeader(&info, nameLen);
+
+  /* Stream file data through deflate. */
+  uint64_t size = 0;
+  uint64_t csize = 0;
+  if (likely(result == 0)) {
+    if (deflater != NULL) {
+      result = deflater->compress(srcFd, writeDeflated, this, &info.crc,
+                                  &size, &csize);
+    } else {
+      result = deflateFile(srcFd, &info.crc, &size, &csize);
+    }
+  }
+
+  if (likely(result == 0)) {
+    info.size = size;
+    info.csize = csize;
+
+    /* Fill CRC in local file header, and sizes in zip64 extra field. */
+    unsigned char crc[4];
+    unsigned char sizes[16];
+    putUInt32(crc, info.crc);
+    putUInt64(sizes, info.size);
+    putUInt64(sizes + 8, info.csize);
+    off_t sizesOffset = info.offset + ZIP_LOCAL_HEADER_SIZE + nameLen + 4;
+    if (unlikely((pwrite(fd, crc, sizeof(crc), info.offset + 14) !=
+                  (ssize_t)sizeof(crc)) ||
+                 (pwrite(fd, sizes, sizeof(sizes), sizesOffset) !=
+                  (ssize_t)sizeof(sizes)))) {
+      result = (errno != 0) ? errno : EIO;
+    }
+  }
+
+  if (likely(result == 0)) {
+    try {
+      entries.push_back(info);
+    } catch (...) {
+      result = ENOMEM;
+    }
+  }
+
+  if (likely(result == 0) && (dataSize != NULL)) {
+    *dataSize = size;
+  }
+
+  if (unlikely(result != 0)) {
+    discardEntry(&info);
+  }
+
+  return result;
+}
+
+/*!
+ * \brief Add entry which is compressed by deflateApart().<br>
+ *        Entry is removed from archive if process is failure.
+ * \param name     [in] Entry name in archive.
+ * \param deflated [in] Compressed data. Its file descriptor is not closed.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TZipArchiver::addDeflated(char const *name, TZipDeflatedData *deflated) {
+  size_t nameLen = strlen(name);
+
+  TZipEntryInfo info;
+  info.name = strdup(name);
+  if (unlikely(info.name == NULL)) {
+    return ENOMEM;
+  }
+  info.crc = deflated->crc;
+  info.size = deflated->size;
+  info.csize = deflated->csize;
+  info.offset = archiveSize;
+  info.mode = deflated->mode;
+  toDosTime(deflated->mtime, &info.dosTime, &info.dosDate);
+
+  /* Sizes are known, so local file header is complete. */
+  int result = writeLocalHeader(&info, nameLen);
+
+  /* Copy compressed data as it is. */
+  uint64_t copied = 0;
+  while ((result == 0) && (copied < info.csize)) {
+    if (unlikely(isAborted)) {
+      result = ECANCELED;
+      break;
+    }
+
+    size_t chunk = (info.csize - copied < ZIP_ARCHIVER_BUFFER_SIZE)
+                       ? (size_t)(info.csize - copied)
+                       : ZIP_ARCHIVER_BUFFER_SIZE;
+    ssize_t readSize = pread(deflated->fd, inBuf, chunk, (off_t)copied);
+    if (unlikely(readSize <= 0)) {
+      if ((readSize < 0) && (errno == EINTR)) {
+        continue;
+      }
+      result = (readSize < 0) ? errno : EIO;
+      break;
+    }
+
+    result = writeData(inBuf, readSize);
+    copied += readSize;
+  }
+
+  if (likely(result == 0)) {
+    try {
+      entries.push_back(info);
+    } catch (...) {
+      result = ENOMEM;
+    }
+  }
+
+  if (unlikely(result != 0)) {
+    discardEntry(&info);
+  }
+
+  return result;
+}
+
+/*!
+ * \brief Compress data which is read until EOF to another file.<br>
+ *        This function does not use any archiver, so threads can
+ *        compress entries at the same time, and add them by addDeflated().
+ * \param srcFd    [in]  File descriptor of source. e.g. file or pipe.
+ * \param destFd   [in]  File descriptor to write raw deflate data.
+ * \param check    [in]  Function to check cancel. It can be null.
+ * \param data     [in]  Data which is passed to check.
+ * \param deflated [out] Compressed data.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TZipArchiver::deflateApart(int srcFd, int destFd, TZipCancelCheck check,
+                               void *data, TZipDeflatedData *deflated) {
+  struct stat st;
+  if (unlikely(fstat(srcFd, &st) != 0)) {
+    return errno;
+  }
+
+  /* Pipe has neither file mode nor modification time to keep. */
+  if (!S_ISREG(st.st_mode)) {
+    st.st_mode = S_IFREG | S_IRUSR | S_IWUSR;
+    st.st_mtime = time(NULL);
+  }
+
+  deflated->fd = destFd;
+  deflated->crc = crc32(0L, Z_NULL, 0);
+  deflated->size = 0;
+  deflated->csize = 0;
+  deflated->mode = st.st_mode;
+  deflated->mtime = st.st_mtime;
+
+  unsigned char *in = (unsigned char *)malloc(ZIP_ARCHIVER_BUFFER_SIZE);
+  unsigned char *out = (unsigned char *)malloc(ZIP_ARCHIVER_BUFFER_SIZE);
+  z_stream apart;
+  memset(&apart, 0, sizeof(apart));
+  if (unlikely((in == NULL) || (out == NULL))) {
+    free(in);
+    free(out);
+    return ENOMEM;
+  }
+  if (unlikely(deflateInit2(&apart, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                            -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)) {
+    free(in);
+    free(out);
+    return ENOMEM;
+  }
+
+  int result = 0;
+  int flush = Z_NO_FLUSH;
+  while ((result == 0) && (flush != Z_FINISH)) {
+    if (unlikely((check != NULL) && check(data))) {
+      result = ECANCELED;
+      break;
+    }
+
+    ssize_t readSize = read(srcFd, in, ZIP_ARCHIVER_BUFFER_SIZE);
+    if (unlikely(readSize < 0)) {
+      if (errno == EINTR) {
+        continue;
+      }
+      result = errno;
+      break;
+    }
+
+    flush = (readSize == 0) ? Z_FINISH : Z_NO_FLUSH;
+    deflated->crc = crc32(deflated->crc, in, (uInt)readSize);
+    deflated->size += readSize;
+
+    apart.next_in = in;
+    apart.avail_in = (uInt)readSize;
+    do {
+      apart.next_out = out;
+      apart.avail_out = ZIP_ARCHIVER_BUFFER_SIZE;
+      deflate(&apart, flush);
+
+      size_t outSize = ZIP_ARCHIVER_BUFFER_SIZE - apart.avail_out;
+      size_t written = 0;
+      while ((result == 0) && (written < outSize)) {
+        ssize_t writeSize = write(destFd, out + written, outSize - written);
+        if (unlikely(writeSize < 0)) {
+          if (errno != EINTR) {
+            result = errno;
+          }
+          continue;
+        }
+        written += writeSize;
+      }
+      deflated->csize += outSize;
+    } while ((result == 0) && (apart.avail_out == 0));
+  }
+
+  deflateEnd(&apart);
+  free(in);
+  free(out);
+
+  return result;
+}
+
+/*!
+ * \brief Start new entry, and write its local file header.
+ * \param info    [in,out] Entry. Name and offset must be set.
+ * \param nameLen [in]     Length of entry name.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TZipArchiver::writeLocalHeader(TZipEntryInfo *info, size_t nameLen) {
+  /* Sizes are in zip64 extra field because they might exceed 4 GiB. */
+  unsigned char header[ZIP_LOCAL_HEADER_SIZE];
+  memset(header, 0, sizeof(header));
+  putUInt32(header, ZIP_LOCAL_HEADER_SIG);
+  putUInt16(header + 4, ZIP_VERSION);
+  putUInt16(header + 8, ZIP_METHOD_DEFLATE);
+  putUInt16(header + 10, info->dosTime);
+  putUInt16(header + 12, info->dosDate);
+  putUInt32(header + 14, info->crc);
+  putUInt32(header + 18, (uint32_t)ZIP_MAX_SIZE);
+  putUInt32(header + 22, (uint32_t)ZIP_MAX_SIZE);
+  putUInt16(header + 26, (uint16_t)nameLen);
+  putUInt16(header + 28, ZIP64_LOCAL_EXTRA_SIZE);
+
+  unsigned char extra[ZIP64_LOCAL_EXTRA_SIZE];
+  putUInt16(extra, ZIP64_EXTRA_ID);
+  putUInt16(extra + 2, ZIP64_LOCAL_EXTRA_SIZE - 4);
+  putUInt64(extra + 4, info->size);
+  putUInt64(extra + 12, info->csize);
+
+  int result = writeData(header, sizeof(header));
+  if (likely(result == 0)) {
+    result = writeData(info->name, nameLen);
+  }
+  if (likely(result == 0)) {
+    result = writeData(extra, sizeof(extra));
+  }
+
+  return result;
+}
+
+/*!
+ * \brief Remove broken entry from archive file.<br>
+ *        Central directory does not refer to it, so following entries
+ *        can be added.
+ * \param info [in] Entry which is failed.
+ */
+void TZipArchiver::discardEntry(TZipEntryInfo *info) {
+  free(info->name);
+  info->name = NULL;
+
+  /* Its data is truncated if possible. */
+  if (likely((ftruncate(fd, info->offset) == 0) &&
+             (lseek(fd, info->offset, SEEK_SET) == (off_t)info->offset))) {
+    archiveSize = info->offset;
+  }
+}
+
+/*!
+ * \brief Compress file to raw deflate data on caller thread.
+ * \param srcFd [in]  File descriptor of source file.
+ * \param crc   [out] CRC-32 of source data.
+ * \param size  [out] Size of source data.
+ * \param csize [out] Size of compressed data.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TZipArchiver::deflateFile(int srcFd, uint32_t *crc, uint64_t *size,
+                              uint64_t *csize) {
+  int result = 0;
+  *crc = crc32(0L, Z_NULL, 0);
+  *size = 0;
+  *csize = 0;
+
+  deflateReset(&stream);
+  int flush = Z_NO_FLUSH;
+  while ((result == 0) && (flush != Z_FINISH)) {
+    if (unlikely(isAborted)) {
+      result = ECANCELED;
+      break;
+    }
+
+    ssize_t readSize = read(srcFd, inBuf, ZIP_ARCHIVER_BUFFER_SIZE);
+    if (unlikely(readSize < 0)) {
+      if (errno == EINTR) {
+        continue;
+      }
+      result = errno;
+      break;
+    }
+
+    flush = (readSize == 0) ? Z_FINISH : Z_NO_FLUSH;
+    *crc = crc32(*crc, inBuf, (uInt)readSize);
+    *size += readSize;
+
+    stream.next_in = inBuf;
+    stream.avail_in = (uInt)readSize;
+    do {
+      stream.next_out = outBuf;
+      stream.avail_out = ZIP_ARCHIVER_BUFFER_SIZE;
+      deflate(&stream, flush);
+
+      size_t outSize = ZIP_ARCHIVER_BUFFER_SIZE - stream.avail_out;
+      *csize += outSize;
+      result = writeData(outBuf, outSize);
+    } while ((result == 0) && (stream.avail_out == 0));
+  }
+
+  return result;
+}
+
+/*!
+ * \brief Write compressed data from TParallelDeflater.
+ * \param data [in] TZipArchiver object.
+ * \param buf  [in] Compressed data.
+ * \param size [in] Size of compressed data.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TZipArchiver::writeDeflated(void *data, const void *buf, size_t size) {
+  TZipArchiver *archiver = (TZipArchiver *)data;
+  if (unlikely(archiver->isAborted)) {
+    return ECANCELED;
+  }
+
+  return archiver->writeData(buf, size);
+}
+
+/*!
+ * \brief Write central directory and end of central directory record.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TZipArchiver::writeCentralDirectory(void) {
+  uint64_t centralOffset = archiveSize;
+
+  for (size_t idx = 0; idx < entries.size(); idx++) {
+    TZipEntryInfo &info = entries[idx];
+    size_t nameLen = strlen(info.name);
+
+    /* Zip64 extra field has only values which overflow, in this order. */
+    unsigned char extra[4 + 8 * 3];
+    size_t extraLen = 4;
+
+    unsigned char header[ZIP_CENTRAL_HEADER_SIZE];
+    memset(header, 0, sizeof(header));
+    putUInt32(header, ZIP_CENTRAL_HEADER_SIG);
+    putUInt16(header + 4, ZIP_VERSION_MADE_BY);
+    putUInt16(header + 6, ZIP_VERSION);
+    putUInt16(header + 10, ZIP_METHOD_DEFLATE);
+    putUInt16(header + 12, info.dosTime);
+    putUInt16(header + 14, info.dosDate);
+    putUInt32(header + 16, info.crc);
+    if (putZipField(header + 24, info.size)) {
+      putUInt64(extra + extraLen, info.size);
+      extraLen += 8;
+    }
+    if (putZipField(header + 20, info.csize)) {
+      putUInt64(extra + extraLen, info.csize);
+      extraLen += 8;
+    }
+    if (putZipField(header + 42, info.offset)) {
+      putUInt64(extra + extraLen, info.offset);
+      extraLen += 8;
+    }
+    putUInt16(header + 28, (uint16_t)nameLen);
+    putUInt32(header + 38, info.mode << 16);
+
+    if (extraLen > 4) {
+      putUInt16(extra, ZIP64_EXTRA_ID);
+      putUInt16(extra + 2, (uint16_t)(extraLen - 4));
+      putUInt16(header + 30, (uint16_t)extraLen);
+    } else {
+      extraLen = 0;
+    }
+
+    int result = writeData(header, sizeof(header));
+    if (likely(result == 0)) {
+      result = writeData(info.name, nameLen);
+    }
+    if (likely(result == 0)) {
+      result = writeData(extra, extraLen);
+    }
+    if (unlikely(result != 0)) {
+      return result;
+    }
+  }
+
+  uint64_t centralEnd = archiveSize;
+  uint64_t centralSize = centralEnd - centralOffset;
+  uint64_t count = entries.size();
+
+  unsigned char record[ZIP_END_OF_CENTRAL_SIZE];
+  memset(record, 0, sizeof(record));
+  putUInt32(record, ZIP_END_OF_CENTRAL_SIG);
+  bool isZip64 = putZipField(record + 12, centralSize);
+  isZip64 |= putZipField(record + 16, centralOffset);
+  isZip64 |= (count >= ZIP_MAX_COUNT);
+  putUInt16(record + 8, isZip64 ? ZIP_MAX_COUNT : (uint16_t)count);
+  putUInt16(record + 10, isZip64 ? ZIP_MAX_COUNT : (uint16_t)count);
+
+  if (isZip64) {
+    /* Zip64 end of central directory record and its locator. */
+    unsigned char zip64[ZIP64_END_OF_CENTRAL_SIZE + ZIP64_LOCATOR_SIZE];
+    memset(zip64, 0, sizeof(zip64));
+    putUInt32(zip64, ZIP64_END_OF_CENTRAL_SIG);
+    putUInt64(zip64 + 4, ZIP64_END_OF_CENTRAL_SIZE - 12);
+    putUInt16(zip64 + 12, ZIP_VERSION_MADE_BY);
+    putUInt16(zip64 + 14, ZIP_VERSION);
+    putUInt64(zip64 + 24, count);
+    putUInt64(zip64 + 32, count);
+    putUInt64(zip64 + 40, centralSize);
+    putUInt64(zip64 + 48, centralOffset);
+
+    unsigned char *locator = zip64 + ZIP64_END_OF_CENTRAL_SIZE;
+    putUInt32(locator, ZIP64_LOCATOR_SIG);
+    putUInt64(locator + 8, centralEnd);
+    putUInt32(locator + 16, 1);
+
+    int result = writeData(zip64, sizeof(zip64));
+    if (unlikely(result != 0)) {
+      return result;
+    }
+  }
+
+  return writeData(record, sizeof(record));
+}
+
+/*!
+ * \brief Write data to archive file.
+ * \param data [in] Data to write.
+ * \param size [in] Size of data.
+ * \return Value is zero, if process is succeed.<br />
+ *         Value is error number a.k.a. "errno", if process is failure.
+ */
+int TZipArchiver::writeData(const void *data, size_t size) {
+  const char *pos = (const char *)data;
+
+  while (size > 0) {
+    ssize_t written = write(fd, pos, size);
+    if (unlikely(written < 0)) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return errno;
+    }
+
+    pos += written;
+    size -= written;
+    archiveSize += written;
+  }
+
+  return 0;
+}
+
+/*!
+ * \brief Release entries.
+ */
+void TZipArchiver::clearEntries(void) {
+  for (size_t idx = 0; idx < entries.size(); idx++) {
+    free(entries[idx].name);
+  }
+  entries.clear();
+}
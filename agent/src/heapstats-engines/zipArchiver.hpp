@@ -0,0 +1,296 @@
+/*!
+ * \file zipArchiver.hpp
+ * \brief This file is used create archive file by zlib.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ *
+ */
+
+#ifndef _ZIP_ARCHIVER_H
+#define _ZIP_ARCHIVER_H
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <time.h>
+#include <zlib.h>
+
+#include <vector>
+
+#include "archiveMaker.hpp"
+#include "parallelDeflater.hpp"
+
+/*!
+ * \brief Size of buffers to read source file and to write archive.
+ */
+#define ZIP_ARCHIVER_BUFFER_SIZE (256 * 1024)
+
+/*!
+ * \brief Entry of zip archive for central directory.
+ */
+typedef struct {
+  char *name;         /*!< Entry name.                        */
+  uint32_t crc;       /*!< CRC-32 of source file.             */
+  uint64_t size;      /*!< Size of source file.               */
+  uint64_t csize;     /*!< Size of compressed data.           */
+  uint64_t offset;    /*!< Offset of local file header.       */
+  uint16_t dosTime;   /*!< Modification time in MS-DOS form.  */
+  uint16_t dosDate;   /*!< Modification date in MS-DOS form.  */
+  uint32_t mode;      /*!< File mode.                         */
+} TZipEntryInfo;
+
+/*!
+ * \brief Function to check whether compression is cancelled.
+ * \param data [in] Data which is passed to deflateApart().
+ * \return Value is true if compression should be stopped.
+ */
+typedef bool (*TZipCancelCheck)(void *data);
+
+/*!
+ * \brief Entry data which is compressed apart from archive file.
+ */
+typedef struct {
+  int fd;           /*!< File descriptor of raw deflate data.  */
+  uint32_t crc;     /*!< CRC-32 of source data.                */
+  uint64_t size;    /*!< Size of source data.                  */
+  uint64_t csize;   /*!< Size of compressed data.              */
+  uint32_t mode;    /*!< File mode of source.                  */
+  time_t mtime;     /*!< Modification time of source.          */
+} TZipDeflatedData;
+
+/*!
+ * \brief This class create zip archive file by zlib.<br>
+ *        Source files are streamed through deflate into the archive. Buffers
+ *        and deflate state are allocated at construction, so making archive
+ *        needs neither Java heap nor large allocation.<br>
+ *        Sizes are unknown until data is compressed, so each local file
+ *        header has zip64 extra field. Central directory uses zip64 only for
+ *        values which do not fit in 32 bits.<br>
+ *        If archive_threads is greater than 1, files are compressed by
+ *        TParallelDeflater. Caller thread is used when it is unavailable.
+ */
+class TZipArchiver : public TArchiveMaker {
+ public:
+  /*!
+   * \brief TZipArchiver constructor.
+   */
+  TZipArchiver(void);
+  /*!
+   * \brief TZipArchiver destructor.
+   */
+  ~TZipArchiver(void);
+
+  /*!
+   * \brief Do file archive and create archive file.
+   * \param env         [in] JNI environment object. It is not used.
+   * \param archiveFile [in] archive file name.
+   * \return Value is zero, if process is succeed.<br />
+   *         Value is error number a.k.a. "errno", if process is failure.
+   */
+  int doArchive(JNIEnv *env, char const *archiveFile);
+
+  /*!
+   * \brief Create archive file to add entries.
+   * \param archiveFile [in] archive file name.
+   * \return Value is zero, if process is succeed.<br />
+   *         Value is error number a.k.a. "errno", if process is failure.
+   */
+  int openArchive(char const *archiveFile);
+
+  /*!
+   * \brief Add file to archive. It is ignored if it is not regular file.
+   * \param path [in] Path of source file.
+   * \param name [in] Entry name in archive.
+   * \return Value is zero, if process is succeed.<br />
+   *         Value is error number a.k.a. "errno", if process is failure.
+   */
+  int addFile(char const *path, char const *name);
+
+  /*!
+   * \brief Add data which is read from file descriptor until EOF.<br>
+   *        Entry is removed from archive if process is failure.
+   * \param srcFd    [in]  File descriptor of source. e.g. file or pipe.
+   * \param name     [in]  Entry name in archive.
+   * \param dataSize [out] Size of data which is read. It can be null.
+   * \return Value is zero, if process is succeed.<br />
+   *         Value is error number a.k.a. "errno", if process is failure.
+   */
+  int addStream(int srcFd, char const *name, uint64_t *dataSize = NULL);
+
+  /*!
+   * \brief Add entry which is compressed by deflateApart().<br>
+   *        Entry is removed from archive if process is failure.
+   * \param name     [in] Entry name in archive.
+   * \param deflated [in] Compressed data. Its file descriptor is not closed.
+   * \return Value is zero, if process is succeed.<br />
+   *         Value is error number a.k.a. "errno", if process is failure.
+   */
+  int addDeflated(char const *name, TZipDeflatedData *deflated);
+
+  /*!
+   * \brief Compress data which is read until EOF to another file.<br>
+   *        This function does not use any archiver, so threads can
+   *        compress entries at the same time, and add them by addDeflated().
+   * \param srcFd    [in]  File descriptor of source. e.g. file or pipe.
+   * \param destFd   [in]  File descriptor to write raw deflate data.
+   * \param check    [in]  Function to check cancel. It can be null.
+   * \param data     [in]  Data which is passed to check.
+   * \param deflated [out] Compressed data.
+   * \return Value is zero, if process is succeed.<br />
+   *         Value is error number a.k.a. "errno", if process is failure.
+   */
+  static int deflateApart(int srcFd, int destFd, TZipCancelCheck check,
+                          void *data, TZipDeflatedData *deflated);
+
+  /*!
+   * \brief Finish archive file.<br>
+   *        Archive file is removed if result is not zero.
+   * \param result [in] Result of adding entries.
+   * \return Value is zero, if process is succeed.<br />
+   *         Value is error number a.k.a. "errno", if process is failure.
+   */
+  int closeArchive(int result);
+
+  /*!
+   * \brief Abort entry which is being added by other thread.<br>
+   *        addFile() and addStream() fail with ECANCELED while it is set.
+   * \param aborted [in] Entry is aborted.
+   */
+  inline void setAborted(bool aborted) { isAborted = aborted; }
+
+  /*!
+   * \brief Entries which are added by addStream() are compressed by
+   *        multiple threads or not.
+   * \return true if parallel deflater is available.
+   */
+  inline bool isParallel(void) { return deflater != NULL; }
+
+ protected:
+  /*!
+   * \brief Execute archive.
+   * \param archiveFile [in] archive file name.
+   * \return Value is zero, if process is succeed.<br />
+   *         Value is error number a.k.a. "errno", if process is failure.
+   */
+  virtual int execute(char const *archiveFile);
+
+  /*!
+   * \brief Write central directory and end of central directory record.
+   * \return Value is zero, if process is succeed.<br />
+   *         Value is error number a.k.a. "errno", if process is failure.
+   */
+  virtual int writeCentralDirectory(void);
+
+  /*!
+   * \brief Start new entry, and write its local file header.
+   * \param info    [in,out] Entry. Name and offset must be set.
+   * \param nameLen [in]     Length of entry name.
+   * \return Value is zero, if process is succeed.<br />
+   *         Value is error number a.k.a. "errno", if process is failure.
+   */
+  int writeLocalHeader(TZipEntryInfo *info, size_t nameLen);
+
+  /*!
+   * \brief Remove broken entry from archive file.<br>
+   *        Central directory does not refer to it, so following entries
+   *        can be added.
+   * \param info [in] Entry which is failed.
+   */
+  void discardEntry(TZipEntryInfo *info);
+
+  /*!
+   * \brief Compress file to raw deflate data on caller thread.
+   * \param srcFd [in]  File descriptor of source file.
+   * \param crc   [out] CRC-32 of source data.
+   * \param size  [out] Size of source data.
+   * \param csize [out] Size of compressed data.
+   * \return Value is zero, if process is succeed.<br />
+   *         Value is error number a.k.a. "errno", if process is failure.
+   */
+  int deflateFile(int srcFd, uint32_t *crc, uint64_t *size, uint64_t *csize);
+
+  /*!
+   * \brief Write compressed data from TParallelDeflater.
+   * \param data [in] TZipArchiver object.
+   * \param buf  [in] Compressed data.
+   * \param size [in] Size of compressed data.
+   * \return Value is zero, if process is succeed.<br />
+   *         Value is error number a.k.a. "errno", if process is failure.
+   */
+  static int writeDeflated(void *data, const void *buf, size_t size);
+
+  /*!
+   * \brief Write data to archive file.
+   * \param data [in] Data to write.
+   * \param size [in] Size of data.
+   * \return Value is zero, if process is succeed.<br />
+   *         Value is error number a.k.a. "errno", if process is failure.
+   */
+  int writeData(const void *data, size_t size);
+
+  /*!
+   * \brief Release entries.
+   */
+  void clearEntries(void);
+
+ private:
+  /*!
+   * \brief File descriptor of archive file.
+   */
+  int fd;
+
+  /*!
+   * \brief Path of archive file.
+   */
+  char *archivePath;
+
+  /*!
+   * \brief Current size of archive file.
+   */
+  uint64_t archiveSize;
+
+  /*!
+   * \brief Entries in archive.
+   */
+  std::vector<TZipEntryInfo> entries;
+
+  /*!
+   * \brief Deflate stream. It is reset for each entry.
+   */
+  z_stream stream;
+
+  /*!
+   * \brief Worker pool of deflate. NULL if caller thread compresses.
+   */
+  TParallelDeflater *deflater;
+
+  /*!
+   * \brief Entry which is being added is aborted.
+   */
+  volatile bool isAborted;
+
+  /*!
+   * \brief Buffer to read source file.
+   */
+  unsigned char *inBuf;
+
+  /*!
+   * \brief Buffer to write compressed data.
+   */
+  unsigned char *outBuf;
+};
+
+#endif  // _ZIP_ARCHIVER_H
@@ -0,0 +1,203 @@
+/*!
+ * \file resourceLogConverter.cpp
+ * \brief Command line converter of binary resource log file.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include "resourceLogReader.hpp"
+
+/*!
+ * \brief Show usage.
+ * \param name [in] Program name.
+ */
+static void usage(const char *name) {
+  fprintf(stderr,
+          "Usage: %s [options] <binary resource log file>\n"
+          "  -o, --output <file>  Write CSV to file. (default: stdout)\n"
+          "  -a, --all            Write all columns with header line.\n"
+          "                       (default: same columns as heaplogfile)\n"
+          "  -h, --help           Show this message.\n"
+          "Use \"-\" as <file> to write to stdout.\n",
+          name);
+}
+
+/*!
+ * \brief Write a value as CSV field.
+ * \param out          [in] Output stream.
+ * \param type         [in] Type of column.
+ * \param value        [in] Value.
+ * \param isCompatible [in] Unknown value is written as zero like CSV of
+ *                          heaplogfile. Otherwise it is empty.
+ */
+static inline void writeValue(FILE *out, TResourceLogColumnType type,
+                              uint64_t value, bool isCompatible) {
+  if ((type == ResourceLogUInt) && (value == RESOURCE_LOG_UNKNOWN_VALUE)) {
+    if (isCompatible) {
+      fputc('0', out);
+    }
+  } else if (type == ResourceLogInt) {
+    fprintf(out, "%lld", (long long int)value);
+  } else {
+    fprintf(out, "%llu", (unsigned long long int)value);
+  }
+}
+
+/*!
+ * \brief Convert binary resource log to CSV.
+ * \param reader    [in] Reader of binary resource log.
+ * \param out       [in] Output stream.
+ * \param selected  [in] Index of columns to write.
+ * \param useHeader [in] Write header line.
+ */
+static void convert(TResourceLogReader *reader, FILE *out,
+                    const std::vector<int> &selected, bool useHeader) {
+  const std::vector<TResourceLogColumnInfo> &columns = reader->getColumns();
+
+  if (useHeader) {
+    for (size_t idx = 0; idx < selected.size(); idx++) {
+      fprintf(out, "%s%s", (idx == 0) ? "" : ",",
+              columns[selected[idx]].name.c_str());
+    }
+    fputc('\n', out);
+  }
+
+  TResourceLogRows rows;
+  const std::vector<TResourceLogBlock> &blocks = reader->getBlocks();
+  for (size_t blk = 0; blk < blocks.size(); blk++) {
+    reader->decode(blocks[blk], &rows);
+
+    for (int row = 0; row < rows.rows; row++) {
+      for (size_t idx = 0; idx < selected.size(); idx++) {
+        int col = selected[idx];
+        if (idx > 0) {
+          fputc(',', out);
+        }
+
+        if (columns[col].type == ResourceLogString) {
+          fputs(rows.strings[col][row].c_str(), out);
+        } else {
+          writeValue(out, columns[col].type, rows.values[col][row],
+                     !useHeader);
+        }
+      }
+      fputc('\n', out);
+    }
+  }
+}
+
+/*!
+ * \brief Entry point of HeapStats binary resource log converter.
+ * \param argc [in] Count of arguments.
+ * \param argv [in] Arguments.
+ * \return Exit status.
+ */
+int main(int argc, char *argv[]) {
+  const char *outFile = "-";
+  bool allColumns = false;
+
+  static struct option options[] = {{"output", required_argument, NULL, 'o'},
+                                    {"all", no_argument, NULL, 'a'},
+                                    {"help", no_argument, NULL, 'h'},
+                                    {NULL, 0, NULL, 0}};
+
+  int opt;
+  while ((opt = getopt_long(argc, argv, "o:ah", options, NULL)) != -1) {
+    switch (opt) {
+      case 'o':
+        outFile = optarg;
+        break;
+      case 'a':
+        allColumns = true;
+        break;
+      case 'h':
+        usage(argv[0]);
+        return 0;
+      default:
+        usage(argv[0]);
+        return 1;
+    }
+  }
+
+  if (optind != argc - 1) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  TResourceLogReader *reader = NULL;
+  try {
+    reader = new TResourceLogReader(argv[optind]);
+  } catch (const char *errMsg) {
+    fprintf(stderr, "%s: %s\n", argv[optind], errMsg);
+    return 1;
+  }
+
+  if (reader->getBrokenBytes() > 0) {
+    fprintf(stderr, "%s: %zu bytes are broken, and they are skipped.\n",
+            argv[optind], reader->getBrokenBytes());
+  }
+
+  /* Select columns. CSV of heaplogfile does not have header line. */
+  std::vector<int> selected;
+  if (allColumns) {
+    for (size_t idx = 0; idx < reader->getColumns().size(); idx++) {
+      selected.push_back((int)idx);
+    }
+  } else {
+    for (int idx = 0; idx <= RESOURCE_LOG_CSV_COLUMNS; idx++) {
+      const char *name = (idx < RESOURCE_LOG_CSV_COLUMNS)
+                             ? resourceLogColumns[idx].name
+                             : RESOURCE_LOG_ARCHIVE_COLUMN;
+      int col = reader->findColumn(name);
+      if (col == -1) {
+        fprintf(stderr, "%s: Column \"%s\" is not in file.\n", argv[optind],
+                name);
+        delete reader;
+        return 1;
+      }
+      selected.push_back(col);
+    }
+  }
+
+  FILE *out = stdout;
+  if (strcmp(outFile, "-") != 0) {
+    out = fopen(outFile, "w");
+    if (out == NULL) {
+      perror(outFile);
+      delete reader;
+      return 1;
+    }
+  }
+
+  convert(reader, out, selected, allColumns);
+
+  int result = 0;
+  if (((out == stdout) ? fflush(out) : fclose(out)) != 0) {
+    perror(outFile);
+    result = 1;
+  }
+
+  delete reader;
+  return result;
+}
@@ -0,0 +1,232 @@
+/*!
+ * \file resourceLogReader.cpp
+ * \brief Reader of binary resource log file.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "resourceLogReader.hpp"
+
+/*!
+ * \brief TResourceLogReader constructor.
+ * \param fname [in] Binary resource log file.
+ */
+TResourceLogReader::TResourceLogReader(const char *fname)
+    : columns(), blocks() {
+  brokenBytes = 0;
+
+  int fd = open(fname, O_RDONLY);
+  if (fd == -1) {
+    throw "Could not open resource log file.";
+  }
+
+  struct stat st;
+  if ((fstat(fd, &st) == -1) || (st.st_size == 0)) {
+    close(fd);
+    throw "Could not get size of resource log file.";
+  }
+
+  mappedSize = st.st_size;
+  mapped = (unsigned char *)mmap(NULL, mappedSize, PROT_READ, MAP_PRIVATE,
+                                 fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) {
+    throw "Could not map resource log file.";
+  }
+
+  try {
+    parse();
+  } catch (...) {
+    munmap(mapped, mappedSize);
+    throw;
+  }
+}
+
+/*!
+ * \brief TResourceLogReader destructor.
+ */
+TResourceLogReader::~TResourceLogReader(void) {
+  munmap(mapped, mappedSize);
+}
+
+/*!
+ * \brief Find column by name.
+ * \param name [in] Name of column.
+ * \return Index of column. Value is -1 if the column is not in file.
+ */
+int TResourceLogReader::findColumn(const char *name) const {
+  for (size_t idx = 0; idx < columns.size(); idx++) {
+    if (columns[idx].name == name) {
+      return (int)idx;
+    }
+  }
+
+  return -1;
+}
+
+/*!
+ * \brief Find next sync marker.
+ * \param from [in] Position to start searching.
+ * \return Position of sync marker. Value is mappedSize if not found.
+ */
+size_t TResourceLogReader::findSyncMarker(size_t from) const {
+  unsigned char marker[8];
+  storeLittleEndian(marker, RESOURCE_LOG_SYNC_MARKER, sizeof(marker));
+
+  if (from >= mappedSize) {
+    return mappedSize;
+  }
+
+  const void *found =
+      memmem(mapped + from, mappedSize - from, marker, sizeof(marker));
+  return (found == NULL) ? mappedSize
+                         : (const unsigned char *)found - mapped;
+}
+
+/*!
+ * \brief Parse header and index blocks.
+ */
+void TResourceLogReader::parse(void) {
+  /* Magic number, format version and count of columns. */
+  if ((mappedSize < 6) ||
+      (memcmp(mapped, RESOURCE_LOG_MAGIC, 4) != 0)) {
+    throw "Not a binary resource log file.";
+  } else if (mapped[4] != RESOURCE_LOG_FORMAT_VERSION) {
+    throw "Unsupported version of resource log file.";
+  }
+
+  int numColumns = mapped[5];
+  size_t pos = 6;
+  for (int idx = 0; idx < numColumns; idx++) {
+    if (mappedSize - pos < 2) {
+      throw "Resource log file is truncated.";
+    }
+
+    TResourceLogColumnInfo column;
+    column.type = (TResourceLogColumnType)mapped[pos];
+    size_t len = mapped[pos + 1];
+    pos += 2;
+    if (mappedSize - pos < len) {
+      throw "Resource log file is truncated.";
+    } else if (column.type > ResourceLogString) {
+      throw "Unknown column type in resource log file.";
+    }
+
+    column.name = std::string((const char *)mapped + pos, len);
+    columns.push_back(column);
+    pos += len;
+  }
+
+  /*
+   * Blocks.
+   * Broken block is skipped, and next block is found by sync marker.
+   */
+  TResourceLogRows scratch;
+  while (pos < mappedSize) {
+    size_t next = findSyncMarker(pos);
+    brokenBytes += next - pos;
+    pos = next;
+    if (mappedSize - pos < RESOURCE_LOG_BLOCK_HEADER_SIZE) {
+      brokenBytes += mappedSize - pos;
+      break;
+    }
+
+    size_t size = loadLittleEndian(mapped + pos + 8, 4);
+    TResourceLogBlock block;
+    block.rows = (int)loadLittleEndian(mapped + pos + 12, 2);
+    block.data = mapped + pos + RESOURCE_LOG_BLOCK_HEADER_SIZE;
+    block.size = size - 2;
+
+    if ((size < 2) || (mappedSize - pos - 12 < size) ||
+        !decode(block, &scratch)) {
+      /* Search next sync marker after this one. */
+      brokenBytes += 1;
+      pos += 1;
+      continue;
+    }
+
+    blocks.push_back(block);
+    pos += 12 + size;
+  }
+}
+
+/*!
+ * \brief Decode rows of block.
+ * \param block [in]  Block to decode.
+ * \param rows  [out] Decoded rows.
+ * \return true if the block is decoded.
+ */
+bool TResourceLogReader::decode(const TResourceLogBlock &block,
+                                TResourceLogRows *rows) const {
+  const unsigned char *data = block.data;
+  size_t remain = block.size;
+
+  rows->rows = block.rows;
+  rows->values.resize(columns.size());
+  rows->strings.resize(columns.size());
+
+  for (size_t idx = 0; idx < columns.size(); idx++) {
+    std::vector<uint64_t> &values = rows->values[idx];
+    std::vector<std::string> &strings = rows->strings[idx];
+    values.clear();
+    strings.clear();
+
+    if (columns[idx].type == ResourceLogString) {
+      for (int row = 0; row < block.rows; row++) {
+        if (remain < 2) {
+          return false;
+        }
+
+        size_t len = loadLittleEndian(data, 2);
+        if (remain - 2 < len) {
+          return false;
+        }
+
+        strings.push_back(std::string((const char *)data + 2, len));
+        data += 2 + len;
+        remain -= 2 + len;
+      }
+    } else {
+      if (remain < 9) {
+        return false;
+      }
+
+      int width = data[0];
+      uint64_t base = loadLittleEndian(data + 1, 8);
+      data += 9;
+      remain -= 9;
+      if (((width & (width - 1)) != 0) || (width > 8) ||
+          (remain < (size_t)width * block.rows)) {
+        return false;
+      }
+
+      for (int row = 0; row < block.rows; row++) {
+        values.push_back(base + loadLittleEndian(data, width));
+        data += width;
+      }
+      remain -= (size_t)width * block.rows;
+    }
+  }
+
+  return remain == 0;
+}
@@ -0,0 +1,156 @@
+/*!
+ * \file resourceLogReader.hpp
+ * \brief Reader of binary resource log file.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+#ifndef RESOURCE_LOG_READER_HPP
+#define RESOURCE_LOG_READER_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "resourceLogFormat.hpp"
+
+/*!
+ * \brief Column in binary resource log file.
+ */
+typedef struct {
+  std::string name;             /*!< Name of column. */
+  TResourceLogColumnType type;  /*!< Type of column. */
+} TResourceLogColumnInfo;
+
+/*!
+ * \brief Block in binary resource log file.
+ */
+typedef struct {
+  int rows;                   /*!< Count of rows.                  */
+  const unsigned char *data;  /*!< Columns of block in mapped file. */
+  size_t size;                /*!< Size of columns.                */
+} TResourceLogBlock;
+
+/*!
+ * \brief Decoded rows of a block.<br>
+ *        Each vector is indexed by column. Integer columns have values, and
+ *        string columns have strings.
+ */
+typedef struct {
+  int rows;                                          /*!< Count of rows. */
+  std::vector<std::vector<uint64_t> > values;        /*!< Integers.      */
+  std::vector<std::vector<std::string> > strings;    /*!< Strings.       */
+} TResourceLogRows;
+
+/*!
+ * \brief This class maps binary resource log file to memory, and makes index
+ *        of its blocks.<br>
+ *        Broken blocks are skipped by searching next sync marker.
+ */
+class TResourceLogReader {
+ public:
+  /*!
+   * \brief TResourceLogReader constructor.
+   * \param fname [in] Binary resource log file.
+   */
+  TResourceLogReader(const char *fname);
+
+  /*!
+   * \brief TResourceLogReader destructor.
+   */
+  virtual ~TResourceLogReader(void);
+
+  /*!
+   * \brief Find column by name.
+   * \param name [in] Name of column.
+   * \return Index of column. Value is -1 if the column is not in file.
+   */
+  int findColumn(const char *name) const;
+
+  /*!
+   * \brief Decode rows of block.
+   * \param block [in]  Block to decode.
+   * \param rows  [out] Decoded rows.
+   * \return true if the block is decoded.
+   */
+  bool decode(const TResourceLogBlock &block, TResourceLogRows *rows) const;
+
+  /*!
+   * \brief Get columns in file.
+   * \return Columns in order of file.
+   */
+  inline const std::vector<TResourceLogColumnInfo> &getColumns(void) const {
+    return columns;
+  }
+
+  /*!
+   * \brief Get all blocks in file.
+   * \return Blocks in order of file.
+   */
+  inline const std::vector<TResourceLogBlock> &getBlocks(void) const {
+    return blocks;
+  }
+
+  /*!
+   * \brief Get size of data which is skipped because it is broken.
+   * \return Size in bytes.
+   */
+  inline size_t getBrokenBytes(void) const { return brokenBytes; }
+
+ protected:
+  /*!
+   * \brief Parse header and index blocks.
+   */
+  void parse(void);
+
+  /*!
+   * \brief Find next sync marker.
+   * \param from [in] Position to start searching.
+   * \return Position of sync marker. Value is mappedSize if not found.
+   */
+  size_t findSyncMarker(size_t from) const;
+
+ private:
+  /*!
+   * \brief Top of mapped file.
+   */
+  unsigned char *mapped;
+
+  /*!
+   * \brief Size of mapped file.
+   */
+  size_t mappedSize;
+
+  /*!
+   * \brief Columns in file.
+   */
+  std::vector<TResourceLogColumnInfo> columns;
+
+  /*!
+   * \brief Blocks in file.
+   */
+  std::vector<TResourceLogBlock> blocks;
+
+  /*!
+   * \brief Size of data which is skipped because it is broken.
+   */
+  size_t brokenBytes;
+};
+
+#endif  // RESOURCE_LOG_READER_HPP
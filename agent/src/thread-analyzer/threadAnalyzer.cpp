@@ -0,0 +1,204 @@
+/*!
+ * \file threadAnalyzer.cpp
+ * \brief Command line analyzer of thread record file.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "threadRecordReader.hpp"
+#include "threadStateAnalyzer.hpp"
+
+/*!
+ * \brief Show usage.
+ * \param name [in] Program name.
+ */
+static void usage(const char *name) {
+  fprintf(stderr,
+          "Usage: %s [options] <thread record file>\n"
+          "  -c, --csv <file>       Write summary of each thread as CSV.\n"
+          "  -j, --json <file>      Write summary and top contended periods\n"
+          "                         as JSON. (default: stdout)\n"
+          "  -t, --timeline <file>  Write state intervals as CSV.\n"
+          "  -w, --window <msec>    Width of contention window. (default: "
+          "1000)\n"
+          "  -n, --top <count>      Count of contended periods. (default: "
+          "10)\n"
+          "  -p, --parallel <count> Count of worker threads. (default: "
+          "online CPUs)\n"
+          "  -h, --help             Show this message.\n"
+          "Use \"-\" as <file> to write to stdout.\n",
+          name);
+}
+
+/*!
+ * \brief Open output file.
+ * \param fname [in] File name. "-" means stdout.
+ * \return Output stream. Value is NULL if process is failure.
+ */
+static FILE *openOutput(const char *fname) {
+  if (strcmp(fname, "-") == 0) {
+    return stdout;
+  }
+
+  FILE *out = fopen(fname, "w");
+  if (out == NULL) {
+    perror(fname);
+  }
+  return out;
+}
+
+/*!
+ * \brief Close output file.
+ * \param out [in] Output stream.
+ * \return true if all data is written.
+ */
+static bool closeOutput(FILE *out) {
+  if (out == stdout) {
+    return fflush(out) == 0;
+  }
+  return fclose(out) == 0;
+}
+
+/*!
+ * \brief Entry point of HeapStats thread record analyzer.
+ * \param argc [in] Count of arguments.
+ * \param argv [in] Arguments.
+ * \return Exit status.
+ */
+int main(int argc, char *argv[]) {
+  const char *csvFile = NULL;
+  const char *jsonFile = NULL;
+  const char *timelineFile = NULL;
+  long windowMSec = 1000;
+  int topN = 10;
+  int numWorkers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+
+  static struct option options[] = {{"csv", required_argument, NULL, 'c'},
+                                    {"json", required_argument, NULL, 'j'},
+                                    {"timeline", required_argument, NULL, 't'},
+                                    {"window", required_argument, NULL, 'w'},
+                                    {"top", required_argument, NULL, 'n'},
+                                    {"parallel", required_argument, NULL, 'p'},
+                                    {"help", no_argument, NULL, 'h'},
+                                    {NULL, 0, NULL, 0}};
+
+  int opt;
+  while ((opt = getopt_long(argc, argv, "c:j:t:w:n:p:h", options, NULL)) !=
+         -1) {
+    switch (opt) {
+      case 'c':
+        csvFile = optarg;
+        break;
+      case 'j':
+        jsonFile = optarg;
+        break;
+      case 't':
+        timelineFile = optarg;
+        break;
+      case 'w':
+        windowMSec = atol(optarg);
+        break;
+      case 'n':
+        topN = atoi(optarg);
+        break;
+      case 'p':
+        numWorkers = atoi(optarg);
+        break;
+      case 'h':
+        usage(argv[0]);
+        return 0;
+      default:
+        usage(argv[0]);
+        return 1;
+    }
+  }
+
+  if ((optind != argc - 1) || (windowMSec <= 0)) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  if ((csvFile == NULL) && (jsonFile == NULL) && (timelineFile == NULL)) {
+    jsonFile = "-";
+  }
+
+  TThreadRecordReader *reader = NULL;
+  try {
+    reader = new TThreadRecordReader(argv[optind]);
+  } catch (const char *errMsg) {
+    fprintf(stderr, "%s: %s\n", argv[optind], errMsg);
+    return 1;
+  }
+
+  if (reader->getMissingSegments() > 0) {
+    fprintf(stderr, "%s: %d segments are not in file.\n", argv[optind],
+            reader->getMissingSegments());
+  }
+
+  int result = 0;
+  FILE *timeline = NULL;
+  if (timelineFile != NULL) {
+    timeline = openOutput(timelineFile);
+    if (timeline == NULL) {
+      delete reader;
+      return 1;
+    }
+  }
+
+  TThreadStateAnalyzer analyzer(reader, windowMSec * 1000000L, timeline);
+  analyzer.analyze(numWorkers);
+
+  if ((timeline != NULL) && !closeOutput(timeline)) {
+    perror(timelineFile);
+    result = 1;
+  }
+
+  if (csvFile != NULL) {
+    FILE *out = openOutput(csvFile);
+    if (out == NULL) {
+      result = 1;
+    } else {
+      analyzer.writeCSV(out);
+      if (!closeOutput(out)) {
+        perror(csvFile);
+        result = 1;
+      }
+    }
+  }
+
+  if (jsonFile != NULL) {
+    FILE *out = openOutput(jsonFile);
+    if (out == NULL) {
+      result = 1;
+    } else {
+      analyzer.writeJSON(out, topN);
+      if (!closeOutput(out)) {
+        perror(jsonFile);
+        result = 1;
+      }
+    }
+  }
+
+  delete reader;
+  return result;
+}
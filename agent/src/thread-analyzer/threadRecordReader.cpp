@@ -0,0 +1,169 @@
+/*!
+ * \file threadRecordReader.cpp
+ * \brief Reader of thread record file.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "threadRecordReader.hpp"
+
+/*!
+ * \brief TThreadRecordReader constructor.
+ * \param fname [in] Thread record file.
+ */
+TThreadRecordReader::TThreadRecordReader(const char *fname)
+    : threadNames(), segments() {
+  pos = 0;
+  anchorWallClock = 0;
+  anchorMonotonic = 0;
+  missingSegments = 0;
+
+  int fd = open(fname, O_RDONLY);
+  if (fd == -1) {
+    throw "Could not open thread record file.";
+  }
+
+  struct stat st;
+  if ((fstat(fd, &st) == -1) || (st.st_size == 0)) {
+    close(fd);
+    throw "Could not get size of thread record file.";
+  }
+
+  mappedSize = st.st_size;
+  mapped = (unsigned char *)mmap(NULL, mappedSize, PROT_READ, MAP_PRIVATE,
+                                 fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) {
+    throw "Could not map thread record file.";
+  }
+
+  try {
+    parse();
+  } catch (...) {
+    munmap(mapped, mappedSize);
+    throw;
+  }
+}
+
+/*!
+ * \brief TThreadRecordReader destructor.
+ */
+TThreadRecordReader::~TThreadRecordReader(void) {
+  munmap(mapped, mappedSize);
+}
+
+/*!
+ * \brief Read a value from current position.
+ * \param dest [out] Buffer to store the value.
+ * \param size [in] Size of the value.
+ * \return true if the value is in file.
+ */
+bool TThreadRecordReader::read(void *dest, size_t size) {
+  if (mappedSize - pos < size) {
+    return false;
+  }
+
+  memcpy(dest, mapped + pos, size);
+  pos += size;
+  return true;
+}
+
+/*!
+ * \brief Parse header and index segments.
+ */
+void TThreadRecordReader::parse(void) {
+  /* Byte order mark. */
+  const unsigned short endianTest = 1;
+  char nativeBOM = (*(const char *)&endianTest == 1) ? 'L' : 'B';
+  char bom;
+  if (!read(&bom, sizeof(char)) || ((bom != 'L') && (bom != 'B'))) {
+    throw "Not a thread record file.";
+  } else if (bom != nativeBOM) {
+    throw "Byte order of thread record file is different from this host.";
+  }
+
+  /* Magic number and format version. */
+  char magic[4];
+  int version;
+  if (!read(magic, sizeof(magic)) ||
+      (memcmp(magic, THREAD_RECORD_MAGIC, sizeof(magic)) != 0)) {
+    throw "Legacy thread record file is not supported.";
+  } else if (!read(&version, sizeof(int)) ||
+             (version != THREAD_RECORD_FORMAT_VERSION)) {
+    throw "Unsupported version of thread record file.";
+  }
+
+  /* Clock anchor. */
+  if (!read(&anchorWallClock, sizeof(jlong)) ||
+      !read(&anchorMonotonic, sizeof(jlong))) {
+    throw "Thread record file is truncated.";
+  }
+
+  /* Thread list. */
+  int numThreads;
+  if (!read(&numThreads, sizeof(int)) || (numThreads < 0)) {
+    throw "Thread record file is truncated.";
+  }
+  for (int Cnt = 0; Cnt < numThreads; Cnt++) {
+    jlong id;
+    int len;
+    if (!read(&id, sizeof(jlong)) || !read(&len, sizeof(int)) ||
+        (len < 0) || (mappedSize - pos < (size_t)len)) {
+      throw "Thread record file is truncated.";
+    }
+
+    threadNames[id] = std::string((const char *)mapped + pos, len);
+    pos += len;
+  }
+
+  /*
+   * Segments and thread names.
+   * Streaming file might be cut at the last segment if the JVM died while
+   * writing. So segments which are not in file are counted only.
+   */
+  int numSegments;
+  if (!read(&numSegments, sizeof(int)) || (numSegments < 0)) {
+    throw "Thread record file is truncated.";
+  }
+  segments.reserve(numSegments);
+  for (int Cnt = 0; Cnt < numSegments; Cnt++) {
+    TSegmentEntry entry;
+    if (!read(&entry.thread_id, sizeof(jlong)) ||
+        !read(&entry.base_time, sizeof(jlong)) ||
+        !read(&entry.used, sizeof(int)) || (entry.used < 0) ||
+        (mappedSize - pos < (size_t)entry.used)) {
+      missingSegments = numSegments - Cnt;
+      break;
+    }
+
+    entry.data = mapped + pos;
+    pos += entry.used;
+    if (entry.base_time == THREAD_NAME_ENTRY_TIME) {
+      /* Name of thread which started after the file was opened. */
+      threadNames[entry.thread_id] =
+          std::string((const char *)entry.data, entry.used);
+    } else {
+      segments.push_back(entry);
+    }
+  }
+}
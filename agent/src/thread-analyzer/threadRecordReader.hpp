@@ -0,0 +1,155 @@
+/*!
+ * \file threadRecordReader.hpp
+ * \brief Reader of thread record file.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+#ifndef THREAD_RECORD_READER_HPP
+#define THREAD_RECORD_READER_HPP
+
+#include <jni.h>
+
+#include <stddef.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "threadRecordFormat.hpp"
+
+/*!
+ * \brief Ring segment in thread record file.
+ */
+typedef struct {
+  jlong thread_id;            /*!< Thread ID of owner.               */
+  jlong base_time;            /*!< Time of first record.             */
+  int used;                   /*!< Size of records in bytes.         */
+  const unsigned char *data;  /*!< Records in mapped file.           */
+} TSegmentEntry;
+
+/*!
+ * \brief Type of ThreadID-ThreadName map.
+ */
+typedef std::map<jlong, std::string> TThreadNameMap;
+
+/*!
+ * \brief This class maps thread record file (format version 3) to memory,
+ *        and makes index of its segments.<br>
+ *        Records are not copied. They are decoded from mapped file.
+ */
+class TThreadRecordReader {
+ public:
+  /*!
+   * \brief TThreadRecordReader constructor.
+   * \param fname [in] Thread record file.
+   */
+  TThreadRecordReader(const char *fname);
+
+  /*!
+   * \brief TThreadRecordReader destructor.
+   */
+  virtual ~TThreadRecordReader(void);
+
+  /*!
+   * \brief Convert monotonic time in file to wall-clock.
+   * \param time [in] Monotonic time in nanoseconds.
+   * \return Nanoseconds from epoch.
+   */
+  inline jlong toWallClock(jlong time) const {
+    return anchorWallClock + (time - anchorMonotonic);
+  }
+
+  /*!
+   * \brief Get ThreadID-ThreadName map.
+   * \return Thread name map.
+   */
+  inline const TThreadNameMap &getThreadNames(void) const {
+    return threadNames;
+  }
+
+  /*!
+   * \brief Get all segments in file.
+   * \return Segments in order of file.
+   */
+  inline const std::vector<TSegmentEntry> &getSegments(void) const {
+    return segments;
+  }
+
+  /*!
+   * \brief Get count of segments which are declared but are not in file.
+   * \return Count of missing segments.
+   */
+  inline int getMissingSegments(void) const { return missingSegments; }
+
+ protected:
+  /*!
+   * \brief Read a value from current position.
+   * \param dest [out] Buffer to store the value.
+   * \param size [in] Size of the value.
+   * \return true if the value is in file.
+   */
+  bool read(void *dest, size_t size);
+
+  /*!
+   * \brief Parse header and index segments.
+   */
+  void parse(void);
+
+ private:
+  /*!
+   * \brief Top of mapped file.
+   */
+  unsigned char *mapped;
+
+  /*!
+   * \brief Size of mapped file.
+   */
+  size_t mappedSize;
+
+  /*!
+   * \brief Current position to read.
+   */
+  size_t pos;
+
+  /*!
+   * \brief Wall-clock in nanoseconds at anchor.
+   */
+  jlong anchorWallClock;
+
+  /*!
+   * \brief Monotonic clock in nanoseconds at anchor.
+   */
+  jlong anchorMonotonic;
+
+  /*!
+   * \brief ThreadID-ThreadName map.
+   */
+  TThreadNameMap threadNames;
+
+  /*!
+   * \brief Segments in file.
+   */
+  std::vector<TSegmentEntry> segments;
+
+  /*!
+   * \brief Count of segments which are declared but are not in file.
+   */
+  int missingSegments;
+};
+
+#endif  // THREAD_RECORD_READER_HPP
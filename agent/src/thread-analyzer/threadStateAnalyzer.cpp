@@ -0,0 +1,510 @@
+/*!
+ * \file threadStateAnalyzer.cpp
+ * \brief Analyzer of thread states in thread record file.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "threadStateAnalyzer.hpp"
+
+/*!
+ * \brief Size of timeline buffer to flush.
+ */
+#define TIMELINE_FLUSH_SIZE (1024 * 1024)
+
+/*!
+ * \brief Names of thread states.
+ */
+static const char *stateNames[NUM_THREAD_STATES] = {
+    "monitor_wait", "monitor_blocked", "sleep",       "park",
+    "file_read",    "file_write",      "socket_read", "socket_write"};
+
+/*!
+ * \brief Get thread state which is started by the event.
+ * \param event [in] Thread event.
+ * \return Thread state. Value is -1 if the event does not start any state.
+ */
+static int getStartedState(jlong event) {
+  switch (event) {
+    case MonitorWait:
+      return StateMonitorWait;
+    case MonitorContendedEnter:
+      return StateMonitorBlocked;
+    case ThreadSleepStart:
+      return StateSleep;
+    case Park:
+      return StatePark;
+    case FileReadStart:
+      return StateFileRead;
+    case FileWriteStart:
+      return StateFileWrite;
+    case SocketReadStart:
+      return StateSocketRead;
+    case SocketWriteStart:
+      return StateSocketWrite;
+    default:
+      return -1;
+  }
+}
+
+/*!
+ * \brief Get thread state which is finished by the event.
+ * \param event [in] Thread event.
+ * \return Thread state. Value is -1 if the event does not finish any state.
+ */
+static int getFinishedState(jlong event) {
+  switch (event) {
+    case MonitorWaited:
+      return StateMonitorWait;
+    case MonitorContendedEntered:
+      return StateMonitorBlocked;
+    case ThreadSleepEnd:
+      return StateSleep;
+    case Unpark:
+      return StatePark;
+    case FileReadEnd:
+      return StateFileRead;
+    case FileWriteEnd:
+      return StateFileWrite;
+    case SocketReadEnd:
+      return StateSocketRead;
+    case SocketWriteEnd:
+      return StateSocketWrite;
+    default:
+      return -1;
+  }
+}
+
+/*!
+ * \brief Compare segments by time of their first record.
+ * \param a [in] Segment.
+ * \param b [in] Segment.
+ * \return true if a is older than b.
+ */
+static bool compareSegment(const TSegmentEntry *a, const TSegmentEntry *b) {
+  return a->base_time < b->base_time;
+}
+
+/*!
+ * \brief Compare contention windows by blocked time.
+ * \param a [in] Contention window.
+ * \param b [in] Contention window.
+ * \return true if a is more contended than b.
+ */
+static bool compareContention(const TContentionMap::value_type *a,
+                              const TContentionMap::value_type *b) {
+  return a->second.blocked_time > b->second.blocked_time;
+}
+
+/*!
+ * \brief Write string as JSON string literal.
+ * \param out [in] Output stream.
+ * \param str [in] String to write.
+ */
+static void writeJSONString(FILE *out, const char *str) {
+  fputc('"', out);
+  for (const unsigned char *pos = (const unsigned char *)str; *pos != '\0';
+       pos++) {
+    if ((*pos == '"') || (*pos == '\\')) {
+      fprintf(out, "\\%c", *pos);
+    } else if (*pos < 0x20) {
+      fprintf(out, "\\u%04x", *pos);
+    } else {
+      fputc(*pos, out);
+    }
+  }
+  fputc('"', out);
+}
+
+/*!
+ * \brief TThreadStateAnalyzer constructor.
+ * \param reader   [in] Reader of thread record file.
+ * \param window   [in] Width of contention window in nanoseconds.
+ * \param timeline [in] Output of state intervals. Value is NULL if it is
+ *                      not needed.
+ */
+TThreadStateAnalyzer::TThreadStateAnalyzer(const TThreadRecordReader *reader,
+                                           jlong window, FILE *timeline)
+    : partitions(), summaries(), contentions() {
+  this->reader = reader;
+  this->window = window;
+  this->timeline = timeline;
+  this->nextPartition = 0;
+  pthread_mutex_init(&mutex, NULL);
+
+  /* Partition segments by thread ID. */
+  std::map<jlong, size_t> index;
+  const std::vector<TSegmentEntry> &segments = reader->getSegments();
+  for (auto itr = segments.begin(); itr != segments.end(); itr++) {
+    auto found = index.find(itr->thread_id);
+    size_t idx;
+    if (found == index.end()) {
+      idx = partitions.size();
+      index[itr->thread_id] = idx;
+      partitions.push_back(std::vector<const TSegmentEntry *>());
+    } else {
+      idx = found->second;
+    }
+    partitions[idx].push_back(&(*itr));
+  }
+
+  summaries.resize(partitions.size());
+
+  if (timeline != NULL) {
+    fputs("thread_id,state,start_time_ns,duration_ns,bytes\n", timeline);
+  }
+}
+
+/*!
+ * \brief TThreadStateAnalyzer destructor.
+ */
+TThreadStateAnalyzer::~TThreadStateAnalyzer(void) {
+  pthread_mutex_destroy(&mutex);
+}
+
+/*!
+ * \brief Get name of thread state.
+ * \param state [in] Thread state.
+ * \return Name of thread state.
+ */
+const char *TThreadStateAnalyzer::getStateName(int state) {
+  return stateNames[state];
+}
+
+/*!
+ * \brief Decode all segments.
+ * \param numWorkers [in] Count of worker threads.
+ */
+void TThreadStateAnalyzer::analyze(int numWorkers) {
+  if (numWorkers < 1) {
+    numWorkers = 1;
+  }
+
+  std::vector<pthread_t> workers;
+  for (int Cnt = 0; Cnt < numWorkers; Cnt++) {
+    pthread_t worker;
+    if (pthread_create(&worker, NULL, &workerEntryPoint, this) != 0) {
+      break;
+    }
+    workers.push_back(worker);
+  }
+
+  if (workers.empty()) {
+    /* Decode in this thread. */
+    workerEntryPoint(this);
+  }
+
+  for (auto itr = workers.begin(); itr != workers.end(); itr++) {
+    pthread_join(*itr, NULL);
+  }
+}
+
+/*!
+ * \brief Entry point of worker thread.
+ * \param data [in] Instance of TThreadStateAnalyzer.
+ * \return Always NULL.
+ */
+void *TThreadStateAnalyzer::workerEntryPoint(void *data) {
+  TThreadStateAnalyzer *analyzer = (TThreadStateAnalyzer *)data;
+  TContentionMap localContentions;
+  std::string buf;
+
+  while (true) {
+    size_t partition = __sync_fetch_and_add(&analyzer->nextPartition, 1);
+    if (partition >= analyzer->partitions.size()) {
+      break;
+    }
+
+    analyzer->analyzeThread(partition, localContentions, buf);
+  }
+
+  /* Merge results of this worker. */
+  analyzer->flushTimeline(buf);
+  pthread_mutex_lock(&analyzer->mutex);
+  {
+    for (auto itr = localContentions.begin(); itr != localContentions.end();
+         itr++) {
+      TContentionWindow &dest = analyzer->contentions[itr->first];
+      dest.blocked_time += itr->second.blocked_time;
+      dest.threads += itr->second.threads;
+    }
+  }
+  pthread_mutex_unlock(&analyzer->mutex);
+
+  return NULL;
+}
+
+/*!
+ * \brief Decode all segments of a thread.
+ * \param partition   [in] Index of partition.
+ * \param contentions [in,out] Contention windows of this worker.
+ * \param buf         [in,out] Buffer of timeline of this worker.
+ */
+void TThreadStateAnalyzer::analyzeThread(size_t partition,
+                                         TContentionMap &contentions,
+                                         std::string &buf) {
+  std::vector<const TSegmentEntry *> &segs = partitions[partition];
+  std::sort(segs.begin(), segs.end(), compareSegment);
+
+  TThreadSummary *summary = &summaries[partition];
+  memset(summary, 0, sizeof(TThreadSummary));
+  summary->thread_id = segs.front()->thread_id;
+  summary->first_time = segs.front()->base_time;
+  summary->last_time = summary->first_time;
+
+  jlong openTime[NUM_THREAD_STATES];
+  for (int idx = 0; idx < NUM_THREAD_STATES; idx++) {
+    openTime[idx] = -1;
+  }
+  jlong lastWindow = -1;
+  char line[128];
+
+  for (auto itr = segs.begin(); itr != segs.end(); itr++) {
+    const unsigned char *pos = (*itr)->data;
+    const unsigned char *end = pos + (*itr)->used;
+    TEventRecord record;
+    record.time = (*itr)->base_time;
+
+    while (pos < end) {
+      int size = decodeCompactRecord(pos, end, &record);
+      if (size == 0) {
+        summary->broken_segments++;
+        break;
+      }
+      pos += size;
+
+      summary->events++;
+      summary->last_time = record.time;
+
+      if (record.event == ThreadStart) {
+        summary->started = true;
+        continue;
+      } else if (record.event == ThreadEnd) {
+        summary->ended = true;
+        continue;
+      }
+
+      int state = getStartedState(record.event);
+      if (state != -1) {
+        openTime[state] = record.time;
+        continue;
+      }
+
+      state = getFinishedState(record.event);
+      if ((state == -1) || (openTime[state] == -1)) {
+        /* Start event has been overwritten in ring buffer. */
+        continue;
+      }
+
+      jlong start = openTime[state];
+      jlong duration = record.time - start;
+      jlong bytes = (state >= StateFileRead) ? record.additionalData : 0;
+      openTime[state] = -1;
+
+      summary->count[state]++;
+      summary->total[state] += duration;
+      summary->max[state] = std::max(summary->max[state], duration);
+      summary->bytes[state] += bytes;
+
+      if (state == StateMonitorBlocked) {
+        addContention(start, record.time, &lastWindow, contentions);
+      }
+
+      if (timeline != NULL) {
+        snprintf(line, sizeof(line), "%lld,%s,%lld,%lld,%lld\n",
+                 (long long)summary->thread_id, stateNames[state],
+                 (long long)reader->toWallClock(start), (long long)duration,
+                 (long long)bytes);
+        buf += line;
+        if (buf.size() >= TIMELINE_FLUSH_SIZE) {
+          flushTimeline(buf);
+        }
+      }
+    }
+  }
+
+  /* States which are not finished until end of data. */
+  for (int state = 0; state < NUM_THREAD_STATES; state++) {
+    if (openTime[state] != -1) {
+      jlong duration = summary->last_time - openTime[state];
+      summary->count[state]++;
+      summary->total[state] += duration;
+      summary->max[state] = std::max(summary->max[state], duration);
+      summary->truncated++;
+
+      if (state == StateMonitorBlocked) {
+        addContention(openTime[state], summary->last_time, &lastWindow,
+                      contentions);
+      }
+    }
+  }
+}
+
+/*!
+ * \brief Add MonitorBlocked interval to contention windows.
+ * \param start       [in] Start time of interval.
+ * \param end         [in] End time of interval.
+ * \param lastWindow  [in,out] Last window which this thread is counted.
+ * \param contentions [in,out] Contention windows of this worker.
+ */
+void TThreadStateAnalyzer::addContention(jlong start, jlong end,
+                                         jlong *lastWindow,
+                                         TContentionMap &contentions) {
+  for (jlong idx = start / window; idx * window < end; idx++) {
+    jlong windowStart = std::max(start, idx * window);
+    jlong windowEnd = std::min(end, (idx + 1) * window);
+
+    TContentionWindow &dest = contentions[idx];
+    dest.blocked_time += windowEnd - windowStart;
+
+    /* Intervals of a thread are in order of time. */
+    if (idx > *lastWindow) {
+      dest.threads++;
+      *lastWindow = idx;
+    }
+  }
+}
+
+/*!
+ * \brief Write buffered timeline to output.
+ * \param buf [in,out] Buffer of timeline. It is cleared.
+ */
+void TThreadStateAnalyzer::flushTimeline(std::string &buf) {
+  if ((timeline == NULL) || buf.empty()) {
+    return;
+  }
+
+  pthread_mutex_lock(&mutex);
+  {
+    fwrite(buf.data(), 1, buf.size(), timeline);
+  }
+  pthread_mutex_unlock(&mutex);
+
+  buf.clear();
+}
+
+/*!
+ * \brief Write summary of each thread as CSV.
+ * \param out [in] Output stream.
+ */
+void TThreadStateAnalyzer::writeCSV(FILE *out) {
+  fputs("thread_id,thread_name,first_time_ns,lifetime_ns,events,started,"
+        "ended,truncated,broken_segments", out);
+  for (int state = 0; state < NUM_THREAD_STATES; state++) {
+    fprintf(out, ",%s_count,%s_ns,%s_max_ns", stateNames[state],
+            stateNames[state], stateNames[state]);
+    if (state >= StateFileRead) {
+      fprintf(out, ",%s_bytes", stateNames[state]);
+    }
+  }
+  fputc('\n', out);
+
+  const TThreadNameMap &names = reader->getThreadNames();
+  for (auto itr = summaries.begin(); itr != summaries.end(); itr++) {
+    auto name = names.find(itr->thread_id);
+    std::string quoted;
+    if (name != names.end()) {
+      /* Quote thread name as RFC 4180. */
+      quoted = name->second;
+      for (size_t idx = 0; (idx = quoted.find('"', idx)) != std::string::npos;
+           idx += 2) {
+        quoted.insert(idx, 1, '"');
+      }
+    }
+
+    fprintf(out, "%lld,\"%s\",%lld,%lld,%lld,%d,%d,%lld,%lld",
+            (long long)itr->thread_id, quoted.c_str(),
+            (long long)reader->toWallClock(itr->first_time),
+            (long long)(itr->last_time - itr->first_time),
+            (long long)itr->events, itr->started ? 1 : 0, itr->ended ? 1 : 0,
+            (long long)itr->truncated, (long long)itr->broken_segments);
+    for (int state = 0; state < NUM_THREAD_STATES; state++) {
+      fprintf(out, ",%lld,%lld,%lld", (long long)itr->count[state],
+              (long long)itr->total[state], (long long)itr->max[state]);
+      if (state >= StateFileRead) {
+        fprintf(out, ",%lld", (long long)itr->bytes[state]);
+      }
+    }
+    fputc('\n', out);
+  }
+}
+
+/*!
+ * \brief Write summary of each thread and top contended periods as JSON.
+ * \param out  [in] Output stream.
+ * \param topN [in] Count of contended periods to write.
+ */
+void TThreadStateAnalyzer::writeJSON(FILE *out, int topN) {
+  const TThreadNameMap &names = reader->getThreadNames();
+
+  fprintf(out, "{\n  \"missing_segments\": %d,\n  \"threads\": [",
+          reader->getMissingSegments());
+  for (auto itr = summaries.begin(); itr != summaries.end(); itr++) {
+    auto name = names.find(itr->thread_id);
+    fprintf(out, "%s\n    {\"thread_id\": %lld, \"thread_name\": ",
+            (itr == summaries.begin()) ? "" : ",", (long long)itr->thread_id);
+    writeJSONString(out, (name != names.end()) ? name->second.c_str() : "");
+    fprintf(out,
+            ", \"first_time_ns\": %lld, \"lifetime_ns\": %lld, "
+            "\"events\": %lld, \"started\": %s, \"ended\": %s, "
+            "\"truncated\": %lld, \"broken_segments\": %lld, \"states\": {",
+            (long long)reader->toWallClock(itr->first_time),
+            (long long)(itr->last_time - itr->first_time),
+            (long long)itr->events, itr->started ? "true" : "false",
+            itr->ended ? "true" : "false", (long long)itr->truncated,
+            (long long)itr->broken_segments);
+    for (int state = 0; state < NUM_THREAD_STATES; state++) {
+      fprintf(out,
+              "%s\"%s\": {\"count\": %lld, \"total_ns\": %lld, "
+              "\"max_ns\": %lld",
+              (state == 0) ? "" : ", ", stateNames[state],
+              (long long)itr->count[state], (long long)itr->total[state],
+              (long long)itr->max[state]);
+      if (state >= StateFileRead) {
+        fprintf(out, ", \"bytes\": %lld", (long long)itr->bytes[state]);
+      }
+      fputc('}', out);
+    }
+    fputs("}}", out);
+  }
+
+  /* Top contended periods. */
+  std::vector<const TContentionMap::value_type *> ranking;
+  for (auto itr = contentions.begin(); itr != contentions.end(); itr++) {
+    ranking.push_back(&(*itr));
+  }
+  std::sort(ranking.begin(), ranking.end(), compareContention);
+  if ((topN >= 0) && (ranking.size() > (size_t)topN)) {
+    ranking.resize(topN);
+  }
+
+  fprintf(out, "\n  ],\n  \"window_ns\": %lld,\n  \"contended_periods\": [",
+          (long long)window);
+  for (auto itr = ranking.begin(); itr != ranking.end(); itr++) {
+    fprintf(out,
+            "%s\n    {\"start_time_ns\": %lld, \"blocked_ns\": %lld, "
+            "\"threads\": %d}",
+            (itr == ranking.begin()) ? "" : ",",
+            (long long)reader->toWallClock((*itr)->first * window),
+            (long long)(*itr)->second.blocked_time, (*itr)->second.threads);
+  }
+  fputs("\n  ]\n}\n", out);
+}
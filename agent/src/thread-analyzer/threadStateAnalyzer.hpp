@@ -0,0 +1,204 @@
+/*!
+ * \file threadStateAnalyzer.hpp
+ * \brief Analyzer of thread states in thread record file.
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+#ifndef THREAD_STATE_ANALYZER_HPP
+#define THREAD_STATE_ANALYZER_HPP
+
+#include <jni.h>
+
+#include <pthread.h>
+#include <stdio.h>
+
+#include <map>
+#include <vector>
+
+#include "threadRecordReader.hpp"
+
+/*!
+ * \brief Thread state which is made from pair of events.
+ */
+typedef enum {
+  StateMonitorWait = 0, /*!< Between MonitorWait and MonitorWaited.     */
+  StateMonitorBlocked,  /*!< Between MonitorContendedEnter(ed).         */
+  StateSleep,           /*!< Between ThreadSleepStart and End.          */
+  StatePark,            /*!< Between Park and Unpark.                   */
+  StateFileRead,        /*!< Between FileReadStart and End.             */
+  StateFileWrite,       /*!< Between FileWriteStart and End.            */
+  StateSocketRead,      /*!< Between SocketReadStart and End.           */
+  StateSocketWrite,     /*!< Between SocketWriteStart and End.          */
+  NUM_THREAD_STATES
+} TThreadState;
+
+/*!
+ * \brief Summary of a thread.
+ */
+typedef struct {
+  jlong thread_id;
+  jlong first_time;                   /*!< Time of first event.          */
+  jlong last_time;                    /*!< Time of last event.           */
+  jlong events;                       /*!< Count of events.              */
+  jlong broken_segments;              /*!< Count of undecodable segments. */
+  jlong truncated;                    /*!< Intervals closed by end of data. */
+  bool started;                       /*!< ThreadStart is recorded.       */
+  bool ended;                         /*!< ThreadEnd is recorded.         */
+  jlong count[NUM_THREAD_STATES];     /*!< Count of intervals.            */
+  jlong total[NUM_THREAD_STATES];     /*!< Total time in nanoseconds.     */
+  jlong max[NUM_THREAD_STATES];       /*!< Longest interval.              */
+  jlong bytes[NUM_THREAD_STATES];     /*!< Bytes of I/O.                  */
+} TThreadSummary;
+
+/*!
+ * \brief Contention in a time window.
+ */
+typedef struct {
+  jlong blocked_time;  /*!< Total time of MonitorBlocked in window.      */
+  int threads;         /*!< Count of threads which were blocked.          */
+} TContentionWindow;
+
+/*!
+ * \brief Type of contention windows. Key is index of window.
+ */
+typedef std::map<jlong, TContentionWindow> TContentionMap;
+
+/*!
+ * \brief This class decodes thread record file with multiple threads.
+ *        Segments are partitioned by thread ID, so each thread is decoded
+ *        by one worker in order of time.
+ */
+class TThreadStateAnalyzer {
+ public:
+  /*!
+   * \brief TThreadStateAnalyzer constructor.
+   * \param reader   [in] Reader of thread record file.
+   * \param window   [in] Width of contention window in nanoseconds.
+   * \param timeline [in] Output of state intervals. Value is NULL if it is
+   *                      not needed.
+   */
+  TThreadStateAnalyzer(const TThreadRecordReader *reader, jlong window,
+                       FILE *timeline);
+
+  /*!
+   * \brief TThreadStateAnalyzer destructor.
+   */
+  virtual ~TThreadStateAnalyzer(void);
+
+  /*!
+   * \brief Decode all segments.
+   * \param numWorkers [in] Count of worker threads.
+   */
+  void analyze(int numWorkers);
+
+  /*!
+   * \brief Write summary of each thread as CSV.
+   * \param out [in] Output stream.
+   */
+  void writeCSV(FILE *out);
+
+  /*!
+   * \brief Write summary of each thread and top contended periods as JSON.
+   * \param out  [in] Output stream.
+   * \param topN [in] Count of contended periods to write.
+   */
+  void writeJSON(FILE *out, int topN);
+
+  /*!
+   * \brief Get name of thread state.
+   * \param state [in] Thread state.
+   * \return Name of thread state.
+   */
+  static const char *getStateName(int state);
+
+ protected:
+  /*!
+   * \brief Entry point of worker thread.
+   * \param data [in] Instance of TThreadStateAnalyzer.
+   * \return Always NULL.
+   */
+  static void *workerEntryPoint(void *data);
+
+  /*!
+   * \brief Decode all segments of a thread.
+   * \param partition   [in] Index of partition.
+   * \param contentions [in,out] Contention windows of this worker.
+   * \param buf         [in,out] Buffer of timeline of this worker.
+   */
+  void analyzeThread(size_t partition, TContentionMap &contentions,
+                     std::string &buf);
+
+  /*!
+   * \brief Add MonitorBlocked interval to contention windows.
+   * \param start       [in] Start time of interval.
+   * \param end         [in] End time of interval.
+   * \param lastWindow  [in,out] Last window which this thread is counted.
+   * \param contentions [in,out] Contention windows of this worker.
+   */
+  void addContention(jlong start, jlong end, jlong *lastWindow,
+                     TContentionMap &contentions);
+
+  /*!
+   * \brief Write buffered timeline to output.
+   * \param buf [in,out] Buffer of timeline. It is cleared.
+   */
+  void flushTimeline(std::string &buf);
+
+ private:
+  /*!
+   * \brief Reader of thread record file.
+   */
+  const TThreadRecordReader *reader;
+
+  /*!
+   * \brief Width of contention window in nanoseconds.
+   */
+  jlong window;
+
+  /*!
+   * \brief Output of state intervals.
+   */
+  FILE *timeline;
+
+  /*!
+   * \brief Mutex for timeline and merge of results.
+   */
+  pthread_mutex_t mutex;
+
+  /*!
+   * \brief Segments of each thread in order of time.
+   */
+  std::vector<std::vector<const TSegmentEntry *> > partitions;
+
+  /*!
+   * \brief Next partition which is not taken by workers.
+   */
+  volatile size_t nextPartition;
+
+  /*!
+   * \brief Summary of each thread. Index is same as partitions.
+   */
+  std::vector<TThreadSummary> summaries;
+
+  /*!
+   * \brief Contention windows of all threads.
+   */
+  TContentionMap contentions;
+};
+
+#endif  // THREAD_STATE_ANALYZER_HPP
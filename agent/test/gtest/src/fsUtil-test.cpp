@@ -88,6 +88,47 @@ TEST_F(FSUtilTest, copyFileWithRename){
   ASSERT_EQ(0, memcmp(src_md5, dst_md5, MD5_DIGEST_LENGTH));
 }
 
+TEST_F(FSUtilTest, copyFileFromProcfs){
+  /* Content of cmdline is not changed while the test is running. */
+  ASSERT_EQ(0, copyFile("/proc/self/cmdline", RESULT_DIR, "procfs_copy"));
+
+  char expected[4096];
+  int fd = open("/proc/self/cmdline", O_RDONLY);
+  ssize_t expectedSize = read(fd, expected, sizeof(expected));
+  close(fd);
+
+  char actual[4096];
+  fd = open(RESULT_DIR "/procfs_copy", O_RDONLY);
+  ASSERT_NE(-1, fd);
+  ssize_t actualSize = read(fd, actual, sizeof(actual));
+  close(fd);
+
+  ASSERT_GT(expectedSize, 0);
+  ASSERT_EQ(expectedSize, actualSize);
+  ASSERT_EQ(0, memcmp(expected, actual, expectedSize));
+}
+
+TEST_F(FSUtilTest, copyFileTail){
+  int srcFd = open(COPY_SRC, O_RDONLY);
+  ASSERT_NE(-1, srcFd);
+  struct stat st;
+  fstat(srcFd, &st);
+
+  int destFd = open(RESULT_DIR "/tail_copy", O_CREAT | O_WRONLY | O_TRUNC,
+                    S_IRUSR | S_IWUSR);
+  ASSERT_NE(-1, destFd);
+
+  off_t size = 0;
+  ASSERT_EQ(0, copyFileTail(srcFd, destFd, st.st_size / 2, &size));
+  ASSERT_EQ(st.st_size - st.st_size / 2, size);
+
+  ASSERT_EQ(0, copyFileTail(srcFd, destFd, st.st_size, &size));
+  ASSERT_EQ(0, size);
+
+  close(destFd);
+  close(srcFd);
+}
+
 TEST_F(FSUtilTest, tempDir){
   char *tmp = NULL;
   ASSERT_EQ(0, createTempDir(&tmp, "heapstats-test-tmp"));
@@ -161,6 +202,19 @@ TEST_F(FSUtilTest, isValidPath){
   ASSERT_FALSE(isValidPath("./does/not/exist"));
 }
 
+TEST_F(FSUtilTest, isOpenedFile){
+  int fd = open(RESULT_DIR "/opened_file", O_CREAT | O_WRONLY | O_TRUNC,
+                S_IRUSR | S_IWUSR);
+  ASSERT_NE(-1, fd);
+
+  struct stat st;
+  fstat(fd, &st);
+  ASSERT_TRUE(isOpenedFile(st.st_dev, st.st_ino));
+
+  close(fd);
+  ASSERT_FALSE(isOpenedFile(st.st_dev, st.st_ino));
+}
+
 TEST_F(FSUtilTest, checkDiskFull){
   ASSERT_TRUE(checkDiskFull(ENOSPC, "testcase"));
   ASSERT_FALSE(checkDiskFull(0, "testcase"));
@@ -0,0 +1,101 @@
+/*!
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <heapstats-engines/latencyHistogram.hpp>
+
+
+#define EXACT_LIMIT (1 << LATENCY_HISTOGRAM_SUB_BITS)
+#define MAX_VALUE ((1LL << LATENCY_HISTOGRAM_MAX_BITS) - 1)
+
+
+TEST(LatencyHistogramTest, exactBuckets){
+  for(jlong value = 0; value < EXACT_LIMIT; value++){
+    ASSERT_EQ(value, TLatencyHistogram::getBucketIndex(value));
+    ASSERT_EQ(value, TLatencyHistogram::getBucketHighValue(value));
+  }
+
+  /* Negative value is stored to the first bucket. */
+  ASSERT_EQ(0, TLatencyHistogram::getBucketIndex(-1));
+}
+
+TEST(LatencyHistogramTest, bucketEdges){
+  /* First log-linear bucket has 2 values. */
+  ASSERT_EQ(EXACT_LIMIT, TLatencyHistogram::getBucketIndex(EXACT_LIMIT));
+  ASSERT_EQ(EXACT_LIMIT, TLatencyHistogram::getBucketIndex(EXACT_LIMIT + 1));
+  ASSERT_EQ(EXACT_LIMIT + 1,
+            TLatencyHistogram::getBucketIndex(EXACT_LIMIT + 2));
+
+  /* Buckets are contiguous, and each value is in its bucket. */
+  jlong low = 0;
+  for(int idx = 0; idx < LATENCY_HISTOGRAM_BUCKETS; idx++){
+    jlong high = TLatencyHistogram::getBucketHighValue(idx);
+    ASSERT_LE(low, high) << idx;
+    ASSERT_EQ(idx, TLatencyHistogram::getBucketIndex(low)) << idx;
+    ASSERT_EQ(idx, TLatencyHistogram::getBucketIndex(high)) << idx;
+
+    /* Relative error of bucket is 1/2^(SUB_BITS-1) at most. */
+    ASSERT_LE((high - low) * (1 << (LATENCY_HISTOGRAM_SUB_BITS - 1)),
+              low) << idx;
+    low = high + 1;
+  }
+
+  ASSERT_EQ(MAX_VALUE,
+      TLatencyHistogram::getBucketHighValue(LATENCY_HISTOGRAM_BUCKETS - 1));
+
+  /* Larger value is clamped to the last bucket. */
+  ASSERT_EQ(LATENCY_HISTOGRAM_BUCKETS - 1,
+            TLatencyHistogram::getBucketIndex(MAX_VALUE + 1));
+  ASSERT_EQ(LATENCY_HISTOGRAM_BUCKETS - 1,
+            TLatencyHistogram::getBucketIndex(0x7fffffffffffffffLL));
+}
+
+TEST(LatencyHistogramTest, statistics){
+  TLatencyHistogram histogram;
+  TLatencyStatistics stat;
+
+  histogram.getStatistics(&stat);
+  ASSERT_EQ(0, stat.count);
+  ASSERT_EQ(0, stat.p50);
+  ASSERT_EQ(0, stat.p999);
+
+  /* 1..1000 */
+  for(jlong value = 1; value <= 1000; value++){
+    histogram.record(value, (value % 2 == 0) ? 10 : 0);
+  }
+
+  histogram.getStatistics(&stat);
+  ASSERT_EQ(1000, stat.count);
+  ASSERT_EQ(500500, stat.total);
+  ASSERT_EQ(5000, stat.bytes);
+  ASSERT_EQ(1000, stat.max);
+
+  /* Percentile is upper bound of the bucket which has it. */
+  ASSERT_EQ(TLatencyHistogram::getBucketHighValue(
+                TLatencyHistogram::getBucketIndex(500)), stat.p50);
+  ASSERT_EQ(TLatencyHistogram::getBucketHighValue(
+                TLatencyHistogram::getBucketIndex(900)), stat.p90);
+  ASSERT_EQ(TLatencyHistogram::getBucketHighValue(
+                TLatencyHistogram::getBucketIndex(990)), stat.p99);
+
+  /* Percentile does not exceed max. */
+  ASSERT_EQ(1000, stat.p999);
+}
+
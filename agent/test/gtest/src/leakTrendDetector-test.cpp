@@ -0,0 +1,135 @@
+/*!
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <heapstats-engines/leakTrendDetector.hpp>
+
+
+#define WINDOW 5
+#define TAG 1
+
+
+class LeakTrendDetectorTest : public testing::Test{
+
+  protected:
+
+    /* Add a snapshot which has only one class. */
+    bool AddSnapShot(TLeakTrendDetector *detector, jlong time, jlong usage,
+                     double *sizeSlope){
+      double countSlope;
+      detector->beginSnapShot(time);
+      bool result = detector->addSample(TAG, usage, usage / 16,
+                                        sizeSlope, &countSlope);
+      detector->endSnapShot();
+
+      return result;
+    }
+
+};
+
+
+TEST_F(LeakTrendDetectorTest, linearGrowth){
+  TLeakTrendDetector detector(WINDOW);
+  double slope = 0.0;
+
+  /* 100 bytes/sec at every 10 sec. */
+  for(int i = 0; i < WINDOW - 1; i++){
+    ASSERT_FALSE(AddSnapShot(&detector, i * 10000L, 1000 + i * 1000, &slope));
+  }
+  ASSERT_TRUE(AddSnapShot(&detector, (WINDOW - 1) * 10000L,
+                          1000 + (WINDOW - 1) * 1000, &slope));
+  ASSERT_DOUBLE_EQ(100.0, slope);
+}
+
+TEST_F(LeakTrendDetectorTest, irregularInterval){
+  TLeakTrendDetector detector(WINDOW);
+  double slope = 0.0;
+  jlong times[WINDOW] = {0, 1000, 5000, 6000, 20000};
+
+  for(int i = 0; i < WINDOW; i++){
+    AddSnapShot(&detector, times[i], 50 * times[i] / 1000, &slope);
+  }
+  ASSERT_DOUBLE_EQ(50.0, slope);
+}
+
+TEST_F(LeakTrendDetectorTest, noDriftInLongRun){
+  TLeakTrendDetector detector(WINDOW);
+  double slope = 0.0;
+
+  /* Large usage over a year of snapshots at every minute. */
+  jlong base = 1700000000000L;
+  for(jlong i = 0; i < 525600; i++){
+    ASSERT_EQ(i >= WINDOW - 1,
+              AddSnapShot(&detector, base + i * 60000,
+                          1000000000000L + i * 60 * 12345, &slope));
+  }
+  ASSERT_NEAR(12345.0, slope, 12345.0 * 1e-9);
+}
+
+TEST_F(LeakTrendDetectorTest, decreaseResetsTrend){
+  TLeakTrendDetector detector(WINDOW);
+  double slope = 0.0;
+  jlong time = 0;
+
+  for(int i = 0; i < WINDOW; i++){
+    AddSnapShot(&detector, time += 1000, 1000 + i, &slope);
+  }
+  ASSERT_FALSE(AddSnapShot(&detector, time += 1000, 10, &slope));
+
+  /* Whole window must grow again. */
+  for(int i = 0; i < WINDOW - 2; i++){
+    ASSERT_FALSE(AddSnapShot(&detector, time += 1000, 20 + i, &slope));
+  }
+  ASSERT_TRUE(AddSnapShot(&detector, time += 1000, 100, &slope));
+}
+
+TEST_F(LeakTrendDetectorTest, alertOnceUntilDecrease){
+  TLeakTrendDetector detector(WINDOW);
+  double slope = 0.0;
+  jlong time = 0;
+
+  for(int i = 0; i < WINDOW; i++){
+    AddSnapShot(&detector, time += 1000, 1000 + i, &slope);
+  }
+  ASSERT_TRUE(detector.setAlerted(TAG));
+
+  ASSERT_TRUE(AddSnapShot(&detector, time += 1000, 2000, &slope));
+  ASSERT_FALSE(detector.setAlerted(TAG));
+
+  /* Decrease re-arms alert. */
+  AddSnapShot(&detector, time += 1000, 10, &slope);
+  for(int i = 0; i < WINDOW - 1; i++){
+    AddSnapShot(&detector, time += 1000, 20 + i, &slope);
+  }
+  ASSERT_TRUE(detector.setAlerted(TAG));
+}
+
+TEST_F(LeakTrendDetectorTest, unloadedClass){
+  TLeakTrendDetector detector(WINDOW);
+  double slope = 0.0;
+
+  AddSnapShot(&detector, 0, 1000, &slope);
+
+  /* Class which is not in snapshot is removed. */
+  detector.beginSnapShot(1000);
+  detector.endSnapShot();
+  ASSERT_FALSE(detector.setAlerted(TAG));
+}
+
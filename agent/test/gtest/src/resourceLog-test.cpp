@@ -0,0 +1,244 @@
+/*!
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <heapstats-engines/globals.hpp>
+#include <heapstats-engines/resourceLogWriter.hpp>
+#include <resource-log/resourceLogReader.hpp>
+
+
+#define RESULT_DIR "results"
+#define LOG_FILE RESULT_DIR "/resource.log"
+
+
+class ResourceLogTest : public testing::Test{
+
+  protected:
+
+    virtual void SetUp(){
+      unlink(LOG_FILE);
+    }
+
+    /* Make values of the row. */
+    void MakeRow(int row, uint64_t *values){
+      for(int col = 0; col < ResourceLogIntColumns; col++){
+        values[col] = 1000000ULL * col + row * (col + 1);
+      }
+    }
+
+    /* Read all rows in log file. */
+    int ReadRows(TResourceLogReader *reader, int column,
+                 std::vector<uint64_t> *values,
+                 std::vector<std::string> *archives){
+      int archiveColumn = reader->findColumn(RESOURCE_LOG_ARCHIVE_COLUMN);
+      int numRows = 0;
+
+      for(size_t idx = 0; idx < reader->getBlocks().size(); idx++){
+        TResourceLogRows rows;
+        EXPECT_TRUE(reader->decode(reader->getBlocks()[idx], &rows));
+
+        numRows += rows.rows;
+        values->insert(values->end(), rows.values[column].begin(),
+                       rows.values[column].end());
+        archives->insert(archives->end(),
+                         rows.strings[archiveColumn].begin(),
+                         rows.strings[archiveColumn].end());
+      }
+
+      return numRows;
+    }
+
+};
+
+
+TEST_F(ResourceLogTest, roundTrip){
+  uint64_t values[ResourceLogIntColumns];
+  TResourceLogWriter *writer = new TResourceLogWriter(LOG_FILE);
+
+  MakeRow(0, values);
+  ASSERT_EQ(0, writer->append(values, ""));
+  MakeRow(1, values);
+  values[ResourceLogJavaRSSize] = RESOURCE_LOG_UNKNOWN_VALUE;
+  values[ResourceLogTime] = (uint64_t)-5;
+  ASSERT_EQ(0, writer->append(values, "heapstats_log.zip"));
+  delete writer;
+
+  TResourceLogReader reader(LOG_FILE);
+  ASSERT_EQ(ResourceLogIntColumns + 1, (int)reader.getColumns().size());
+  ASSERT_EQ(1U, reader.getBlocks().size());
+  ASSERT_EQ(0U, reader.getBrokenBytes());
+
+  TResourceLogRows rows;
+  ASSERT_TRUE(reader.decode(reader.getBlocks()[0], &rows));
+  ASSERT_EQ(2, rows.rows);
+
+  for(int col = 0; col < ResourceLogIntColumns; col++){
+    int idx = reader.findColumn(resourceLogColumns[col].name);
+    ASSERT_NE(-1, idx) << resourceLogColumns[col].name;
+    ASSERT_EQ(resourceLogColumns[col].type, reader.getColumns()[idx].type);
+
+    MakeRow(0, values);
+    ASSERT_EQ(values[col], rows.values[idx][0]) << resourceLogColumns[col].name;
+    MakeRow(1, values);
+    values[ResourceLogJavaRSSize] = RESOURCE_LOG_UNKNOWN_VALUE;
+    values[ResourceLogTime] = (uint64_t)-5;
+    ASSERT_EQ(values[col], rows.values[idx][1]) << resourceLogColumns[col].name;
+  }
+
+  int archive = reader.findColumn(RESOURCE_LOG_ARCHIVE_COLUMN);
+  ASSERT_STREQ("", rows.strings[archive][0].c_str());
+  ASSERT_STREQ("heapstats_log.zip", rows.strings[archive][1].c_str());
+
+  ASSERT_EQ(-1, reader.findColumn("no_such_column"));
+}
+
+TEST_F(ResourceLogTest, rowIsWrittenImmediately){
+  uint64_t values[ResourceLogIntColumns];
+  TResourceLogWriter *writer = new TResourceLogWriter(LOG_FILE);
+
+  /* Rows are readable before the writer is closed, across blocks. */
+  for(int row = 0; row <= RESOURCE_LOG_MAX_BLOCK_ROWS; row++){
+    MakeRow(row, values);
+    ASSERT_EQ(0, writer->append(values, (row == 3) ? "archive.zip" : ""));
+
+    TResourceLogReader reader(LOG_FILE);
+    std::vector<uint64_t> causes;
+    std::vector<std::string> archives;
+    ASSERT_EQ(row + 1, ReadRows(&reader, reader.findColumn("cause"),
+                                &causes, &archives));
+    ASSERT_EQ(0U, reader.getBrokenBytes());
+    ASSERT_EQ(values[ResourceLogCause], causes[row]);
+  }
+
+  TResourceLogReader reader(LOG_FILE);
+  ASSERT_EQ(2U, reader.getBlocks().size());
+  delete writer;
+}
+
+TEST_F(ResourceLogTest, rowsArePackedWhenBlockIsFilled){
+  uint64_t values[ResourceLogIntColumns];
+  TResourceLogWriter *writer = new TResourceLogWriter(LOG_FILE);
+
+  /* Each row is written as a block until the block is filled. */
+  for(int row = 0; row < RESOURCE_LOG_MAX_BLOCK_ROWS - 1; row++){
+    MakeRow(row, values);
+    ASSERT_EQ(0, writer->append(values, ""));
+  }
+
+  off_t unpackedSize;
+  {
+    TResourceLogReader reader(LOG_FILE);
+    ASSERT_EQ((size_t)RESOURCE_LOG_MAX_BLOCK_ROWS - 1,
+              reader.getBlocks().size());
+
+    int fd = open(LOG_FILE, O_RDONLY);
+    unpackedSize = lseek(fd, 0, SEEK_END);
+    close(fd);
+  }
+
+  MakeRow(RESOURCE_LOG_MAX_BLOCK_ROWS - 1, values);
+  ASSERT_EQ(0, writer->append(values, "archive.zip"));
+
+  TResourceLogReader reader(LOG_FILE);
+  std::vector<uint64_t> causes;
+  std::vector<std::string> archives;
+  ASSERT_EQ(1U, reader.getBlocks().size());
+  ASSERT_EQ(RESOURCE_LOG_MAX_BLOCK_ROWS,
+            ReadRows(&reader, reader.findColumn("cause"), &causes,
+                     &archives));
+  ASSERT_EQ(0U, reader.getBrokenBytes());
+  ASSERT_STREQ("archive.zip", archives.back().c_str());
+
+  int fd = open(LOG_FILE, O_RDONLY);
+  ASSERT_LT(lseek(fd, 0, SEEK_END), unpackedSize);
+  close(fd);
+
+  delete writer;
+}
+
+TEST_F(ResourceLogTest, appendToExistingFile){
+  uint64_t values[ResourceLogIntColumns];
+
+  TResourceLogWriter *writer = new TResourceLogWriter(LOG_FILE);
+  MakeRow(0, values);
+  ASSERT_EQ(0, writer->append(values, "first.zip"));
+  delete writer;
+
+  writer = new TResourceLogWriter(LOG_FILE);
+  MakeRow(1, values);
+  ASSERT_EQ(0, writer->append(values, "second.zip"));
+  delete writer;
+
+  TResourceLogReader reader(LOG_FILE);
+  std::vector<uint64_t> times;
+  std::vector<std::string> archives;
+  ASSERT_EQ(2, ReadRows(&reader, reader.findColumn("time"), &times,
+                        &archives));
+  ASSERT_EQ(0U, reader.getBrokenBytes());
+
+  MakeRow(0, values);
+  ASSERT_EQ(values[ResourceLogTime], times[0]);
+  MakeRow(1, values);
+  ASSERT_EQ(values[ResourceLogTime], times[1]);
+  ASSERT_STREQ("first.zip", archives[0].c_str());
+  ASSERT_STREQ("second.zip", archives[1].c_str());
+}
+
+TEST_F(ResourceLogTest, skipBrokenBlock){
+  uint64_t values[ResourceLogIntColumns];
+  TResourceLogWriter *writer = new TResourceLogWriter(LOG_FILE);
+  for(int row = 0; row < RESOURCE_LOG_MAX_BLOCK_ROWS * 2; row++){
+    MakeRow(row, values);
+    ASSERT_EQ(0, writer->append(values, ""));
+  }
+  delete writer;
+
+  /* Break sync marker of the first block. */
+  off_t offset;
+  {
+    TResourceLogReader reader(LOG_FILE);
+    ASSERT_EQ(2U, reader.getBlocks().size());
+
+    int fd = open(LOG_FILE, O_RDONLY);
+    offset = lseek(fd, 0, SEEK_END);
+    close(fd);
+    offset -= reader.getBlocks()[1].size + reader.getBlocks()[0].size +
+              RESOURCE_LOG_BLOCK_HEADER_SIZE * 2;
+  }
+
+  int fd = open(LOG_FILE, O_WRONLY);
+  ASSERT_EQ(1, pwrite(fd, "X", 1, offset));
+  close(fd);
+
+  TResourceLogReader reader(LOG_FILE);
+  std::vector<uint64_t> causes;
+  std::vector<std::string> archives;
+  ASSERT_EQ(RESOURCE_LOG_MAX_BLOCK_ROWS,
+            ReadRows(&reader, reader.findColumn("cause"), &causes,
+                     &archives));
+  ASSERT_GT(reader.getBrokenBytes(), 0U);
+
+  MakeRow(RESOURCE_LOG_MAX_BLOCK_ROWS, values);
+  ASSERT_EQ(values[ResourceLogCause], causes[0]);
+}
+
@@ -0,0 +1,139 @@
+/*!
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <heapstats-engines/threadRecordFormat.hpp>
+
+
+class ThreadRecordFormatTest : public testing::Test{
+
+  protected:
+
+    /* Encode a record and decode it after the previous time. */
+    int RoundTrip(jlong prevTime, jlong delta, int event, jlong additionalData,
+                  TEventRecord *record){
+      unsigned char buf[MAX_COMPACT_RECORD_SIZE];
+      int size = encodeCompactRecord(buf, delta, event, additionalData);
+      EXPECT_LE(size, MAX_COMPACT_RECORD_SIZE);
+
+      record->time = prevTime;
+      record->thread_id = 1;
+      EXPECT_EQ(size, decodeCompactRecord(buf, buf + size, record));
+
+      return size;
+    }
+
+};
+
+
+TEST_F(ThreadRecordFormatTest, varintBoundaries){
+  TEventRecord record;
+
+  /* Event byte and 1 byte of delta. */
+  ASSERT_EQ(2, RoundTrip(100, 0, ThreadStart, 0, &record));
+  ASSERT_EQ(100, record.time);
+  ASSERT_EQ(ThreadStart, record.event);
+  ASSERT_EQ(0, record.additionalData);
+
+  ASSERT_EQ(2, RoundTrip(100, 0x7f, ThreadEnd, 0, &record));
+  ASSERT_EQ(100 + 0x7f, record.time);
+
+  ASSERT_EQ(3, RoundTrip(100, 0x80, ThreadEnd, 0, &record));
+  ASSERT_EQ(100 + 0x80, record.time);
+
+  ASSERT_EQ(3, RoundTrip(0, 0x3fff, Park, 0, &record));
+  ASSERT_EQ(0x3fff, record.time);
+
+  ASSERT_EQ(4, RoundTrip(0, 0x4000, Park, 0, &record));
+  ASSERT_EQ(0x4000, record.time);
+
+  /* Negative delta is encoded as 64 bits value. */
+  ASSERT_EQ(11, RoundTrip(100, -1, Unpark, 0, &record));
+  ASSERT_EQ(99, record.time);
+  ASSERT_EQ(1, record.thread_id);
+}
+
+TEST_F(ThreadRecordFormatTest, additionalData){
+  TEventRecord record;
+  jlong values[] = {1, -1, 63, -64, 64, -65, 0x7fffffffffffffffLL,
+                    (jlong)0x8000000000000000ULL};
+  int sizes[] = {3, 3, 3, 3, 4, 4, 12, 12};
+
+  for(size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++){
+    ASSERT_EQ(sizes[i], RoundTrip(0, 1, FileReadEnd, values[i], &record));
+    ASSERT_EQ(FileReadEnd, record.event);
+    ASSERT_EQ(values[i], record.additionalData);
+  }
+
+  /* Max size record. */
+  ASSERT_EQ(MAX_COMPACT_RECORD_SIZE,
+            RoundTrip(0, -1, SocketReadEnd, (jlong)0x8000000000000000ULL,
+                      &record));
+}
+
+TEST_F(ThreadRecordFormatTest, sequence){
+  unsigned char buf[MAX_COMPACT_RECORD_SIZE * 3];
+  int size = encodeCompactRecord(buf, 1000, MonitorWait, 0);
+  size += encodeCompactRecord(buf + size, 200000, MonitorWaited, 5);
+  size += encodeCompactRecord(buf + size, 3, ThreadEnd, 0);
+
+  TEventRecord record = {5000, 1, 0, 0};
+  const unsigned char *pos = buf;
+  const unsigned char *end = buf + size;
+
+  pos += decodeCompactRecord(pos, end, &record);
+  ASSERT_EQ(6000, record.time);
+  ASSERT_EQ(MonitorWait, record.event);
+
+  pos += decodeCompactRecord(pos, end, &record);
+  ASSERT_EQ(206000, record.time);
+  ASSERT_EQ(MonitorWaited, record.event);
+  ASSERT_EQ(5, record.additionalData);
+
+  pos += decodeCompactRecord(pos, end, &record);
+  ASSERT_EQ(206003, record.time);
+  ASSERT_EQ(ThreadEnd, record.event);
+  ASSERT_EQ(0, record.additionalData);
+
+  ASSERT_EQ(end, pos);
+  ASSERT_EQ(0, decodeCompactRecord(pos, end, &record));
+}
+
+TEST_F(ThreadRecordFormatTest, truncatedRecord){
+  unsigned char buf[MAX_COMPACT_RECORD_SIZE];
+  int size = encodeCompactRecord(buf, 0x12345678, SocketWriteEnd, -300);
+
+  /* Every prefix of the record is broken. */
+  for(int len = 0; len < size; len++){
+    TEventRecord record = {0, 1, 0, 0};
+    ASSERT_EQ(0, decodeCompactRecord(buf, buf + len, &record)) << len;
+  }
+
+  /* Varint which does not terminate in 64 bits is broken. */
+  unsigned char endless[MAX_COMPACT_RECORD_SIZE];
+  endless[0] = ThreadStart;
+  for(int i = 1; i < MAX_COMPACT_RECORD_SIZE; i++){
+    endless[i] = 0x80;
+  }
+  TEventRecord record = {0, 1, 0, 0};
+  ASSERT_EQ(0, decodeCompactRecord(endless, endless + sizeof(endless),
+                                   &record));
+}
+
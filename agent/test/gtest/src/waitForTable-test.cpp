@@ -0,0 +1,167 @@
+/*!
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <heapstats-engines/waitForTable.hpp>
+
+
+#define LAST_SLOT (WAIT_FOR_SHARD_SLOTS - 1)
+
+
+class WaitForTableTest : public testing::Test{
+
+  protected:
+
+    /* Same as TWaitForTable::hashKey() */
+    unsigned long long int HashKey(jlong key){
+      unsigned long long int hash = (unsigned long long int)key;
+      hash ^= hash >> 33;
+      hash *= 0xff51afd7ed558ccdULL;
+      hash ^= hash >> 33;
+      hash *= 0xc4ceb9fe1a85ec53ULL;
+      hash ^= hash >> 33;
+      return hash;
+    }
+
+    /* Find keys which are in the shard and have the home slot. */
+    void FindKeys(int shard, int home, jlong *keys, int num, jlong *from){
+      for(int found = 0; found < num; (*from)++){
+        unsigned long long int hash = HashKey(*from);
+        if(((int)(hash & (WAIT_FOR_SHARDS - 1)) == shard) &&
+           ((int)((hash >> 6) & (WAIT_FOR_SHARD_SLOTS - 1)) == home)){
+          keys[found++] = *from;
+        }
+      }
+    }
+
+};
+
+
+TEST_F(WaitForTableTest, putAndGet){
+  TWaitForTable table;
+  jlong value = 0;
+
+  ASSERT_FALSE(table.get(100, &value));
+
+  ASSERT_TRUE(table.put(100, 1));
+  ASSERT_TRUE(table.get(100, &value));
+  ASSERT_EQ(1, value);
+
+  /* Update */
+  ASSERT_TRUE(table.put(100, 2));
+  ASSERT_TRUE(table.get(100, &value));
+  ASSERT_EQ(2, value);
+
+  ASSERT_FALSE(table.replace(100, 1, 3));
+  ASSERT_TRUE(table.replace(100, 2, 3));
+  ASSERT_TRUE(table.get(100, &value));
+  ASSERT_EQ(3, value);
+  ASSERT_FALSE(table.replace(200, 0, 1));
+
+  table.remove(100);
+  ASSERT_FALSE(table.get(100, &value));
+
+  /* Removing absent key is ignored. */
+  table.remove(100);
+
+  ASSERT_TRUE(table.put(100, 4));
+  ASSERT_TRUE(table.put(200, 5));
+  table.clear();
+  ASSERT_FALSE(table.get(100, &value));
+  ASSERT_FALSE(table.get(200, &value));
+}
+
+TEST_F(WaitForTableTest, removeWithWraparound){
+  TWaitForTable table;
+  jlong from = 1;
+  jlong lastKeys[3];
+  jlong firstKey;
+  FindKeys(0, LAST_SLOT, lastKeys, 3, &from);
+  from = 1;
+  FindKeys(0, 0, &firstKey, 1, &from);
+
+  /*
+   * Cluster wraps around the end of shard:
+   *   slot 127: lastKeys[0], 0: lastKeys[1], 1: lastKeys[2], 2: firstKey
+   */
+  for(int i = 0; i < 3; i++){
+    ASSERT_TRUE(table.put(lastKeys[i], i));
+  }
+  ASSERT_TRUE(table.put(firstKey, 3));
+
+  /* Following entries are shifted back across the end of shard. */
+  table.remove(lastKeys[0]);
+
+  jlong value = -1;
+  ASSERT_FALSE(table.get(lastKeys[0], &value));
+  for(int i = 1; i < 3; i++){
+    ASSERT_TRUE(table.get(lastKeys[i], &value));
+    ASSERT_EQ(i, value);
+  }
+  ASSERT_TRUE(table.get(firstKey, &value));
+  ASSERT_EQ(3, value);
+
+  /* Entry in its home slot stays after removing the wrapped entry. */
+  table.remove(lastKeys[2]);
+  ASSERT_TRUE(table.get(lastKeys[1], &value));
+  ASSERT_EQ(1, value);
+  ASSERT_TRUE(table.get(firstKey, &value));
+  ASSERT_EQ(3, value);
+
+  table.remove(lastKeys[1]);
+  table.remove(firstKey);
+  for(int i = 0; i < 3; i++){
+    ASSERT_FALSE(table.get(lastKeys[i], &value));
+  }
+  ASSERT_FALSE(table.get(firstKey, &value));
+}
+
+TEST_F(WaitForTableTest, fullShard){
+  TWaitForTable table;
+  jlong keys[WAIT_FOR_SHARD_SLOTS + 1];
+  jlong from = 1;
+  for(int i = 0; i <= WAIT_FOR_SHARD_SLOTS; i++){
+    FindKeys(1, (LAST_SLOT - 2 + i) & LAST_SLOT, &keys[i], 1, &from);
+  }
+
+  for(int i = 0; i < WAIT_FOR_SHARD_SLOTS; i++){
+    ASSERT_TRUE(table.put(keys[i], i));
+  }
+  ASSERT_FALSE(table.put(keys[WAIT_FOR_SHARD_SLOTS], 0));
+
+  /* Existing entry can be updated even if the shard is full. */
+  ASSERT_TRUE(table.put(keys[0], 100));
+
+  jlong value;
+  for(int i = 0; i < WAIT_FOR_SHARD_SLOTS; i += 2){
+    table.remove(keys[i]);
+  }
+  for(int i = 0; i < WAIT_FOR_SHARD_SLOTS; i++){
+    ASSERT_EQ((i % 2) != 0, table.get(keys[i], &value)) << i;
+    if((i % 2) != 0){
+      ASSERT_EQ(i, value);
+    }
+  }
+
+  ASSERT_TRUE(table.put(keys[WAIT_FOR_SHARD_SLOTS], 200));
+  ASSERT_TRUE(table.get(keys[WAIT_FOR_SHARD_SLOTS], &value));
+  ASSERT_EQ(200, value);
+}
+
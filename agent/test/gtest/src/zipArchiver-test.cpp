@@ -0,0 +1,204 @@
+/*!
+ * Copyright (C) 2026 Nippon Telegraph and Telephone Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <string>
+
+#include <heapstats-engines/globals.hpp>
+#include <heapstats-engines/configuration.hpp>
+#include <heapstats-engines/zipArchiver.hpp>
+
+
+#define RESULT_DIR "results"
+#define ARCHIVE_FILE RESULT_DIR "/zip_test.zip"
+#define SOURCE_FILE RESULT_DIR "/zip_source"
+#define DEFLATED_FILE RESULT_DIR "/zip_deflated"
+
+/* Larger than chunks of parallel deflate. */
+#define SOURCE_SIZE (1024 * 1024 + 123)
+
+
+class ZipArchiverTest : public testing::Test{
+
+  protected:
+
+    TConfiguration *savedConf;
+
+    std::string source;
+
+    virtual void SetUp(){
+      savedConf = conf;
+      conf = new TConfiguration(NULL);
+      unlink(ARCHIVE_FILE);
+
+      /* Compressible data which has some noise. */
+      srand(1);
+      source.clear();
+      for(int i = 0; i < SOURCE_SIZE; i++){
+        source += (char)(((i / 7) % 26) + 'a' + ((rand() % 16) == 0));
+      }
+
+      int fd = open(SOURCE_FILE, O_CREAT | O_WRONLY | O_TRUNC,
+                    S_IRUSR | S_IWUSR);
+      ASSERT_EQ((ssize_t)source.size(),
+                write(fd, source.data(), source.size()));
+      close(fd);
+    }
+
+    virtual void TearDown(){
+      delete conf;
+      conf = savedConf;
+    }
+
+    /* Test archive by unzip. */
+    bool TestArchive(){
+      return system("unzip -tqq " ARCHIVE_FILE " > /dev/null") == 0;
+    }
+
+    /* Extract entry by unzip. */
+    std::string ReadEntry(const char *name){
+      std::string cmd = std::string("unzip -p " ARCHIVE_FILE " ") + name +
+                        " 2> /dev/null";
+      std::string content;
+      FILE *pipe = popen(cmd.c_str(), "r");
+      char buf[4096];
+      size_t readSize;
+      while((readSize = fread(buf, 1, sizeof(buf), pipe)) > 0){
+        content.append(buf, readSize);
+      }
+      pclose(pipe);
+
+      return content;
+    }
+
+    /* Add data to archive through pipe. */
+    int AddFromPipe(TZipArchiver *archiver, const char *data, size_t size,
+                    const char *name, uint64_t *dataSize){
+      int fds[2];
+      if(pipe(fds) != 0){
+        return errno;
+      }
+
+      /* Data must be smaller than pipe buffer. */
+      EXPECT_EQ((ssize_t)size, write(fds[1], data, size));
+      close(fds[1]);
+      int result = archiver->addStream(fds[0], name, dataSize);
+      close(fds[0]);
+
+      return result;
+    }
+
+    /* Add files to archive, and check it by unzip. */
+    void MakeArchive(){
+      TZipArchiver archiver;
+      ASSERT_EQ(0, archiver.openArchive(ARCHIVE_FILE));
+      ASSERT_EQ(0, archiver.addFile(SOURCE_FILE, "dir/source"));
+
+      uint64_t dataSize = 1;
+      ASSERT_EQ(0, AddFromPipe(&archiver, "stream data\n", 12, "stream",
+                               &dataSize));
+      ASSERT_EQ(12U, dataSize);
+      ASSERT_EQ(0, AddFromPipe(&archiver, "", 0, "empty", &dataSize));
+      ASSERT_EQ(0U, dataSize);
+
+      /* Not regular file is ignored. */
+      ASSERT_EQ(0, archiver.addFile(RESULT_DIR, "dir"));
+
+      ASSERT_EQ(0, archiver.closeArchive(0));
+
+      ASSERT_TRUE(TestArchive());
+      ASSERT_TRUE(source == ReadEntry("dir/source"));
+      ASSERT_STREQ("stream data\n", ReadEntry("stream").c_str());
+      ASSERT_STREQ("", ReadEntry("empty").c_str());
+    }
+
+};
+
+
+TEST_F(ZipArchiverTest, addEntries){
+  conf->ArchiveThreads()->set(1);
+  MakeArchive();
+}
+
+TEST_F(ZipArchiverTest, addEntriesInParallel){
+  conf->ArchiveThreads()->set(4);
+  MakeArchive();
+}
+
+TEST_F(ZipArchiverTest, addDeflated){
+  int srcFd = open(SOURCE_FILE, O_RDONLY);
+  int destFd = open(DEFLATED_FILE, O_CREAT | O_RDWR | O_TRUNC,
+                    S_IRUSR | S_IWUSR);
+  ASSERT_NE(-1, srcFd);
+  ASSERT_NE(-1, destFd);
+
+  TZipDeflatedData deflated;
+  ASSERT_EQ(0, TZipArchiver::deflateApart(srcFd, destFd, NULL, NULL,
+                                          &deflated));
+  ASSERT_EQ((uint64_t)SOURCE_SIZE, deflated.size);
+  ASSERT_LT(deflated.csize, deflated.size);
+  close(srcFd);
+
+  TZipArchiver archiver;
+  ASSERT_EQ(0, archiver.openArchive(ARCHIVE_FILE));
+  ASSERT_EQ(0, archiver.addDeflated("deflated", &deflated));
+  ASSERT_EQ(0, archiver.closeArchive(0));
+  close(destFd);
+
+  ASSERT_TRUE(TestArchive());
+  ASSERT_TRUE(source == ReadEntry("deflated"));
+}
+
+TEST_F(ZipArchiverTest, abortEntry){
+  TZipArchiver archiver;
+  ASSERT_EQ(0, archiver.openArchive(ARCHIVE_FILE));
+  ASSERT_EQ(0, AddFromPipe(&archiver, "first\n", 6, "first", NULL));
+
+  /* Aborted entry is discarded, and entries before it are kept. */
+  archiver.setAborted(true);
+  ASSERT_EQ(ECANCELED, archiver.addFile(SOURCE_FILE, "aborted"));
+  archiver.setAborted(false);
+  ASSERT_EQ(0, AddFromPipe(&archiver, "last\n", 5, "last", NULL));
+  ASSERT_EQ(0, archiver.closeArchive(0));
+
+  ASSERT_TRUE(TestArchive());
+  ASSERT_STREQ("first\n", ReadEntry("first").c_str());
+  ASSERT_STREQ("last\n", ReadEntry("last").c_str());
+  ASSERT_STREQ("", ReadEntry("aborted").c_str());
+}
+
+TEST_F(ZipArchiverTest, removeFailedArchive){
+  TZipArchiver archiver;
+  ASSERT_EQ(0, archiver.openArchive(ARCHIVE_FILE));
+  ASSERT_EQ(0, archiver.addFile(SOURCE_FILE, "source"));
+  archiver.closeArchive(ECANCELED);
+
+  struct stat st;
+  errno = 0;
+  stat(ARCHIVE_FILE, &st);
+  ASSERT_EQ(ENOENT, errno);
+}
+
@@ -40,9 +40,8 @@ public class ThreadRecordParser{
 
     private long additionalData;
 
-    public ThreadStat(long longTime, long id, long longEvent,
+    public ThreadStat(Instant instant, long id, long longEvent,
                                                       long additionalData){
-      Instant instant = Instant.ofEpochMilli(longTime);
       time = LocalDateTime.ofInstant(instant, ZoneId.systemDefault());
       this.id = id;
       event = ThreadEvent.values()[(int)longEvent];
@@ -69,6 +68,18 @@ public class ThreadRecordParser{
 
   }
 
+  /* Time of entry which has thread name instead of records. */
+  private static final long THREAD_NAME_ENTRY_TIME = -1L;
+
+  private long wallClockAnchor;
+
+  private long monotonicAnchor;
+
+  private Instant toInstant(long monotonicTime){
+    return Instant.ofEpochSecond(0,
+                          wallClockAnchor + (monotonicTime - monotonicAnchor));
+  }
+
   private ByteOrder getByteOrder(SeekableByteChannel ch, ByteBuffer buffer)
                                                              throws IOException{
     buffer.position(buffer.capacity() - 1);
@@ -80,6 +91,17 @@ public class ThreadRecordParser{
                                        : ByteOrder.BIG_ENDIAN;
   }
 
+  private void setTimeAnchor(SeekableByteChannel ch, ByteBuffer buffer)
+                                                             throws IOException{
+    buffer.position(buffer.capacity() - 16);
+    buffer.mark();
+    ch.read(buffer);
+    buffer.reset();
+
+    wallClockAnchor = buffer.getLong();
+    monotonicAnchor = buffer.getLong();
+  }
+
   private Map<Long, String> getThreadIdMap(SeekableByteChannel ch,
                                           ByteBuffer buffer) throws IOException{
     int capacity = buffer.capacity();
@@ -116,24 +138,84 @@ public class ThreadRecordParser{
     return idMap;
   }
 
+  private int getFormatVersion(SeekableByteChannel ch, ByteBuffer buffer)
+                                                             throws IOException{
+    buffer.position(buffer.capacity() - 8);
+    buffer.mark();
+    ch.read(buffer);
+    buffer.reset();
+
+    byte[] magic = new byte[4];
+    buffer.get(magic);
+    if(!new String(magic).equals("HTRC")){
+      throw new IOException("Unknown thread record format");
+    }
+
+    return buffer.getInt();
+  }
+
+  private static long readVarLong(ByteBuffer buffer){
+    long result = 0;
+
+    for(int shift = 0; shift < 64; shift += 7){
+      byte b = buffer.get();
+      result |= (long)(b & 0x7f) << shift;
+
+      if((b & 0x80) == 0){
+        break;
+      }
+    }
+
+    return result;
+  }
+
   private List<ThreadStat> getThreadStatList(SeekableByteChannel ch,
-                                          ByteBuffer buffer) throws IOException{
+                                          ByteBuffer buffer,
+                                          Map<Long, String> idMap)
+                                                             throws IOException{
     List<ThreadStat> threadStatList = new ArrayList<>();
-    buffer.flip();
+    int capacity = buffer.capacity();
+
+    buffer.position(capacity - 4);
+    buffer.mark();
+    ch.read(buffer);
+    buffer.reset();
+    int numSegments = buffer.getInt();
+
+    for(int Cnt = 0; Cnt < numSegments; Cnt++){
+      buffer.position(capacity - 20);
+      buffer.mark();
+      ch.read(buffer);
+      buffer.reset();
+      long id = buffer.getLong();
+      long time = buffer.getLong();
+      int len = buffer.getInt();
 
-    while(ch.read(buffer) != -1){
-      buffer.flip();
-      ThreadStat stat = new ThreadStat(buffer.getLong(), buffer.getLong(),
-                                        buffer.getLong(), buffer.getLong());
+      ByteBuffer records = ByteBuffer.allocate(len);
+      while(records.hasRemaining() && (ch.read(records) != -1));
+      records.flip();
 
-      if(stat.getEvent() == ThreadEvent.Unused){
-        break;
+      if(time == THREAD_NAME_ENTRY_TIME){
+        idMap.put(id, new String(records.array()));
+        continue;
       }
 
-      threadStatList.add(stat);
-      buffer.flip();
+      while(records.hasRemaining()){
+        int event = records.get() & 0xff;
+        time += readVarLong(records);
+
+        long additionalData = 0;
+        if((event & 0x80) != 0){
+          long zigzag = readVarLong(records);
+          additionalData = (zigzag >>> 1) ^ -(zigzag & 1);
+        }
+
+        threadStatList.add(new ThreadStat(toInstant(time), id, event & 0x7f,
+                                          additionalData));
+      }
     }
 
+    threadStatList.sort(Comparator.comparing(ThreadStat::getTime));
     return threadStatList;
   }
 
@@ -144,14 +226,17 @@ public class ThreadRecordParser{
                                                       StandardOpenOption.READ)){
       buffer.order(getByteOrder(ch, buffer));
       System.out.println("ByteOrder: " + buffer.order());
+      System.out.println("Format version: " + getFormatVersion(ch, buffer));
       System.out.println();
 
+      setTimeAnchor(ch, buffer);
+
       Map<Long, String> idMap = getThreadIdMap(ch, buffer);
+      List<ThreadStat> threadStatList = getThreadStatList(ch, buffer, idMap);
       System.out.println("Thread ID Map:");
       idMap.forEach((k, v) -> System.out.println(k + ": " + v));
       System.out.println();
 
-      List<ThreadStat> threadStatList = getThreadStatList(ch, buffer);
       threadStatList.forEach(System.out::println);
     }
 
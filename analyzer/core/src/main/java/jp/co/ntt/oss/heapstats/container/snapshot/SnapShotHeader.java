@@ -69,6 +69,12 @@ public class SnapShotHeader implements Comparable<SnapShotHeader>, Serializable
      */
     public static final byte EXTENDED_FORMAT_FLAG_SAFEPOINT_TIME = 0b00000010;
 
+    /**
+     * Flag for class filter of extended SnapShot format.
+     * SnapShot which has this flag contains only classes which are matched to class filter.
+     */
+    public static final byte EXTENDED_FORMAT_FLAG_FILTERED = 0b00000100;
+
     /**
      * serialVersionUID.
      */
@@ -650,6 +656,16 @@ public class SnapShotHeader implements Comparable<SnapShotHeader>, Serializable
         return (snapShotType & EXTENDED_FORMAT_FLAG_SAFEPOINT_TIME) == EXTENDED_FORMAT_FLAG_SAFEPOINT_TIME;
     }
 
+    /**
+     * Get true if this snapshot data is counted by class filter.
+     * Classes which are not in this snapshot are not measured.
+     * @return true if this snapshot is filtered.
+     */
+    public boolean isFiltered(){
+        return ((snapShotType & EXTENDED_FORMAT) == EXTENDED_FORMAT) &&
+               ((snapShotType & EXTENDED_FORMAT_FLAG_FILTERED) == EXTENDED_FORMAT_FLAG_FILTERED);
+    }
+
     /**
      * Get true if this snapshot data has a metaspace data.
      * @return true if has a metaspace data.
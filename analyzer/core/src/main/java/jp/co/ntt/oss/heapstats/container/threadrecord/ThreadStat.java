@@ -68,7 +68,19 @@ public class ThreadStat implements Comparable<ThreadStat>{
      * @param additionalData Additional information like size of reading, etc.
      */
     public ThreadStat(long longTime, long id, long longEvent, long additionalData){
-      time = LocalDateTime.ofInstant(Instant.ofEpochMilli(longTime), ZoneId.systemDefault());
+      this(Instant.ofEpochMilli(longTime), id, longEvent, additionalData);
+    }
+
+    /**
+     * Constructor of ThreadStat.
+     * 
+     * @param instant Date time of this event.
+     * @param id Thread ID.
+     * @param longEvent Event value of ThreadEvent.
+     * @param additionalData Additional information like size of reading, etc.
+     */
+    public ThreadStat(Instant instant, long id, long longEvent, long additionalData){
+      time = LocalDateTime.ofInstant(instant, ZoneId.systemDefault());
       this.id = id;
       event = ThreadEvent.values()[(int)longEvent];
       this.additionalData = additionalData;
@@ -17,6 +17,7 @@
  */
 package jp.co.ntt.oss.heapstats.parser;
 
+import java.io.EOFException;
 import java.io.IOException;
 import java.io.UncheckedIOException;
 import java.nio.ByteBuffer;
@@ -25,7 +26,9 @@ import java.nio.channels.SeekableByteChannel;
 import java.nio.file.Files;
 import java.nio.file.Path;
 import java.nio.file.StandardOpenOption;
+import java.time.Instant;
 import java.util.ArrayList;
+import java.util.Arrays;
 import java.util.HashMap;
 import java.util.List;
 import java.util.Map;
@@ -40,6 +43,21 @@ import jp.co.ntt.oss.heapstats.container.threadrecord.ThreadStat.ThreadEvent;
  * @author Yasumasa Suenaga
  */
 public class ThreadRecordParser {
+
+    /**
+     * Magic number of thread record file.
+     */
+    private static final byte[] MAGIC = {'H', 'T', 'R', 'C'};
+
+    /**
+     * Latest format version which this parser supports.
+     */
+    private static final int FORMAT_VERSION = 2;
+
+    /**
+     * Flag in event byte which presents additional data follows.
+     */
+    private static final int EVENT_HAS_ADDITIONAL_DATA = 0x80;
     
     /**
      * This map holds Thread ID - Thread Name map.
@@ -50,6 +68,16 @@ public class ThreadRecordParser {
      * This list holds thread status.
      */
     private List<ThreadStat> threadStatList;
+
+    /**
+     * Wall-clock time in NS from UNIX epoch of the anchor.
+     */
+    private long wallClockAnchor;
+
+    /**
+     * Monotonic time in NS of the anchor.
+     */
+    private long monotonicAnchor;
     
     /**
      * Get byte order from channel.
@@ -68,6 +96,36 @@ public class ThreadRecordParser {
         return (buffer.get() == (byte)'L') ? ByteOrder.LITTLE_ENDIAN : ByteOrder.BIG_ENDIAN;
     }
     
+    /**
+     * Get wall-clock / monotonic clock anchor from channel.
+     * 
+     * @param ch Channel to read.
+     * @param buffer ByteBuffer to use.
+     * @throws IOException If some other I/O error occurs.
+     */
+    private void setTimeAnchor(SeekableByteChannel ch, ByteBuffer buffer) throws IOException{
+        int capacity = buffer.capacity();
+
+        buffer.position(capacity - 16);
+        buffer.mark();
+        ch.read(buffer);
+        buffer.reset();
+
+        wallClockAnchor = buffer.getLong();
+        monotonicAnchor = buffer.getLong();
+    }
+
+    /**
+     * Convert monotonic time of event to wall-clock time.
+     * 
+     * @param monotonicTime Monotonic time in NS.
+     * @return Wall-clock time of the event.
+     */
+    private Instant toInstant(long monotonicTime){
+        long epochNanos = wallClockAnchor + (monotonicTime - monotonicAnchor);
+        return Instant.ofEpochSecond(0, epochNanos);
+    }
+    
     /**
      * Get Thread ID - Thread Name map entry from channel.
      * This method may throw UncheckedIOException if IOException occurs.
@@ -131,7 +189,128 @@ public class ThreadRecordParser {
     }
 
     /**
-     * Get Thread Stat list from channel.
+     * Get format version from channel.
+     * Legacy file does not have magic number, so the channel is rewound
+     * to the top of Thread ID - Thread Name map in that case.
+     * 
+     * @param ch Channel to read.
+     * @param buffer ByteBuffer to use.
+     * @return Format version.
+     * @throws IOException If some other I/O error occurs.
+     */
+    private int getFormatVersion(SeekableByteChannel ch, ByteBuffer buffer) throws IOException{
+        int capacity = buffer.capacity();
+
+        buffer.position(capacity - 4);
+        buffer.mark();
+        ch.read(buffer);
+        buffer.reset();
+
+        byte[] magic = new byte[4];
+        buffer.get(magic);
+        if(!Arrays.equals(magic, MAGIC)){
+            ch.position(1); // next to byte order mark
+            return 1;
+        }
+
+        buffer.position(capacity - 4);
+        buffer.mark();
+        ch.read(buffer);
+        buffer.reset();
+
+        int version = buffer.getInt();
+        if(version > FORMAT_VERSION){
+            throw new IOException("Unsupported thread record format: " + version);
+        }
+
+        return version;
+    }
+
+    /**
+     * Read bytes from channel until buffer is filled.
+     * 
+     * @param ch Channel to read.
+     * @param buffer ByteBuffer to fill.
+     * @throws IOException If some other I/O error occurs or reaches EOF.
+     */
+    private void readFully(SeekableByteChannel ch, ByteBuffer buffer) throws IOException{
+        while(buffer.hasRemaining()){
+            if(ch.read(buffer) == -1){
+                throw new EOFException("Thread record file is truncated.");
+            }
+        }
+        buffer.flip();
+    }
+
+    /**
+     * Read unsigned LEB128 value.
+     * 
+     * @param buffer ByteBuffer to read.
+     * @return Decoded value.
+     */
+    private static long readVarLong(ByteBuffer buffer){
+        long result = 0;
+
+        for(int shift = 0; shift < 64; shift += 7){
+            byte b = buffer.get();
+            result |= (long)(b & 0x7f) << shift;
+
+            if((b & 0x80) == 0){
+                break;
+            }
+        }
+
+        return result;
+    }
+
+    /**
+     * Get Thread Stat list from compact ring segments in channel.
+     * Each record is an event byte, varint of time delta from previous
+     * record, and optional zigzag varint of additional data.
+     * 
+     * @param ch Channel to read.
+     * @param order Byte order of the file.
+     * @return Thread Stat list.
+     * @throws IOException If some other I/O error occurs.
+     */
+    private List<ThreadStat> getCompactThreadStatList(SeekableByteChannel ch, ByteOrder order) throws IOException{
+        List<ThreadStat> result = new ArrayList<>();
+        ByteBuffer header = ByteBuffer.allocate(20).order(order);
+
+        header.limit(4);
+        readFully(ch, header);
+        int numSegments = header.getInt();
+
+        for(int i = 0; i < numSegments; i++){
+            header.clear();
+            readFully(ch, header);
+            long id = header.getLong();
+            long time = header.getLong();
+            int length = header.getInt();
+
+            ByteBuffer records = ByteBuffer.allocate(length);
+            readFully(ch, records);
+
+            while(records.hasRemaining()){
+                int event = records.get() & 0xff;
+                time += readVarLong(records);
+
+                long additionalData = 0;
+                if((event & EVENT_HAS_ADDITIONAL_DATA) != 0){
+                    long zigzag = readVarLong(records);
+                    additionalData = (zigzag >>> 1) ^ -(zigzag & 1);
+                }
+
+                result.add(new ThreadStat(toInstant(time), id, event & ~EVENT_HAS_ADDITIONAL_DATA, additionalData));
+            }
+
+        }
+
+        return result;
+    }
+
+    /**
+     * Get Thread Stat list from legacy channel.
      * 
      * @param ch Channel to read.
      * @param buffer ByteBuffer to use.
@@ -173,8 +352,16 @@ public class ThreadRecordParser {
 
         try(SeekableByteChannel ch = Files.newByteChannel(path, StandardOpenOption.READ)){
             buffer.order(getByteOrder(ch, buffer));
-            idMap = getThreadIdMap(ch, buffer);
-            threadStatList = getThreadStatList(ch, buffer);
+
+            if(getFormatVersion(ch, buffer) == 1){
+                idMap = getThreadIdMap(ch, buffer);
+                threadStatList = getThreadStatList(ch, buffer);
+            }
+            else{
+                setTimeAnchor(ch, buffer);
+                idMap = getThreadIdMap(ch, buffer);
+                threadStatList = getCompactThreadStatList(ch, buffer.order());
+            }
         }
         
         threadStatList = threadStatList.parallelStream()
@@ -68,10 +68,13 @@ public class CSVDumpHeap extends ProgressRunnable{
         joiner.add(String.format("0x%X", tag))
               .add(className);
         
-        snapShots.stream()
-                 .map(h -> Optional.ofNullable(h.getSnapShot(needJavaStyle).get(tag)))
-                 .peek(p -> joiner.add(p.map(o -> o.getCount()).orElse(0L).toString()))
-                 .forEach(p -> joiner.add(p.map(o -> o.getTotalSize()).orElse(0L).toString()));
+        /* Classes which are not in filtered snapshot are not measured, so they are empty. */
+        snapShots.forEach(h -> {
+            Optional<ObjectData> p = Optional.ofNullable(h.getSnapShot(needJavaStyle).get(tag));
+            String unknown = h.isFiltered() ? "" : "0";
+            joiner.add(p.map(o -> Long.toString(o.getCount())).orElse(unknown));
+            joiner.add(p.map(o -> Long.toString(o.getTotalSize())).orElse(unknown));
+        });
         
         return joiner.toString();
     }
@@ -154,7 +154,10 @@ public class DiffCalculator extends ProgressRunnable {
 
         Map<Long, ObjectData> start = startHeader.getSnapShot(needJavaStyle);
         Map<Long, ObjectData> end = endHeader.getSnapShot(needJavaStyle);
-        start.forEach((k, v) -> end.putIfAbsent(k, new ObjectData(k, v.getName(), v.getClassLoader(), v.getClassLoaderTag(), 0, 0, v.getLoaderName(), null)));
+        /* Classes which are not in filtered snapshot are not measured, so they are not regarded as freed. */
+        if (!endHeader.isFiltered()) {
+            start.forEach((k, v) -> end.putIfAbsent(k, new ObjectData(k, v.getName(), v.getClassLoader(), v.getClassLoaderTag(), 0, 0, v.getLoaderName(), null)));
+        }
 
         if (filter.isPresent()) {
             end.entrySet().stream()
@@ -95,6 +95,27 @@ public class HeapStats implements HeapStatsMBean{
    */
   private native boolean invokeAllLogCollection0();
 
+  /**
+   * Invoke snapshot of Thread Recorder at libheapstats.
+   *
+   * @return true if the request is accepted.
+   */
+  private native boolean invokeThreadRecordSnapshot0();
+
+  /**
+   * Get I/O latency statistics from libheapstats.
+   *
+   * @return Current statistics.
+   */
+  private native Map<String, Long> getIOLatencyStatistics0();
+
+  /**
+   * Get the most contended monitor classes from libheapstats.
+   *
+   * @return Current statistics.
+   */
+  private native Map<String, Long> getContendedMonitors0();
+
   /**
    * {@inheritDoc}
    */
@@ -218,6 +239,30 @@ public class HeapStats implements HeapStatsMBean{
     return invokeAllLogCollection0();
   }
 
+  /**
+   * {@inheritDoc}
+   */
+  @Override
+  public boolean invokeThreadRecordSnapshot(){
+    return invokeThreadRecordSnapshot0();
+  }
+
+  /**
+   * {@inheritDoc}
+   */
+  @Override
+  public Map<String, Long> getIOLatencyStatistics(){
+    return getIOLatencyStatistics0();
+  }
+
+  /**
+   * {@inheritDoc}
+   */
+  @Override
+  public Map<String, Long> getContendedMonitors(){
+    return getContendedMonitors0();
+  }
+
   /**
    * {@inheritDoc}
    */
@@ -121,6 +121,38 @@ public interface HeapStatsMBean{
    */
   public boolean invokeAllLogCollection();
 
+  /**
+   * Invoke snapshot of Thread Recorder.
+   * Current records are written to timestamped file asynchronously
+   * while recording continues.
+   *
+   * @return true if the request is accepted.
+   */
+  public boolean invokeThreadRecordSnapshot();
+
+  /**
+   * Get I/O latency statistics which are gathered by Thread Recorder.
+   * Key is "&lt;kind&gt;.&lt;statistic&gt;" such as "socket_read.p99_ns".
+   * Kind is file_write, file_read, socket_write or socket_read.
+   * Statistic is count, bytes, mean_ns, p50_ns, p90_ns, p99_ns, p999_ns
+   * or max_ns.
+   *
+   * @return Current statistics. Map is empty if Thread Recorder is not
+   *         working.
+   */
+  public Map<String, Long> getIOLatencyStatistics();
+
+  /**
+   * Get the most contended monitor classes since last snapshot.
+   * Key is "&lt;class name&gt;.&lt;statistic&gt;" such as
+   * "Ljava/lang/Object;.wait_ns". Statistic is count, wait_ns or
+   * max_wait_ns. Entries are ordered by wait time.
+   *
+   * @return Current statistics. Map is empty if contention profiler is not
+   *         working.
+   */
+  public Map<String, Long> getContendedMonitors();
+
   /**
    * Create a MBean service.
    * This function is for WildFly/JBoss.
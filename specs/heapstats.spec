@@ -15,6 +15,7 @@ Buildroot: /var/tmp/heapstats
 # Requires for running
 Requires: pcre >= 6
 Requires: tbb
+Requires: zlib
 
 # Requires for building
 BuildRequires: pcre-devel >= 6
@@ -25,6 +26,7 @@ BuildRequires: binutils-devel
 BuildRequires: autoconf
 BuildRequires: automake
 BuildRequires: tbb-devel
+BuildRequires: zlib-devel
 
 %description
 A lightweight monitoring JVMTI agent for Java HotSpot VM.
@@ -93,6 +95,9 @@ rm -rf $RPM_BUILD_ROOT
 %dir %{_sysconfdir}/heapstats/iotracer/
 %{_sysconfdir}/heapstats/iotracer/IoTrace.class
 /usr/bin/heapstats-attacher
+%{_bindir}/heapstats-thread-analyzer
+%{_bindir}/heapstats-resource-log
+%{_bindir}/heapstats-rehydrate
 /usr/libexec/heapstats/heapstats-attacher.jar
 /etc/ld.so.conf.d/heapstats-agent.conf
 /usr/share/snmp/mibs/HeapStatsMibs.txt